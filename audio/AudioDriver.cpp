@@ -14,6 +14,7 @@
 
 #define TEST_TONES    0
 #define PASSTHROUGH   0
+#define MASTER_LIMITER  0   // Peak limiter on the output, ahead of master volume
 
 
 extern "C" {
@@ -49,6 +50,11 @@ volatile bool AUDIO_MEM dsp_overload;
 
 float master_volume_ = 0;
 
+#if MASTER_LIMITER
+#include "../synth/BusDynamics.hpp"
+static BusLimiter master_limiter_;
+#endif  // MASTER_LIMITER
+
 #if TEST_TONES
 maxiOsc osc, osc2;
 
@@ -101,6 +107,9 @@ static inline __attribute__((always_inline)) void AUDIO_FUNC(process_normal)(
     };
 
     y = audio_callback_(y);  // y should now be in [-1.0, 1.0] range
+#if MASTER_LIMITER
+    master_limiter_.play(y.L, y.R);
+#endif
 
     output[indexL] = static_cast<int32_t>(_scale_and_saturate(y.L * master_volume_));
     output[indexR] = static_cast<int32_t>(_scale_and_saturate(y.R * master_volume_));
@@ -125,6 +134,9 @@ static void AUDIO_FUNC(process_audio)(const int32_t* input, int32_t* output, siz
         // Serial.println(input[0]);
         // Call block callback
         audio_callback_block_(input_buffer, output_buffer, kNChannels, num_frames);
+#if MASTER_LIMITER
+        master_limiter_.processBlock(output_buffer[0], output_buffer[1], num_frames);
+#endif
 
         // Convert from deinterleaved float to interleaved int32_t
         for (size_t i = 0; i < num_frames; i++) {
@@ -222,6 +234,16 @@ bool AudioDriver::Setup(const codec_config_t &config) {
 
     maxiSettings::setup(kSampleRate, 2, kBufferSize);
 
+#if MASTER_LIMITER
+    master_limiter_.setup(static_cast<float>(kSampleRate));
+    master_limiter_.setThreshold(-0.3f);
+    master_limiter_.setRatio(100.f);
+    master_limiter_.setAttack(0.f);
+    master_limiter_.setRelease(50.f);
+    master_limiter_.setLookahead(1.f);
+    master_limiter_.reset();
+#endif
+
     if (!Wire.setSDA(i2c_sgt5000Data) ||
             !Wire.setSCL(i2c_sgt5000Clk)) {
          DEBUG_PRINTLN("AUDIO- Failed to setup I2C with codec!");
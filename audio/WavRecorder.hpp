@@ -0,0 +1,345 @@
+#ifndef __WAV_RECORDER_HPP__
+#define __WAV_RECORDER_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "../interface/SDAsyncIO.hpp"
+#include "../utils/SPSCRing.hpp"
+#include "../PicoDefs.hpp"
+
+
+/**
+ * @brief Streams multitrack 16-bit PCM WAV files to the SD card.
+ *
+ * The audio callback pushes frames into a lock-free ring; Service(), on the
+ * other core, moves them into SDAsyncIO buffers and queues the writes. If
+ * the card stalls for longer than the ring can cover, frames are dropped
+ * and counted as overruns rather than blocking audio. A failed open or
+ * write (or a write SDAsyncIO could not queue) ends the recording, and the
+ * cause is logged.
+ *
+ * Every write is a whole kBufferBytes buffer at a sector-aligned file
+ * offset (the 44-byte header shares the first buffer), so the card never
+ * has to read-modify-write a sector until the final, partial buffer.
+ *
+ *     WavRecorder<2> recorder(sdio);
+ *     recorder.Start("/take1.wav", 48000, 2);   // control core
+ *     recorder.Push(frame);                     // audio core, per frame
+ *     recorder.Service(); sdio.Service();       // control core loop
+ *     recorder.Stop();
+ *
+ * @tparam kMaxTracks Largest number of interleaved tracks.
+ * @tparam kRingSamples Ring size in samples (power of 2); at 48 kHz stereo
+ * the default covers 170 ms of card latency.
+ */
+template<size_t kMaxTracks = 2, size_t kRingSamples = 16384>
+class WavRecorder
+{
+public:
+    static constexpr size_t kHeaderBytes = 44;
+
+    struct Stats {
+        uint32_t frames_recorded;
+        uint32_t overrun_frames;    ///< Frames dropped because the ring was full
+        uint32_t overruns;          ///< Separate runs of dropped frames
+        uint32_t write_errors;
+        size_t ring_peak;           ///< Most samples waiting in the ring
+    };
+
+    explicit WavRecorder(SDAsyncIO &io) :
+        io_(io),
+        state_(kIdle),
+        handle_(-1),
+        n_tracks_(0),
+        sample_rate_(0),
+        fill_(nullptr),
+        fill_bytes_(0),
+        data_bytes_(0),
+        dropping_(false),
+        failure_(kNoFailure),
+        push_stats_{},
+        write_errors_(0),
+        ring_peak_(0) {}
+
+    /**
+     * @brief Open a new file and start accepting frames.
+     */
+    bool Start(const char *path, uint32_t sample_rate, size_t n_tracks) {
+        if (state_ != kIdle || n_tracks == 0 || n_tracks > kMaxTracks) {
+            return false;
+        }
+        fill_ = io_.AcquireBuffer();
+        if (!fill_) {
+            return false;
+        }
+        handle_ = io_.Open(path, true, [this](bool ok, size_t) {
+            if (!ok) {
+                Fail_(kOpenFailed);
+            }
+        });
+        if (handle_ < 0) {
+            io_.ReleaseBuffer(fill_);
+            fill_ = nullptr;
+            return false;
+        }
+        n_tracks_ = n_tracks;
+        sample_rate_ = sample_rate;
+        data_bytes_ = 0;
+        dropping_ = false;
+        failure_ = kNoFailure;
+        push_stats_ = {};
+        write_errors_ = 0;
+        ring_peak_ = 0;
+        WriteHeader_(fill_, 0);
+        fill_bytes_ = kHeaderBytes;
+        ring_.Clear();
+        __dmb();
+        state_ = kRecording;
+        return true;
+    }
+
+    /**
+     * @brief Stop accepting frames. The file is completed by Service() once
+     * the ring has drained.
+     */
+    void Stop() {
+        if (state_ == kRecording) {
+            state_ = kStopping;
+        }
+    }
+
+    inline bool IsRecording() const { return state_ == kRecording; }
+    inline bool IsIdle() const { return state_ == kIdle; }
+
+    /**
+     * @brief Record one frame of n_tracks samples (audio core).
+     * @return false if the frame was dropped.
+     */
+    bool __force_inline Push(const float *frame) {
+        if (state_ != kRecording) {
+            return false;
+        }
+        int16_t pcm[kMaxTracks];
+        for (size_t i = 0; i < n_tracks_; i++) {
+            pcm[i] = ToPCM_(frame[i]);
+        }
+        if (!ring_.Push(pcm, n_tracks_)) {
+            push_stats_.overrun_frames++;
+            if (!dropping_) {
+                dropping_ = true;
+                push_stats_.overruns++;
+            }
+            return false;
+        }
+        dropping_ = false;
+        push_stats_.frames_recorded++;
+        return true;
+    }
+
+    /**
+     * @brief Record n_frames interleaved frames (audio core).
+     * @return Frames recorded.
+     */
+    size_t Push(const float *frames, size_t n_frames) {
+        size_t n = 0;
+        for (size_t i = 0; i < n_frames; i++) {
+            n += Push(frames + i * n_tracks_);
+        }
+        return n;
+    }
+
+    /**
+     * @brief Move ring data to the card queue; call from the non-audio
+     * core's loop alongside SDAsyncIO::Service().
+     */
+    void Service() {
+        if (state_ == kIdle) {
+            return;
+        }
+        const size_t waiting = ring_.Available();
+        if (waiting > ring_peak_) {
+            ring_peak_ = waiting;
+        }
+        if (failure_ != kNoFailure) {
+            Abort_();
+            return;
+        }
+
+        while (true) {
+            if (!fill_) {
+                fill_ = io_.AcquireBuffer();
+                fill_bytes_ = 0;
+                if (!fill_) {
+                    // All buffers queued: the ring absorbs the delay
+                    break;
+                }
+            }
+            const size_t want = (SDAsyncIO::kBufferBytes - fill_bytes_) / sizeof(int16_t);
+            const size_t n = ring_.Pop(reinterpret_cast<int16_t *>(fill_ + fill_bytes_), want);
+            fill_bytes_ += n * sizeof(int16_t);
+            data_bytes_ += n * sizeof(int16_t);
+            if (fill_bytes_ < SDAsyncIO::kBufferBytes) {
+                break;
+            }
+            Flush_();
+        }
+
+        if (state_ == kStopping && ring_.Available() == 0) {
+            Finish_();
+        }
+    }
+
+    Stats GetStats() const {
+        Stats s;
+        s.frames_recorded = push_stats_.frames_recorded;
+        s.overrun_frames = push_stats_.overrun_frames;
+        s.overruns = push_stats_.overruns;
+        s.write_errors = write_errors_;
+        s.ring_peak = ring_peak_;
+        return s;
+    }
+
+protected:
+    enum State : uint8_t {
+        kIdle,
+        kRecording,
+        kStopping
+    };
+
+    enum Failure : uint8_t {
+        kNoFailure,
+        kOpenFailed,
+        kWriteFailed,       ///< The card reported a short or failed write
+        kQueueFull          ///< SDAsyncIO rejected a write: the file has a gap
+    };
+
+    // Each counter has one writer: Push() on the audio core updates
+    // push_stats_, the control core (Service() and the SDAsyncIO
+    // completions it runs) the rest
+    struct PushStats {
+        uint32_t frames_recorded;
+        uint32_t overrun_frames;
+        uint32_t overruns;
+    };
+
+    SDAsyncIO &io_;
+    SPSCRing<int16_t, kRingSamples> ring_;
+    volatile State state_;
+    int handle_;
+    size_t n_tracks_;
+    uint32_t sample_rate_;
+    uint8_t *fill_;             ///< Buffer being filled, or nullptr
+    size_t fill_bytes_;
+    uint32_t data_bytes_;
+    bool dropping_;
+    volatile Failure failure_;
+    PushStats push_stats_;
+    uint32_t write_errors_;
+    size_t ring_peak_;
+
+    static int16_t __force_inline ToPCM_(float x) {
+        if (x > 1.f) x = 1.f;
+        if (x < -1.f) x = -1.f;
+        return static_cast<int16_t>(x * 32767.f);
+    }
+
+    /**
+     * @brief Keep the first failure; Service() aborts the recording.
+     */
+    void Fail_(Failure failure) {
+        if (failure_ == kNoFailure) {
+            failure_ = failure;
+        }
+    }
+
+    void Flush_() {
+        if (!io_.Write(handle_, fill_, fill_bytes_, [this](bool ok, size_t) {
+                if (!ok) {
+                    write_errors_++;
+                    Fail_(kWriteFailed);
+                }
+            })) {
+            write_errors_++;
+            Fail_(kQueueFull);
+        }
+        fill_ = nullptr;
+        fill_bytes_ = 0;
+    }
+
+    /**
+     * @brief Write the last partial buffer, patch the header sizes, close.
+     */
+    void Finish_() {
+        if (fill_ && fill_bytes_ > 0) {
+            Flush_();
+        } else if (fill_) {
+            io_.ReleaseBuffer(fill_);
+            fill_ = nullptr;
+        }
+        uint8_t *header = io_.AcquireBuffer();
+        if (!header) {
+            // Try again on the next call
+            return;
+        }
+        WriteHeader_(header, data_bytes_);
+        if (!io_.WriteAt(handle_, 0, header, kHeaderBytes)) {
+            write_errors_++;
+        }
+        io_.Close(handle_);
+        handle_ = -1;
+        state_ = kIdle;
+    }
+
+    void Abort_() {
+        switch (failure_) {
+            case kOpenFailed:
+                DEBUG_PRINTLN("WavRecorder: could not open file");
+                break;
+            case kWriteFailed:
+                DEBUG_PRINTLN("WavRecorder: write to card failed, recording stopped");
+                break;
+            case kQueueFull:
+                DEBUG_PRINTLN("WavRecorder: SD request queue full, recording stopped");
+                break;
+            default:
+                break;
+        }
+        state_ = kIdle;
+        if (fill_) {
+            io_.ReleaseBuffer(fill_);
+            fill_ = nullptr;
+        }
+        ring_.Clear();
+        io_.Close(handle_);
+        handle_ = -1;
+    }
+
+    static void Put16_(uint8_t *p, uint16_t v) {
+        p[0] = static_cast<uint8_t>(v);
+        p[1] = static_cast<uint8_t>(v >> 8);
+    }
+
+    static void Put32_(uint8_t *p, uint32_t v) {
+        Put16_(p, static_cast<uint16_t>(v));
+        Put16_(p + 2, static_cast<uint16_t>(v >> 16));
+    }
+
+    void WriteHeader_(uint8_t *p, uint32_t data_bytes) const {
+        const uint16_t block_align = static_cast<uint16_t>(n_tracks_ * sizeof(int16_t));
+        std::memcpy(p, "RIFF", 4);
+        Put32_(p + 4, 36 + data_bytes);
+        std::memcpy(p + 8, "WAVEfmt ", 8);
+        Put32_(p + 16, 16);
+        Put16_(p + 20, 1);      // PCM
+        Put16_(p + 22, static_cast<uint16_t>(n_tracks_));
+        Put32_(p + 24, sample_rate_);
+        Put32_(p + 28, sample_rate_ * block_align);
+        Put16_(p + 32, block_align);
+        Put16_(p + 34, 16);
+        std::memcpy(p + 36, "data", 4);
+        Put32_(p + 40, data_bytes);
+    }
+};
+
+#endif  // __WAV_RECORDER_HPP__
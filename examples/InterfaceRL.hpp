@@ -25,6 +25,8 @@
 #include "../hardware/memlnaut/display/NameInputView.hpp"
 #include "../hardware/memlnaut/display/CCSelectView.hpp"
 #include "InterfaceRLFileFormat.hpp"
+#include "../hardware/FlashModelStore.hpp"
+#include "../hardware/StateStore.hpp"
 
 #define RL_MEM __not_in_flash("rlmem")
 
@@ -357,9 +359,15 @@ protected:
     void _perform_randomiseRL_action();
     bool _save_RL_to_SD(String id);
     bool _load_RL_from_SD(String id);
+    bool _install_RL_to_flash(int slot, const String& name);
+    bool _load_RL_from_flash(int slot, const String& name);
+    static FlashModelStore& _modelStore();
     void _forget_replay_mem_interf();
     void _saveSlotNames();
+    void _saveSlotNamesToSD();
     void _loadSlotNames();
+    bool _loadSlotNamesFromStore();
+    void _applySlotName(int slot, const String& name);
 
     static constexpr int kNumSlots = 12;
     String slotNames[kNumSlots];
@@ -391,7 +399,8 @@ private:
     // Constant used to pad the unused NN input dims; recomputed only on input-mode change.
     float unusedInputDefault_ = 0.5f;
 
-    static constexpr const char* kInputSourceFile = "/input_source.bin";
+    static constexpr const char* kInputSourceFile = "/input_source.bin";  // Pre-StateStore location
+    static constexpr const char* kInputSourceKey = "input_source";
     void assembleInputs();
     void copyAndZero(const float* src, size_t n);
     void saveInputSource();
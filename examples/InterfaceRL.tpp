@@ -431,7 +431,9 @@ void InterfaceRL<N_OUTPUTS>::setup(size_t n_inputs, size_t n_outputs, bool addMe
         String filename = (slotNames[slotIdx].length() > 0) ? slotNames[slotIdx] : String(id);
         fileLoadView->SetMessage("Loading " + filename);
         uint32_t save = spin_lock_blocking(mlpActive);
-        if (MEMLNaut::Instance()->startSD()) {
+        if (this->_load_RL_from_flash(slotIdx, filename)) {
+            fileLoadView->SetMessage("Loaded " + filename);
+        } else if (MEMLNaut::Instance()->startSD()) {
             if (this->_load_RL_from_SD(filename)) {
                 fileLoadView->SetMessage("Loaded " + filename);
             } else {
@@ -455,14 +457,20 @@ void InterfaceRL<N_OUTPUTS>::setup(size_t n_inputs, size_t n_outputs, bool addMe
                 fileLoadView->updateButtonName(static_cast<size_t>(pendingSaveSlot), displayName);
                 fileSaveView->SetMessage("Saving as " + displayName);
                 uint32_t save = spin_lock_blocking(mlpActive);
+                // Flash copy for instant recall; the SD copy stays the library
+                const bool installed = this->_install_RL_to_flash(pendingSaveSlot, displayName);
+                // Names go to StateStore either way, so a flash-only save can be recalled
+                _saveSlotNames();
                 if (MEMLNaut::Instance()->startSD()) {
-                    _saveSlotNames();
+                    _saveSlotNamesToSD();
                     if (this->_save_RL_to_SD(displayName)) {
                         fileSaveView->SetMessage("Saved as " + displayName);
                     } else {
                         fileSaveView->SetMessage("Failed to save model");
                     }
                     MEMLNaut::Instance()->stopSD();
+                } else if (installed) {
+                    fileSaveView->SetMessage("Saved to flash only (no SD card)");
                 } else {
                     fileSaveView->SetMessage("SD card error - is it inserted and formatted?");
                 }
@@ -482,7 +490,7 @@ template<size_t N_OUTPUTS>
 void InterfaceRL<N_OUTPUTS>::setModeInfo(const String& modeRoot, const String& modeTag) {
     _modeRoot = modeRoot;
     _modeTag = modeTag;
-    if (MEMLNaut::Instance()->startSD()) {
+    if (!_loadSlotNamesFromStore() && MEMLNaut::Instance()->startSD()) {
         _loadSlotNames();
         MEMLNaut::Instance()->stopSD();
     }
@@ -595,8 +603,82 @@ bool InterfaceRL<N_OUTPUTS>::_load_RL_from_SD(String id) {
     return success;
 }
 
+template<size_t N_OUTPUTS>
+FlashModelStore& InterfaceRL<N_OUTPUTS>::_modelStore() {
+    // One region shared by all modes; records carry the mode tag
+    static FlashModelStore store;
+    return store;
+}
+
+template<size_t N_OUTPUTS>
+bool InterfaceRL<N_OUTPUTS>::_install_RL_to_flash(int slot, const String& name) {
+    static constexpr size_t kLayers[] = {kMaxNNInputs, 16, 16, N_OUTPUTS};
+    const size_t total = SynthMLP::TotalWeights();
+
+    std::vector<float> weights(total);
+    for (size_t i = 0; i < total; i++) {
+        weights[i] = *synthMapping.WeightPtrAt(i);
+    }
+    std::vector<uint8_t> extraData;
+    if (_extraSaveFn) {
+        extraData = _extraSaveFn();
+    }
+
+    return _modelStore().Install(static_cast<size_t>(slot), _modeTag.c_str(), name.c_str(),
+        MEML_FILE_FORMAT_VERSION, FlashModelStore::LayoutHash(kLayers, 4, total),
+        weights.data(), total, extraData.data(), extraData.size());
+}
+
+template<size_t N_OUTPUTS>
+bool InterfaceRL<N_OUTPUTS>::_load_RL_from_flash(int slot, const String& name) {
+    static constexpr size_t kLayers[] = {kMaxNNInputs, 16, 16, N_OUTPUTS};
+    const size_t total = SynthMLP::TotalWeights();
+
+    FlashModelStore& store = _modelStore();
+    const FlashModelStore::RecordHeader* record = store.Find(static_cast<size_t>(slot));
+    if (!record) {
+        return false;
+    }
+    // Only a record of this mode and slot name, with this architecture; anything
+    // else (another mode's model, a renamed slot) falls back to the SD copy
+    if (!FlashModelStore::FieldEquals(record->mode_tag, _modeTag.c_str())
+        || !FlashModelStore::FieldEquals(record->name, name.c_str())
+        || record->format_version > MEML_FILE_FORMAT_VERSION
+        || record->layout_hash != FlashModelStore::LayoutHash(kLayers, 4, total)
+        || record->n_weights != total) {
+        return false;
+    }
+
+    if (record->extra_size > 0 && _extraLoadFn) {
+        _extraLoadFn(store.Extra(record), static_cast<uint16_t>(record->extra_size), record->format_version);
+    }
+
+    float* first = synthMapping.WeightPtrAt(0);
+    if (total > 0 && synthMapping.WeightPtrAt(total - 1) == first + (total - 1)) {
+        store.CopyWeights(record, first, total);
+    } else {
+        const float* src = store.Weights(record);
+        for (size_t i = 0; i < total; i++) {
+            *synthMapping.WeightPtrAt(i) = src[i];
+        }
+    }
+    newInput = true;
+    return true;
+}
+
 template<size_t N_OUTPUTS>
 void InterfaceRL<N_OUTPUTS>::_saveSlotNames() {
+    String joined;
+    for (int i = 0; i < kNumSlots; i++) {
+        joined += slotNames[i] + "\n";
+    }
+    String key = _modeRoot + "/slots";
+    StateStore::Default().Set(key.c_str(), joined.c_str(), joined.length());
+}
+
+template<size_t N_OUTPUTS>
+void InterfaceRL<N_OUTPUTS>::_saveSlotNamesToSD() {
+    // slots.txt travels with the models on the card
     String dir = "/" + _modeRoot;
     if (!SD.exists(dir.c_str())) {
         SD.mkdir(dir.c_str());
@@ -611,6 +693,32 @@ void InterfaceRL<N_OUTPUTS>::_saveSlotNames() {
     file.close();
 }
 
+template<size_t N_OUTPUTS>
+void InterfaceRL<N_OUTPUTS>::_applySlotName(int slot, const String& name) {
+    slotNames[slot] = name;
+    if (name.length() > 0) {
+        fileSaveView->updateButtonName(static_cast<size_t>(slot), name);
+        fileLoadView->updateButtonName(static_cast<size_t>(slot), name);
+    }
+}
+
+template<size_t N_OUTPUTS>
+bool InterfaceRL<N_OUTPUTS>::_loadSlotNamesFromStore() {
+    String key = _modeRoot + "/slots";
+    const std::vector<uint8_t>* stored = StateStore::Default().Find(key.c_str());
+    if (!stored) return false;
+    String joined;
+    joined.concat(reinterpret_cast<const char*>(stored->data()), stored->size());
+    int start = 0;
+    for (int i = 0; i < kNumSlots; i++) {
+        int end = joined.indexOf('\n', start);
+        if (end < 0) break;
+        _applySlotName(i, joined.substring(start, end));
+        start = end + 1;
+    }
+    return true;
+}
+
 template<size_t N_OUTPUTS>
 void InterfaceRL<N_OUTPUTS>::_loadSlotNames() {
     String path = "/" + _modeRoot + "/slots.txt";
@@ -619,11 +727,7 @@ void InterfaceRL<N_OUTPUTS>::_loadSlotNames() {
     for (int i = 0; i < kNumSlots; i++) {
         String line = file.readStringUntil('\n');
         line.trim();
-        slotNames[i] = line;
-        if (line.length() > 0) {
-            fileSaveView->updateButtonName(static_cast<size_t>(i), line);
-            fileLoadView->updateButtonName(static_cast<size_t>(i), line);
-        }
+        _applySlotName(i, line);
     }
     file.close();
 }
@@ -811,14 +915,16 @@ void InterfaceRL<N_OUTPUTS>::copyAndZero(const float* src, size_t n) {
 
 template<size_t N_OUTPUTS>
 void InterfaceRL<N_OUTPUTS>::saveInputSource() {
-    FILE* f = fopen(kInputSourceFile, "wb");
-    if (f) { fwrite(&input_source_, sizeof(input_source_), 1, f); fclose(f); }
+    StateStore::Default().SetValue(kInputSourceKey, input_source_);
 }
 
 template<size_t N_OUTPUTS>
 void InterfaceRL<N_OUTPUTS>::loadInputSource() {
-    FILE* f = fopen(kInputSourceFile, "rb");
-    if (f) { fread(&input_source_, sizeof(input_source_), 1, f); fclose(f); }
+    if (!StateStore::Default().GetValue(kInputSourceKey, input_source_)) {
+        // Saved by older firmware
+        FILE* f = fopen(kInputSourceFile, "rb");
+        if (f) { fread(&input_source_, sizeof(input_source_), 1, f); fclose(f); }
+    }
     updateUnusedInputDefault();
 }
 
@@ -982,18 +1088,21 @@ void InterfaceRL<N_OUTPUTS>::storeExperience(float reward, std::vector<float> &e
 template<size_t N_OUTPUTS>
 void InterfaceRL<N_OUTPUTS>::saveCCNumbers() {
     if (!ccSelectView) return;
-    String path = "/" + _modeRoot + "_cc_numbers.bin";
-    FILE* f = fopen(path.c_str(), "wb");
-    if (f) {
-        const auto& ccs = ccSelectView->getSelectedCCs();
-        fwrite(ccs.data(), 1, ccs.size(), f);
-        fclose(f);
-    }
+    String key = _modeRoot + "/cc";
+    const auto& ccs = ccSelectView->getSelectedCCs();
+    StateStore::Default().Set(key.c_str(), ccs.data(), ccs.size());
 }
 
 template<size_t N_OUTPUTS>
 void InterfaceRL<N_OUTPUTS>::loadCCNumbers() {
     if (!ccSelectView) return;
+    String key = _modeRoot + "/cc";
+    const std::vector<uint8_t>* stored = StateStore::Default().Find(key.c_str());
+    if (stored && !stored->empty()) {
+        ccSelectView->setSelectedCCs(*stored);
+        return;
+    }
+    // Saved by older firmware
     String path = "/" + _modeRoot + "_cc_numbers.bin";
     FILE* f = fopen(path.c_str(), "rb");
     if (f) {
@@ -23,28 +23,28 @@ stereosample_t KassiaAudioApp::Process(const stereosample_t x)
     // bpf4Val = bpfEnv4.play(bpf4Val);
     // WRITE_VOLATILE(sharedMem::f3, bpf4Val);
 
-    smoother.Process(neuralNetOutputs.data(), smoothParams.data());
+    smoother.Tick();
 
     // Process smoothed params
-    dl1mix = smoothParams[0] * smoothParams[0] * 0.4f;
-    dl2mix = smoothParams[1] * smoothParams[1] * 0.4f;
-    dl3mix = smoothParams[2] * smoothParams[2] * 0.8f;
-    allp1fb = smoothParams[4] * 0.99f;
-    allp2fb = smoothParams[5] * 0.99f;
-    float comb1fb = (smoothParams[6] * 0.95f);
-    float comb2fb = (smoothParams[7] * 0.95f);
-
-    float dl1fb = (smoothParams[8] * 0.95f);
-    float dl2fb = (smoothParams[9] * 0.95f);
-    float dl3fb = (smoothParams[10] * 0.95f);
+    dl1mix = smoother.Get(0) * smoother.Get(0) * 0.4f;
+    dl2mix = smoother.Get(1) * smoother.Get(1) * 0.4f;
+    dl3mix = smoother.Get(2) * smoother.Get(2) * 0.8f;
+    allp1fb = smoother.Get(4) * 0.99f;
+    allp2fb = smoother.Get(5) * 0.99f;
+    float comb1fb = (smoother.Get(6) * 0.95f);
+    float comb2fb = (smoother.Get(7) * 0.95f);
+
+    float dl1fb = (smoother.Get(8) * 0.95f);
+    float dl2fb = (smoother.Get(9) * 0.95f);
+    float dl3fb = (smoother.Get(10) * 0.95f);
     // Wet-dry mix between 0.2 and 1
-    wetdry_mix_ = (smoothParams[11] * 0.8f) + 0.2f;
+    wetdry_mix_ = (smoother.Get(11) * 0.8f) + 0.2f;
     // Pitch shift transposition between -12 and +12 semitones
-    float pitchshift_transpose = (smoothParams[12] * 24.f) - 12.f; // Scale to -12 to +12 semitones
+    float pitchshift_transpose = (smoother.Get(12) * 24.f) - 12.f; // Scale to -12 to +12 semitones
     pitchshifter_.SetTransposition(pitchshift_transpose);
     //pitchshifter_.SetTransposition(-5.f);
     // Set pitch shifter mix
-    pitchshifter_mix_ = smoothParams[13] * 0.99f;
+    pitchshifter_mix_ = smoother.Get(13) * 0.99f;
 
     // PROCESS
     float pitchshifted = pitchshifter_.Process(mix);
@@ -91,7 +91,7 @@ void KassiaAudioApp::Setup(float sample_rate, std::shared_ptr<InterfaceBase> int
 
 void KassiaAudioApp::ProcessParams(const std::vector<float>& params)
 {
-    neuralNetOutputs = params;
+    smoother.SetTargets(params.data(), params.size());
 }
 
 
@@ -20,10 +20,12 @@ class KassiaAudioApp : public AudioAppBase
 public:
     static constexpr size_t kN_Params = 14;
 
-    KassiaAudioApp() : AudioAppBase(), smoother(150.f, kSampleRate),
-        neuralNetOutputs(kN_Params, 0),
-        smoothParams(kN_Params, 0)
-     {}
+    KassiaAudioApp() : AudioAppBase(), smoother(kSampleRate)
+    {
+        for (size_t i = 0; i < kN_Params; i++) {
+            smoother.Register(150.f);
+        }
+    }
 
     AudioDriver::codec_config_t GetDriverConfig() const override {
         return {
@@ -52,8 +54,6 @@ protected:
     maxiReverbFilters<300> comb1;
     maxiReverbFilters<1000> comb2;
 
-    std::vector<float> neuralNetOutputs, smoothParams;
-
 
     float frame=0;
     float dl1mix = 0.0f;
@@ -75,7 +75,7 @@ protected:
 
     maxiDCBlocker dcb;
 
-    OnePoleSmoother<kN_Params> smoother;
+    ParamSmoother<kN_Params> smoother;
     daisysp::PitchShifter pitchshifter_;
     float pitchshifter_mix_{0.5f};
     float wetdry_mix_{0.5f};
@@ -102,10 +102,11 @@ public:
     }
 
 
-    MLDrummer() : AudioAppBase(), smoother(150.f, kSampleRate),
-        neuralNetOutputs(kN_Params, 0),
-        smoothParams(kN_Params, 0)
+    MLDrummer() : AudioAppBase(), smoother(kSampleRate)
     {
+        for (size_t i = 0; i < kN_Params; i++) {
+            smoother.Register(150.f);
+        }
         if (!get_sample_info("afrfunk1", &sample_info)) {
             DEBUG_PRINTLN("Error: Sample  not found in audio data.");
         }else{
@@ -152,16 +153,16 @@ public:
         WRITE_VOLATILE(sharedMem::f3, bpf4Val);
     #endif
 
-        smoother.Process(neuralNetOutputs.data(), smoothParams.data());
+        smoother.Tick();
 
         // Process drum machine
 #if BREAKBEAT
         //cast phase with rounding
         size_t currentSegment = static_cast<size_t>(phase / sample_info.sample_count / segLength);
-        float segmentRoot = (float)static_cast<size_t>(smoothParams[currentSegment] * segments);
+        float segmentRoot = (float)static_cast<size_t>(smoother.Get(currentSegment) * segments);
 
         // Check continue flag for current segment
-        bool continuePrevious = smoothParams[currentSegment + segments] > 0.5f;
+        bool continuePrevious = smoother.Get(currentSegment + segments) > 0.5f;
 
         float samplePosition;
         if (continuePrevious) {
@@ -182,7 +183,7 @@ public:
         // float y = sample_info.samples[static_cast<size_t>(phase+0.5f)];
         float y = sample_info.samples[static_cast<size_t>(samplePosition+0.5f)];
         float rateInput = 1.f;
-        // if (smoothParams[1] > 0.5f) {
+        // if (smoother.Get(1) > 0.5f) {
         //     rateInput *= -1.f;
         // }
         phase += rateInput;
@@ -208,9 +209,9 @@ public:
         // First parameter sets read speed
         constexpr float kRateInputMin = 0.5f;
         constexpr float kRateInputMax = 2.f;
-        float rateInput = kRateInputMin + (smoothParams[0] * (kRateInputMax - kRateInputMin));
+        float rateInput = kRateInputMin + (smoother.Get(0) * (kRateInputMax - kRateInputMin));
         // Second parameter sets direction
-        if (smoothParams[1] > 0.5f) {
+        if (smoother.Get(1) > 0.5f) {
             rateInput *= -1.f;
         }
         // Read sample at current phase (linear interpolation, with wrap-around if across sample_count boundary)
@@ -248,14 +249,12 @@ public:
 
     void ProcessParams(const std::vector<float>& params) override
     {
-        neuralNetOutputs = params;
+        smoother.SetTargets(params.data(), params.size());
 
     }
 
 protected:
 
-    std::vector<float> neuralNetOutputs, smoothParams;
-
 #if OLD_LISTENING_MODE
     //listening
     maxiBiquad bpf1;
@@ -271,7 +270,7 @@ protected:
 
     maxiDCBlocker dcb;
 
-    OnePoleSmoother<kN_Params> smoother;
+    ParamSmoother<kN_Params> smoother;
 
     sample_info_t sample_info;
     float phase=0.f;
@@ -297,7 +296,7 @@ public:
     static constexpr size_t kN_Params = sizeof(params) / sizeof(float);
 
     MLDrummerNew() : AudioAppBase(),
-        smoother(150.f, kSampleRate),
+        smoother(kSampleRate),
         loops {
             PlayLoop("bettyloops100"),
             PlayLoop("bettyloops101"),
@@ -316,27 +315,49 @@ public:
         // Set mixer gains to 1
         for (size_t i = 0; i < kMixerChannels; i++) {
             params.mixer[i] = 1.f;
+            smoother.Register(150.f, ParamSmoother<kMixerChannels>::kOnePole, 1.f);
+        }
+    }
+
+    void Setup(float sample_rate, std::shared_ptr<InterfaceBase> interface) override
+    {
+        AudioAppBase::Setup(sample_rate, interface);
+        // Loops may be stored at their own rate in the pack
+        streamer.Begin();
+        for (size_t i = 0; i < kMixerChannels; i++) {
+            loops[i].SetOutputRate(sample_rate);
+            if (loops[i].AttachStream(&streams[i])) {
+                streamer.Add(&streams[i]);
+            }
         }
+        streamer.Service();
+    }
+
+    void loop() override
+    {
+        // Keep the loops' SRAM read-ahead windows filled outside the audio callback
+        streamer.Service();
+        AudioAppBase::loop();
     }
 
     void ProcessParams(const std::vector<float>& p) override
     {
         size_t n = p.size() < kN_Params ? p.size() : kN_Params;
         memcpy(&params, p.data(), n * sizeof(float));
+        smoother.SetTargets(params.mixer, kMixerChannels);
     }
 
     inline stereosample_t __attribute__((always_inline)) Process(stereosample_t x)
     {
 
         // Smooth mixer parameters
-        float smoothed_mixer_params[kMixerChannels];
-        smoother.Process(params.mixer, smoothed_mixer_params);
+        smoother.Tick();
 
         // Fetch samples
         static const size_t kN_playheads = kMixerChannels;
         float mix[kMixerChannels] = {0.f};
         for (size_t i = 0; i < kN_playheads; i++) {
-            mix[i] = loops[i].Process() * params.mixer[i];
+            mix[i] = loops[i].Process() * smoother.Get(i);
         }
         // Mix down
         float out = 0.f;
@@ -351,7 +372,9 @@ public:
 protected:
 
     PlayLoop loops[kMixerChannels];
-    OnePoleSmoother<kMixerChannels> smoother;
+    SampleStream streams[kMixerChannels];
+    SampleStreamer streamer;
+    ParamSmoother<kMixerChannels> smoother;
     maxiOsc osc;
 
 };
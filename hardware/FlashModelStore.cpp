@@ -0,0 +1,223 @@
+#include "FlashModelStore.hpp"
+#include "../utils/CRC16.hpp"
+#include "../PicoDefs.hpp"
+
+#if defined(ARDUINO_ARCH_RP2040)
+#include <Arduino.h>
+#include "hardware/flash.h"
+#include "hardware/dma.h"
+
+// From the arduino-pico linker script
+extern "C" uint8_t __flash_binary_end;
+extern "C" uint8_t _FS_start;
+extern "C" uint8_t _FS_end;
+#endif
+
+
+FlashModelStore::FlashModelStore(uint32_t flash_offset, size_t n_slots, size_t slot_bytes) :
+    flash_offset_(flash_offset),
+    n_slots_(n_slots),
+    slot_bytes_(slot_bytes)
+{
+#if defined(ARDUINO_ARCH_RP2040)
+    base_ = reinterpret_cast<const uint8_t *>(XIP_BASE + flash_offset_);
+    usable_ = CheckRegion(XIP_BASE + flash_offset_, n_slots_ * slot_bytes_, XIP_BASE + PICO_FLASH_SIZE_BYTES,
+                          reinterpret_cast<uintptr_t>(&__flash_binary_end),
+                          reinterpret_cast<uintptr_t>(&_FS_start), reinterpret_cast<uintptr_t>(&_FS_end));
+    if (!usable_) {
+        DEBUG_PRINTF("FlashModelStore: region at 0x%08lx overlaps the firmware or filesystem, disabled\n",
+                     static_cast<unsigned long>(flash_offset_));
+    }
+#else
+    sim_.assign(n_slots_ * slot_bytes_, 0xFF);
+    base_ = sim_.data();
+    usable_ = flash_offset_ % kSectorBytes == 0;
+#endif
+}
+
+
+bool FlashModelStore::CheckRegion(uintptr_t start, size_t bytes, uintptr_t flash_end,
+                                  uintptr_t image_end, uintptr_t fs_start, uintptr_t fs_end) {
+    const uintptr_t end = start + bytes;
+    return start % kSectorBytes == 0 && bytes > 0 && end <= flash_end && start >= image_end &&
+           (fs_start == fs_end || end <= fs_start || start >= fs_end);
+}
+
+
+bool FlashModelStore::FieldEquals(const char (&field)[16], const char *s) {
+    const size_t n = s ? std::strlen(s) : 0;
+    if (n >= sizeof(field)) {
+        return false;
+    }
+    // Install() zero-pads, so everything after the string must be zero
+    for (size_t i = 0; i < sizeof(field); i++) {
+        if (field[i] != (i < n ? s[i] : '\0')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+size_t FlashModelStore::Capacity(size_t extra_size) const {
+    const size_t weights_offset = Align_(sizeof(RecordHeader) + extra_size, kWeightAlign);
+    return weights_offset < slot_bytes_ ? (slot_bytes_ - weights_offset) / sizeof(float) : 0;
+}
+
+
+bool FlashModelStore::Install(size_t slot, const char *mode_tag, const char *name,
+                              uint16_t format_version, uint32_t layout_hash,
+                              const float *weights, size_t n_weights,
+                              const uint8_t *extra, size_t extra_size) {
+    if (!usable_) {
+        return false;
+    }
+    if (slot >= n_slots_ || n_weights > Capacity(extra_size) || (!weights && n_weights)) {
+        DEBUG_PRINTLN("FlashModelStore: model does not fit the slot");
+        return false;
+    }
+
+    RecordHeader header{};
+    // Keep a terminator so FieldEquals() compares whole strings
+    if ((mode_tag && std::strlen(mode_tag) >= sizeof(header.mode_tag)) ||
+        (name && std::strlen(name) >= sizeof(header.name))) {
+        DEBUG_PRINTLN("FlashModelStore: mode tag or name too long");
+        return false;
+    }
+    header.magic = kMagic;
+    header.format_version = format_version;
+    header.header_bytes = sizeof(RecordHeader);
+    if (mode_tag) {
+        std::memcpy(header.mode_tag, mode_tag, std::strlen(mode_tag));
+    }
+    if (name) {
+        std::memcpy(header.name, name, std::strlen(name));
+    }
+    header.layout_hash = layout_hash;
+    header.n_weights = static_cast<uint32_t>(n_weights);
+    header.extra_offset = sizeof(RecordHeader);
+    header.extra_size = static_cast<uint32_t>(extra_size);
+    header.weights_offset = static_cast<uint32_t>(Align_(sizeof(RecordHeader) + extra_size, kWeightAlign));
+
+    const size_t used = header.weights_offset + n_weights * sizeof(float);
+    std::vector<uint8_t> image(Align_(used, kPageBytes), 0xFF);
+    if (extra_size) {
+        std::memcpy(image.data() + header.extra_offset, extra, extra_size);
+    }
+    std::memcpy(image.data() + header.weights_offset, weights, n_weights * sizeof(float));
+    header.crc = CRC16::compute(image.data() + header.extra_offset, used - header.extra_offset);
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    const uint32_t offset = static_cast<uint32_t>(slot * slot_bytes_);
+    Erase_(offset, Align_(image.size(), kSectorBytes));
+    // Header page last: an interrupted install leaves the slot without a
+    // valid magic rather than with a wrong CRC
+    if (image.size() > kPageBytes) {
+        Program_(offset + kPageBytes, image.data() + kPageBytes, image.size() - kPageBytes);
+    }
+    Program_(offset, image.data(), kPageBytes);
+
+    return Find(slot, true) != nullptr;
+}
+
+
+bool FlashModelStore::Erase(size_t slot) {
+    if (!usable_ || slot >= n_slots_) {
+        return false;
+    }
+    Erase_(static_cast<uint32_t>(slot * slot_bytes_), kSectorBytes);
+    return true;
+}
+
+
+const FlashModelStore::RecordHeader *FlashModelStore::Find(size_t slot, bool verify) const {
+    if (slot >= n_slots_) {
+        return nullptr;
+    }
+    const RecordHeader *r = reinterpret_cast<const RecordHeader *>(Slot_(slot));
+    if (r->magic != kMagic || r->header_bytes != sizeof(RecordHeader)) {
+        return nullptr;
+    }
+    const size_t end = static_cast<size_t>(r->weights_offset) + static_cast<size_t>(r->n_weights) * sizeof(float);
+    if (r->weights_offset % kWeightAlign != 0 || end > slot_bytes_ ||
+        r->extra_offset + r->extra_size > r->weights_offset) {
+        return nullptr;
+    }
+    if (verify) {
+        const uint8_t *p = Slot_(slot) + r->extra_offset;
+        if (CRC16::compute(p, end - r->extra_offset) != r->crc) {
+            DEBUG_PRINTLN("FlashModelStore: CRC mismatch");
+            return nullptr;
+        }
+    }
+    return r;
+}
+
+
+bool FlashModelStore::CopyWeights(const RecordHeader *record, float *dst, size_t n) const {
+    if (!record || !dst || n != record->n_weights) {
+        return false;
+    }
+    const float *src = Weights(record);
+#if defined(ARDUINO_ARCH_RP2040)
+    const int channel = dma_claim_unused_channel(false);
+    if (channel >= 0) {
+        dma_channel_config c = dma_channel_get_default_config(channel);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, true);
+        dma_channel_configure(channel, &c, dst, src, n, true);
+        dma_channel_wait_for_finish_blocking(channel);
+        dma_channel_unclaim(channel);
+        return true;
+    }
+#endif
+    std::memcpy(dst, src, n * sizeof(float));
+    return true;
+}
+
+
+uint32_t FlashModelStore::LayoutHash(const size_t *layer_sizes, size_t n_layers, size_t n_weights) {
+    // FNV-1a over the sizes, so any change of shape changes the hash
+    uint32_t h = 2166136261u;
+    auto mix = [&h](uint32_t v) {
+        for (int i = 0; i < 4; i++) {
+            h ^= (v >> (8 * i)) & 0xFF;
+            h *= 16777619u;
+        }
+    };
+    for (size_t i = 0; i < n_layers; i++) {
+        mix(static_cast<uint32_t>(layer_sizes[i]));
+    }
+    mix(static_cast<uint32_t>(n_weights));
+    return h;
+}
+
+
+void FlashModelStore::Erase_(uint32_t offset, size_t bytes) {
+#if defined(ARDUINO_ARCH_RP2040)
+    noInterrupts();
+    rp2040.idleOtherCore();
+    flash_range_erase(flash_offset_ + offset, bytes);
+    rp2040.resumeOtherCore();
+    interrupts();
+#else
+    std::memset(sim_.data() + offset, 0xFF, bytes);
+#endif
+}
+
+
+void FlashModelStore::Program_(uint32_t offset, const uint8_t *data, size_t bytes) {
+#if defined(ARDUINO_ARCH_RP2040)
+    noInterrupts();
+    rp2040.idleOtherCore();
+    flash_range_program(flash_offset_ + offset, data, bytes);
+    rp2040.resumeOtherCore();
+    interrupts();
+#else
+    // NOR flash: programming can only clear bits
+    for (size_t i = 0; i < bytes; i++) {
+        sim_[offset + i] &= data[i];
+    }
+#endif
+}
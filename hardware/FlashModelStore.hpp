@@ -0,0 +1,174 @@
+#ifndef __FLASH_MODEL_STORE_HPP__
+#define __FLASH_MODEL_STORE_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+
+// Flash region holding installed models, as an offset from the start of
+// flash. The default sits below the sample pack (AUDIO_FLASH_ADDRESS,
+// 2 MB in). The store refuses to write if the firmware image runs into the
+// region or the region overlaps the filesystem (see IsUsable()).
+#ifndef MODEL_STORE_FLASH_OFFSET
+#define MODEL_STORE_FLASH_OFFSET    0x00180000U
+#endif
+#ifndef MODEL_STORE_SLOTS
+#define MODEL_STORE_SLOTS           12
+#endif
+#ifndef MODEL_STORE_SLOT_BYTES
+#define MODEL_STORE_SLOT_BYTES      (16u * 1024u)
+#endif
+
+
+/**
+ * @brief Fixed slots of raw flash holding MLP weights in their in-memory
+ * layout.
+ *
+ * A record is a 64-byte header, the caller's extra data, then the weights
+ * as a 16-byte aligned float array. Nothing is parsed or allocated on
+ * load: Weights() points straight into XIP flash (usable for inference as
+ * is), or CopyWeights() moves them into a network in one DMA transfer, so
+ * switching presets takes microseconds rather than an SD round trip.
+ *
+ * Installing erases and programs the slot's sectors. Flash can't be read
+ * while that happens, so the other core is paused and audio drops out for
+ * the duration (tens of ms per 4 KB sector): install from a save action,
+ * not during performance.
+ *
+ * On the host the region is a RAM buffer that behaves like NOR flash
+ * (programming only clears bits), so store logic can be tested off-target
+ * (tools/flash_model_store_bench.cpp).
+ */
+class FlashModelStore
+{
+public:
+    static constexpr uint32_t kMagic = 0x534D454DU;    // 'MEMS'
+    static constexpr size_t kSectorBytes = 4096;
+    static constexpr size_t kPageBytes = 256;
+    static constexpr size_t kWeightAlign = 16;
+
+    static_assert(MODEL_STORE_SLOT_BYTES % kSectorBytes == 0, "Slots must be whole sectors");
+
+    struct RecordHeader {
+        uint32_t magic;             // kMagic
+        uint16_t format_version;    // MEML_FILE_FORMAT_VERSION of the writer
+        uint16_t header_bytes;      // sizeof(RecordHeader)
+        char     mode_tag[16];      // Null-padded mode identifier
+        char     name[16];          // Null-padded slot name
+        uint32_t layout_hash;       // Network architecture signature
+        uint32_t n_weights;
+        uint32_t weights_offset;    // From the record start
+        uint32_t extra_size;
+        uint32_t extra_offset;      // From the record start
+        uint16_t crc;               // CRC-16 of extra data and weights
+        uint16_t reserved;
+    };
+
+    static_assert(sizeof(RecordHeader) == 64, "Unexpected record header size");
+
+    /**
+     * @param flash_offset Start of the region, from the start of flash.
+     * @param n_slots Number of slots.
+     * @param slot_bytes Bytes per slot, whole sectors.
+     */
+    FlashModelStore(uint32_t flash_offset = MODEL_STORE_FLASH_OFFSET,
+                    size_t n_slots = MODEL_STORE_SLOTS,
+                    size_t slot_bytes = MODEL_STORE_SLOT_BYTES);
+
+    inline size_t GetSlotCount() const { return n_slots_; }
+
+    /**
+     * @brief Whether the region passed CheckRegion() at construction.
+     * Install() and Erase() do nothing when it did not.
+     */
+    inline bool IsUsable() const { return usable_; }
+
+    /**
+     * @brief Whether a region may be erased: sector aligned, inside flash,
+     * after the end of the firmware image and clear of the filesystem.
+     * Addresses are XIP addresses; pass fs_start == fs_end for no filesystem.
+     */
+    static bool CheckRegion(uintptr_t start, size_t bytes, uintptr_t flash_end,
+                            uintptr_t image_end, uintptr_t fs_start, uintptr_t fs_end);
+
+    /**
+     * @brief Largest number of weights a slot holds next to extra_size bytes.
+     */
+    size_t Capacity(size_t extra_size) const;
+
+    /**
+     * @brief Write a model into a slot, replacing what was there.
+     *
+     * @return false if it doesn't fit, the slot is out of range, the
+     * mode tag or name is 16 characters or longer, or the region is not
+     * usable.
+     */
+    bool Install(size_t slot, const char *mode_tag, const char *name,
+                 uint16_t format_version, uint32_t layout_hash,
+                 const float *weights, size_t n_weights,
+                 const uint8_t *extra = nullptr, size_t extra_size = 0);
+
+    /**
+     * @brief Erase a slot.
+     */
+    bool Erase(size_t slot);
+
+    /**
+     * @brief The record in a slot, or nullptr if empty or corrupt.
+     *
+     * @param verify Also check the CRC (reads the whole record).
+     */
+    const RecordHeader *Find(size_t slot, bool verify = true) const;
+
+    /**
+     * @brief Weights of a valid record, in place in flash.
+     */
+    inline const float *Weights(const RecordHeader *record) const {
+        return reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(record) + record->weights_offset);
+    }
+
+    inline const uint8_t *Extra(const RecordHeader *record) const {
+        return reinterpret_cast<const uint8_t *>(record) + record->extra_offset;
+    }
+
+    /**
+     * @brief Copy a record's weights to contiguous memory (DMA when a
+     * channel is free, memcpy otherwise).
+     *
+     * @return false if n doesn't match the record.
+     */
+    bool CopyWeights(const RecordHeader *record, float *dst, size_t n) const;
+
+    /**
+     * @brief Whether a null-padded header field (mode_tag, name) holds
+     * exactly `s`. Install() rejects strings that don't fit with their
+     * terminator, so a longer `s` never matches.
+     */
+    static bool FieldEquals(const char (&field)[16], const char *s);
+
+    /**
+     * @brief Signature of a network shape, for RecordHeader::layout_hash.
+     */
+    static uint32_t LayoutHash(const size_t *layer_sizes, size_t n_layers, size_t n_weights);
+
+protected:
+    uint32_t flash_offset_;
+    size_t n_slots_;
+    size_t slot_bytes_;
+    const uint8_t *base_;       ///< Region as seen through XIP
+    bool usable_;
+#if !defined(ARDUINO_ARCH_RP2040)
+    std::vector<uint8_t> sim_;  ///< Host stand-in for the flash region
+#endif
+
+    inline const uint8_t *Slot_(size_t slot) const { return base_ + slot * slot_bytes_; }
+
+    static inline size_t Align_(size_t x, size_t a) { return (x + a - 1) & ~(a - 1); }
+
+    void Erase_(uint32_t offset, size_t bytes);
+    void Program_(uint32_t offset, const uint8_t *data, size_t bytes);
+};
+
+#endif  // __FLASH_MODEL_STORE_HPP__
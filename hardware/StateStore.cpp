@@ -0,0 +1,323 @@
+#include "StateStore.hpp"
+#include "../utils/CRC16.hpp"
+#include "../PicoDefs.hpp"
+
+#if defined(ARDUINO_ARCH_RP2040)
+#include <Arduino.h>
+#include <LittleFS.h>
+#endif
+
+
+#if defined(ARDUINO_ARCH_RP2040)
+
+bool LittleFSJournalBackend::Begin() {
+    // Mounting twice is harmless; FlashFS::begin() may have done it already
+    return LittleFS.begin();
+}
+
+size_t LittleFSJournalBackend::Size() {
+    File f = LittleFS.open(path_.c_str(), "r");
+    if (!f) {
+        return 0;
+    }
+    const size_t size = f.size();
+    f.close();
+    return size;
+}
+
+size_t LittleFSJournalBackend::Read(uint32_t offset, void *dst, size_t bytes) {
+    File f = LittleFS.open(path_.c_str(), "r");
+    if (!f || !f.seek(offset)) {
+        return 0;
+    }
+    const size_t n = f.read(static_cast<uint8_t *>(dst), bytes);
+    f.close();
+    return n;
+}
+
+bool LittleFSJournalBackend::Append(const void *src, size_t bytes) {
+    File f = LittleFS.open(path_.c_str(), "a");
+    if (!f) {
+        return false;
+    }
+    const size_t n = f.write(static_cast<const uint8_t *>(src), bytes);
+    f.close();
+    return n == bytes;
+}
+
+bool LittleFSJournalBackend::Replace(const void *src, size_t bytes) {
+    const std::string tmp = path_ + ".tmp";
+    File f = LittleFS.open(tmp.c_str(), "w");
+    if (!f) {
+        return false;
+    }
+    const size_t n = f.write(static_cast<const uint8_t *>(src), bytes);
+    f.close();
+    if (n != bytes) {
+        LittleFS.remove(tmp.c_str());
+        return false;
+    }
+    // LittleFS renames atomically, so a power cut leaves the old or the new journal
+    return LittleFS.rename(tmp.c_str(), path_.c_str());
+}
+
+#endif  // ARDUINO_ARCH_RP2040
+
+
+StateStore *StateStore::default_ = nullptr;
+
+
+StateStore::StateStore(JournalBackend &backend, Config config) :
+    backend_(backend),
+    config_(config),
+    journal_bytes_(0),
+    change_count_(0),
+    seen_changes_(0),
+    first_dirty_ms_(0),
+    last_change_ms_(0),
+    failed_ms_(0),
+    retry_ms_(0),
+    compact_next_(false),
+    stats_{} {}
+
+
+StateStore &StateStore::Default() {
+#if defined(ARDUINO_ARCH_RP2040)
+    static LittleFSJournalBackend backend;
+#else
+    static SimFlashJournalBackend backend;
+#endif
+    static StateStore store(backend);
+    if (!default_) {
+        default_ = &store;
+        store.Begin();
+    }
+    return store;
+}
+
+
+void StateStore::PollDefault(uint32_t now_ms) {
+    if (default_) {
+        default_->Service(now_ms);
+    }
+}
+
+
+bool StateStore::Begin() {
+    values_.clear();
+    dirty_.clear();
+    journal_bytes_ = 0;
+    compact_next_ = false;
+    stats_.bad_records = 0;
+
+    if (!backend_.Begin()) {
+        DEBUG_PRINTLN("StateStore: can't mount the journal");
+        return false;
+    }
+
+    // One sequential read of the whole journal, then parse in RAM
+    std::vector<uint8_t> journal(backend_.Size());
+    journal.resize(backend_.Read(0, journal.data(), journal.size()));
+
+    size_t pos = 0;
+    while (pos + kRecordOverhead <= journal.size()) {
+        const uint8_t *r = journal.data() + pos;
+        const size_t key_len = r[2];
+        const size_t value_len = static_cast<size_t>(r[3] | (r[4] << 8));
+        const size_t length = kRecordOverhead + key_len + value_len;
+        if (r[0] != kRecordMagic || pos + length > journal.size()) {
+            break;
+        }
+        const uint16_t crc = static_cast<uint16_t>(r[length - 2] | (r[length - 1] << 8));
+        if (CRC16::compute(r + 1, length - 3) != crc) {
+            break;
+        }
+        std::string key(reinterpret_cast<const char *>(r + 5), key_len);
+        if (r[1] == kSet) {
+            values_[key].assign(r + 5 + key_len, r + 5 + key_len + value_len);
+        } else if (r[1] == kDelete) {
+            values_.erase(key);
+        }
+        pos += length;
+    }
+    journal_bytes_ = pos;
+
+    if (pos < journal.size()) {
+        // A torn or corrupt tail would hide everything appended after it
+        stats_.bad_records++;
+        DEBUG_PRINTLN("StateStore: dropping damaged journal tail");
+        compact_next_ = true;
+        return Compact();
+    }
+    return true;
+}
+
+
+bool StateStore::Set(const char *key, const void *data, size_t bytes) {
+    const size_t key_len = std::strlen(key);
+    if (key_len == 0 || key_len > kMaxKey || bytes > kMaxValue) {
+        return false;
+    }
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    auto it = values_.find(key);
+    if (it != values_.end() && it->second.size() == bytes &&
+        std::equal(p, p + bytes, it->second.begin())) {
+        // Unchanged: nothing to write
+        return true;
+    }
+    values_[key].assign(p, p + bytes);
+    dirty_[key] = false;
+    change_count_++;
+    return true;
+}
+
+
+const std::vector<uint8_t> *StateStore::Find(const char *key) const {
+    auto it = values_.find(key);
+    return it == values_.end() ? nullptr : &it->second;
+}
+
+
+bool StateStore::Get(const char *key, std::vector<uint8_t> &value) const {
+    const std::vector<uint8_t> *v = Find(key);
+    if (!v) {
+        return false;
+    }
+    value = *v;
+    return true;
+}
+
+
+bool StateStore::Remove(const char *key) {
+    if (!values_.erase(key)) {
+        return false;
+    }
+    dirty_[key] = true;
+    change_count_++;
+    return true;
+}
+
+
+void StateStore::Service(uint32_t now_ms) {
+    if (dirty_.empty()) {
+        return;
+    }
+    if (seen_changes_ != change_count_) {
+        if (seen_changes_ == 0) {
+            // First change since the last flush
+            first_dirty_ms_ = now_ms;
+        }
+        seen_changes_ = change_count_;
+        last_change_ms_ = now_ms;
+    }
+    if (retry_ms_ && now_ms - failed_ms_ < retry_ms_) {
+        return;
+    }
+    if (now_ms - last_change_ms_ >= config_.debounce_ms ||
+        now_ms - first_dirty_ms_ >= config_.max_delay_ms) {
+        if (!Flush()) {
+            // Don't hammer a failing flash every loop
+            failed_ms_ = now_ms;
+            retry_ms_ = retry_ms_ ? std::min(retry_ms_ * 2, kMaxRetryMs)
+                                  : std::max<uint32_t>(config_.debounce_ms, 100);
+        }
+    }
+}
+
+
+bool StateStore::Flush() {
+    if (dirty_.empty()) {
+        return true;
+    }
+    std::vector<uint8_t> batch;
+    for (const auto &entry : dirty_) {
+        if (entry.second) {
+            Encode_(batch, kDelete, entry.first, nullptr, 0);
+        } else {
+            const std::vector<uint8_t> &value = values_[entry.first];
+            Encode_(batch, kSet, entry.first, value.data(), value.size());
+        }
+    }
+
+    const size_t n_records = dirty_.size();
+    const size_t projected = journal_bytes_ + batch.size();
+    if (compact_next_ || (projected > config_.compact_bytes &&
+        static_cast<float>(projected) > config_.compact_ratio * static_cast<float>(LiveBytes_()))) {
+        // The snapshot includes this batch, so compaction replaces the append
+        return Compact();
+    }
+
+    if (!backend_.Append(batch.data(), batch.size())) {
+        // Part of the batch may be in the file past journal_bytes_; a later
+        // append would land behind it, where Begin() never reads
+        compact_next_ = true;
+        stats_.write_errors++;
+        DEBUG_PRINTLN("StateStore: journal append failed");
+        return false;
+    }
+    journal_bytes_ += batch.size();
+    stats_.flushes++;
+    stats_.records_written += static_cast<uint32_t>(n_records);
+    dirty_.clear();
+    seen_changes_ = change_count_ = 0;
+    retry_ms_ = 0;
+    return true;
+}
+
+
+bool StateStore::Compact() {
+    std::vector<uint8_t> snapshot;
+    snapshot.reserve(LiveBytes_());
+    for (const auto &entry : values_) {
+        Encode_(snapshot, kSet, entry.first, entry.second.data(), entry.second.size());
+    }
+    if (!backend_.Replace(snapshot.data(), snapshot.size())) {
+        stats_.write_errors++;
+        DEBUG_PRINTLN("StateStore: compaction failed");
+        return false;
+    }
+    journal_bytes_ = snapshot.size();
+    compact_next_ = false;
+    stats_.compactions++;
+    stats_.records_written += static_cast<uint32_t>(values_.size());
+    dirty_.clear();
+    seen_changes_ = change_count_ = 0;
+    retry_ms_ = 0;
+    return true;
+}
+
+
+StateStore::Stats StateStore::GetStats() const {
+    Stats s = stats_;
+    s.keys = values_.size();
+    s.live_bytes = LiveBytes_();
+    s.journal_bytes = journal_bytes_;
+    return s;
+}
+
+
+void StateStore::Encode_(std::vector<uint8_t> &out, RecordType type, const std::string &key,
+                         const uint8_t *value, size_t bytes) {
+    const size_t start = out.size();
+    out.push_back(kRecordMagic);
+    out.push_back(type);
+    out.push_back(static_cast<uint8_t>(key.size()));
+    out.push_back(static_cast<uint8_t>(bytes));
+    out.push_back(static_cast<uint8_t>(bytes >> 8));
+    out.insert(out.end(), key.begin(), key.end());
+    if (bytes) {
+        out.insert(out.end(), value, value + bytes);
+    }
+    const uint16_t crc = CRC16::compute(out.data() + start + 1, out.size() - start - 1);
+    out.push_back(static_cast<uint8_t>(crc));
+    out.push_back(static_cast<uint8_t>(crc >> 8));
+}
+
+
+size_t StateStore::LiveBytes_() const {
+    size_t bytes = 0;
+    for (const auto &entry : values_) {
+        bytes += kRecordOverhead + entry.first.size() + entry.second.size();
+    }
+    return bytes;
+}
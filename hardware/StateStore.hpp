@@ -0,0 +1,334 @@
+#ifndef __STATE_STORE_HPP__
+#define __STATE_STORE_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+/**
+ * @brief Append-only file the StateStore journal lives in.
+ */
+class JournalBackend
+{
+public:
+    virtual ~JournalBackend() = default;
+
+    /**
+     * @brief Mount / open. Called from StateStore::Begin().
+     */
+    virtual bool Begin() { return true; }
+
+    virtual size_t Size() = 0;
+
+    virtual size_t Read(uint32_t offset, void *dst, size_t bytes) = 0;
+
+    virtual bool Append(const void *src, size_t bytes) = 0;
+
+    /**
+     * @brief Replace the whole contents atomically (used by compaction).
+     */
+    virtual bool Replace(const void *src, size_t bytes) = 0;
+};
+
+
+/**
+ * @brief Journal file on FlashFS (LittleFS), replaced via rename.
+ */
+class LittleFSJournalBackend : public JournalBackend
+{
+public:
+    explicit LittleFSJournalBackend(const char *path = "/state.jnl") : path_(path) {}
+
+    bool Begin() override;
+    size_t Size() override;
+    size_t Read(uint32_t offset, void *dst, size_t bytes) override;
+    bool Append(const void *src, size_t bytes) override;
+    bool Replace(const void *src, size_t bytes) override;
+
+protected:
+    std::string path_;
+};
+
+
+/**
+ * @brief Host stand-in for a LittleFS file on NOR flash, with a wear and
+ * time model.
+ *
+ * LittleFS blocks are copy-on-write, so every append commit erases and
+ * reprograms the file's tail block (plus any new blocks); Replace() writes
+ * a fresh copy. Blocks are handed out round-robin, as LittleFS's wear
+ * levelling does over time, and each erase is counted against its block.
+ */
+class SimFlashJournalBackend : public JournalBackend
+{
+public:
+    struct Timing {
+        float erase_ms;             ///< Per 4 KB block
+        float program_us;           ///< Per 256-byte page
+        float commit_ms;            ///< Metadata update per commit
+    };
+
+    struct Stats {
+        uint32_t commits;
+        uint32_t erases;
+        uint32_t max_block_erases;  ///< Wear of the most worn block
+        uint64_t bytes_programmed;
+        double busy_ms;
+    };
+
+    static constexpr size_t kBlockBytes = 4096;
+    static constexpr size_t kPageBytes = 256;
+
+    SimFlashJournalBackend(size_t n_blocks = 64, Timing timing = {45.f, 400.f, 1.f}) :
+        timing_(timing), wear_(n_blocks, 0), next_block_(0), fail_writes_(0), fail_partial_(0), stats_{} {}
+
+    size_t Size() override { return data_.size(); }
+
+    size_t Read(uint32_t offset, void *dst, size_t bytes) override {
+        if (offset >= data_.size()) {
+            return 0;
+        }
+        if (bytes > data_.size() - offset) {
+            bytes = data_.size() - offset;
+        }
+        std::memcpy(dst, data_.data() + offset, bytes);
+        return bytes;
+    }
+
+    bool Append(const void *src, size_t bytes) override {
+        const size_t start = data_.size();
+        const uint8_t *p = static_cast<const uint8_t *>(src);
+        const bool fail = fail_writes_ > 0;
+        if (fail) {
+            fail_writes_--;
+            bytes = std::min(bytes, fail_partial_);
+            if (bytes == 0) {
+                return false;
+            }
+        }
+        data_.insert(data_.end(), p, p + bytes);
+        // The partly written tail block is copied, then new blocks follow
+        const size_t first_block = start / kBlockBytes;
+        const size_t last_block = (data_.size() - 1) / kBlockBytes;
+        const size_t rewritten = data_.size() - first_block * kBlockBytes;
+        Commit_(last_block - first_block + 1, rewritten);
+        return !fail;
+    }
+
+    bool Replace(const void *src, size_t bytes) override {
+        if (fail_writes_ > 0) {
+            fail_writes_--;
+            return false;
+        }
+        const uint8_t *p = static_cast<const uint8_t *>(src);
+        data_.assign(p, p + bytes);
+        Commit_((bytes + kBlockBytes - 1) / kBlockBytes, bytes);
+        return true;
+    }
+
+    /**
+     * @brief Chop the file, simulating power loss during a write.
+     */
+    void Truncate(size_t bytes) {
+        if (bytes < data_.size()) {
+            data_.resize(bytes);
+        }
+    }
+
+    /**
+     * @brief Make the next n writes fail. A failing Append() still leaves
+     * its first `partial` bytes in the file (a torn record); a failing
+     * Replace() leaves the file as it was.
+     */
+    void FailWrites(size_t n, size_t partial = 0) {
+        fail_writes_ = n;
+        fail_partial_ = partial;
+    }
+
+    Stats GetStats() const { return stats_; }
+    void ResetStats() { stats_ = {}; std::fill(wear_.begin(), wear_.end(), 0); }
+
+protected:
+    Timing timing_;
+    std::vector<uint8_t> data_;
+    std::vector<uint32_t> wear_;
+    size_t next_block_;
+    size_t fail_writes_;
+    size_t fail_partial_;
+    Stats stats_;
+
+    void Commit_(size_t n_blocks, size_t bytes) {
+        for (size_t i = 0; i < n_blocks; i++) {
+            uint32_t &w = wear_[next_block_];
+            next_block_ = (next_block_ + 1) % wear_.size();
+            w++;
+            if (w > stats_.max_block_erases) {
+                stats_.max_block_erases = w;
+            }
+        }
+        const size_t pages = (bytes + kPageBytes - 1) / kPageBytes;
+        stats_.commits++;
+        stats_.erases += static_cast<uint32_t>(n_blocks);
+        stats_.bytes_programmed += pages * kPageBytes;
+        stats_.busy_ms += n_blocks * timing_.erase_ms + pages * timing_.program_us * 0.001 + timing_.commit_ms;
+    }
+};
+
+
+/**
+ * @brief Small key/value store for settings and UI state, kept in RAM and
+ * persisted as an append-only journal.
+ *
+ * Set() only changes the RAM copy. Service(), called from the main loop,
+ * writes all changed keys as one batch once they have been quiet for
+ * debounce_ms (or have waited max_delay_ms), so a knob being turned costs
+ * one commit rather than one per step. Each record carries a CRC-16;
+ * Begin() reads the journal front to back once, later records winning, and
+ * stops at the first bad record (a write cut short by power loss). When the
+ * journal outgrows the live data it is compacted into a fresh snapshot;
+ * after a failed append (which may have left part of a record behind) the
+ * next flush always compacts, so nothing is appended after torn bytes.
+ *
+ * Record: [0x5A][type][key length][value length, 16-bit LE][key][value][CRC-16 LE]
+ */
+class StateStore
+{
+public:
+    struct Config {
+        uint32_t debounce_ms;
+        uint32_t max_delay_ms;
+        size_t compact_bytes;       ///< Compact once the journal exceeds this...
+        float compact_ratio;        ///< ...and is this many times the live data
+    };
+
+    struct Stats {
+        size_t keys;
+        size_t live_bytes;          ///< Size of a compacted journal
+        size_t journal_bytes;
+        uint32_t flushes;
+        uint32_t records_written;
+        uint32_t compactions;
+        uint32_t bad_records;       ///< Found by Begin()
+        uint32_t write_errors;
+    };
+
+    static constexpr size_t kMaxKey = 255;
+    static constexpr size_t kMaxValue = 65535;
+
+    explicit StateStore(JournalBackend &backend, Config config = {2000, 10000, 8192, 2.f});
+
+    /**
+     * @brief Store on FlashFS shared by the whole firmware (host: simulated).
+     * Begin() runs on first use.
+     */
+    static StateStore &Default();
+
+    /**
+     * @brief Service the default store if anything has used it.
+     */
+    static void PollDefault(uint32_t now_ms);
+
+    /**
+     * @brief Load the journal. Safe to call again (reloads).
+     */
+    bool Begin();
+
+    /**
+     * @brief Set a key. Nothing is written until Service()/Flush().
+     * @return false if the key or value is too long.
+     */
+    bool Set(const char *key, const void *data, size_t bytes);
+
+    bool Set(const std::string &key, const std::vector<uint8_t> &value) {
+        return Set(key.c_str(), value.data(), value.size());
+    }
+
+    template<typename T>
+    bool SetValue(const char *key, const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Store plain data only");
+        return Set(key, &value, sizeof(T));
+    }
+
+    /**
+     * @return The value, or nullptr if the key is not set.
+     */
+    const std::vector<uint8_t> *Find(const char *key) const;
+
+    bool Get(const char *key, std::vector<uint8_t> &value) const;
+
+    /**
+     * @brief Read a plain value; false (value untouched) if missing or of
+     * another size.
+     */
+    template<typename T>
+    bool GetValue(const char *key, T &value) const {
+        static_assert(std::is_trivially_copyable<T>::value, "Store plain data only");
+        const std::vector<uint8_t> *v = Find(key);
+        if (!v || v->size() != sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, v->data(), sizeof(T));
+        return true;
+    }
+
+    bool Remove(const char *key);
+
+    inline bool IsDirty() const { return !dirty_.empty(); }
+
+    /**
+     * @brief Flush when the debounce or maximum delay has expired.
+     * After a failed write, waits debounce_ms before retrying, doubling
+     * up to kMaxRetryMs while writes keep failing.
+     */
+    void Service(uint32_t now_ms);
+
+    /**
+     * @brief Write pending changes now (e.g. before a reboot).
+     */
+    bool Flush();
+
+    /**
+     * @brief Rewrite the journal as a snapshot of the live keys.
+     */
+    bool Compact();
+
+    Stats GetStats() const;
+
+protected:
+    enum RecordType : uint8_t {
+        kSet = 1,
+        kDelete = 2
+    };
+
+    static constexpr uint8_t kRecordMagic = 0x5A;
+    static constexpr size_t kRecordOverhead = 7;    // magic, type, lengths, CRC
+    static constexpr uint32_t kMaxRetryMs = 60000;  ///< Longest wait between failed flushes
+
+    JournalBackend &backend_;
+    Config config_;
+    std::map<std::string, std::vector<uint8_t>> values_;
+    std::map<std::string, bool> dirty_;             ///< Key -> deleted
+    size_t journal_bytes_;
+    uint32_t change_count_;
+    uint32_t seen_changes_;
+    uint32_t first_dirty_ms_;
+    uint32_t last_change_ms_;
+    uint32_t failed_ms_;
+    uint32_t retry_ms_;                             ///< 0 unless the last flush failed
+    bool compact_next_;                             ///< The journal may end in a torn record
+    Stats stats_;
+
+    static StateStore *default_;
+
+    static void Encode_(std::vector<uint8_t> &out, RecordType type, const std::string &key,
+                        const uint8_t *value, size_t bytes);
+    size_t LiveBytes_() const;
+};
+
+#endif  // __STATE_STORE_HPP__
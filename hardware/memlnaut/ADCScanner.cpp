@@ -0,0 +1,117 @@
+#include "ADCScanner.hpp"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+
+
+ADCScanner::ADCScanner() :
+    dma_channel_(-1)
+{
+    memset(ring_, 0, sizeof(ring_));
+}
+
+ADCScanner::~ADCScanner()
+{
+    Stop();
+}
+
+bool ADCScanner::Start(uint first_gpio)
+{
+    if (dma_channel_ >= 0) {
+        return true;
+    }
+
+    dma_channel_ = dma_claim_unused_channel(false);
+    if (dma_channel_ < 0) {
+        return false;
+    }
+
+    adc_init();
+    for (uint i = 0; i < kNumChannels; i++) {
+        adc_gpio_init(first_gpio + i);
+    }
+    adc_select_input(0);
+    adc_set_round_robin((1u << kNumChannels) - 1);
+    adc_fifo_setup(
+        true,   // Write each conversion to the FIFO
+        true,   // Raise DREQ for DMA
+        1,      // DREQ on every sample
+        false,  // No error bit
+        false   // Keep full 12 bits
+    );
+    // ADC clock is 48 MHz, one conversion takes at least 96 cycles
+    adc_set_clkdiv(48000000.f / kSampleRateHz - 1.f);
+
+    dma_channel_config c = dma_channel_get_default_config(dma_channel_);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, DREQ_ADC);
+
+    // Wrap writes at the ring size (in bytes)
+    uint32_t ring_bits = 0;
+    for (size_t size = sizeof(ring_); size >>= 1;) ring_bits++;
+    channel_config_set_ring(&c, true, ring_bits);
+
+    dma_channel_configure(
+        dma_channel_,
+        &c,
+        ring_,
+        &adc_hw->fifo,
+        0xFFFFFFFF,     // Endless on RP2350 (mode bits), ~37 hours on RP2040
+        true
+    );
+
+    adc_fifo_drain();
+    adc_run(true);
+
+    DEBUG_PRINTF("ADCScanner: DMA channel %d, %u Hz per channel\n",
+                 dma_channel_, kSampleRateHz / kNumChannels);
+    return true;
+}
+
+void ADCScanner::Stop()
+{
+    if (dma_channel_ < 0) {
+        return;
+    }
+    adc_run(false);
+    adc_set_round_robin(0);
+    dma_channel_abort(dma_channel_);
+    dma_channel_unclaim(dma_channel_);
+    adc_fifo_drain();
+    dma_channel_ = -1;
+}
+
+size_t __not_in_flash_func(ADCScanner::CompleteRoundEnd_)() const
+{
+    // The write address is independent of transfer count encoding
+    const uintptr_t write_addr = dma_channel_hw_addr(dma_channel_)->write_addr;
+    const size_t write_idx = (write_addr - reinterpret_cast<uintptr_t>(ring_)) / sizeof(uint16_t);
+    return (write_idx & (kRingSamples - 1)) & ~(kNumChannels - 1);
+}
+
+void __not_in_flash_func(ADCScanner::Process)(std::array<uint16_t, kNumChannels> &out) const
+{
+    constexpr size_t kWindow = kNumChannels * kOversample;
+    const size_t end = CompleteRoundEnd_();
+    size_t idx = (end + kRingSamples - kWindow) & (kRingSamples - 1);
+
+    uint32_t acc[kNumChannels] = { 0 };
+    for (size_t round = 0; round < kOversample; round++) {
+        for (size_t ch = 0; ch < kNumChannels; ch++) {
+            acc[ch] += ring_[idx + ch];
+        }
+        idx = (idx + kNumChannels) & (kRingSamples - 1);
+    }
+
+    for (size_t ch = 0; ch < kNumChannels; ch++) {
+        out[ch] = static_cast<uint16_t>((acc[ch] + kOversample / 2) / kOversample);
+    }
+}
+
+uint16_t ADCScanner::Latest(size_t channel) const
+{
+    std::array<uint16_t, kNumChannels> values;
+    Process(values);
+    return values[channel % kNumChannels];
+}
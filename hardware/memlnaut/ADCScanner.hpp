@@ -0,0 +1,71 @@
+#ifndef __ADC_SCANNER_HPP__
+#define __ADC_SCANNER_HPP__
+
+#include <Arduino.h>
+#include <array>
+#include "../../PicoDefs.hpp"
+
+/**
+ * @brief Free-running round-robin ADC capture into a DMA ring.
+ *
+ * The ADC converts channels [0 .. kNumChannels-1] in turn at a fixed rate
+ * and DMA writes every result into a ring, so nobody ever waits on a
+ * conversion. Process() then reduces the most recent kOversample readings
+ * of each channel to one value (mean), in a single batch.
+ *
+ * The ring length is a multiple of kNumChannels, so slot i always holds
+ * channel i % kNumChannels.
+ */
+class ADCScanner {
+public:
+    static constexpr size_t kNumChannels = 8;
+    static constexpr size_t kOversample = 8;        ///< Readings averaged per channel
+    static constexpr size_t kRingSamples = 256;     ///< Power of 2, multiple of kNumChannels
+    static constexpr uint32_t kSampleRateHz = 32000; ///< Total ADC rate (4 kHz per channel)
+
+    static_assert((kRingSamples & (kRingSamples - 1)) == 0, "Ring size must be a power of 2");
+    static_assert(kRingSamples % kNumChannels == 0, "Ring must hold whole rounds");
+    static_assert(kRingSamples >= 2 * kNumChannels * kOversample, "Ring too small for oversampling window");
+
+    ADCScanner();
+    ~ADCScanner();
+
+    /**
+     * @brief Configure the ADC pins, start round-robin conversion and DMA.
+     *
+     * @param first_gpio GPIO of ADC channel 0 (40 on RP2350B, 26 on RP2040).
+     * @return true if running, false if no DMA channel was available.
+     */
+    bool Start(uint first_gpio);
+
+    /**
+     * @brief Stop conversions and release the DMA channel.
+     */
+    void Stop();
+
+    inline bool IsRunning() const { return dma_channel_ >= 0; }
+
+    /**
+     * @brief Reduce the latest oversampling window of every channel.
+     * Cheap and non-blocking; call once per control loop iteration.
+     *
+     * @param out One 12-bit value per channel.
+     */
+    void Process(std::array<uint16_t, kNumChannels> &out) const;
+
+    /**
+     * @brief Latest oversampled value of a single channel.
+     */
+    uint16_t Latest(size_t channel) const;
+
+protected:
+    int dma_channel_;
+    uint16_t ring_[kRingSamples] __attribute__((aligned(kRingSamples * sizeof(uint16_t))));
+
+    /**
+     * @brief Index one past the newest complete round of conversions.
+     */
+    size_t CompleteRoundEnd_() const;
+};
+
+#endif // __ADC_SCANNER_HPP__
@@ -1,5 +1,6 @@
 #include "MEMLNaut.hpp"
 #include "../../audio/AudioDriver.hpp"
+#include "../StateStore.hpp"
 #include "Arduino.h"
 #include "pico/util/queue.h"
 
@@ -143,6 +144,11 @@ MEMLNaut::MEMLNaut(bool old_display) {
     // Initialise all pins
     Pins::initializePins();
 
+    // Start free-running ADC capture (ADC channel 0 is JOY_X)
+    if (!adcScanner.Start(Pins::JOY_X)) {
+        DEBUG_PRINTLN("MEMLNaut: ADC scanner unavailable, using analogRead()");
+    }
+
     // Attach momentary switch interrupts (FALLING edge)
     attachInterrupt(digitalPinToInterrupt(Pins::MOM_A1), handleMomA1, CHANGE);
     attachInterrupt(digitalPinToInterrupt(Pins::MOM_A2), handleMomA2, CHANGE);
@@ -209,28 +215,36 @@ void MEMLNaut::setTogB2Callback(ToggleCallback cb) { togB2Callback = cb; }
 void MEMLNaut::setJoySWCallback(ToggleCallback cb) { joySWCallback = cb; }
 
 // ADC callback setters
+uint16_t MEMLNaut::readADC(size_t index) {
+    // analogRead() would reprogram the ADC under the running scanner
+    if (adcScanner.IsRunning()) {
+        return adcScanner.Latest(ADC_PINS[index] - Pins::JOY_X);
+    }
+    return analogRead(ADC_PINS[index]);
+}
+
 void MEMLNaut::setJoyXCallback(AnalogCallback cb, uint16_t threshold) {
-    adcStates[0] = {analogRead(Pins::JOY_X) / ADC_SCALE, threshold, cb};
+    adcStates[0] = {readADC(0) / ADC_SCALE, threshold, cb};
 }
 void MEMLNaut::setJoyYCallback(AnalogCallback cb, uint16_t threshold) {
-    adcStates[1] = {analogRead(Pins::JOY_Y) / ADC_SCALE, threshold, cb};
+    adcStates[1] = {readADC(1) / ADC_SCALE, threshold, cb};
 }
 void MEMLNaut::setJoyZCallback(AnalogCallback cb, uint16_t threshold) {
-    adcStates[2] = {analogRead(Pins::JOY_Z) / ADC_SCALE, threshold, cb};
+    adcStates[2] = {readADC(2) / ADC_SCALE, threshold, cb};
 }
 void MEMLNaut::setADC3Callback(AnalogCallback cb, uint16_t threshold) {
-    adcStates[7] = {analogRead(Pins::ADC3) / ADC_SCALE, threshold, cb};
+    adcStates[7] = {readADC(7) / ADC_SCALE, threshold, cb};
 }
 void MEMLNaut::setRVGain1Callback(AnalogCallback cb, uint16_t threshold) {
     //adcStates[3] = {analogRead(Pins::RV_GAIN1) / ADC_SCALE, threshold, cb};
     // DEBUG_PRINTLN("RVGain1 overridden - only controls audio volume");
     //this overrides the volume control
-    adcStates[3] = {analogRead(Pins::RV_GAIN1) / ADC_SCALE, threshold, cb};
+    adcStates[3] = {readADC(3) / ADC_SCALE, threshold, cb};
 }
 
 void MEMLNaut::setRVGain1Volume(uint16_t threshold) {
     adcStates[3] = {
-        analogRead(Pins::RV_GAIN1) / ADC_SCALE,
+        readADC(3) / ADC_SCALE,
         threshold,
         [] (float value) {
             AudioDriver::SetMasterVolume(value);
@@ -238,13 +252,13 @@ void MEMLNaut::setRVGain1Volume(uint16_t threshold) {
     };
 }
 void MEMLNaut::setRVZ1Callback(AnalogCallback cb, uint16_t threshold) {
-    adcStates[4] = {analogRead(Pins::RV_Z1) / ADC_SCALE, threshold, cb};
+    adcStates[4] = {readADC(4) / ADC_SCALE, threshold, cb};
 }
 void MEMLNaut::setRVY1Callback(AnalogCallback cb, uint16_t threshold) {
-    adcStates[5] = {analogRead(Pins::RV_Y1) / ADC_SCALE, threshold, cb};
+    adcStates[5] = {readADC(5) / ADC_SCALE, threshold, cb};
 }
 void MEMLNaut::setRVX1Callback(AnalogCallback cb, uint16_t threshold) {
-    adcStates[6] = {analogRead(Pins::RV_X1) / ADC_SCALE, threshold, cb};
+    adcStates[6] = {readADC(6) / ADC_SCALE, threshold, cb};
 }
 
 void MEMLNaut::setRotaryEncoderCallback(RotaryEncoderCallback cb) {
@@ -297,14 +311,16 @@ void MEMLNaut::loop() {
         }
     }
 
-    const uint8_t adcPins[NUM_ADCS] = {
-        Pins::JOY_X, Pins::JOY_Y, Pins::JOY_Z,
-        Pins::RV_GAIN1, Pins::RV_Z1, Pins::RV_Y1, Pins::RV_X1,
-        Pins::ADC3
-    };
+    // One batch read of the DMA ring (already oversampled), no ADC waits
+    std::array<uint16_t, ADCScanner::kNumChannels> scanned;
+    const bool scanning = adcScanner.IsRunning();
+    if (scanning) {
+        adcScanner.Process(scanned);
+    }
 
     for (size_t i = 0; i < NUM_ADCS; i++) {
-        uint16_t rawValue = analogRead(adcPins[i]);
+        uint16_t rawValue = scanning ? scanned[ADC_PINS[i] - Pins::JOY_X]
+                                     : analogRead(ADC_PINS[i]);
         uint16_t filteredValue = adcFilters[i].process(rawValue);
         float currentValue = filteredValue / ADC_SCALE;
         auto& state = adcStates[i];
@@ -319,21 +335,21 @@ void MEMLNaut::loop() {
         loopCallback();
     }
 
+    // Persist settings changed by the callbacks once they settle
+    StateStore::PollDefault(millis());
+
 
     if (disp) {
         PERIODIC_RUN(MEMLNaut::Instance()->disp->PollTouch();, 30);
-        PERIODIC_RUN(MEMLNaut::Instance()->disp->Draw();, 39);
+        // Draw() caps the frame rate and waits out DMA transfers itself
+        PERIODIC_RUN(MEMLNaut::Instance()->disp->Draw();, 5);
     }
 }
 
 void MEMLNaut::SyncOnBoot() {
     // Synchronize ADCs
-    const uint8_t adcPins[NUM_ADCS] = {
-        Pins::JOY_X, Pins::JOY_Y, Pins::JOY_Z,
-        Pins::RV_GAIN1, Pins::RV_Z1, Pins::RV_Y1, Pins::RV_X1
-    };
     for (size_t i = 0; i < NUM_ADCS; i++) {
-        uint16_t rawValue = analogRead(adcPins[i]);
+        uint16_t rawValue = readADC(i);
         adcFilters[i].reset(rawValue); // Reset filter to current value
         float currentValue = rawValue / ADC_SCALE;
         adcStates[i].lastValue = currentValue;
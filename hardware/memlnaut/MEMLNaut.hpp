@@ -4,6 +4,7 @@
 #include "Pins.hpp"
 #include "../../utils/Debounce.hpp"
 #include "../../utils/MedianFilter.h"
+#include "ADCScanner.hpp"
 #include <functional>
 #include <array>
 #include "display/DisplayDriver.hpp"
@@ -27,6 +28,13 @@ private:
     static constexpr size_t FILTER_SIZE = 5;
     static constexpr float ADC_SCALE = 4128.7f;
 
+    // Pin of each ADC state slot; slot order is the callback order below
+    static constexpr uint8_t ADC_PINS[NUM_ADCS] = {
+        Pins::JOY_X, Pins::JOY_Y, Pins::JOY_Z,
+        Pins::RV_GAIN1, Pins::RV_Z1, Pins::RV_Y1, Pins::RV_X1,
+        Pins::ADC3
+    };
+
     static constexpr size_t NUM_BUTTONS = 7;
     static constexpr size_t NUM_TOGGLES = 5;
 
@@ -39,6 +47,11 @@ private:
     std::array<ADCState, NUM_ADCS> adcStates;
     std::array<MedianFilter<uint16_t>, NUM_ADCS> adcFilters;
 
+    // Round-robin DMA capture of all ADC channels; falls back to
+    // analogRead() if it could not be started
+    ADCScanner adcScanner;
+    uint16_t readADC(size_t index);
+
     std::array<ToggleDebounce, NUM_BUTTONS> debouncers;
     std::array<ToggleDebounce, NUM_TOGGLES> toggleDebouncers;
 
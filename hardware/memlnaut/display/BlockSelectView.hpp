@@ -71,15 +71,14 @@ public:
     }  
 
     void OnDraw() override {
-        TFT_eSprite textSprite(scr);
-        textSprite.createSprite(320, 20);
-        textSprite.setTextFont(2);
         scr->fillRect(area.x, area.y, area.w, area.h, TFT_BLACK);
-        constexpr int32_t lineheight = 20;
-        textSprite.setTextColor(TFT_WHITE, TFT_BLACK);
-        textSprite.fillRect(0,0,320,20,TFT_BLACK);
-        textSprite.drawString(msg, 3, 0);
-        textSprite.pushSprite(area.x,area.y + area.h - 25);
+        TFT_eSprite* textSprite = AcquireSprite(320, 20);
+        if (!textSprite) return;
+        textSprite->setTextFont(2);
+        textSprite->setTextColor(TFT_WHITE, TFT_BLACK);
+        textSprite->fillSprite(TFT_BLACK);
+        textSprite->drawString(msg, 3, 0);
+        PushSprite(textSprite, area.x, area.y + area.h - 25);
     }  
 
     void updateButtonName(size_t idx, const String& newName) {
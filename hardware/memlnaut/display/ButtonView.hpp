@@ -38,20 +38,22 @@ public:
         redraw();
     }
 
+    bool DrawsToPanel() const override { return false; }
+
     void OnDraw() override {
-        TFT_eSprite sprite(scr);
-        sprite.createSprite(area.w, area.h);
+        TFT_eSprite* sprite = AcquireSprite(area.w, area.h);
+        if (!sprite) return;
 
-        sprite.fillSprite(fillColour);
+        sprite->fillSprite(fillColour);
         int32_t bw = pressed ? 1 : borderWidth;
         int32_t col = pressed ? TFT_RED : TFT_WHITE;
         for (int32_t i = 0; i < bw; i++) {
-            sprite.drawRect(i, i, area.w - 2*i, area.h - 2*i, col);
+            sprite->drawRect(i, i, area.w - 2*i, area.h - 2*i, col);
         }
-        sprite.setTextColor(fontColour);
-        sprite.setTextFont(fontNum);
-        sprite.drawString(this->name_, 10, 10);
-        sprite.pushSprite(area.x, area.y);
+        sprite->setTextColor(fontColour);
+        sprite->setTextFont(fontNum);
+        sprite->drawString(this->name_, 10, 10);
+        PushSprite(sprite, area.x, area.y);
         // scr->drawString("1", area.x + 10, area.y + 10);
     }  
 
@@ -0,0 +1,279 @@
+#include "Compositor.hpp"
+#include <algorithm>
+
+
+void Compositor::Setup(int width, int height, uint32_t max_fps) {
+    screen_ = {0, 0, width, height};
+    frame_interval_us_ = max_fps ? 1000000 / max_fps : 0;
+    // Without a DMA channel, Push() falls back to blocking sprite pushes
+    dma_ = tft_->initDMA();
+    stats_.dma = dma_;
+}
+
+
+bool Compositor::BeginFrame(uint32_t now_us) {
+    if (Busy()) {
+        stats_.deferred++;
+        return false;
+    }
+    if (now_us - last_frame_us_ < frame_interval_us_) {
+        return false;
+    }
+    frame_start_us_ = now_us;
+    frame_bytes_ = 0;
+    return true;
+}
+
+
+void Compositor::EndFrame(uint32_t now_us) {
+    const bool drew = n_dirty_ > 0 || frame_bytes_ > 0;
+    n_dirty_ = 0;
+    for (auto &e : pool_) {
+        e.held = false;
+    }
+    if (!drew) {
+        // Idle frames don't count against the frame interval
+        return;
+    }
+    last_frame_us_ = frame_start_us_;
+    stats_.frames++;
+    stats_.frame_us = now_us - frame_start_us_;
+    stats_.max_frame_us = std::max(stats_.max_frame_us, stats_.frame_us);
+    stats_.frame_bytes = frame_bytes_;
+}
+
+
+void Compositor::Invalidate(const rect &r) {
+    // Clip to the screen
+    const int x0 = std::max(r.x, screen_.x);
+    const int y0 = std::max(r.y, screen_.y);
+    const int x1 = std::min(r.x + r.w, screen_.x + screen_.w);
+    const int y1 = std::min(r.y + r.h, screen_.y + screen_.h);
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    rect m{x0, y0, x1 - x0, y1 - y0};
+
+    // Absorb every rectangle it touches
+    for (size_t i = 0; i < n_dirty_;) {
+        if (Touches_(m, dirty_[i])) {
+            m = Union_(m, dirty_[i]);
+            dirty_[i] = dirty_[--n_dirty_];
+            i = 0;
+        } else {
+            i++;
+        }
+    }
+    if (n_dirty_ < kMaxDirty) {
+        dirty_[n_dirty_++] = m;
+        return;
+    }
+    // List full: grow whichever rectangle grows least
+    size_t best = 0;
+    int best_growth = INT32_MAX;
+    for (size_t i = 0; i < n_dirty_; i++) {
+        const int growth = Area_(Union_(dirty_[i], m)) - Area_(dirty_[i]);
+        if (growth < best_growth) {
+            best_growth = growth;
+            best = i;
+        }
+    }
+    dirty_[best] = Union_(dirty_[best], m);
+}
+
+
+TFT_eSprite *Compositor::Acquire(int w, int h) {
+    if (w <= 0 || h <= 0) {
+        return nullptr;
+    }
+    Entry *match = nullptr;
+    Entry *empty = nullptr;
+    Entry *lru = nullptr;
+    for (auto &e : pool_) {
+        if (!e.sprite) {
+            if (!empty) {
+                empty = &e;
+            }
+            continue;
+        }
+        // The sprite being sent is still being read by the DMA
+        if (e.held || e.sprite->getPointer() == in_flight_) {
+            continue;
+        }
+        if (e.w == w && e.h == h) {
+            match = &e;
+            break;
+        }
+        if (!lru || e.last_use < lru->last_use) {
+            lru = &e;
+        }
+    }
+
+    if (!match) {
+        match = empty ? empty : lru;
+        if (!match) {
+            // Every entry is held or in flight
+            if (!in_flight_) {
+                return nullptr;
+            }
+            WaitIdle();
+            return Acquire(w, h);
+        }
+        Evict_(*match);
+        const size_t bytes = static_cast<size_t>(w) * h * sizeof(uint16_t);
+        // Keep within budget by dropping the least recently used idle sprites
+        while (pool_bytes_ + bytes > kPoolBytes) {
+            Entry *victim = nullptr;
+            for (auto &e : pool_) {
+                if (e.sprite && &e != match && !e.held && e.sprite->getPointer() != in_flight_ &&
+                    (!victim || e.last_use < victim->last_use)) {
+                    victim = &e;
+                }
+            }
+            if (!victim) {
+                break;
+            }
+            Evict_(*victim);
+        }
+        match->sprite.reset(new TFT_eSprite(tft_));
+        match->sprite->setColorDepth(16);
+        if (!match->sprite->createSprite(w, h)) {
+            match->sprite.reset();
+            return nullptr;
+        }
+        match->w = w;
+        match->h = h;
+        pool_bytes_ += bytes;
+        stats_.sprite_allocs++;
+    }
+    match->held = true;
+    match->last_use = ++use_clock_;
+    return match->sprite.get();
+}
+
+
+void Compositor::Push(TFT_eSprite *sprite, int x, int y, int w, int h) {
+    if (!sprite) {
+        return;
+    }
+    for (auto &e : pool_) {
+        if (e.sprite.get() == sprite) {
+            e.held = false;
+        }
+    }
+    if (w <= 0 || h <= 0) {
+        w = sprite->width();
+        h = sprite->height();
+    }
+    PushPixels(static_cast<const uint16_t *>(sprite->getPointer()), x, y, w, h);
+}
+
+
+void Compositor::PushPixels(const uint16_t *pixels, int x, int y, int w, int h) {
+    int top, rows;
+    if (!pixels || !ClipRows_(x, y, w, h, top, rows)) {
+        return;
+    }
+    if (!dma_) {
+        const bool swap = tft_->getSwapBytes();
+        tft_->setSwapBytes(false);
+        tft_->pushImage(x, y + top, w, rows, pixels + static_cast<size_t>(top) * w);
+        tft_->setSwapBytes(swap);
+        return;
+    }
+    // One channel: the previous transfer must finish (it ran while this
+    // buffer was being drawn)
+    if (in_flight_) {
+        tft_->dmaWait();
+    }
+    if (!in_write_) {
+        tft_->startWrite();
+        in_write_ = true;
+    }
+    // Sprite pixels are already in panel byte order, as pushSprite assumes
+    const bool swap = tft_->getSwapBytes();
+    tft_->setSwapBytes(false);
+    tft_->pushImageDMA(x, y + top, w, rows, const_cast<uint16_t *>(pixels) + static_cast<size_t>(top) * w);
+    tft_->setSwapBytes(swap);
+    in_flight_ = pixels;
+}
+
+
+bool Compositor::ClipRows_(int x, int y, int w, int h, int &top, int &rows) {
+    // Band of rows that overlaps the dirty region; columns can't be clipped
+    // without breaking the buffer's contiguity
+    top = h;
+    int bottom = 0;
+    for (size_t i = 0; i < n_dirty_; i++) {
+        const rect &d = dirty_[i];
+        if (d.x < x + w && x < d.x + d.w && d.y < y + h && y < d.y + d.h) {
+            top = std::min(top, std::max(0, d.y - y));
+            bottom = std::max(bottom, std::min(h, d.y + d.h - y));
+        }
+    }
+    const uint32_t row_bytes = static_cast<uint32_t>(w) * sizeof(uint16_t);
+    rows = std::max(0, bottom - top);
+    stats_.bytes_clipped += static_cast<uint64_t>(row_bytes) * (h - rows);
+    stats_.bytes_pushed += static_cast<uint64_t>(row_bytes) * rows;
+    frame_bytes_ += row_bytes * rows;
+    return rows > 0;
+}
+
+
+bool Compositor::Busy() {
+    if (dma_ && in_flight_ && tft_->dmaBusy()) {
+        return true;
+    }
+    EndTransfer_();
+    return false;
+}
+
+
+void Compositor::WaitIdle() {
+    if (dma_ && in_flight_) {
+        tft_->dmaWait();
+    }
+    EndTransfer_();
+}
+
+
+Compositor::Stats Compositor::GetStats() const {
+    Stats s = stats_;
+    s.pool_bytes = pool_bytes_;
+    return s;
+}
+
+
+void Compositor::EndTransfer_() {
+    in_flight_ = nullptr;
+    if (in_write_) {
+        // Touch and direct drawing toggle chip selects themselves
+        tft_->endWrite();
+        in_write_ = false;
+    }
+}
+
+
+void Compositor::Evict_(Entry &e) {
+    if (e.sprite) {
+        e.sprite->deleteSprite();
+        e.sprite.reset();
+        pool_bytes_ -= static_cast<size_t>(e.w) * e.h * sizeof(uint16_t);
+    }
+    e.w = e.h = 0;
+    e.held = false;
+}
+
+
+rect Compositor::Union_(const rect &a, const rect &b) {
+    const int x0 = std::min(a.x, b.x);
+    const int y0 = std::min(a.y, b.y);
+    const int x1 = std::max(a.x + a.w, b.x + b.w);
+    const int y1 = std::max(a.y + a.h, b.y + b.h);
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+
+bool Compositor::Touches_(const rect &a, const rect &b) {
+    return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
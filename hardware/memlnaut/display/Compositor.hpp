@@ -0,0 +1,150 @@
+#ifndef __COMPOSITOR_HPP__
+#define __COMPOSITOR_HPP__
+
+#include <TFT_eSPI.h>
+#include "UIElements.hpp"
+#include <array>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+
+/**
+ * @brief Frame scheduler between the views and the panel.
+ *
+ * Views draw into sprites from a pool (allocated once per size and
+ * reused, two per size so one can be drawn while the other is sent) and
+ * hand them to Push(). Only the sprite rows that fall inside the frame's
+ * dirty rectangles are sent, by SPI DMA: Push() returns as soon as the
+ * transfer has started, and the last transfer of a frame completes while
+ * the control loop carries on. A frame is only started once the previous
+ * one has finished and the frame interval has elapsed.
+ *
+ * Anything that talks to the panel directly (fills, text, touch) must
+ * wait for Busy() to be false or call WaitIdle() first; ViewBase::Draw()
+ * does this before OnDraw() unless the view's DrawsToPanel() is false.
+ * Only those sprite-only views (graphs, buttons) draw while a transfer is
+ * in flight.
+ */
+class Compositor
+{
+public:
+    struct Stats {
+        uint32_t frames;            ///< Frames that drew something
+        uint32_t deferred;          ///< Draw() calls held back by a transfer in flight
+        uint32_t frame_us;          ///< CPU time of the last frame
+        uint32_t max_frame_us;
+        uint32_t frame_bytes;       ///< Sent by the last frame
+        uint64_t bytes_pushed;
+        uint64_t bytes_clipped;     ///< Sprite rows outside the dirty region, not sent
+        uint64_t bytes_direct;      ///< Drawn straight to the panel, as reported by views
+        uint32_t sprite_allocs;
+        size_t pool_bytes;
+        bool dma;
+    };
+
+    static constexpr size_t kMaxDirty = 8;
+    static constexpr size_t kPoolSize = 8;
+    static constexpr size_t kPoolBytes = 48 * 1024;
+
+    explicit Compositor(TFT_eSPI *tft) : tft_(tft) {}
+
+    /**
+     * @brief Call once the panel is initialised.
+     */
+    void Setup(int width, int height, uint32_t max_fps = 30);
+
+    /**
+     * @return false if the frame must be skipped (previous transfer still
+     * running, or too soon after the last frame).
+     */
+    bool BeginFrame(uint32_t now_us);
+    void EndFrame(uint32_t now_us);
+
+    /**
+     * @brief Mark part of the screen as changed in this frame.
+     */
+    void Invalidate(const rect &r);
+
+    /**
+     * @brief A pooled 16-bit sprite of this size, not in use by a transfer.
+     * Contents are whatever was drawn last; valid until pushed.
+     */
+    TFT_eSprite *Acquire(int w, int h);
+
+    /**
+     * @brief Send a sprite's dirty rows to the panel at (x, y).
+     * Works for pooled and view-owned sprites.
+     *
+     * @param w, h If set, send only the first w x h pixels of the buffer,
+     * read as rows of w (for drawing a narrower strip into a pooled sprite).
+     */
+    void Push(TFT_eSprite *sprite, int x, int y, int w = 0, int h = 0);
+
+    /**
+     * @brief Send w x h pixels (row-major, panel byte order, as in a
+     * sprite) to the panel at (x, y). The buffer must stay untouched until
+     * the transfer ends; a pooled sprite's buffer may be used at any
+     * stride up to its size.
+     */
+    void PushPixels(const uint16_t *pixels, int x, int y, int w, int h);
+
+    /**
+     * @brief Account for a direct fill or draw of this many bytes.
+     */
+    inline void CountDirect(uint32_t bytes) {
+        stats_.bytes_direct += bytes;
+        frame_bytes_ += bytes;
+    }
+
+    /**
+     * @return Bytes sent so far, by DMA and directly.
+     */
+    inline uint64_t BytesSent() const { return stats_.bytes_pushed + stats_.bytes_direct; }
+
+    /**
+     * @return true while a transfer is in flight.
+     */
+    bool Busy();
+
+    void WaitIdle();
+
+    Stats GetStats() const;
+
+protected:
+    struct Entry {
+        std::unique_ptr<TFT_eSprite> sprite;
+        int w = 0;
+        int h = 0;
+        uint32_t last_use = 0;
+        bool held = false;          // Acquired, not yet pushed
+    };
+
+    TFT_eSPI *tft_;
+    rect screen_{0, 0, 0, 0};
+    uint32_t frame_interval_us_ = 0;
+    uint32_t last_frame_us_ = 0;
+    uint32_t frame_start_us_ = 0;
+    bool dma_ = false;
+    bool in_write_ = false;
+    const void *in_flight_ = nullptr;     ///< Buffer being read by the DMA
+
+    std::array<rect, kMaxDirty> dirty_;
+    size_t n_dirty_ = 0;
+
+    std::array<Entry, kPoolSize> pool_;
+    size_t pool_bytes_ = 0;
+    uint32_t use_clock_ = 0;
+
+    uint32_t frame_bytes_ = 0;
+    Stats stats_{};
+
+    void EndTransfer_();
+    bool ClipRows_(int x, int y, int w, int h, int &top, int &rows);
+    void Evict_(Entry &e);
+    static rect Union_(const rect &a, const rect &b);
+    static bool Touches_(const rect &a, const rect &b);
+    static inline int Area_(const rect &r) { return r.w * r.h; }
+};
+
+#endif  // __COMPOSITOR_HPP__
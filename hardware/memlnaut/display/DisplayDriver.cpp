@@ -7,6 +7,7 @@ void DisplayDriver::Setup() {
     tft_.init();
     tft_.setRotation(1);
     tft_.fillScreen(TFT_BLACK);
+    compositor_.Setup(tft_.width(), tft_.height(), kMaxFps);
     tft_initialized_ = true;
     Serial.println("display init");
 
@@ -46,14 +47,17 @@ void DisplayDriver::Draw() {
     // Serial.println("display draw");
     lastDrawTime_ = millis();
 
-    // Check if any of the views need redrawing
-    bool needRedraw = false;
+    // Skip while the last frame is still going out over DMA, or too soon
+    if (!compositor_.BeginFrame(micros())) {
+        return;
+    }
+
     if (redraw_internal_) {
 
-        // Clear screen
-        tft_.fillScreen(TFT_BLACK);
-        // tft_.setTextColor(TFT_WHITE);
-        tft_.fillRect(0, 0, tft_.width(), 30, TFT_WHITE);
+        // Clear screen: the bar and the area below it, each filled once
+        compositor_.Invalidate({0, 0, tft_.width(), tft_.height()});
+        tft_.fillRect(0, 0, tft_.width(), topBarHeight, TFT_WHITE);
+        tft_.fillRect(0, topBarHeight, tft_.width(), tft_.height() - topBarHeight, TFT_BLACK);
 
         // Clear the redraw flag now that screen is cleared
         // This allows rapid view changes while ensuring old content is removed
@@ -94,7 +98,30 @@ void DisplayDriver::Draw() {
         views_[currentViewIndex_]->Draw();
     }
 
+    compositor_.EndFrame(micros());
+}
 
+void DisplayDriver::PrintViewStats() {
+    const auto stats = compositor_.GetStats();
+    Serial.printf("Display: %lu frames, %.1f ms last, %.1f ms max, %lu B last frame, %lu kB sent\n",
+                  (unsigned long)stats.frames, stats.frame_us / 1000.f, stats.max_frame_us / 1000.f,
+                  (unsigned long)stats.frame_bytes,
+                  (unsigned long)((stats.bytes_pushed + stats.bytes_direct) / 1024));
+    std::function<void(const std::shared_ptr<ViewBase>&, int)> print =
+        [&print](const std::shared_ptr<ViewBase>& view, int depth) {
+        const auto& s = view->GetDrawStats();
+        Serial.printf("%*s%-20s %6.1f draws/s %8lu B last %10lu B total\n", 2 + 2 * depth, "",
+                      view->GetName().c_str(), s.rate, (unsigned long)s.lastBytes, (unsigned long)s.bytes);
+        for (auto& sub : view->GetSubViews()) {
+            print(sub, depth + 1);
+        }
+    };
+    for (auto& view : views_) {
+        print(view, 0);
+    }
+    if (dialogView_) {
+        print(dialogView_, 0);
+    }
 }
 
 void DisplayDriver::NavigateToView(const std::shared_ptr<ViewBase>& target) {
@@ -152,6 +179,11 @@ void DisplayDriver::ChangeView(int delta) {
 void DisplayDriver::PollTouch() {
     // lastTouchTime_ = millis();
 
+    // Touch shares the SPI bus with the panel
+    if (compositor_.Busy()) {
+        return;
+    }
+
     uint16_t x, y;
     bool pressed = tft_.getTouch(&x, &y, 20);
     if(pressed) {
@@ -2,6 +2,7 @@
 #define __DISPLAY_DRIVER_HPP__
 
 #include "View.hpp"
+#include "Compositor.hpp"
 #include <vector>
 #include <memory>
 #include <algorithm>
@@ -15,7 +16,9 @@
 
 class DisplayDriver {
 public:
-    DisplayDriver() {}
+    DisplayDriver() {
+        ViewBase::SetCompositor(&compositor_);
+    }
 
     void Setup();
     void Draw();
@@ -49,6 +52,9 @@ public:
     void PollTouch();
     unsigned long GetLastTouchTime() const { return lastTouchTime_; }
     unsigned long GetLastDrawTime() const { return lastDrawTime_; }
+    Compositor::Stats GetDisplayStats() const { return compositor_.GetStats(); }
+    // Refresh rate and SPI bytes per draw of every view, over serial
+    void PrintViewStats();
 
     void ChangeView(int delta);
     void NavigateToView(const std::shared_ptr<ViewBase>& target);
@@ -88,7 +94,9 @@ public:
 private:
     // Internal TFT hardware instance
     TFT_eSPI tft_;
-    
+    Compositor compositor_{&tft_};
+    static constexpr uint32_t kMaxFps = 30;
+
 
     // Views
     std::vector<std::shared_ptr<ViewBase>> views_;
@@ -3,80 +3,85 @@
 
 #include "View.hpp"
 #include "UIElements.hpp"
+#include "../../../utils/EnvelopeFeed.hpp"
+#include <algorithm>
+#include <limits>
 
 
+// Sweeping strip chart of NPOINTS columns. New columns are written at a
+// cursor that wraps round, with a short blank gap ahead of it, so a frame
+// only sends the columns that changed rather than the whole plot.
+// Fed either with addDataPoint() (loss curves, control values) or from
+// an EnvelopeFeed filled on the audio core (scope), which is drained each
+// frame while the view is on screen. The range follows the data unless
+// fixed with setRange(); a rescale redraws the plot from its history.
 template<size_t NPOINTS=128>
 class GraphView : public ViewBase {
 
 public:
-    TFT_eSprite *sprite = nullptr;
-    TFT_eSprite *sprTitle = nullptr;
-    TFT_eSprite *sprMax = nullptr;
+    using Feed = EnvelopeFeed<>;
 
     GraphView(String name, int _fillcolour_ = TFT_BLUE)
         : ViewBase(name), fillColour(_fillcolour_)
     {
+        history.fill(kEmpty);
     }
 
 
     void OnSetup() override {
-        graphHeight = area.h - 20;
-        xstep = static_cast<float>(area.w) / static_cast<float>(NPOINTS - 1);
-
-        sprite = new TFT_eSprite(scr);
-        sprite->createSprite(area.w, graphHeight);
-
-        sprTitle = new TFT_eSprite(scr);
-        sprTitle->createSprite(100,20);
-
-        sprMax = new TFT_eSprite(scr);
-        sprMax->createSprite(100,15);
-
-        sprTitle->fillSprite(TFT_BLACK);
-        sprTitle->setTextColor(TFT_SILVER, TFT_BLACK);
-        sprTitle->setTextFont(2);
-        sprTitle->drawString(this->name_, 0, 0);
-
-
-
+        graphTop = area.y + 20;
+        graphHeight = std::max(1, area.h - 20);
+        colW = std::max(1, area.w / static_cast<int>(NPOINTS));
+    }
 
-    }  
+    bool DrawsToPanel() const override { return false; }
 
     void OnDraw() override {
-        // scr->fillRect(area.x, area.y, area.w, area.h, TFT_BLUE);
-        // if (pressed) {
-        //     scr->drawRect(area.x, area.y, area.w, area.h, TFT_RED);
-        // } else {
-        //     scr->drawRect(area.x, area.y, area.w, area.h, TFT_WHITE);
-        // }
-        // scr->setTextColor(TFT_WHITE);
-        // scr->setTextFont(4);
-        // scr->drawString(this->name_, area.x + 10, area.y + 10);
-        // scr->drawString("1", area.x + 10, area.y + 10);
-        // for(size_t i = 0; i < NPOINTS-1; i++) {
-        //     scr->drawLine(oldGraphPoints[i].x, oldGraphPoints[i].y, oldGraphPoints[i+1].x, oldGraphPoints[i+1].y, TFT_BLACK);
-        // }
-        sprite->fillSprite(TFT_BLACK);
-        for(size_t i = 0; i < NPOINTS-1; i++) {
-            sprite->drawLine(graphPoints[i].x, graphPoints[i].y, graphPoints[i+1].x, graphPoints[i+1].y, fillColour);
-        }
-
-        sprite->pushSprite(area.x, area.y+20);
+        if (feed) {
+            Feed::Column c;
+            while (feed->Pop(c)) {
+                append(c);
+            }
+        }
+        if (rescale) {
+            updateRange();
+        }
+        if (fullRedraw || pending >= NPOINTS) {
+            drawColumns(0, NPOINTS);
+        } else if (pending > 0) {
+            // The new columns, and the gap that erases ahead of them
+            drawColumns((cursor + NPOINTS - pending) % NPOINTS, pending + kGap);
+        }
+        fullRedraw = false;
+        pending = 0;
+
         if (redrawMax) {
-            sprMax->fillSprite(TFT_BLACK);
-            sprMax->setTextColor(TFT_SILVER, TFT_BLACK);
-            sprMax->setTextFont(1);
-            sprMax->drawString((String("max: ") + String(ymax)).c_str(), 0, 0);
-            sprMax->pushSprite(area.x+area.w-110, area.y);
+            TFT_eSprite* sprMax = AcquireSprite(100, 15);
+            if (sprMax) {
+                sprMax->fillSprite(TFT_BLACK);
+                sprMax->setTextColor(TFT_SILVER, TFT_BLACK);
+                sprMax->setTextFont(1);
+                sprMax->drawString((String("max: ") + String(ymax)).c_str(), 0, 0);
+                PushSpriteDirty(sprMax, area.x+area.w-110, area.y);
+            }
             redrawMax = false;
         }
         if (redrawTitle) {
-            sprTitle->pushSprite(area.x, area.y);
+            TFT_eSprite* sprTitle = AcquireSprite(100, 20);
+            if (sprTitle) {
+                sprTitle->fillSprite(TFT_BLACK);
+                sprTitle->setTextColor(TFT_SILVER, TFT_BLACK);
+                sprTitle->setTextFont(2);
+                sprTitle->drawString(this->name_, 0, 0);
+                PushSpriteDirty(sprTitle, area.x, area.y);
+            }
             redrawTitle = false;
         }
-        sprTitle->pushSprite(area.x, area.y);
 
-    }  
+        if (feed && IsVisible()) {
+            poll();  // keep draining the feed while on screen
+        }
+    }
 
 
 
@@ -88,74 +93,164 @@ public:
 
     void addDataPoint(float value) {
         if (IsVisible()) {
+            append({value, value});
+            poll();
+        }
+    }
 
-            dataPoints[dataPointIndex] = value;
-            ymax = -std::numeric_limits<float>::infinity();
-            ymin = std::numeric_limits<float>::infinity();
-            for(size_t i = 0; i < NPOINTS; i++) {
-                if (dataPoints[i] > ymax) {
-                    ymax = dataPoints[i];
-                }
-                // if (dataPoints[i] < xmin) {
-                    // xmin = dataPoints[i];
-                // }
-            }
-            redrawMax = oldyMax != ymax;
-            oldyMax = ymax;
-
-            ymin = 0.f;
-            yrange = ymax - ymin;
-            if (yrange < 0.00001f) {
-                yrange = 0.00001f;
-            }
-            yrangeInv = 1.f / yrange;
-            for(size_t i = 0; i < NPOINTS; i++) {
-                oldGraphPoints[i] = {graphPoints[i].x, graphPoints[i].y};
-                size_t index = (dataPointIndex + i + 1) % NPOINTS;
-                int graphX = static_cast<int>(static_cast<float>(i) * xstep);
-                int graphY = graphHeight - static_cast<int>((dataPoints[index]-ymin) * yrangeInv * graphHeight);
-                graphPoints[i] = { graphX, graphY };
-            }
-            dataPointIndex = (dataPointIndex + 1) % NPOINTS;
-            // for(size_t i=0; i < 10; i++) {
-            //     Serial.printf("(%d,%d),", oldGraphPoints[i].x, oldGraphPoints[i].y);
-            // }
-            // Serial.println(" ");
-            // for(size_t i=0; i < 10; i++) {
-            //     Serial.printf("(%d,%d),", graphPoints[i].x, graphPoints[i].y);
-            // }
-            // Serial.println("\n --------- ");
-            redraw();
+    // Plot columns from a feed (nullptr to detach). The feed is switched
+    // on and off with the view's visibility.
+    void attachFeed(Feed* newFeed) {
+        feed = newFeed;
+        if (feed) {
+            feed->SetActive(IsVisible());
+            poll();
         }
     }
 
+    // Fix the y range (e.g. -1..1 for audio) instead of following the data
+    void setRange(float lo, float hi) {
+        autoRange = false;
+        ymin = lo;
+        ymax = std::max(hi, lo + 0.00001f);
+        fullRedraw = true;
+        redrawMax = true;
+        poll();
+    }
+
     void OnDisplay() override {
         ViewBase::OnDisplay();
-        for(size_t i = 0; i < NPOINTS; i++) {
-            graphPoints[i] = { static_cast<int>(i*xstep), 0 };
+        if (feed) {
+            feed->Clear();
+            feed->SetActive(true);
         }
+        fullRedraw = true;
         redrawMax = true;
         redrawTitle = true;
         redraw();
     };
 
+    void OnHide() override {
+        if (feed) {
+            feed->SetActive(false);
+        }
+    }
+
 
 private:
-    struct Point {
-        int x=0;
-        int y=0;
-    };
+    using Column = Feed::Column;
+
+    static constexpr Column kEmpty{1.f, 0.f};   // lo > hi: nothing plotted yet
+    static constexpr size_t kGap = 3;           // Blank columns ahead of the cursor
+    static constexpr size_t kStripCols = 32;    // Columns per pooled strip sprite
 
     int fillColour;
-    std::array<float, NPOINTS> dataPoints{0.0f};
-    std::array<Point, NPOINTS> graphPoints{}, oldGraphPoints{};
-    size_t dataPointIndex = 0;
-    float xstep=1;
-    float ymax, ymin,yrange, yrangeInv;
-    float graphHeight = 1;
-    float oldyMax = 0.f;
+    Feed* feed = nullptr;
+    std::array<Column, NPOINTS> history;
+    size_t cursor = 0;          // Next column to write
+    size_t pending = 0;         // Columns written since the last draw
+    bool fullRedraw = true;
+    bool rescale = false;
+    bool autoRange = true;
+    float ymin = 0.f;
+    float ymax = 0.00001f;
+    int graphTop = 0;
+    int graphHeight = 1;
+    int colW = 1;
     bool redrawMax=true;
     bool redrawTitle=true;
+
+    void append(const Column& c) {
+        history[cursor] = c;
+        cursor = (cursor + 1) % NPOINTS;
+        if (pending < NPOINTS) {
+            pending++;
+        }
+        if (autoRange && (c.hi > ymax || c.lo < ymin || cursor == 0)) {
+            // Grow straight away; check for shrinking once per sweep
+            rescale = true;
+        }
+    }
+
+    void updateRange() {
+        rescale = false;
+        // Seeded from the data, so a trace away from 0 gets the full height
+        float hi = -std::numeric_limits<float>::infinity();
+        float lo = std::numeric_limits<float>::infinity();
+        for (const auto& c : history) {
+            if (c.lo <= c.hi) {
+                hi = std::max(hi, c.hi);
+                lo = std::min(lo, c.lo);
+            }
+        }
+        if (lo > hi) {
+            return;     // Nothing plotted yet
+        }
+        if (hi < lo + 0.00001f) {
+            hi = lo + 0.00001f;
+        }
+        // Headroom when growing, hysteresis when shrinking, so a slowly
+        // rising curve doesn't redraw the plot on every point
+        const float range = hi - lo;
+        if (hi > ymax || lo < ymin || range < 0.5f * (ymax - ymin)) {
+            ymin = lo;
+            ymax = lo + range * 1.25f;
+            fullRedraw = true;
+            redrawMax = true;
+        }
+    }
+
+    inline int toY(float v) const {
+        const int y = static_cast<int>((ymax - v) / (ymax - ymin) * static_cast<float>(graphHeight - 1));
+        return std::clamp(y, 0, graphHeight - 1);
+    }
+
+    inline bool inGap(size_t pos) const {
+        return (pos + NPOINTS - cursor) % NPOINTS < kGap;
+    }
+
+    // Draw count columns from pos (wrapping) in strips of pooled sprites,
+    // writing pixels straight into the buffer at the strip's width
+    void drawColumns(size_t pos, size_t count) {
+        count = std::min(count, NPOINTS);
+        const uint16_t fg = swap16(static_cast<uint16_t>(fillColour));
+        size_t done = 0;
+        while (done < count) {
+            const size_t first = (pos + done) % NPOINTS;
+            const size_t n = std::min({count - done, NPOINTS - first, kStripCols});
+            TFT_eSprite* strip = AcquireSprite(static_cast<int>(kStripCols) * colW, graphHeight);
+            if (!strip) return;
+            uint16_t* px = static_cast<uint16_t*>(strip->getPointer());
+            const int w = static_cast<int>(n) * colW;
+            std::fill(px, px + w * graphHeight, TFT_BLACK);
+            for (size_t i = 0; i < n; i++) {
+                const size_t col = first + i;
+                const size_t prev = (col + NPOINTS - 1) % NPOINTS;
+                const Column& c = history[col];
+                if (inGap(col) || c.lo > c.hi) {
+                    continue;
+                }
+                int top = toY(c.hi);
+                int bottom = toY(c.lo);
+                // Join to the previous column so the trace is continuous
+                const Column& p = history[prev];
+                if (!inGap(prev) && p.lo <= p.hi) {
+                    top = std::min(top, toY(p.lo));
+                    bottom = std::max(bottom, toY(p.hi));
+                }
+                for (int y = top; y <= bottom; y++) {
+                    std::fill_n(px + y * w + static_cast<int>(i) * colW, colW, fg);
+                }
+            }
+            PushSpriteDirty(strip, area.x + static_cast<int>(first) * colW, graphTop, w, graphHeight);
+            done += n;
+        }
+    }
+
+    // Sprite buffers hold pixels in panel byte order
+    static inline uint16_t swap16(uint16_t c) {
+        return static_cast<uint16_t>((c >> 8) | (c << 8));
+    }
 };
 
-#endif 
+#endif
@@ -16,17 +16,17 @@ public:
     }  
 
     void OnDraw() override {
-        TFT_eSprite textSprite(scr);
-        textSprite.createSprite(320, 20);
-        textSprite.setTextFont(2);
         scr->fillRect(area.x, area.y, area.w, area.h, TFT_BLACK);
         constexpr int32_t lineheight = 20;
-        textSprite.setTextColor(TFT_WHITE, TFT_BLACK);
         for(size_t i=0; i < lines.size(); i++) {
-            textSprite.fillRect(0,0,320,20,TFT_BLACK);
-            textSprite.drawString(lines[i].c_str(), 0, 0);
-            textSprite.pushSprite(area.x + 10,area.y + (i*lineheight));
-
+            // Alternates between two pooled buffers, so each line is drawn while the last is sent
+            TFT_eSprite* textSprite = AcquireSprite(320, 20);
+            if (!textSprite) return;
+            textSprite->setTextFont(2);
+            textSprite->setTextColor(TFT_WHITE, TFT_BLACK);
+            textSprite->fillSprite(TFT_BLACK);
+            textSprite->drawString(lines[i].c_str(), 0, 0);
+            PushSprite(textSprite, area.x + 10, area.y + (i*lineheight));
         }
 
     }  
@@ -41,9 +41,7 @@ public:
     void OnDraw() override {
         scr->drawLine(area.x, area.y, area.x, area.y + area.h, isFocused() ? TFT_GREEN : TFT_BLUE);
         
-        TFT_eSprite textSprite(scr);
         constexpr int32_t lineheight = 25;
-        textSprite.createSprite(area.w-50, lineheight);
         constexpr size_t sizes[] = {1,2,2,2,1};
         constexpr size_t heights[] = {15,25,25,25,15};
         constexpr size_t indents[] = {5,10,15,10,5};
@@ -52,20 +50,22 @@ public:
         int heightAccum = 0;
         for(int i=0; i < 5; i++) {
             int itemIndex = selectedIndex - 2 + i;
-            textSprite.fillSprite(TFT_BLACK);
+            TFT_eSprite* textSprite = AcquireSprite(area.w-50, lineheight);
+            if (!textSprite) return;
+            textSprite->fillSprite(TFT_BLACK);
             if (itemIndex < 0 || itemIndex >= options.size()) {
                 //
             }else{
                 if (isFocused() && (itemIndex == selectedIndex)) {
-                    textSprite.setTextColor(TFT_YELLOW, TFT_BLACK);
+                    textSprite->setTextColor(TFT_YELLOW, TFT_BLACK);
 
                 } else {
-                    textSprite.setTextColor(colours[i], TFT_BLACK);
+                    textSprite->setTextColor(colours[i], TFT_BLACK);
                 }
-                textSprite.setTextFont(sizes[i]);
-                textSprite.drawString(options[itemIndex].c_str(), indents[i], 0);
+                textSprite->setTextFont(sizes[i]);
+                textSprite->drawString(options[itemIndex].c_str(), indents[i], 0);
             }
-            textSprite.pushSprite(area.x + 10,area.y + 20 + heightAccum);
+            PushSprite(textSprite, area.x + 10, area.y + 20 + heightAccum);
             heightAccum += heights[i];
         }
 
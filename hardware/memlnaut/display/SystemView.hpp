@@ -21,19 +21,17 @@ public:
         totalHeap = rp2040.getTotalHeap();
         usedHeap = totalHeap - freeHeap;
         sys_clk = clock_get_hz(clk_sys);        
+        if (GetCompositor()) {
+            displayStats = GetCompositor()->GetStats();
+        }
     };
 
     
     void OnDraw() override {
-        TFT_eSprite textSprite(scr);
-        textSprite.createSprite(320, 20);
-        textSprite.setTextFont(2);
         scr->fillRect(area.x, area.y, area.w, area.h, TFT_BLACK);
         constexpr int32_t lineheight = 20;
-        textSprite.setTextColor(TFT_WHITE, TFT_BLACK);
         std::deque<String> lines;
         lines.push_back(String("MEMLNaut ") + String(MEMLLIB_VERSION));
-        lines.push_back("");
         lines.push_back("Info: https://musicallyembodiedml.github.io");
         lines.push_back("");
         lines.push_back("Build: " + String(__DATE__) + " " + String(__TIME__));
@@ -41,14 +39,24 @@ public:
         lines.push_back("Heap: " + String(freeHeap/1024) + "k free, " +
                        String(totalHeap/1024) + "k total, " +
                        String(usedHeap/1024) + "k used");
+        lines.push_back("Frame: " + String(displayStats.frame_us/1000.f, 1) + " ms (max " +
+                       String(displayStats.max_frame_us/1000.f, 1) + "), " +
+                       String(displayStats.frames) + " frames" +
+                       (displayStats.dma ? ", DMA" : ""));
+        lines.push_back("Pushed: " + String(displayStats.frame_bytes/1024.f, 1) + "k last frame, " +
+                       String(static_cast<uint32_t>(displayStats.bytes_pushed/1024)) + "k total");
         lines.push_back("");
         lines.push_back("Made by Chris Kiefer and Andrea Martelloni");
         lines.push_back("Emute Lab, University of Sussex, UK");
 
         for(size_t i=0; i < lines.size(); i++) {
-            textSprite.fillRect(0,0,320,20,TFT_BLACK);
-            textSprite.drawString(lines[i].c_str(), 0, 0);
-            textSprite.pushSprite(area.x + 10,area.y + (i*lineheight));
+            TFT_eSprite* textSprite = AcquireSprite(320, 20);
+            if (!textSprite) return;
+            textSprite->setTextFont(2);
+            textSprite->setTextColor(TFT_WHITE, TFT_BLACK);
+            textSprite->fillSprite(TFT_BLACK);
+            textSprite->drawString(lines[i].c_str(), 0, 0);
+            PushSprite(textSprite, area.x + 10, area.y + (i*lineheight));
         }
 
     }  
@@ -60,6 +68,7 @@ private:
     uint32_t totalHeap = 0;
     uint32_t usedHeap = 0;
     uint32_t sys_clk=0;
+    Compositor::Stats displayStats{};
 
 };
 
@@ -3,34 +3,55 @@
 
 #include "View.hpp"
 #include "UIElements.hpp"
+#include "../../../utils/EnvelopeFeed.hpp"
 #include <vector>
+#include <algorithm>
 #include <functional>
 #include <cmath>
 
-// Vertical VU meters fed from an external published level buffer (filled on the audio core).
+// Vertical VU meters fed from an external published level buffer (filled on the audio core),
+// or from one EnvelopeFeed per meter (the peak of the columns that arrived since the last frame).
 // The view arms/disarms that measurement via onActive() as it comes on/off screen, and
-// self-refreshes (~25 fps) only while it is the current view — so it costs nothing when hidden.
+// self-refreshes (at the display frame rate) only while it is the current view — so it costs
+// nothing when hidden. Only the part of each bar that changed is filled.
 class VUMeterView : public ViewBase {
 public:
     using OnActiveCallback = std::function<void(bool)>;
+    using Feed = EnvelopeFeed<>;
 
     VUMeterView(String name, std::vector<String> labels,
                 const volatile float* levels, OnActiveCallback onActive)
         : ViewBase(name), labels_(std::move(labels)), levels_(levels),
           onActive_(std::move(onActive)) {}
 
+    VUMeterView(String name, std::vector<String> labels, std::vector<Feed*> feeds)
+        : ViewBase(name), labels_(std::move(labels)), levels_(nullptr),
+          feeds_(std::move(feeds)) {
+        onActive_ = [this](bool active) {
+            for (auto* feed : feeds_) {
+                if (feed) {
+                    feed->Clear();
+                    feed->SetActive(active);
+                }
+            }
+        };
+    }
+
     void OnSetup() override {
         nBars_    = labels_.size();
         slotW_    = nBars_ ? area.w / (int)nBars_ : area.w;
         barW_     = 10;
         meterTop_ = area.y + topPad_;
         meterH_   = area.h - topPad_ - labelH_;
+        lit_.assign(nBars_, 0);
+        peak_.assign(nBars_, 0.f);
     }
 
     void OnDisplay() override {
         ViewBase::OnDisplay();
         if (onActive_) onActive_(true);
         drawLabels_ = true;
+        std::fill(lit_.begin(), lit_.end(), -1);  // unknown: repaint whole columns
         redraw();
     }
 
@@ -40,25 +61,25 @@ public:
 
     void OnDraw() override {
         const int bottom = meterTop_ + meterH_;
-        const float gThr = 0.6f, yThr = 0.85f;  // green / yellow / red zone boundaries
 
         for (size_t i = 0; i < nBars_; ++i) {
             const int slotX = area.x + (int)i * slotW_;
             const int x = slotX + (slotW_ - barW_) / 2;
 
-            float lvl = levels_ ? levels_[i] : 0.f;
+            float lvl = levelOf_(i);
             if (lvl < 0.f) lvl = 0.f; else if (lvl > 1.f) lvl = 1.f;
-
-            // Erase the full column, then paint the lit zones from the bottom up.
-            scr->fillRect(x, meterTop_, barW_, meterH_, TFT_BLACK);
-
-            const int gPx = (int)(fminf(lvl, gThr) * meterH_);
-            const int yPx = (int)(fmaxf(0.f, fminf(lvl, yThr) - gThr) * meterH_);
-            const int rPx = (int)(fmaxf(0.f, lvl - yThr) * meterH_);
-
-            if (gPx > 0) scr->fillRect(x, bottom - gPx,             barW_, gPx, TFT_GREEN);
-            if (yPx > 0) scr->fillRect(x, bottom - gPx - yPx,       barW_, yPx, TFT_YELLOW);
-            if (rPx > 0) scr->fillRect(x, bottom - gPx - yPx - rPx, barW_, rPx, TFT_RED);
+            const int px = (int)(lvl * meterH_);
+
+            if (lit_[i] < 0) {
+                // Erase the full column, then paint the lit zones from the bottom up.
+                FillRect(x, meterTop_, barW_, meterH_ - px, TFT_BLACK);
+                paintZones_(x, 0, px);
+            } else if (px > lit_[i]) {
+                paintZones_(x, lit_[i], px);
+            } else if (px < lit_[i]) {
+                FillRect(x, bottom - lit_[i], barW_, lit_[i] - px, TFT_BLACK);
+            }
+            lit_[i] = px;
 
             if (drawLabels_) {
                 scr->setTextFont(2);
@@ -68,7 +89,7 @@ public:
             }
         }
         drawLabels_ = false;
-        redraw();  // keep refreshing while we are the active view
+        poll();  // keep refreshing while we are the active view
     }
 
 private:
@@ -82,6 +103,41 @@ private:
     const int topPad_ = 6;
     const int labelH_ = 20;
     bool drawLabels_ = true;
+    std::vector<Feed*> feeds_;
+    std::vector<int> lit_;          // Lit height per bar in px, -1 = repaint
+    std::vector<float> peak_;       // Last level from each feed
+
+    float levelOf_(size_t i) {
+        if (i < feeds_.size() && feeds_[i]) {
+            // Peak of everything since the last frame; hold it if nothing came
+            Feed::Column c;
+            bool any = false;
+            float pk = 0.f;
+            while (feeds_[i]->Pop(c)) {
+                pk = fmaxf(pk, fmaxf(fabsf(c.lo), fabsf(c.hi)));
+                any = true;
+            }
+            if (any) peak_[i] = pk;
+            return peak_[i];
+        }
+        return levels_ ? levels_[i] : 0.f;
+    }
+
+    // Light rows [from, to) of a bar, counted up from the bottom
+    void paintZones_(int x, int from, int to) {
+        const int bottom = meterTop_ + meterH_;
+        const int zoneTop[3] = { (int)(gThr_ * meterH_), (int)(yThr_ * meterH_), meterH_ };
+        const uint32_t zoneColour[3] = { TFT_GREEN, TFT_YELLOW, TFT_RED };
+        int zoneBottom = 0;
+        for (int z = 0; z < 3; ++z) {
+            const int lo = std::max(from, zoneBottom);
+            const int hi = std::min(to, zoneTop[z]);
+            if (hi > lo) FillRect(x, bottom - hi, barW_, hi - lo, zoneColour[z]);
+            zoneBottom = zoneTop[z];
+        }
+    }
+
+    static constexpr float gThr_ = 0.6f, yThr_ = 0.85f;  // green / yellow / red zone boundaries
 };
 
 #endif
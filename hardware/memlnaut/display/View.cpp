@@ -1,9 +1,12 @@
 #include "View.hpp"
 
+Compositor* ViewBase::compositor_ = nullptr;
+
 void ViewBase::Setup(TFT_eSPI* tft, rect bounds) {
     scr = tft;
-    needRedraw_ = true;
     area = bounds;
+    dirty_ = {0, 0, 0, 0};
+    MarkDirty_(area);
     OnSetup();
 }
 
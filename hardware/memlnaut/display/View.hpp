@@ -3,6 +3,8 @@
 
 #include <TFT_eSPI.h>
 #include "UIElements.hpp"
+#include "Compositor.hpp"
+#include <algorithm>
 
 
 class ViewBase {
@@ -13,6 +15,9 @@ public:
     void Setup(TFT_eSPI* tft, rect bounds);  // No longer virtual
     virtual void OnSetup() = 0;  // New virtual setup hook
     virtual void OnDraw() = 0;  
+    // False if OnDraw only uses AcquireSprite/PushSprite, so it can run
+    // while the previous transfer is still going
+    virtual bool DrawsToPanel() const { return true; }
     virtual void OnTouchDown(size_t x, size_t y) {
 
     };  
@@ -37,15 +42,49 @@ public:
     }
     
     inline void redraw() {
-        needRedraw_ = true;
+        MarkDirty_(area);
         for(auto& subview: subviews) {
             subview->redraw();
         }
     }
 
+    // Only part of this view changed; sprite rows outside it aren't sent
+    inline void redraw(const rect& r) {
+        MarkDirty_(r);
+    }
+
+    // Call OnDraw next frame without marking anything dirty: for views
+    // that pull new data and invalidate just what they draw
+    inline void poll() {
+        needRedraw_ = true;
+    }
+
+    struct DrawStats {
+        uint32_t draws;
+        uint64_t bytes;         // Sent to the panel by OnDraw
+        uint32_t lastBytes;
+        float rate;             // Draws per second, smoothed
+        uint32_t lastDrawUs;
+    };
+
+    const DrawStats& GetDrawStats() const { return drawStats_; }
+    const std::vector<std::shared_ptr<ViewBase>>& GetSubViews() const { return subviews; }
+
     void Draw() {
         if (NeedRedraw()) {
+            uint64_t sent = 0;
+            if (compositor_) {
+                compositor_->Invalidate(dirty_);
+                if (DrawsToPanel()) {
+                    compositor_->WaitIdle();
+                }
+                sent = compositor_->BytesSent();
+            }
+            dirty_ = {0, 0, 0, 0};
             OnDraw();
+            if (compositor_) {
+                CountDraw_(static_cast<uint32_t>(compositor_->BytesSent() - sent));
+            }
         }
         for(auto& subview: subviews) {
             subview->Draw();
@@ -127,6 +166,9 @@ public:
         // Override in subclass if needed
     }
 
+    static void SetCompositor(Compositor* c) { compositor_ = c; }
+    static Compositor* GetCompositor() { return compositor_; }
+
 protected:
     explicit ViewBase(String &name)  // Changed parameter type
             : name_(name)
@@ -141,6 +183,64 @@ protected:
     std::vector<std::shared_ptr<ViewBase>> subviews;
     bool viewIsVisible = false;
     bool hasFocus = false;
+    rect dirty_{0, 0, 0, 0};
+    DrawStats drawStats_{};
+
+    static Compositor* compositor_;
+
+    // Pooled sprite for drawing in OnDraw(); hand it back with PushSprite()
+    TFT_eSprite* AcquireSprite(int w, int h) {
+        return compositor_ ? compositor_->Acquire(w, h) : nullptr;
+    }
+
+    void PushSprite(TFT_eSprite* sprite, int x, int y) {
+        if (compositor_) {
+            compositor_->Push(sprite, x, y);
+        } else if (sprite) {
+            sprite->pushSprite(x, y);
+        }
+    }
+
+    // Mark the sprite's rectangle dirty in the current frame, then push it
+    // (see Compositor::Push for w and h)
+    void PushSpriteDirty(TFT_eSprite* sprite, int x, int y, int w = 0, int h = 0) {
+        if (!compositor_ || !sprite) return;
+        compositor_->Invalidate({x, y, w > 0 ? w : sprite->width(), h > 0 ? h : sprite->height()});
+        compositor_->Push(sprite, x, y, w, h);
+    }
+
+    // Direct fill, counted against this view's SPI cost
+    void FillRect(int x, int y, int w, int h, uint32_t colour) {
+        scr->fillRect(x, y, w, h, colour);
+        if (compositor_) {
+            compositor_->CountDirect(static_cast<uint32_t>(w * h * 2));
+        }
+    }
+
+    void CountDraw_(uint32_t bytes) {
+        const uint32_t now = micros();
+        if (drawStats_.draws > 0 && now != drawStats_.lastDrawUs) {
+            const float rate = 1e6f / static_cast<float>(now - drawStats_.lastDrawUs);
+            drawStats_.rate += 0.1f * (rate - drawStats_.rate);
+        }
+        drawStats_.lastDrawUs = now;
+        drawStats_.draws++;
+        drawStats_.bytes += bytes;
+        drawStats_.lastBytes = bytes;
+    }
+
+    void MarkDirty_(const rect& r) {
+        needRedraw_ = true;
+        if (dirty_.w <= 0 || dirty_.h <= 0) {
+            dirty_ = r;
+            return;
+        }
+        const int x0 = std::min(dirty_.x, r.x);
+        const int y0 = std::min(dirty_.y, r.y);
+        const int x1 = std::max(dirty_.x + dirty_.w, r.x + r.w);
+        const int y1 = std::max(dirty_.y + dirty_.h, r.y + r.h);
+        dirty_ = {x0, y0, x1 - x0, y1 - y0};
+    }
 };
 
 
@@ -36,14 +36,16 @@ public:
     };
 
     
+    bool DrawsToPanel() const override { return false; }
+
     void OnDraw() override {
-        TFT_eSprite textSprite(scr);
-        textSprite.createSprite(area.w, 20);
-        textSprite.fillSprite(TFT_BLACK);
-        textSprite.setTextColor(TFT_WHITE, TFT_BLACK);
-        textSprite.setTextFont(2);
-        textSprite.drawString(isFocused() ? "Press to confirm" : "Press to select", 10, 0);
-        textSprite.pushSprite(area.x, area.y + 165);
+        TFT_eSprite* textSprite = AcquireSprite(area.w, 20);
+        if (!textSprite) return;
+        textSprite->fillSprite(TFT_BLACK);
+        textSprite->setTextColor(TFT_WHITE, TFT_BLACK);
+        textSprite->setTextFont(2);
+        textSprite->drawString(isFocused() ? "Press to confirm" : "Press to select", 10, 0);
+        PushSprite(textSprite, area.x, area.y + 165);
     }
 
     bool acceptsFocus() override {
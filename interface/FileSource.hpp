@@ -0,0 +1,135 @@
+#ifndef __FILE_SOURCE_HPP__
+#define __FILE_SOURCE_HPP__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Random-access, read-only file interface for streaming readers.
+ *
+ * SDCard implements it on the card; MockFileSource implements it in memory
+ * with a simple card timing model for host-side benchmarks. Handles are
+ * small integers, -1 meaning failure.
+ */
+class FileSource
+{
+public:
+    virtual ~FileSource() = default;
+
+    /**
+     * @brief Open a file for reading.
+     * @return Handle, or -1.
+     */
+    virtual int Open(const char *path) = 0;
+
+    virtual void Close(int handle) = 0;
+
+    /**
+     * @brief File size in bytes (0 for a bad handle).
+     */
+    virtual uint32_t Size(int handle) = 0;
+
+    /**
+     * @brief Read bytes at an absolute offset.
+     * @return Number of bytes read.
+     */
+    virtual size_t ReadAt(int handle, uint32_t offset, void *dst, size_t bytes) = 0;
+};
+
+
+/**
+ * @brief In-memory FileSource that accounts the time a card would take.
+ *
+ * Each Open() and ReadAt() adds to a simulated busy time: a fixed cost per
+ * open and per read command, plus the transfer at a sustained rate. A
+ * benchmark can give the reader a time budget per audio block and see
+ * when voices start to underrun.
+ */
+class MockFileSource : public FileSource
+{
+public:
+    struct Timing {
+        float open_us;          ///< Directory lookup and FAT walk
+        float command_us;       ///< Per read command (CMD18 + token wait)
+        float bytes_per_us;     ///< Sustained multi-block rate (1.0 = 1 MB/s)
+    };
+
+    /**
+     * @brief Defaults are roughly a class 10 card on 25 MHz SPI.
+     */
+    MockFileSource(Timing timing = {3000.f, 400.f, 2.5f}) : timing_(timing),
+        busy_us_(0), n_reads_(0), bytes_read_(0) {}
+
+    void AddFile(const char *path, std::vector<uint8_t> data) {
+        files_[path] = std::move(data);
+    }
+
+    void SetTiming(Timing timing) { timing_ = timing; }
+
+    int Open(const char *path) override {
+        auto it = files_.find(path);
+        busy_us_ += timing_.open_us;
+        if (it == files_.end()) {
+            return -1;
+        }
+        for (size_t h = 0; h < open_.size(); h++) {
+            if (!open_[h]) {
+                open_[h] = &it->second;
+                return static_cast<int>(h);
+            }
+        }
+        open_.push_back(&it->second);
+        return static_cast<int>(open_.size() - 1);
+    }
+
+    void Close(int handle) override {
+        if (Valid_(handle)) {
+            open_[handle] = nullptr;
+        }
+    }
+
+    uint32_t Size(int handle) override {
+        return Valid_(handle) ? static_cast<uint32_t>(open_[handle]->size()) : 0;
+    }
+
+    size_t ReadAt(int handle, uint32_t offset, void *dst, size_t bytes) override {
+        if (!Valid_(handle) || offset >= open_[handle]->size()) {
+            return 0;
+        }
+        const std::vector<uint8_t> &data = *open_[handle];
+        if (bytes > data.size() - offset) {
+            bytes = data.size() - offset;
+        }
+        std::memcpy(dst, data.data() + offset, bytes);
+        busy_us_ += timing_.command_us + static_cast<float>(bytes) / timing_.bytes_per_us;
+        n_reads_++;
+        bytes_read_ += bytes;
+        return bytes;
+    }
+
+    /**
+     * @brief Simulated card time used so far, in microseconds.
+     */
+    double GetBusyUs() const { return busy_us_; }
+    size_t GetReads() const { return n_reads_; }
+    size_t GetBytesRead() const { return bytes_read_; }
+    void ResetStats() { busy_us_ = 0; n_reads_ = 0; bytes_read_ = 0; }
+
+protected:
+    bool Valid_(int handle) const {
+        return handle >= 0 && static_cast<size_t>(handle) < open_.size() && open_[handle];
+    }
+
+    Timing timing_;
+    std::map<std::string, std::vector<uint8_t>> files_;
+    std::vector<std::vector<uint8_t> *> open_;
+    double busy_us_;
+    size_t n_reads_;
+    size_t bytes_read_;
+};
+
+#endif  // __FILE_SOURCE_HPP__
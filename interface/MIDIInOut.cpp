@@ -18,7 +18,38 @@ MIDI_CREATE_CUSTOM_INSTANCE(HardwareSerial, Serial2, MIDI, CustomMIDISettings);
 #ifdef MIDI_USB_CLIENT
 #include <Adafruit_TinyUSB.h>
 Adafruit_USBD_MIDI usb_midi;
-MIDI_CREATE_INSTANCE(Adafruit_USBD_MIDI, usb_midi, USBMIDI);
+
+/**
+ * @brief Class-compliant USB-MIDI device port via TinyUSB.
+ * Adafruit_USBD_MIDI converts between USB-MIDI event packets and the
+ * MIDI 1.0 byte stream, so the shared parser sees the same bytes as DIN.
+ */
+class USBMIDITransport : public MIDITransport
+{
+public:
+    bool Begin() override {
+        return usb_midi.begin();
+    }
+
+    size_t Read(uint8_t *dst, size_t max_bytes) override {
+        size_t n = 0;
+        while (n < max_bytes && usb_midi.available()) {
+            dst[n++] = static_cast<uint8_t>(usb_midi.read());
+        }
+        return n;
+    }
+
+    size_t Write(const uint8_t *src, size_t n_bytes) override {
+        if (!Connected()) {
+            return 0;
+        }
+        return usb_midi.write(src, n_bytes);
+    }
+
+    bool Connected() override {
+        return TinyUSBDevice.mounted();
+    }
+};
 #endif
 
 
@@ -36,26 +67,28 @@ MIDIInOut::MIDIInOut() : n_outputs_(0),
                          midi_tx_pin_(0),
                          rx_dma_channel_(-1),
                          rx_read_pos_(0),
-                         parser_state_(0),
-                         parser_status_(0),
-                         parser_index_(0),
-                         running_status_(0),
+                         usb_transport_(nullptr),
                          msg_write_pos_(0),
                          msg_read_pos_(0),
                          max_messages_per_poll_(16),
                          max_bytes_per_poll_(64),
                          track_changes_(true),
-                         queue_write_pos_(0) {
+                         queue_write_pos_(0),
+                         usb_queue_write_pos_(0) {
     instance_ = this;
     memset(tx_dma_buffer_, 0, sizeof(tx_dma_buffer_));
     memset(rx_dma_buffer_, 0, sizeof(rx_dma_buffer_));
-    memset(parser_data_, 0, sizeof(parser_data_));
     memset(msg_queue_, 0, sizeof(msg_queue_));
     memset(midi_queue_buffer_, 0, sizeof(midi_queue_buffer_));
+    memset(usb_queue_buffer_, 0, sizeof(usb_queue_buffer_));
+    for (size_t i = 0; i < kNumMessageClasses; i++) {
+        routes_[i] = kRouteBoth;
+    }
 #ifdef MIDI_USB_CLIENT
     // TinyUSB setup - must be before Serial
     TinyUSBDevice.setManufacturerDescriptor("ELI");
     TinyUSBDevice.setProductDescriptor("MEMLNaut MIDI");
+    usb_transport_ = std::make_shared<USBMIDITransport>();
 #endif
 }
 
@@ -167,15 +200,13 @@ void MIDIInOut::Setup(size_t n_outputs,
     // Serial2.flush();
     // MEMORY_BARRIER();
 
-#ifdef MIDI_USB_CLIENT
-    USBMIDI.begin(MIDI_CHANNEL_OMNI);
-    
-    // Set up callbacks for incoming MIDI
-    USBMIDI.setHandleNoteOn(handleNoteOn);
-    USBMIDI.setHandleNoteOff(handleNoteOff);
-    MIDI.setHandleControlChange(handleControlChange);    
-
-#endif    
+    // USB (or virtual) port shares the parser and queues with DIN
+    if (usb_transport_) {
+        if (!usb_transport_->Begin()) {
+            DEBUG_PRINTLN("Warning: USB MIDI transport failed to start");
+        }
+        usb_parser_.Reset();
+    }
 
      DEBUG_PRINTLN("MIDI setup complete");
     // Serial2.flush();  // Ensure the message is sent completely
@@ -187,9 +218,6 @@ void MIDIInOut::Poll()
     if (rx_dma_channel_ >= 0) {
         // Process incoming bytes from DMA buffer
         processRxBuffer();
-
-        // Process queued messages with rate limiting
-        processQueuedMessages();
     } else {
         // Non-DMA path: Read from Serial2 directly with rate limiting
         // Process limited number of bytes per poll to prevent blocking
@@ -197,14 +225,49 @@ void MIDIInOut::Poll()
 
         while (Serial2.available() && bytes_processed < max_bytes_per_poll_) {
             uint8_t byte = Serial2.read();
-            processMidiByte(byte);
+            processMidiByte(din_parser_, byte);
             bytes_processed++;
         }
+    }
 
-        // Process queued messages with rate limiting
-        processQueuedMessages();
+    if (usb_transport_) {
+        processUSBInput();
+    }
+
+    // Process queued messages from both ports with rate limiting
+    processQueuedMessages();
+}
+
+void MIDIInOut::processUSBInput() {
+    // Same per-poll byte budget as DIN, read in one block
+    uint8_t buffer[64];
+    uint32_t bytes_left = max_bytes_per_poll_ ? max_bytes_per_poll_ : UINT32_MAX;
+
+    while (bytes_left > 0) {
+        size_t chunk = bytes_left < sizeof(buffer) ? bytes_left : sizeof(buffer);
+        size_t n = usb_transport_->Read(buffer, chunk);
+        for (size_t i = 0; i < n; i++) {
+            processMidiByte(usb_parser_, buffer[i]);
+        }
+        if (n < chunk) {
+            break;
+        }
+        bytes_left -= n;
+    }
+}
+
+void MIDIInOut::writeDIN(const uint8_t* data, size_t length) {
+    if (tx_dma_channel_ >= 0) {
+        sendViaDMA(data, length);
+    } else {
+        Serial2.write(data, length);
+    }
+}
+
+void MIDIInOut::writeUSB(const uint8_t* data, size_t length) {
+    if (usb_transport_) {
+        usb_transport_->Write(data, length);
     }
-    // USBMIDI.read();
 }
 
 
@@ -284,10 +347,16 @@ void MIDIInOut::SendParamsAsMIDICC(std::span<const float> params) {
 
     // Only send if we have data
     if (buf_idx > 0) {
-        if (tx_dma_channel_ >= 0) {
-            sendViaDMADirect(buf_idx);  // No memcpy - buffer already built in place
-        } else {
-            Serial2.write(tx_dma_buffer_, buf_idx);
+        // USB first: the DMA transfer below owns tx_dma_buffer_ until complete
+        if (routeUSB(kMsgCC)) {
+            writeUSB(tx_dma_buffer_, buf_idx);
+        }
+        if (routeDIN(kMsgCC)) {
+            if (tx_dma_channel_ >= 0) {
+                sendViaDMADirect(buf_idx);  // No memcpy - buffer already built in place
+            } else {
+                Serial2.write(tx_dma_buffer_, buf_idx);
+            }
         }
     }
 }
@@ -412,11 +481,19 @@ bool MIDIInOut::sendNoteOn(uint8_t note_number, uint8_t velocity) {
         return false;
     }
 
-    // RefreshUART_(); // Refresh UART if needed
+    if (routeUSB(kMsgNote)) {
+        const uint8_t msg[3] = { static_cast<uint8_t>(0x90 | ((note_channel_ - 1) & 0x0F)),
+                                 note_number, velocity };
+        writeUSB(msg, sizeof(msg));
+    }
 
-    // while(!Serial2) { delay(1); } // Wait for Serial2
-    MIDI.sendNoteOn(note_number, velocity, note_channel_);
-    // MEMORY_BARRIER();
+    if (routeDIN(kMsgNote)) {
+        // RefreshUART_(); // Refresh UART if needed
+
+        // while(!Serial2) { delay(1); } // Wait for Serial2
+        MIDI.sendNoteOn(note_number, velocity, note_channel_);
+        // MEMORY_BARRIER();
+    }
     return true;
 }
 
@@ -425,30 +502,51 @@ bool MIDIInOut::sendNoteOff(uint8_t note_number, uint8_t velocity) {
         return false;
     }
 
-    RefreshUART_(); // Refresh UART if needed
+    if (routeUSB(kMsgNote)) {
+        const uint8_t msg[3] = { static_cast<uint8_t>(0x80 | ((note_channel_ - 1) & 0x0F)),
+                                 note_number, velocity };
+        writeUSB(msg, sizeof(msg));
+    }
 
-    while(!Serial2) { delay(1); } // Wait for Serial2
-    MIDI.sendNoteOff(note_number, velocity, note_channel_);
-    MEMORY_BARRIER();
+    if (routeDIN(kMsgNote)) {
+        RefreshUART_(); // Refresh UART if needed
+
+        while(!Serial2) { delay(1); } // Wait for Serial2
+        MIDI.sendNoteOff(note_number, velocity, note_channel_);
+        MEMORY_BARRIER();
+    }
     return true;
 }
 
 // Buffered MIDI queue implementation
+bool MIDIInOut::queueBytes(MessageClass msg_class, const uint8_t* data, size_t length) {
+    if (routeDIN(msg_class)) {
+        // Auto-flush if not enough space
+        if (queue_write_pos_ + length > MIDI_QUEUE_BUFFER_SIZE) {
+            flushQueue();
+        }
+        memcpy(midi_queue_buffer_ + queue_write_pos_, data, length);
+        queue_write_pos_ += length;
+    }
+    if (routeUSB(msg_class)) {
+        if (usb_queue_write_pos_ + length > MIDI_QUEUE_BUFFER_SIZE) {
+            flushQueue();
+        }
+        memcpy(usb_queue_buffer_ + usb_queue_write_pos_, data, length);
+        usb_queue_write_pos_ += length;
+    }
+    return true;
+}
+
 bool MIDIInOut::queueNoteOn(uint8_t note, uint8_t velocity) {
     if (note > 127 || velocity > 127) {
         return false;
     }
 
-    // Auto-flush if not enough space
-    if (queue_write_pos_ + 3 > MIDI_QUEUE_BUFFER_SIZE) {
-        flushQueue();
-    }
-
-    midi_queue_buffer_[queue_write_pos_++] = 0x90 | ((note_channel_ - 1) & 0x0F);
-    midi_queue_buffer_[queue_write_pos_++] = note & 0x7F;
-    midi_queue_buffer_[queue_write_pos_++] = velocity & 0x7F;
-
-    return true;
+    const uint8_t msg[3] = { static_cast<uint8_t>(0x90 | ((note_channel_ - 1) & 0x0F)),
+                             static_cast<uint8_t>(note & 0x7F),
+                             static_cast<uint8_t>(velocity & 0x7F) };
+    return queueBytes(kMsgNote, msg, sizeof(msg));
 }
 
 bool MIDIInOut::queueNoteOff(uint8_t note, uint8_t velocity) {
@@ -456,41 +554,26 @@ bool MIDIInOut::queueNoteOff(uint8_t note, uint8_t velocity) {
         return false;
     }
 
-    // Auto-flush if not enough space
-    if (queue_write_pos_ + 3 > MIDI_QUEUE_BUFFER_SIZE) {
-        flushQueue();
-    }
-
-    midi_queue_buffer_[queue_write_pos_++] = 0x80 | ((note_channel_ - 1) & 0x0F);
-    midi_queue_buffer_[queue_write_pos_++] = note & 0x7F;
-    midi_queue_buffer_[queue_write_pos_++] = velocity & 0x7F;
-
-    return true;
+    const uint8_t msg[3] = { static_cast<uint8_t>(0x80 | ((note_channel_ - 1) & 0x0F)),
+                             static_cast<uint8_t>(note & 0x7F),
+                             static_cast<uint8_t>(velocity & 0x7F) };
+    return queueBytes(kMsgNote, msg, sizeof(msg));
 }
 
 
 bool MIDIInOut::queueClock() {
-    if (queue_write_pos_ + 1 > MIDI_QUEUE_BUFFER_SIZE) {
-        flushQueue();
-    }
-    midi_queue_buffer_[queue_write_pos_++] = 0xF8 ;
-    return true;
+    const uint8_t msg = 0xF8;
+    return queueBytes(kMsgClock, &msg, 1);
 }
 bool MIDIInOut::queueClockStart() {
-    if (queue_write_pos_ + 1 > MIDI_QUEUE_BUFFER_SIZE) {
-        flushQueue();
-    }
-    midi_queue_buffer_[queue_write_pos_++] = 0xFA ;
-    return true;
+    const uint8_t msg = 0xFA;
+    return queueBytes(kMsgClock, &msg, 1);
 }
 
 
 bool MIDIInOut::queueClockStop() {
-    if (queue_write_pos_ + 1 > MIDI_QUEUE_BUFFER_SIZE) {
-        flushQueue();
-    }
-    midi_queue_buffer_[queue_write_pos_++] = 0xFC ;
-    return true;
+    const uint8_t msg = 0xFC;
+    return queueBytes(kMsgClock, &msg, 1);
 }
 
 
@@ -499,21 +582,23 @@ bool MIDIInOut::queueCC(uint8_t cc_number, uint8_t value) {
         return false;
     }
 
-    // Auto-flush if not enough space
-    if (queue_write_pos_ + 3 > MIDI_QUEUE_BUFFER_SIZE) {
-        flushQueue();
-    }
-
-    midi_queue_buffer_[queue_write_pos_++] = 0xB0 | ((send_channel_ - 1) & 0x0F);
-    midi_queue_buffer_[queue_write_pos_++] = cc_number & 0x7F;
-    midi_queue_buffer_[queue_write_pos_++] = value & 0x7F;
-
-    return true;
+    const uint8_t msg[3] = { static_cast<uint8_t>(0xB0 | ((send_channel_ - 1) & 0x0F)),
+                             static_cast<uint8_t>(cc_number & 0x7F),
+                             static_cast<uint8_t>(value & 0x7F) };
+    return queueBytes(kMsgCC, msg, sizeof(msg));
 }
 
 size_t MIDIInOut::flushQueue() {
+    size_t bytes_sent = 0;
+
+    if (usb_queue_write_pos_ > 0) {
+        writeUSB(usb_queue_buffer_, usb_queue_write_pos_);
+        bytes_sent += usb_queue_write_pos_;
+        usb_queue_write_pos_ = 0;
+    }
+
     if (queue_write_pos_ == 0) {
-        return 0;  // Nothing to send
+        return bytes_sent;  // Nothing to send on DIN
     }
 
     size_t bytes_to_send = queue_write_pos_;
@@ -534,7 +619,7 @@ size_t MIDIInOut::flushQueue() {
     // Reset queue position
     queue_write_pos_ = 0;
 
-    return bytes_to_send;
+    return bytes_sent + bytes_to_send;
 }
 
 // DMA Implementation
@@ -611,10 +696,11 @@ void MIDIInOut::waitForDMA() {
 
 void MIDIInOut::sendRawBytes(const uint8_t* data, size_t length) {
     if (length == 0) return;
-    if (tx_dma_channel_ >= 0) {
-        sendViaDMA(data, length);
-    } else {
-        Serial2.write(data, length);
+    if (routeUSB(kMsgRaw)) {
+        writeUSB(data, length);
+    }
+    if (routeDIN(kMsgRaw)) {
+        writeDIN(data, length);
     }
 }
 
@@ -666,7 +752,7 @@ void MIDIInOut::processRxBuffer() {
         uint8_t byte = rx_dma_buffer_[rx_read_pos_];
         rx_read_pos_ = (rx_read_pos_ + 1) & (RX_BUFFER_SIZE - 1);
 
-        processMidiByte(byte);
+        processMidiByte(din_parser_, byte);
     }
 }
 
@@ -707,79 +793,31 @@ void MIDIInOut::updateTempoEstimate() {
     midiClockTS = now;
 }
 
-void MIDIInOut::processMidiByte(uint8_t byte) {
-    // Check if this is a status byte
-    if (byte & 0x80) {
-        // System Real-Time messages (single byte, can interrupt other messages)
-        if (byte == 0xF8) {
-            updateTempoEstimate();
-            return;
-        }
-        if (byte == 0xFA) {
-            if (transport_callback_) {
-                transport_callback_(true);  // Start
-            }
-            return;
-        }  
-        if (byte == 0xFC) {
-            if (transport_callback_) {
-                transport_callback_(false);  // Stop
-            }
-            return;
-        }
-
-        // System Common messages or Channel Voice messages
-        parser_status_ = byte;
-        parser_index_ = 0;
-
-        // Determine expected data bytes
-        uint8_t msg_type = byte & 0xF0;
+void MIDIInOut::processMidiByte(MIDIParser &parser, uint8_t byte) {
+    MIDIMessage msg;
 
-        if (msg_type == 0xF0) {
-            // System messages - ignore SysEx for this implementation
-            if (byte == 0xF0) {
-                parser_state_ = 0xFF;  // Ignore until 0xF7
+    switch (parser.Process(byte, msg)) {
+        case MIDIParser::kRealtime:
+            // System Real-Time messages are handled immediately
+            if (msg.type == 0xF8) {
+                updateTempoEstimate();
+            } else if (msg.type == 0xFA) {
+                if (transport_callback_) {
+                    transport_callback_(true);  // Start
+                }
+            } else if (msg.type == 0xFC) {
+                if (transport_callback_) {
+                    transport_callback_(false);  // Stop
+                }
             }
-            return;
-        }
+            break;
 
-        // Channel voice message
-        running_status_ = parser_status_;
+        case MIDIParser::kChannel:
+            queueMessage(msg.type, msg.channel, msg.data1, msg.data2);
+            break;
 
-    } else if (parser_status_ == 0 && running_status_ != 0) {
-        // Use running status
-        parser_status_ = running_status_;
-        parser_index_ = 0;
-    }
-
-    // Ignore if in SysEx ignore mode
-    if (parser_state_ == 0xFF) {
-        if (byte == 0xF7) parser_state_ = 0;
-        return;
-    }
-
-    // Process data bytes
-    if (!(byte & 0x80) && parser_status_ != 0) {
-        uint8_t msg_type = parser_status_ & 0xF0;
-
-        // Determine how many data bytes we need
-        uint8_t expected_bytes = 2;
-        if (msg_type == 0xC0 || msg_type == 0xD0) {  // Program Change or Channel Aftertouch
-            expected_bytes = 1;
-        }
-
-        parser_data_[parser_index_++] = byte;
-
-        if (parser_index_ >= expected_bytes) {
-            // Complete message received - queue it
-            uint8_t channel = (parser_status_ & 0x0F) + 1;  // 1-16
-            uint8_t data2 = (expected_bytes > 1) ? parser_data_[1] : 0;
-
-            queueMessage(msg_type, channel, parser_data_[0], data2);
-
-            // Reset for next message (but keep running status)
-            parser_index_ = 0;
-        }
+        default:
+            break;
     }
 }
 
@@ -9,6 +9,8 @@
 #include <span>
 #include "hardware/dma.h"
 #include "hardware/uart.h"
+#include "MIDIParser.hpp"
+#include "MIDITransport.hpp"
 
 //#define MIDI_USB_CLIENT
 
@@ -17,6 +19,27 @@
 class MIDIInOut
 {
 public:
+    /**
+     * @brief Message classes that can be routed independently.
+     */
+    enum MessageClass : uint8_t {
+        kMsgNote = 0,   ///< Note on/off
+        kMsgCC,         ///< Control change, incl. SendParamsAsMIDICC()
+        kMsgClock,      ///< Clock, start, stop
+        kMsgRaw,        ///< sendRawBytes() (SysEx etc.)
+        kNumMessageClasses
+    };
+
+    /**
+     * @brief Output port bitmask.
+     */
+    enum Route : uint8_t {
+        kRouteNone = 0,
+        kRouteDIN = 1 << 0,
+        kRouteUSB = 1 << 1,
+        kRouteBoth = kRouteDIN | kRouteUSB
+    };
+
     /**
      * @brief Constructor (only instantiates memory and member variables).     *
      */
@@ -264,6 +287,33 @@ public:
 
     size_t getParamCount() const { return n_outputs_; }
 
+    /**
+     * @brief Attach a second, byte-stream MIDI port (USB-MIDI or a loopback
+     * transport for testing). Input is parsed alongside DIN in Poll(),
+     * output follows the routing table.
+     * When built with MIDI_USB_CLIENT the TinyUSB port is attached by default.
+     *
+     * @param transport Transport to attach, or nullptr to detach.
+     */
+    void SetUSBTransport(std::shared_ptr<MIDITransport> transport) { usb_transport_ = transport; }
+
+    /**
+     * @brief Choose which port(s) a class of outgoing messages is sent to.
+     * Default is kRouteBoth; USB output is skipped while no transport is attached.
+     *
+     * @param msg_class Class of message.
+     * @param route Bitmask of Route values.
+     */
+    void SetRoute(MessageClass msg_class, uint8_t route) {
+        if (msg_class < kNumMessageClasses) {
+            routes_[msg_class] = route & kRouteBoth;
+        }
+    }
+
+    uint8_t GetRoute(MessageClass msg_class) const {
+        return msg_class < kNumMessageClasses ? routes_[msg_class] : kRouteNone;
+    }
+
 protected:
     std::vector<uint8_t> cc_numbers_;
     size_t n_outputs_;
@@ -303,20 +353,16 @@ private:
     uint8_t rx_dma_buffer_[RX_BUFFER_SIZE] __attribute__((aligned(RX_BUFFER_SIZE)));
     uint32_t rx_read_pos_;
 
-    // MIDI parser state
-    uint8_t parser_state_;
-    uint8_t parser_status_;
-    uint8_t parser_data_[2];
-    uint8_t parser_index_;
-    uint8_t running_status_;
+    // MIDI parser state (one per input port)
+    MIDIParser din_parser_;
+    MIDIParser usb_parser_;
+
+    // USB / virtual port and output routing
+    std::shared_ptr<MIDITransport> usb_transport_;
+    uint8_t routes_[kNumMessageClasses];
 
     // Message buffering for rate limiting
-    struct MIDIMessage {
-        uint8_t type;
-        uint8_t channel;
-        uint8_t data1;
-        uint8_t data2;
-    };
+    using MIDIMessage = MIDIParser::Message;
     static constexpr size_t MSG_QUEUE_SIZE = 64;
     MIDIMessage msg_queue_[MSG_QUEUE_SIZE];
     volatile uint32_t msg_write_pos_;
@@ -337,7 +383,8 @@ private:
     // RX processing
     uint32_t getRxWritePos();
     void processRxBuffer();
-    void processMidiByte(uint8_t byte);
+    void processMidiByte(MIDIParser &parser, uint8_t byte);
+    void processUSBInput();
     void queueMessage(uint8_t type, uint8_t channel, uint8_t data1, uint8_t data2);
     void processQueuedMessages();
 
@@ -347,10 +394,21 @@ private:
         return static_cast<uint8_t>(clamped * mapping.scale_factor + mapping.min_value + 0.5f);
     }
 
-    // Buffered MIDI queue support
+    // Port output helpers
+    inline bool routeDIN(MessageClass msg_class) const { return routes_[msg_class] & kRouteDIN; }
+    inline bool routeUSB(MessageClass msg_class) const {
+        return (routes_[msg_class] & kRouteUSB) && usb_transport_;
+    }
+    void writeDIN(const uint8_t* data, size_t length);
+    void writeUSB(const uint8_t* data, size_t length);
+
+    // Buffered MIDI queue support (one queue per port, shared flush)
     static constexpr size_t MIDI_QUEUE_BUFFER_SIZE = 1024;
     uint8_t midi_queue_buffer_[MIDI_QUEUE_BUFFER_SIZE];
     size_t queue_write_pos_;  // No volatile needed - single-threaded user code only
+    uint8_t usb_queue_buffer_[MIDI_QUEUE_BUFFER_SIZE];
+    size_t usb_queue_write_pos_;
+    bool queueBytes(MessageClass msg_class, const uint8_t* data, size_t length);
 };
 
 #endif  // __MIDI_IN_OUT_HPP__
@@ -0,0 +1,111 @@
+#ifndef __MIDI_PARSER_HPP__
+#define __MIDI_PARSER_HPP__
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Byte-stream MIDI 1.0 parser, shared by every MIDI transport.
+ *
+ * Has no hardware dependencies so that the same code parses DIN, USB and
+ * loopback streams. Each transport owns its own parser instance, so running
+ * status on one port can never be corrupted by bytes arriving on another.
+ */
+class MIDIParser
+{
+public:
+    /**
+     * @brief A decoded channel voice or system real-time message.
+     * For channel messages type is the status nibble (0x80 .. 0xE0) and
+     * channel is 1-16. For real-time messages type is the status byte itself.
+     */
+    struct Message {
+        uint8_t type;
+        uint8_t channel;
+        uint8_t data1;
+        uint8_t data2;
+    };
+
+    enum Result : uint8_t {
+        kNone = 0,      ///< Byte consumed, no message complete
+        kChannel,       ///< Complete channel voice message in msg
+        kRealtime       ///< Single byte real-time message (clock, start, stop...) in msg.type
+    };
+
+    MIDIParser() { Reset(); }
+
+    /**
+     * @brief Drop any partial message and running status.
+     */
+    inline void Reset() {
+        status_ = 0;
+        index_ = 0;
+        in_sysex_ = false;
+        data_[0] = data_[1] = 0;
+    }
+
+    /**
+     * @brief Feed one byte from the wire.
+     *
+     * @param byte Incoming byte.
+     * @param msg Filled in when the return value is not kNone.
+     * @return Result describing what, if anything, was completed.
+     */
+    inline Result Process(uint8_t byte, Message &msg) {
+        if (byte & 0x80) {
+            // System Real-Time can interrupt anything, including SysEx
+            if (byte >= 0xF8) {
+                msg.type = byte;
+                msg.channel = 0;
+                msg.data1 = 0;
+                msg.data2 = 0;
+                return kRealtime;
+            }
+            if (byte == 0xF0) {
+                // SysEx - ignored until 0xF7
+                in_sysex_ = true;
+                status_ = 0;
+                return kNone;
+            }
+            if (byte >= 0xF1) {
+                // System Common (incl. 0xF7) cancels running status
+                in_sysex_ = false;
+                status_ = 0;
+                return kNone;
+            }
+            in_sysex_ = false;
+            status_ = byte;
+            index_ = 0;
+            return kNone;
+        }
+
+        if (in_sysex_ || status_ == 0) {
+            return kNone;
+        }
+
+        const uint8_t msg_type = status_ & 0xF0;
+        // Program Change and Channel Aftertouch carry a single data byte
+        const uint8_t expected_bytes = (msg_type == 0xC0 || msg_type == 0xD0) ? 1 : 2;
+
+        data_[index_++] = byte;
+        if (index_ < expected_bytes) {
+            return kNone;
+        }
+
+        // Complete message - keep status_ for running status
+        index_ = 0;
+        msg.type = msg_type;
+        msg.channel = (status_ & 0x0F) + 1;  // 1-16
+        msg.data1 = data_[0];
+        msg.data2 = (expected_bytes > 1) ? data_[1] : 0;
+        return kChannel;
+    }
+
+protected:
+    uint8_t status_;
+    uint8_t data_[2];
+    uint8_t index_;
+    bool in_sysex_;
+};
+
+#endif  // __MIDI_PARSER_HPP__
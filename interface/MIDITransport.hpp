@@ -0,0 +1,122 @@
+#ifndef __MIDI_TRANSPORT_HPP__
+#define __MIDI_TRANSPORT_HPP__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <span>
+
+/**
+ * @brief Byte-stream MIDI transport used by MIDIInOut for non-DIN ports.
+ *
+ * DIN MIDI stays on Serial2 with its own DMA path inside MIDIInOut; anything
+ * else (USB-MIDI, virtual ports) implements this interface. Parsing and
+ * output queueing are done by MIDIInOut, so a transport only moves bytes.
+ */
+class MIDITransport
+{
+public:
+    virtual ~MIDITransport() = default;
+
+    /**
+     * @brief Bring up the port. Called from MIDIInOut::Setup().
+     * @return true if the transport is usable.
+     */
+    virtual bool Begin() { return true; }
+
+    /**
+     * @brief Non-blocking read.
+     *
+     * @param dst Destination buffer.
+     * @param max_bytes Maximum number of bytes to read.
+     * @return Number of bytes actually read.
+     */
+    virtual size_t Read(uint8_t *dst, size_t max_bytes) = 0;
+
+    /**
+     * @brief Write a block of complete MIDI messages.
+     * @return Number of bytes accepted.
+     */
+    virtual size_t Write(const uint8_t *src, size_t n_bytes) = 0;
+
+    /**
+     * @brief Whether a host is currently attached.
+     */
+    virtual bool Connected() { return true; }
+};
+
+
+/**
+ * @brief Virtual transport that replays a byte stream and captures output.
+ *
+ * Used for host-side testing and benchmarking of the MIDI parser and output
+ * scheduling: Replay() queues bytes to be returned by Read(), and everything
+ * passed to Write() is recorded (and optionally echoed back to the input).
+ */
+class LoopbackMIDITransport : public MIDITransport
+{
+public:
+    LoopbackMIDITransport(bool echo = false) : echo_(echo), rx_pos_(0),
+        bytes_read_(0), bytes_written_(0) {}
+
+    /**
+     * @brief Append bytes to the stream returned by Read().
+     */
+    void Replay(std::span<const uint8_t> bytes) {
+        Compact_();
+        rx_.insert(rx_.end(), bytes.begin(), bytes.end());
+    }
+
+    /**
+     * @brief Route written bytes straight back to the input.
+     */
+    void SetEcho(bool echo) { echo_ = echo; }
+
+    size_t Read(uint8_t *dst, size_t max_bytes) override {
+        size_t n = rx_.size() - rx_pos_;
+        if (n > max_bytes) n = max_bytes;
+        if (n > 0) {
+            std::memcpy(dst, rx_.data() + rx_pos_, n);
+            rx_pos_ += n;
+            bytes_read_ += n;
+        }
+        return n;
+    }
+
+    size_t Write(const uint8_t *src, size_t n_bytes) override {
+        tx_.insert(tx_.end(), src, src + n_bytes);
+        bytes_written_ += n_bytes;
+        if (echo_) {
+            Replay(std::span<const uint8_t>(src, n_bytes));
+        }
+        return n_bytes;
+    }
+
+    /**
+     * @brief Bytes written so far (since the last ClearWritten()).
+     */
+    const std::vector<uint8_t>& GetWritten() const { return tx_; }
+    void ClearWritten() { tx_.clear(); }
+
+    size_t Pending() const { return rx_.size() - rx_pos_; }
+    size_t GetBytesRead() const { return bytes_read_; }
+    size_t GetBytesWritten() const { return bytes_written_; }
+
+protected:
+    void Compact_() {
+        if (rx_pos_ > 0 && rx_pos_ == rx_.size()) {
+            rx_.clear();
+            rx_pos_ = 0;
+        }
+    }
+
+    bool echo_;
+    std::vector<uint8_t> rx_;
+    std::vector<uint8_t> tx_;
+    size_t rx_pos_;
+    size_t bytes_read_;
+    size_t bytes_written_;
+};
+
+#endif  // __MIDI_TRANSPORT_HPP__
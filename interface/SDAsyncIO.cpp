@@ -0,0 +1,305 @@
+#include "SDAsyncIO.hpp"
+#include <cstring>
+#include <Arduino.h>
+#include "../PicoDefs.hpp"
+
+
+SDAsyncIO::SDAsyncIO() :
+    n_requests_(0),
+    n_rejected_(0),
+    n_buffer_starved_(0),
+    max_queue_depth_(0),
+    stats_{} {
+    queue_init(&requests_, sizeof(Request), kQueueDepth);
+    queue_init(&free_buffers_, sizeof(uint8_t), kNumBuffers);
+    queue_init(&free_handles_, sizeof(uint8_t), kMaxFiles);
+    queue_init(&free_completions_, sizeof(uint8_t), kQueueDepth);
+    for (uint8_t i = 0; i < kNumBuffers; i++) {
+        queue_try_add(&free_buffers_, &i);
+    }
+    for (uint8_t i = 0; i < kMaxFiles; i++) {
+        queue_try_add(&free_handles_, &i);
+        paths_[i][0] = '\0';
+    }
+    for (uint8_t i = 0; i < kQueueDepth; i++) {
+        queue_try_add(&free_completions_, &i);
+    }
+}
+
+
+int SDAsyncIO::Open(const char *path, bool truncate, Completion done) {
+    if (!path || std::strlen(path) >= kMaxPath) {
+        return -1;
+    }
+    uint8_t handle;
+    if (!queue_try_remove(&free_handles_, &handle)) {
+        DEBUG_PRINTLN("SDAsyncIO: no free file handles");
+        return -1;
+    }
+    // The servicing core reads the path only after the request is queued
+    std::strncpy(paths_[handle], path, kMaxPath);
+
+    Request r{};
+    r.op = kOpOpen;
+    r.handle = static_cast<int8_t>(handle);
+    r.truncate = truncate;
+    if (!Queue_(r, done)) {
+        queue_try_add(&free_handles_, &handle);
+        return -1;
+    }
+    return handle;
+}
+
+
+uint8_t *SDAsyncIO::AcquireBuffer() {
+    uint8_t index;
+    if (!queue_try_remove(&free_buffers_, &index)) {
+        n_buffer_starved_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return buffers_[index];
+}
+
+
+void SDAsyncIO::ReleaseBuffer(uint8_t *buffer) {
+    if (!buffer) {
+        return;
+    }
+    const uint8_t index = static_cast<uint8_t>((buffer - buffers_[0]) / kBufferBytes);
+    queue_try_add(&free_buffers_, &index);
+}
+
+
+bool SDAsyncIO::Write(int handle, uint8_t *buffer, size_t bytes, Completion done) {
+    return WriteAt(handle, UINT32_MAX, buffer, bytes, done);
+}
+
+
+bool SDAsyncIO::WriteAt(int handle, uint32_t offset, uint8_t *buffer, size_t bytes, Completion done) {
+    if (!ValidHandle_(handle) || !buffer || bytes > kBufferBytes) {
+        ReleaseBuffer(buffer);
+        return false;
+    }
+    Request r{};
+    r.op = offset == UINT32_MAX ? kOpWrite : kOpWriteAt;
+    r.handle = static_cast<int8_t>(handle);
+    r.buffer = static_cast<uint8_t>((buffer - buffers_[0]) / kBufferBytes);
+    r.offset = offset;
+    r.bytes = static_cast<uint32_t>(bytes);
+    if (!Queue_(r, done)) {
+        ReleaseBuffer(buffer);
+        return false;
+    }
+    return true;
+}
+
+
+bool SDAsyncIO::Close(int handle, Completion done) {
+    if (!ValidHandle_(handle)) {
+        return false;
+    }
+    Request r{};
+    r.op = kOpClose;
+    r.handle = static_cast<int8_t>(handle);
+    return Queue_(r, done);
+}
+
+
+bool SDAsyncIO::WriteFile(const char *path, const uint8_t *data, size_t bytes, Completion done) {
+    if (!path || std::strlen(path) >= kMaxPath || (!data && bytes)) {
+        return false;
+    }
+    WholeFile *file = new WholeFile;
+    std::strncpy(file->path, path, kMaxPath);
+    file->data.assign(data, data + bytes);
+    file->out = nullptr;
+
+    Request r{};
+    r.op = kOpWriteFile;
+    r.handle = -1;
+    r.bytes = static_cast<uint32_t>(bytes);
+    r.file = file;
+    if (!Queue_(r, done)) {
+        delete file;
+        return false;
+    }
+    return true;
+}
+
+
+bool SDAsyncIO::ReadFile(const char *path, std::vector<uint8_t> *out, Completion done) {
+    if (!path || std::strlen(path) >= kMaxPath || !out) {
+        return false;
+    }
+    WholeFile *file = new WholeFile;
+    std::strncpy(file->path, path, kMaxPath);
+    file->out = out;
+
+    Request r{};
+    r.op = kOpReadFile;
+    r.handle = -1;
+    r.file = file;
+    if (!Queue_(r, done)) {
+        delete file;
+        return false;
+    }
+    return true;
+}
+
+
+size_t SDAsyncIO::Service(uint32_t budget_us) {
+    const uint32_t start = micros();
+    size_t n = 0;
+    Request r;
+    while (queue_try_remove(&requests_, &r)) {
+        const uint32_t t0 = micros();
+        Perform_(r);
+        const uint32_t elapsed = micros() - t0;
+        if (elapsed > stats_.max_request_us) {
+            stats_.max_request_us = elapsed;
+        }
+        n++;
+        if (budget_us && micros() - start >= budget_us) {
+            break;
+        }
+    }
+    return n;
+}
+
+
+bool SDAsyncIO::Queue_(Request &r, Completion &done) {
+    r.completion = kNoCompletion;
+    if (done) {
+        uint8_t slot;
+        if (!queue_try_remove(&free_completions_, &slot)) {
+            n_rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        completions_[slot] = std::move(done);
+        r.completion = slot;
+    }
+    if (!queue_try_add(&requests_, &r)) {
+        if (r.completion != kNoCompletion) {
+            completions_[r.completion] = nullptr;
+            queue_try_add(&free_completions_, &r.completion);
+        }
+        n_rejected_.fetch_add(1, std::memory_order_relaxed);
+        DEBUG_PRINTLN("SDAsyncIO: request queue full");
+        return false;
+    }
+    n_requests_.fetch_add(1, std::memory_order_relaxed);
+    const uint32_t depth = queue_get_level(&requests_);
+    uint32_t peak = max_queue_depth_.load(std::memory_order_relaxed);
+    while (depth > peak && !max_queue_depth_.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {
+    }
+    return true;
+}
+
+
+void SDAsyncIO::Perform_(const Request &r) {
+    bool ok = false;
+    size_t bytes = 0;
+
+    switch (r.op) {
+        case kOpOpen: {
+            File &f = files_[r.handle];
+            // Not FILE_WRITE: its O_APPEND sends every write to the end of
+            // the file, so WriteAt could never patch a header
+            f = SD.open(paths_[r.handle], O_RDWR | O_CREAT | (r.truncate ? O_TRUNC : 0));
+            ok = static_cast<bool>(f);
+            if (!ok) {
+                DEBUG_PRINTF("SDAsyncIO: failed to open %s\n", paths_[r.handle]);
+            } else if (!r.truncate) {
+                ok = f.seek(f.size());
+            }
+            break;
+        }
+
+        case kOpWrite:
+        case kOpWriteAt: {
+            File &f = files_[r.handle];
+            if (f) {
+                ok = true;
+                size_t end = 0;
+                if (r.op == kOpWriteAt) {
+                    end = f.position();
+                    ok = f.seek(r.offset);
+                }
+                if (ok) {
+                    bytes = f.write(buffers_[r.buffer], r.bytes);
+                    ok = bytes == r.bytes;
+                    stats_.bytes_written += bytes;
+                }
+                if (r.op == kOpWriteAt) {
+                    // Patching (e.g. a header) must not move the append point
+                    f.seek(end);
+                }
+            }
+            queue_try_add(&free_buffers_, &r.buffer);
+            break;
+        }
+
+        case kOpClose: {
+            File &f = files_[r.handle];
+            ok = static_cast<bool>(f);
+            if (ok) {
+                f.flush();
+                f.close();
+            }
+            f = File();
+            paths_[r.handle][0] = '\0';
+            const uint8_t handle = static_cast<uint8_t>(r.handle);
+            queue_try_add(&free_handles_, &handle);
+            break;
+        }
+
+        case kOpWriteFile: {
+            if (SD.exists(r.file->path)) {
+                SD.remove(r.file->path);
+            }
+            File f = SD.open(r.file->path, FILE_WRITE);
+            if (f) {
+                bytes = f.write(r.file->data.data(), r.file->data.size());
+                ok = bytes == r.file->data.size();
+                stats_.bytes_written += bytes;
+                f.close();
+            }
+            delete r.file;
+            break;
+        }
+
+        case kOpReadFile: {
+            File f = SD.open(r.file->path, FILE_READ);
+            if (f) {
+                std::vector<uint8_t> &out = *r.file->out;
+                out.resize(f.size());
+                bytes = f.read(out.data(), out.size());
+                ok = bytes == out.size();
+                stats_.bytes_read += bytes;
+                f.close();
+            }
+            delete r.file;
+            break;
+        }
+    }
+
+    Finish_(r, ok, bytes);
+}
+
+
+void SDAsyncIO::Finish_(const Request &r, bool ok, size_t bytes) {
+    stats_.completed++;
+    if (!ok) {
+        stats_.errors++;
+    }
+    if (r.completion == kNoCompletion) {
+        return;
+    }
+    Completion done = std::move(completions_[r.completion]);
+    completions_[r.completion] = nullptr;
+    const uint8_t slot = r.completion;
+    queue_try_add(&free_completions_, &slot);
+    if (done) {
+        done(ok, bytes);
+    }
+}
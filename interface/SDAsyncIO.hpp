@@ -0,0 +1,184 @@
+#ifndef __SD_ASYNC_IO_HPP__
+#define __SD_ASYNC_IO_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "pico/util/queue.h"
+#include "SD.h"
+
+
+/**
+ * @brief Write-behind request queue in front of the SD card.
+ *
+ * Callers on any core queue requests and return immediately; Service(),
+ * called from the main loop of the core that does not run audio, performs
+ * them on the card and then runs the completion callbacks (on that core).
+ *
+ * Streaming writes use preallocated, sector-aligned buffers from a pool:
+ * AcquireBuffer(), fill, Write() (which hands the buffer back to the pool
+ * once written). Whole-file writes and reads copy into heap memory instead,
+ * so they don't compete with streams for pool buffers.
+ *
+ * The SD card must be started (MEMLNaut::startSD()) while requests run.
+ */
+class SDAsyncIO
+{
+public:
+    static constexpr size_t kBufferBytes = 4096;    ///< Multiple of the 512-byte sector
+    static constexpr size_t kNumBuffers = 8;
+    static constexpr size_t kMaxFiles = 4;
+    static constexpr size_t kQueueDepth = 32;
+    static constexpr size_t kMaxPath = 64;
+
+    static_assert(kBufferBytes % 512 == 0, "Buffers must be whole sectors");
+
+    /**
+     * @brief Runs on the servicing core when a request has been carried out.
+     * @param ok Whether the operation succeeded.
+     * @param bytes Bytes written or read.
+     */
+    using Completion = std::function<void(bool ok, size_t bytes)>;
+
+    struct Stats {
+        uint32_t requests;
+        uint32_t completed;
+        uint32_t errors;
+        uint32_t rejected;          ///< Queue or completion table full
+        uint32_t buffer_starved;    ///< AcquireBuffer() found the pool empty
+        uint32_t max_queue_depth;
+        uint32_t max_request_us;    ///< Longest single card operation
+        uint64_t bytes_written;
+        uint64_t bytes_read;
+    };
+
+    SDAsyncIO();
+
+    /**
+     * @brief Open a file for streaming writes.
+     *
+     * @param truncate Start from an empty file (otherwise append).
+     * @return Handle for Write/WriteAt/Close, or -1 if all handles are in use.
+     */
+    int Open(const char *path, bool truncate = true, Completion done = nullptr);
+
+    /**
+     * @brief Take a kBufferBytes buffer from the pool.
+     * @return nullptr if all buffers are queued.
+     */
+    uint8_t *AcquireBuffer();
+
+    /**
+     * @brief Return an acquired buffer without writing it.
+     */
+    void ReleaseBuffer(uint8_t *buffer);
+
+    /**
+     * @brief Append a pool buffer to an open file. The buffer goes back to
+     * the pool after the write, whether or not this returns true.
+     */
+    bool Write(int handle, uint8_t *buffer, size_t bytes, Completion done = nullptr);
+
+    /**
+     * @brief Write a pool buffer at a byte offset (e.g. to patch a header).
+     */
+    bool WriteAt(int handle, uint32_t offset, uint8_t *buffer, size_t bytes, Completion done = nullptr);
+
+    /**
+     * @brief Flush and close a handle once its queued writes are done.
+     */
+    bool Close(int handle, Completion done = nullptr);
+
+    /**
+     * @brief Write a whole file (data is copied).
+     */
+    bool WriteFile(const char *path, const uint8_t *data, size_t bytes, Completion done = nullptr);
+
+    /**
+     * @brief Read a whole file into *out (which must outlive the request).
+     */
+    bool ReadFile(const char *path, std::vector<uint8_t> *out, Completion done = nullptr);
+
+    /**
+     * @brief Carry out queued requests.
+     *
+     * @param budget_us Stop after this long (0 = until the queue is empty).
+     * The request in progress always completes.
+     * @return Number of requests performed.
+     */
+    size_t Service(uint32_t budget_us = 0);
+
+    /**
+     * @brief No requests waiting.
+     */
+    bool Idle() { return queue_is_empty(&requests_); }
+
+    /**
+     * @brief Counters so far. The request-side counts are atomic; the
+     * card-side ones (completed onwards) are exact on the servicing core.
+     */
+    Stats GetStats() const {
+        Stats s = stats_;
+        s.requests = n_requests_.load(std::memory_order_relaxed);
+        s.rejected = n_rejected_.load(std::memory_order_relaxed);
+        s.buffer_starved = n_buffer_starved_.load(std::memory_order_relaxed);
+        s.max_queue_depth = max_queue_depth_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+protected:
+    enum Op : uint8_t {
+        kOpOpen,
+        kOpWrite,
+        kOpWriteAt,
+        kOpClose,
+        kOpWriteFile,
+        kOpReadFile
+    };
+
+    static constexpr uint8_t kNoCompletion = 0xFF;
+
+    struct WholeFile {
+        char path[kMaxPath];
+        std::vector<uint8_t> data;      ///< Copy of the data to write
+        std::vector<uint8_t> *out;      ///< Read target
+    };
+
+    struct Request {
+        Op op;
+        int8_t handle;
+        uint8_t buffer;         ///< Pool index for kOpWrite/kOpWriteAt
+        uint8_t completion;     ///< Completion slot or kNoCompletion
+        uint32_t offset;
+        uint32_t bytes;
+        WholeFile *file;        ///< Whole-file ops only, freed on completion
+        bool truncate;
+    };
+
+    alignas(512) uint8_t buffers_[kNumBuffers][kBufferBytes];
+    File files_[kMaxFiles];
+    char paths_[kMaxFiles][kMaxPath];
+    Completion completions_[kQueueDepth];
+
+    queue_t requests_;
+    queue_t free_buffers_;
+    queue_t free_handles_;
+    queue_t free_completions_;
+
+    // Requests arrive from either core, so their counters are atomic;
+    // stats_ holds the rest and is written by the servicing core only
+    std::atomic<uint32_t> n_requests_;
+    std::atomic<uint32_t> n_rejected_;
+    std::atomic<uint32_t> n_buffer_starved_;
+    std::atomic<uint32_t> max_queue_depth_;
+    Stats stats_;
+
+    bool Queue_(Request &r, Completion &done);
+    void Perform_(const Request &r);
+    void Finish_(const Request &r, bool ok, size_t bytes);
+    inline bool ValidHandle_(int handle) const { return handle >= 0 && handle < static_cast<int>(kMaxFiles); }
+};
+
+#endif  // __SD_ASYNC_IO_HPP__
@@ -90,3 +90,34 @@ bool SDCard::Touch(const char* filename) {
     file.close();
     return true;
 }
+
+int SDCard::Open(const char* path) {
+    if (!cardPresent_) return -1;
+    for (size_t i = 0; i < kMaxOpenFiles; i++) {
+        if (!files_[i].isOpen()) {
+            files_[i] = sd_.open(path, O_RDONLY);
+            return files_[i].isOpen() ? static_cast<int>(i) : -1;
+        }
+    }
+    return -1;
+}
+
+void SDCard::Close(int handle) {
+    if (handle >= 0 && handle < static_cast<int>(kMaxOpenFiles)) {
+        files_[handle].close();
+    }
+}
+
+uint32_t SDCard::Size(int handle) {
+    if (handle < 0 || handle >= static_cast<int>(kMaxOpenFiles) || !files_[handle].isOpen()) return 0;
+    return static_cast<uint32_t>(files_[handle].fileSize());
+}
+
+size_t SDCard::ReadAt(int handle, uint32_t offset, void* dst, size_t bytes) {
+    if (handle < 0 || handle >= static_cast<int>(kMaxOpenFiles) || !files_[handle].isOpen()) return 0;
+    FsFile& file = files_[handle];
+    // Sequential reads (the common streaming case) skip the seek
+    if (file.curPosition() != offset && !file.seekSet(offset)) return 0;
+    const int n = file.read(dst, bytes);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
@@ -7,11 +7,14 @@
 #include <functional>
 #include <cstdint>
 #include "../hardware/memlnaut/Pins.hpp"
+#include "FileSource.hpp"
 #include "SdFat.h"
 
 
-class SDCard {
+class SDCard : public FileSource {
 public:
+    static constexpr size_t kMaxOpenFiles = 16;  ///< Files open for streaming at once
+
     using CardEventCallback = std::function<void(bool)>;  // Callback type for card events (inserted/removed)
 
     enum class CardType {
@@ -108,6 +111,13 @@ public:
      */
     void Poll();
 
+    // FileSource, for streaming readers (e.g. SDSampler)
+
+    int Open(const char* path) override;
+    void Close(int handle) override;
+    uint32_t Size(int handle) override;
+    size_t ReadAt(int handle, uint32_t offset, void* dst, size_t bytes) override;
+
 private:
     const int miso_;
     const int mosi_;
@@ -117,6 +127,7 @@ private:
     CardEventCallback cardEventCb_;
     mutable SdFs sd_;  // Make sd_ mutable to allow vol() calls in const methods
     FatFile root_;
+    FsFile files_[kMaxOpenFiles];
 };
 
 #endif  // __SD_CARD_HPP__
@@ -0,0 +1,283 @@
+#ifndef __SENSOR_PROTOCOL_V2_HPP__
+#define __SENSOR_PROTOCOL_V2_HPP__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <span>
+#include "../utils/CRC16.hpp"
+
+/**
+ * @brief MEML Sensor Board protocol v2.
+ *
+ * v1 frames are a bare array of floats, one per channel, with no timing.
+ * v2 frames carry several samples of up to 32 channels with the device
+ * timestamp, so one SLIP frame (and one callback) covers a whole batch.
+ *
+ * Frame payload (inside SLIP framing), little endian:
+ *
+ *     [0]       kMagic
+ *     [1]       sample format (kFloat32 or kInt16)
+ *     [2..5]    device timestamp of the first sample, microseconds
+ *     [6..9]    channel mask, bit n set = channel n present
+ *     [10..11]  sample period, microseconds
+ *     [12]      samples per channel in this frame
+ *     [13..]    samples, interleaved: sample 0 of every present channel
+ *               in ascending channel order, then sample 1, ...
+ *     [last 2]  CRC-16/CCITT-FALSE over all preceding bytes
+ *
+ * int16 samples are normalised to [-1, 1) by 1/32768.
+ * At 32 channels x 1 kHz x int16 the stream is ~70 kB/s, so the link needs
+ * to run at 1 Mbaud or more.
+ */
+namespace SensorProtocolV2 {
+
+constexpr uint8_t kMagic = 0xB2;
+constexpr size_t kMaxChannels = 32;
+constexpr size_t kHeaderBytes = 13;
+constexpr size_t kCRCBytes = 2;
+constexpr size_t kMaxValues = 512;  ///< Channels x samples per frame
+/// Largest payload, a full float32 frame
+constexpr size_t kMaxFrameBytes = kHeaderBytes + kMaxValues * sizeof(float) + kCRCBytes;
+
+enum SampleFormat : uint8_t {
+    kFloat32 = 0,
+    kInt16 = 1
+};
+
+/**
+ * @brief A decoded batch of readings.
+ * samples holds n_samples rows of n_channels values; row r belongs to
+ * device time timestamp_us + r * sample_period_us.
+ */
+struct Frame {
+    uint32_t timestamp_us;
+    uint32_t channel_mask;
+    uint16_t sample_period_us;
+    uint8_t n_channels;
+    uint8_t n_samples;
+    std::span<const float> samples;
+
+    /**
+     * @brief Channel number of column `column` (the column-th set bit in the mask).
+     * @return kMaxChannels if column >= n_channels.
+     */
+    inline size_t Channel(size_t column) const {
+        uint32_t mask = channel_mask;
+        for (size_t i = 0; i < column && mask; i++) {
+            mask &= mask - 1;
+        }
+        return mask ? static_cast<size_t>(__builtin_ctz(mask)) : kMaxChannels;
+    }
+};
+
+inline uint32_t ReadU32_(const uint8_t *p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline void WriteU32_(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+/**
+ * @brief Check whether a SLIP payload looks like a v2 frame.
+ */
+inline bool IsV2(std::span<const uint8_t> payload) {
+    return payload.size() >= kHeaderBytes + kCRCBytes && payload[0] == kMagic;
+}
+
+/**
+ * @brief Validate and decode a v2 frame payload.
+ *
+ * @param payload SLIP frame payload, including the CRC trailer.
+ * @param frame Filled in on success; frame.samples points into values.
+ * @param values Caller's array of at least kMaxValues floats.
+ * @return true if the frame is well formed and the CRC matches.
+ */
+inline bool Parse(std::span<const uint8_t> payload, Frame &frame, float *values) {
+    if (!IsV2(payload)) {
+        return false;
+    }
+    const uint8_t *p = payload.data();
+    const size_t body = payload.size() - kCRCBytes;
+    const uint16_t rx_crc = static_cast<uint16_t>(p[body] | (p[body + 1] << 8));
+    if (CRC16::compute(p, body) != rx_crc) {
+        return false;
+    }
+
+    const uint8_t format = p[1];
+    frame.timestamp_us = ReadU32_(p + 2);
+    frame.channel_mask = ReadU32_(p + 6);
+    frame.sample_period_us = static_cast<uint16_t>(p[10] | (p[11] << 8));
+    frame.n_samples = p[12];
+    frame.n_channels = static_cast<uint8_t>(__builtin_popcount(frame.channel_mask));
+
+    const size_t n_values = static_cast<size_t>(frame.n_channels) * frame.n_samples;
+    const size_t value_bytes = (format == kInt16) ? sizeof(int16_t) : sizeof(float);
+    if (format > kInt16 || n_values > kMaxValues ||
+        body != kHeaderBytes + n_values * value_bytes) {
+        return false;
+    }
+
+    const uint8_t *src = p + kHeaderBytes;
+    if (format == kInt16) {
+        constexpr float kScale = 1.f / 32768.f;
+        for (size_t i = 0; i < n_values; i++) {
+            int16_t v = static_cast<int16_t>(src[2 * i] | (src[2 * i + 1] << 8));
+            values[i] = static_cast<float>(v) * kScale;
+        }
+    } else {
+        std::memcpy(values, src, n_values * sizeof(float));
+    }
+
+    frame.samples = std::span<const float>(values, n_values);
+    return true;
+}
+
+/**
+ * @brief Build a v2 frame payload (with CRC, without SLIP framing).
+ *
+ * @param values Interleaved samples, n_samples x popcount(channel_mask).
+ * @param out Destination, at least kMaxFrameBytes long.
+ * @return Payload length, or 0 if the batch is too large.
+ */
+inline size_t Encode(uint32_t timestamp_us, uint32_t channel_mask, uint16_t sample_period_us,
+                     uint8_t n_samples, SampleFormat format, const float *values, uint8_t *out) {
+    const size_t n_values = static_cast<size_t>(__builtin_popcount(channel_mask)) * n_samples;
+    if (n_values > kMaxValues) {
+        return 0;
+    }
+
+    out[0] = kMagic;
+    out[1] = format;
+    WriteU32_(out + 2, timestamp_us);
+    WriteU32_(out + 6, channel_mask);
+    out[10] = sample_period_us & 0xFF;
+    out[11] = sample_period_us >> 8;
+    out[12] = n_samples;
+
+    uint8_t *dst = out + kHeaderBytes;
+    if (format == kInt16) {
+        for (size_t i = 0; i < n_values; i++) {
+            float v = values[i] * 32768.f;
+            v = v > 32767.f ? 32767.f : (v < -32768.f ? -32768.f : v);
+            int16_t q = static_cast<int16_t>(lrintf(v));
+            dst[2 * i] = static_cast<uint8_t>(q & 0xFF);
+            dst[2 * i + 1] = static_cast<uint8_t>((q >> 8) & 0xFF);
+        }
+        dst += n_values * sizeof(int16_t);
+    } else {
+        std::memcpy(dst, values, n_values * sizeof(float));
+        dst += n_values * sizeof(float);
+    }
+
+    const size_t body = static_cast<size_t>(dst - out);
+    const uint16_t crc = CRC16::compute(out, body);
+    dst[0] = crc & 0xFF;
+    dst[1] = crc >> 8;
+    return body + kCRCBytes;
+}
+
+
+/**
+ * @brief Host-side sensor board simulator.
+ *
+ * Generates a SLIP-framed v2 byte stream of synthetic signals (a sine per
+ * channel at a channel-dependent rate) so UARTInput's v2 path can be fed
+ * from a file or loopback at kHz rates without hardware. Can also inject
+ * corrupted frames to exercise the error counters.
+ */
+class StreamSimulator
+{
+public:
+    static constexpr size_t kMaxEncodedBytes = kMaxFrameBytes * 2 + 2;
+
+    StreamSimulator(uint32_t channel_mask, uint32_t sample_rate_hz,
+                    uint8_t samples_per_frame, SampleFormat format = kInt16) :
+        channel_mask_(channel_mask),
+        period_us_(static_cast<uint16_t>(1000000 / sample_rate_hz)),
+        samples_per_frame_(samples_per_frame),
+        format_(format),
+        time_us_(0),
+        n_(0),
+        corrupt_every_(0),
+        frame_count_(0) {}
+
+    /**
+     * @brief Flip one payload byte in every n-th frame (0 = never).
+     */
+    void SetCorruptEvery(size_t n) { corrupt_every_ = n; }
+
+    uint32_t GetTimeUs() const { return time_us_; }
+
+    /**
+     * @brief Produce the next SLIP-encoded frame.
+     *
+     * @param out Destination, at least kMaxEncodedBytes long.
+     * @return Number of bytes written, 0 if the batch would exceed kMaxValues.
+     */
+    size_t NextFrame(uint8_t *out) {
+        const size_t n_channels = static_cast<size_t>(__builtin_popcount(channel_mask_));
+        if (n_channels * samples_per_frame_ > kMaxValues) {
+            return 0;
+        }
+
+        float values[kMaxValues];
+        size_t k = 0;
+        for (size_t s = 0; s < samples_per_frame_; s++) {
+            const float t = static_cast<float>(n_ + s) * period_us_ * 1e-6f;
+            for (size_t ch = 0; ch < kMaxChannels; ch++) {
+                if (channel_mask_ & (1u << ch)) {
+                    values[k++] = 0.9f * sinf(6.2831853f * (1.f + ch) * t);
+                }
+            }
+        }
+
+        uint8_t payload[kMaxFrameBytes];
+        size_t len = Encode(time_us_, channel_mask_, period_us_, samples_per_frame_,
+                            format_, values, payload);
+        n_ += samples_per_frame_;
+        time_us_ += static_cast<uint32_t>(period_us_) * samples_per_frame_;
+
+        frame_count_++;
+        if (corrupt_every_ > 0 && (frame_count_ % corrupt_every_) == 0) {
+            payload[kHeaderBytes] ^= 0x5A;
+        }
+
+        // SLIP framing (double-ENDed)
+        size_t w = 0;
+        out[w++] = 192;
+        for (size_t i = 0; i < len; i++) {
+            if (payload[i] == 192) {
+                out[w++] = 219;
+                out[w++] = 220;
+            } else if (payload[i] == 219) {
+                out[w++] = 219;
+                out[w++] = 221;
+            } else {
+                out[w++] = payload[i];
+            }
+        }
+        out[w++] = 192;
+        return w;
+    }
+
+protected:
+    uint32_t channel_mask_;
+    uint16_t period_us_;
+    uint8_t samples_per_frame_;
+    SampleFormat format_;
+    uint32_t time_us_;
+    size_t n_;
+    size_t corrupt_every_;
+    size_t frame_count_;
+};
+
+}  // namespace SensorProtocolV2
+
+#endif  // __SENSOR_PROTOCOL_V2_HPP__
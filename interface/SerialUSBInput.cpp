@@ -1,15 +1,12 @@
 #include "SerialUSBInput.hpp"
-#include "../utils/SLIP.hpp"
 
 #include "SerialUSBOutput.hpp"
 
 SerialUSBOutput usbSerialOut;
 
 SerialUSBInput::SerialUSBInput(size_t n_inputs, std::shared_ptr<display> dispptr, size_t baud_rate) :
-    slipBuffer{ 0 },
+    slip_(),
     value_states_(n_inputs, 0),
-    spiState(SPISTATES::WAITFOREND),
-    spiIdx(0),
     callback_(nullptr),
     refresh_uart_(false),
     n_inputs_(n_inputs),
@@ -20,20 +17,6 @@ SerialUSBInput::SerialUSBInput(size_t n_inputs, std::shared_ptr<display> dispptr
     //assume Serial has already begun()
 }
 
-float bytes2float_union(const uint8_t* bytes) {
-    union {
-        uint32_t i;
-        float f;
-    } converter;
-
-    converter.i = bytes[0] |
-                 (bytes[1] << 8) |
-                 (bytes[2] << 16) |
-                 (bytes[3] << 24);
-
-    return converter.f;
-}
-
 void SerialUSBInput::Poll()
 {
     if (!refresh_uart_) {
@@ -51,73 +34,28 @@ void SerialUSBInput::Poll()
         refresh_uart_ = true;
     }
 
+    // Read whatever the USB CDC buffer holds in blocks
+    auto on_frame = [this](std::span<const uint8_t> frame) { OnFrame_(frame); };
+    uint8_t block[64];
     while (true) {
-        int raw = Serial.read();
-        if (raw < 0) break;                           // no more data
-        uint8_t spiByte = static_cast<uint8_t>(raw);
-
-        switch(spiState) {
-            case SPISTATES::WAITFOREND:
-                if (spiByte == SLIP::END) {
-                    slipBuffer[0] = SLIP::END;
-                    spiState = SPISTATES::READBYTES;
-                }
-                break;
-
-            // case SPISTATES::ENDORBYTES:
-            //     if (spiByte == SLIP::END) {
-            //         spiIdx = 1;
-            //     } else {
-            //         slipBuffer[1] = spiByte;
-            //         spiIdx = 2;
-            //     }
-            //     spiState = SPISTATES::READBYTES;
-            //     break;
-
-            case SPISTATES::READBYTES:
-                if (spiIdx < static_cast<int>(kSlipBufferSize_)) {
-                    slipBuffer[spiIdx++] = spiByte;
-
-                    if (spiByte == SLIP::END) {
-                        // Safe decode into fixed buffer
-                        //disp->post("Received packet");
-                        size_t  maxOut = n_inputs_ * sizeof(float);
-                        uint8_t outBuf[maxOut] = {0};
-                        size_t  got    = SLIP::decode(slipBuffer, spiIdx, outBuf, maxOut);
-                        if (got == maxOut) {
-                            //disp->post("Decoded packet successfully");
-                            //float f = bytes2float_union(outBuf);
-                            //disp->post("Value: " + String(f, 8));
-
-                            for (size_t n = 0; n < n_inputs_; n++) {
-                                // Convert each 4-byte float in the buffer
-                                float f = bytes2float_union(&outBuf[n * sizeof(float)]);
-                                value_states_[n] = f; // Store the value
-                                //if (n == 0) disp->post("USBIn0: "+ String(f, 8));
-                            }
-                            callback_(value_states_);
+        size_t n = Serial.available();
+        if (n == 0) break;                            // no more data
+        if (n > sizeof(block)) n = sizeof(block);
+        n = Serial.readBytes(block, n);
+        slip_.Feed(std::span<const uint8_t>(block, n), on_frame);
+    }
+}
 
-                            // std::vector<float> values(1);
-                            // values[0] = f * 2.0f;
-                            // usbSerialOut.SendFloatArray(values);
-                            //disp->post("Sent value back: " + String(f, 8));
-                            // spiMessage msg;
-                            // memcpy(&msg, outBuf, maxOut);
-                            // Parse_(msg);
-                        }else{
-                            disp->post("Invalid packet: " + String(got));
-                        }
-                        // Reset for next packet
-                        spiState = SPISTATES::WAITFOREND;
-                        spiIdx   = 0;
-                    }
-                } else {
-                    DEBUG_PRINTLN("UARTInput: SLIP buffer overrun, dropping packet");
-                    spiState = SPISTATES::WAITFOREND;
-                    spiIdx   = 0;
-                }
-                break;
-        }
+void SerialUSBInput::OnFrame_(std::span<const uint8_t> frame)
+{
+    // Fixed layout: exactly n_inputs_ little-endian floats
+    if (frame.size() != n_inputs_ * sizeof(float)) {
+        disp->post("Invalid packet: " + String(frame.size()));
+        return;
+    }
+    SLIPDecoder<kSlipBufferSize_>::ParseFloats(frame, value_states_.data(), n_inputs_);
+    if (callback_) {
+        callback_(value_states_);
     }
 }
 
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../utils/MedianFilter.h"
 #include "../hardware/memlnaut/Pins.hpp"
+#include "../utils/SLIPDecoder.hpp"
 #include <SerialPIO.h>
 #include <functional>
 #include "../hardware/memlnaut/display.hpp" // Added include
@@ -44,11 +45,19 @@ public:
     {
         callback_ = callback;
     }
+    /**
+     * @brief Expect a CRC-16 trailer on every frame from the host.
+     */
+    inline void EnableCRC(bool enable) { slip_.SetCRC(enable); }
+    /**
+     * @brief Frame and error counters from the SLIP decoder.
+     */
+    inline const auto& GetStats() const { return slip_.GetStats(); }
 
 protected:
     static const size_t kSlipBufferSize_ = 512;
     std::vector<size_t> sensor_indexes_;
-    uint8_t slipBuffer[kSlipBufferSize_];
+    SLIPDecoder<kSlipBufferSize_> slip_;
 
     // std::vector<MedianFilter<float>> filters_;
     std::vector<float> value_states_;
@@ -61,16 +70,8 @@ protected:
         uint8_t msg;
         float value;
     };
-    enum SPISTATES
-    {
-        WAITFOREND,
-        ENDORBYTES,
-        READBYTES
-    };
-    SPISTATES spiState;
-    int spiIdx;
-
     void Parse_(spiMessage msg);
+    void OnFrame_(std::span<const uint8_t> frame);
 
 private:
     std::shared_ptr<display> disp;
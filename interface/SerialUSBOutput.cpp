@@ -1,47 +1,40 @@
 #include "SerialUSBOutput.hpp"
 
-SerialUSBOutput::SerialUSBOutput()
+SerialUSBOutput::SerialUSBOutput() :
+    compact_(false),
+    compact_encoder_()
 {
     //assume Serial has already begun()
 
 }
 
+void SerialUSBOutput::SetCompactFormat(bool enable, compact_encoder_t::Encoding encoding)
+{
+    compact_ = enable;
+    compact_encoder_.SetEncoding(encoding);
+}
+
 void SerialUSBOutput::SendFloatArray(const std::vector<float> &params)
 {
-    Serial.write(SLIP_END);
-    // Encode each float (4 bytes) via SLIP
-    for(const auto& f : params)
-    {
-        union {
-            float   f;
-            uint8_t b[4];
-        } data;
-        data.f = f;
+    const size_t n = std::min(params.size(), kMaxParams);
 
-        for(int i = 0; i < 4; i++)
-        {
-            slipSendByte(data.b[i]);
+    if (compact_) {
+        size_t length = compact_encoder_.Encode(std::span<const float>(params.data(), n), raw_buffer_);
+        if (length > 0) {
+            SendPacket_(raw_buffer_, length);
         }
+    } else {
+        // Floats are sent as-is (little endian), straight from the vector
+        SendPacket_(reinterpret_cast<const uint8_t*>(params.data()), n * sizeof(float));
     }
-
-    // Finally, write the SLIP_END marker
-    Serial.write(SLIP_END);
 }
 
-void SerialUSBOutput::slipSendByte(uint8_t b)
+void SerialUSBOutput::SendPacket_(const uint8_t *raw, size_t length)
 {
-    if(b == SLIP_END)
-    {
-        Serial.write(SLIP_ESC);
-        Serial.write(SLIP_ESC_END);
-    }
-    else if(b == SLIP_ESC)
-    {
-        Serial.write(SLIP_ESC);
-        Serial.write(SLIP_ESC_ESC);
-    }
-    else
-    {
-        Serial.write(b);
+    // Whole packet is escaped into tx_buffer_ (with leading and trailing END)
+    // and handed to the USB stack in a single write
+    size_t encoded = SLIP::encode(raw, length, tx_buffer_);
+    if (encoded > 0) {
+        Serial.write(tx_buffer_, encoded);
     }
 }
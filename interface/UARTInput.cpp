@@ -1,23 +1,30 @@
 #include "UARTInput.hpp"
-#include "../utils/SLIP.hpp"
 #include "../utils/Maths.hpp"
+#include "hardware/dma.h"
+#include "hardware/uart.h"
 
 
 UARTInput::UARTInput(const std::vector<size_t>& sensor_indexes,
                      size_t sensor_rx,
                      size_t sensor_tx,
-                     size_t baud_rate) :
+                     size_t baud_rate,
+                     bool use_dma_rx) :
     sensor_indexes_(sensor_indexes),
     sensor_rx_(sensor_rx),
     sensor_tx_(sensor_tx),
-    slipBuffer{ 0 },
+    slip_(),
     filters_(),
     value_states_{ 0 },
-    spiState(SPISTATES::WAITFOREND),
-    spiIdx(0),
     callback_(nullptr),
+    frame_callback_(nullptr),
+    protocol_(kProtocolV1),
+    v1_crc_(false),
+    v2_errors_(0),
     refresh_uart_(false),
-    baud_rate_(baud_rate)
+    baud_rate_(baud_rate),
+    use_dma_rx_(use_dma_rx),
+    rx_dma_channel_(-1),
+    rx_read_pos_(0)
 {
     // Reserve once to avoid heap fragmentation at runtime
     filters_.reserve(kMaxChannels);
@@ -30,6 +37,53 @@ UARTInput::UARTInput(const std::vector<size_t>& sensor_indexes,
     Serial1.begin(baud_rate);
 }
 
+UARTInput::~UARTInput()
+{
+    if (rx_dma_channel_ >= 0) {
+        dma_channel_abort(rx_dma_channel_);
+        dma_channel_unclaim(rx_dma_channel_);
+        rx_dma_channel_ = -1;
+    }
+}
+
+bool UARTInput::SetupRxDMA_()
+{
+    // Serial1 is uart0
+    rx_dma_channel_ = dma_claim_unused_channel(false);
+    if (rx_dma_channel_ < 0) {
+        return false;
+    }
+
+    dma_channel_config c = dma_channel_get_default_config(rx_dma_channel_);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, uart_get_dreq(uart0, false));
+
+    // Wrap writes at kRxBufferSize_
+    uint32_t ring_bits = 0;
+    for (size_t size = kRxBufferSize_; size >>= 1;) ring_bits++;
+    channel_config_set_ring(&c, true, ring_bits);
+
+    rx_read_pos_ = 0;
+    dma_channel_configure(
+        rx_dma_channel_,
+        &c,
+        rx_dma_buffer_,
+        &uart_get_hw(uart0)->dr,
+        0xFFFFFFFF,
+        true
+    );
+
+    return true;
+}
+
+uint32_t UARTInput::GetRxWritePos_()
+{
+    uint32_t remaining = dma_channel_hw_addr(rx_dma_channel_)->transfer_count;
+    return (0xFFFFFFFF - remaining) & (kRxBufferSize_ - 1);
+}
+
 void UARTInput::ListenToSensorIndexes(const std::vector<size_t>& indexes)
 {
     sensor_indexes_ = indexes;
@@ -61,64 +115,83 @@ void UARTInput::Poll()
         DEBUG_PRINTLN("PIO_UART refreshed.");
         DEBUG_PRINT("Serial available: ");
         DEBUG_PRINTLN(Serial1.available());
+        if (use_dma_rx_ && rx_dma_channel_ < 0) {
+            if (!SetupRxDMA_()) {
+                DEBUG_PRINTLN("UARTInput: DMA RX setup failed, falling back to Serial1.read()");
+            }
+        }
+        slip_.Reset();
         refresh_uart_ = true;
     }
 
+    auto on_frame = [this](std::span<const uint8_t> frame) { OnFrame_(frame); };
+
+    if (rx_dma_channel_ >= 0) {
+        slip_.FeedRing(rx_dma_buffer_, kRxBufferSize_, rx_read_pos_, GetRxWritePos_(), on_frame);
+        return;
+    }
+
+    // Drain the UART FIFO in blocks rather than one read() per byte
+    uint8_t block[64];
     while (true) {
-        int raw = Serial1.read();
-        if (raw < 0) break;                           // no more data
-        uint8_t spiByte = static_cast<uint8_t>(raw);
-        //DEBUG_PRINTF("%02X ", spiByte);
-
-        switch(spiState) {
-            case SPISTATES::WAITFOREND:
-                if (spiByte == SLIP::END) {
-                    slipBuffer[0] = SLIP::END;
-                    spiState = SPISTATES::ENDORBYTES;
-                }
-                break;
+        size_t n = Serial1.available();
+        if (n == 0) break;                            // no more data
+        if (n > sizeof(block)) n = sizeof(block);
+        n = Serial1.readBytes(block, n);
+        slip_.Feed(std::span<const uint8_t>(block, n), on_frame);
+    }
+}
 
-            case SPISTATES::ENDORBYTES:
-                if (spiByte == SLIP::END) {
-                    spiIdx = 1;
-                } else {
-                    slipBuffer[1] = spiByte;
-                    spiIdx = 2;
-                }
-                spiState = SPISTATES::READBYTES;
-                break;
+void UARTInput::SetProtocol(Protocol protocol)
+{
+    protocol_ = protocol;
+    slip_.SetCRC(protocol != kProtocolV2 && v1_crc_);
+}
+
+void UARTInput::OnFrame_(std::span<const uint8_t> frame)
+{
+    if (protocol_ == kProtocolV2) {
+        OnFrameV2_(frame);
+        return;
+    }
+
+    float values[kMaxChannels];
+    size_t n = SLIPDecoder<kSlipBufferSize_>::ParseFloats(frame, values, kMaxChannels);
+    ParseBuf_(values, n);
+}
+
+void UARTInput::OnFrameV2_(std::span<const uint8_t> frame)
+{
+    SensorProtocolV2::Frame decoded;
+    if (!SensorProtocolV2::Parse(frame, decoded, v2_values_)) {
+        v2_errors_++;
+        return;
+    }
+    if (decoded.n_samples == 0) {
+        return;
+    }
 
-            case SPISTATES::READBYTES:
-                if (spiIdx < static_cast<int>(kSlipBufferSize_)) {
-                    slipBuffer[spiIdx++] = spiByte;
-
-                    if (spiByte == SLIP::END) {
-                        //DEBUG_PRINTLN(); // Newline after hex bytes
-                        // Safe decode into fixed buffer
-                        //uint8_t outBuf[sizeof(spiMessage)] = {0};
-                        //size_t  maxOut = sizeof(spiMessage);
-                        //size_t  got    = SLIP::decode(slipBuffer, spiIdx, outBuf, maxOut);
-                        float outBuf[kMaxChannels] = {0};
-                        size_t maxOut = sizeof(outBuf);
-                        size_t got = SLIP::decode(slipBuffer, spiIdx,
-                                reinterpret_cast<uint8_t*>(outBuf), maxOut);
-                        // DEBUG_PRINTF("Got %zu bytes\n", got);
-                        {
-                            //spiMessage msg;
-                            //memcpy(&msg, outBuf, maxOut);
-                            //Parse_(msg);
-                            ParseBuf_(outBuf, got >> 2);
-                        }
-                        // Reset for next packet
-                        spiState = SPISTATES::WAITFOREND;
-                        spiIdx   = 0;
-                    }
-                } else {
-                    DEBUG_PRINTLN("UARTInput: SLIP buffer overrun, dropping packet");
-                    spiState = SPISTATES::WAITFOREND;
-                    spiIdx   = 0;
-                }
+    if (frame_callback_) {
+        frame_callback_(decoded);
+        return;
+    }
+
+    // Fallback for v1-style consumers: newest row only, low channels only
+    if (callback_) {
+        const float *row = decoded.samples.data() +
+            static_cast<size_t>(decoded.n_samples - 1) * decoded.n_channels;
+        for (size_t col = 0; col < decoded.n_channels; col++) {
+            size_t chan = decoded.Channel(col);
+            if (chan >= kMaxChannels || chan >= value_states_.size()) {
                 break;
+            }
+            float value = row[col];
+            // Protect against infs and nans
+            if (std::isnan(value) || std::isinf(value)) {
+                value = value_states_[chan];
+            }
+            value_states_[chan] = value;
+            callback_(chan, value);
         }
     }
 }
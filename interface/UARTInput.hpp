@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include "../utils/MedianFilter.h"
 #include "../hardware/memlnaut/Pins.hpp"
+#include "../utils/SLIPDecoder.hpp"
+#include "SensorProtocolV2.hpp"
 #include <SerialPIO.h>
 #include <functional>
 
@@ -20,6 +22,12 @@ public:
     static constexpr size_t kObservedChan = 9999;
 
     using uart_in_callback_t = std::function<void(size_t, float)>;
+    using uart_frame_callback_t = std::function<void(const SensorProtocolV2::Frame&)>;
+
+    enum Protocol {
+        kProtocolV1,    ///< One float per channel per frame (default)
+        kProtocolV2     ///< Timestamped, batched multi-channel frames
+    };
     /**
      * @brief Construct a new UARTInput object for communication
      * with the MEML Sensor Board.
@@ -27,11 +35,19 @@ public:
      * @param sensor_indexes Vector of indexes to read (maximum 8, numbers 0-7).
      * @param sensor_rx RX pin the Sensor Board is connected to (default: Pins::SENSOR_RX).
      * @param sensor_tx TX pin the Sensor Board is connected to (default: Pins::SENSOR_TX).
+     * @param baud_rate UART baud rate (default: 115200).
+     * @param use_dma_rx Capture RX into a DMA ring instead of reading Serial1
+     * byte by byte (default: false to preserve DMA channels).
      */
     UARTInput(const std::vector<size_t> &sensor_indexes,
               size_t sensor_rx = Pins::SENSOR_RX,
               size_t sensor_tx = Pins::SENSOR_TX,
-              size_t baud_rate = 115200);
+              size_t baud_rate = 115200,
+              bool use_dma_rx = false);
+    /**
+     * @brief Destructor - releases the RX DMA channel.
+     */
+    ~UARTInput();
     /**
      * @brief Poll input. Put in a regular loop.
      */
@@ -45,22 +61,60 @@ public:
     {
         callback_ = callback;
     }
+    /**
+     * @brief Set the callback for protocol v2 frames.
+     * Called once per frame with every sample of every channel in it.
+     * If no frame callback is set, the newest sample of channels
+     * 0..kMaxChannels-1 is passed to the per-channel callback instead.
+     *
+     * @param callback Callback that accepts a SensorProtocolV2::Frame.
+     */
+    inline void SetFrameCallback(uart_frame_callback_t callback)
+    {
+        frame_callback_ = callback;
+    }
+    /**
+     * @brief Select the wire protocol the sensor board speaks.
+     * v2 frames carry their own CRC, so the SLIP-level CRC is disabled;
+     * switching back to v1 restores the EnableCRC() setting.
+     */
+    void SetProtocol(Protocol protocol);
     /**
      * @brief Change the sensor indexes to listen to.
      *
      * @param indexes Vector of indexes to read (maximum 8, numbers 0-7).
      */
     void ListenToSensorIndexes(const std::vector<size_t> &indexes);
+    /**
+     * @brief Expect a CRC-16 trailer on every frame from the sensor board.
+     */
+    inline void EnableCRC(bool enable) {
+        v1_crc_ = enable;
+        slip_.SetCRC(enable && protocol_ != kProtocolV2);
+    }
+    /**
+     * @brief Frame and error counters from the SLIP decoder.
+     */
+    inline const auto& GetStats() const { return slip_.GetStats(); }
+    /**
+     * @brief Number of v2 frames dropped for a bad header, length or CRC.
+     */
+    inline uint32_t GetV2ErrorCount() const { return v2_errors_; }
 
 protected:
-    static const size_t kSlipBufferSize_ = 128;
+    static const size_t kSlipBufferSize_ = SensorProtocolV2::kMaxFrameBytes;
     std::vector<size_t> sensor_indexes_;
     size_t sensor_rx_;
     size_t sensor_tx_;
-    uint8_t slipBuffer[kSlipBufferSize_];
+    SLIPDecoder<kSlipBufferSize_> slip_;
     std::vector<MedianFilter<float>> filters_;
     std::vector<float> value_states_;
     uart_in_callback_t callback_ = nullptr;
+    uart_frame_callback_t frame_callback_ = nullptr;
+    Protocol protocol_;
+    bool v1_crc_;                   ///< SLIP-level CRC, v1 frames only
+    uint32_t v2_errors_;
+    float v2_values_[SensorProtocolV2::kMaxValues];
     bool refresh_uart_;
     size_t baud_rate_;
 
@@ -69,17 +123,19 @@ protected:
         uint8_t msg;
         float value;
     };
-    enum SPISTATES
-    {
-        WAITFOREND,
-        ENDORBYTES,
-        READBYTES
-    };
-    SPISTATES spiState;
-    int spiIdx;
-
     // void Parse_(spiMessage msg);
     void ParseBuf_(float* buf, size_t len = kMaxChannels);
+    void OnFrame_(std::span<const uint8_t> frame);
+    void OnFrameV2_(std::span<const uint8_t> frame);
+
+    // DMA input support
+    static constexpr size_t kRxBufferSize_ = 256;
+    bool use_dma_rx_;
+    int rx_dma_channel_;
+    uint8_t rx_dma_buffer_[kRxBufferSize_] __attribute__((aligned(kRxBufferSize_)));
+    uint32_t rx_read_pos_;
+    bool SetupRxDMA_();
+    uint32_t GetRxWritePos_();
 
 private:
     //SerialPIO pioSerial_;
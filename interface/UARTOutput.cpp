@@ -1,47 +1,41 @@
 #include "UARTOutput.hpp"
 
 UARTOutput::UARTOutput(int txPin)
-    : pioSerial_(txPin, NOPIN) // TX only, no RX pin
+    : pioSerial_(txPin, NOPIN), // TX only, no RX pin
+      compact_(false),
+      compact_encoder_()
 {
     // Start the PIO-based serial port at 115200 baud
     pioSerial_.begin(115200);
 }
 
+void UARTOutput::SetCompactFormat(bool enable, compact_encoder_t::Encoding encoding)
+{
+    compact_ = enable;
+    compact_encoder_.SetEncoding(encoding);
+}
+
 void UARTOutput::SendParams(const std::vector<float> &params)
 {
-    // Encode each float (4 bytes) via SLIP
-    for(const auto& f : params)
-    {
-        union {
-            float   f;
-            uint8_t b[4];
-        } data;
-        data.f = f;
+    const size_t n = std::min(params.size(), kMaxParams);
 
-        for(int i = 0; i < 4; i++)
-        {
-            slipSendByte(data.b[i]);
+    if (compact_) {
+        size_t length = compact_encoder_.Encode(std::span<const float>(params.data(), n), raw_buffer_);
+        if (length > 0) {
+            SendPacket_(raw_buffer_, length);
         }
+    } else {
+        // Floats are sent as-is (little endian), straight from the vector
+        SendPacket_(reinterpret_cast<const uint8_t*>(params.data()), n * sizeof(float));
     }
-
-    // Finally, write the SLIP_END marker
-    pioSerial_.write(SLIP_END);
 }
 
-void UARTOutput::slipSendByte(uint8_t b)
+void UARTOutput::SendPacket_(const uint8_t *raw, size_t length)
 {
-    if(b == SLIP_END)
-    {
-        pioSerial_.write(SLIP_ESC);
-        pioSerial_.write(SLIP_ESC_END);
-    }
-    else if(b == SLIP_ESC)
-    {
-        pioSerial_.write(SLIP_ESC);
-        pioSerial_.write(SLIP_ESC_ESC);
-    }
-    else
-    {
-        pioSerial_.write(b);
+    // Whole packet is escaped into tx_buffer_ and written to the PIO UART
+    // FIFO in one call
+    size_t encoded = SLIP::encode(raw, length, tx_buffer_);
+    if (encoded > 0) {
+        pioSerial_.write(tx_buffer_, encoded);
     }
 }
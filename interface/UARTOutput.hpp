@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include <SerialPIO.h>
 #include "../hardware/memlnaut/Pins.hpp"
+#include "../utils/SLIP.hpp"
+#include "../utils/CompactPacket.hpp"
 #include <vector>
 
 
@@ -28,20 +30,36 @@ public:
      */
     void SendParams(const std::vector<float> &params);
 
+    /**
+     * @brief Largest parameter count per packet; extra values are dropped.
+     */
+    static constexpr size_t kMaxParams = 64;
+    using compact_encoder_t = CompactPacketEncoder<kMaxParams>;
+
+    /**
+     * @brief Switch to the compact delta-coded packet format
+     * (see CompactPacketEncoder) instead of raw 32-bit floats.
+     *
+     * @param enable True for compact packets, false for raw floats (default).
+     * @param encoding Half-float or int16 payload.
+     */
+    void SetCompactFormat(bool enable,
+                          compact_encoder_t::Encoding encoding = compact_encoder_t::kHalf);
+
 private:
     /**
-     * @brief Helper to apply SLIP-escaping on a single byte.
+     * @brief SLIP-encodes a raw packet into tx_buffer_ and sends it in one write.
      */
-    void slipSendByte(uint8_t b);
+    void SendPacket_(const uint8_t *raw, size_t length);
 
     // PIO-based Serial
     SerialPIO pioSerial_;
 
-    // SLIP special characters
-    static constexpr uint8_t SLIP_END     = 0xC0;  ///< End of SLIP packet
-    static constexpr uint8_t SLIP_ESC     = 0xDB;  ///< Escape character
-    static constexpr uint8_t SLIP_ESC_END = 0xDC;  ///< Escaped END
-    static constexpr uint8_t SLIP_ESC_ESC = 0xDD;  ///< Escaped ESC
+    bool compact_;
+    compact_encoder_t compact_encoder_;
+    uint8_t raw_buffer_[compact_encoder_t::kMaxPacketBytes];
+    // Worst case SLIP expansion of kMaxParams floats
+    uint8_t tx_buffer_[kMaxParams * sizeof(float) * 2 + 2];
 };
 
 
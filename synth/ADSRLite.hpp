@@ -1,6 +1,283 @@
 #ifndef MEMLLIB_SYNTH_ADSRLITE_HPP
 #define MEMLLIB_SYNTH_ADSRLITE_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
 
 
-#endif // MEMLLIB_SYNTH_ADSRLITE_HPP
\ No newline at end of file
+/**
+ * @brief Settings shared by any number of BlockADSRVoice envelopes.
+ *
+ * Times are converted to segment lengths in samples once, in setup(). The
+ * attack is linear. Decay and release are
+ * linear (as ADSRLite) or exponential, in which case the time is how long
+ * they take to get within -80 dB of their target.
+ */
+struct BlockADSRParams {
+    enum Shape { kLinear, kExponential };
+
+    uint32_t attack = 0;
+    uint32_t decay = 0;
+    uint32_t release = 0;
+    float sustain = 1.f;
+    float decayCoef = 0.f;
+    float releaseCoef = 0.f;
+    Shape shape = kLinear;
+
+    void setup(float attackMs, float decayMs, float sustainLevel, float releaseMs,
+               float sampleRate, Shape newShape = kLinear) {
+        attack = MsToSamples_(attackMs, sampleRate);
+        decay = MsToSamples_(decayMs, sampleRate);
+        release = MsToSamples_(releaseMs, sampleRate);
+        sustain = sustainLevel < 0.f ? 0.f : (sustainLevel > 1.f ? 1.f : sustainLevel);
+        shape = newShape;
+        decayCoef = decay ? expf(-9.21f / static_cast<float>(decay)) : 0.f;
+        releaseCoef = release ? expf(-9.21f / static_cast<float>(release)) : 0.f;
+    }
+
+private:
+    static uint32_t MsToSamples_(float ms, float sampleRate) {
+        return ms > 0.f ? static_cast<uint32_t>(ms * 0.001f * sampleRate + 0.5f) : 0;
+    }
+};
+
+
+/**
+ * @brief One ADSR envelope rendered a block at a time.
+ *
+ * Every segment is the recurrence y = a * y + b (a = 1 for linear, the
+ * decay coefficient for exponential), and its length in samples is worked
+ * out when the segment starts. process() therefore runs a branch-free
+ * loop per segment and only looks at the stage at segment ends and
+ * events, where y is snapped to the segment's end value.
+ *
+ * trigger() and release() take a frame offset into the next process()
+ * call (or later ones), so note events land on the right sample whatever
+ * the block size. Retriggering attacks from the current level in the
+ * attack time, as ADSRLite does.
+ */
+class BlockADSRVoice {
+public:
+    enum Stage : uint8_t { kIdle, kAttack, kDecay, kSustain, kRelease };
+
+    inline void trigger(float velocity, uint32_t offset = 0) {
+        trigAt_ = offset;
+        trigVel_ = velocity;
+    }
+
+    inline void release(uint32_t offset = 0) {
+        relAt_ = offset;
+    }
+
+    inline void reset() {
+        stage_ = kIdle;
+        y_ = 0.f;
+        a_ = 1.f;
+        b_ = 0.f;
+        remaining_ = kForever;
+        trigAt_ = relAt_ = kNone;
+    }
+
+    inline bool isActive() const { return stage_ != kIdle || trigAt_ != kNone; }
+    inline Stage stage() const { return stage_; }
+    inline float value() const { return y_ * vel_; }
+
+    /**
+     * @brief Writes n envelope samples (scaled by velocity) to out.
+     */
+    void process(const BlockADSRParams &p, float *out, size_t n) {
+        size_t i = 0;
+        while (i < n) {
+            // Events due now, release after retrigger when both coincide
+            if (trigAt_ == 0) {
+                trigAt_ = kNone;
+                vel_ = trigVel_;
+                enter_(p, kAttack);
+            }
+            if (relAt_ == 0) {
+                relAt_ = kNone;
+                if (stage_ != kIdle) {
+                    enter_(p, kRelease);
+                }
+            }
+            uint32_t run = static_cast<uint32_t>(n - i);
+            run = remaining_ < run ? remaining_ : run;
+            run = trigAt_ < run ? trigAt_ : run;
+            run = relAt_ < run ? relAt_ : run;
+
+            const float a = a_, b = b_, vel = vel_;
+            float y = y_;
+            if (a == 1.f && b == 0.f) {
+                // Idle or sustain
+                const float v = y * vel;
+                for (uint32_t j = 0; j < run; j++) {
+                    out[i + j] = v;
+                }
+            } else {
+                for (uint32_t j = 0; j < run; j++) {
+                    y = a * y + b;
+                    out[i + j] = y * vel;
+                }
+            }
+            y_ = y;
+            i += run;
+            countDown_(run);
+            if (remaining_ == 0) {
+                next_(p);
+            }
+        }
+    }
+
+protected:
+    static constexpr uint32_t kForever = UINT32_MAX;
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    Stage stage_ = kIdle;
+    float y_ = 0.f;
+    float a_ = 1.f, b_ = 0.f;
+    float vel_ = 1.f;
+    float trigVel_ = 1.f;
+    uint32_t remaining_ = kForever;
+    uint32_t trigAt_ = kNone;
+    uint32_t relAt_ = kNone;
+
+    inline void countDown_(uint32_t run) {
+        if (remaining_ != kForever) remaining_ -= run;
+        if (trigAt_ != kNone) trigAt_ -= run;
+        if (relAt_ != kNone) relAt_ -= run;
+    }
+
+    // Segment finished: land on its end value and start the next one
+    inline void next_(const BlockADSRParams &p) {
+        switch (stage_) {
+            case kAttack:
+                y_ = 1.f;
+                enter_(p, kDecay);
+                break;
+            case kDecay:
+                y_ = p.sustain;
+                enter_(p, kSustain);
+                break;
+            case kRelease:
+                y_ = 0.f;
+                enter_(p, kIdle);
+                break;
+            default:
+                remaining_ = kForever;
+                break;
+        }
+    }
+
+    void enter_(const BlockADSRParams &p, Stage stage) {
+        stage_ = stage;
+        a_ = 1.f;
+        b_ = 0.f;
+        remaining_ = kForever;
+        switch (stage) {
+            case kAttack:
+                if (!p.attack) {
+                    y_ = 1.f;
+                    enter_(p, kDecay);
+                    return;
+                }
+                b_ = (1.f - y_) / static_cast<float>(p.attack);
+                remaining_ = p.attack;
+                break;
+            case kDecay:
+                if (!p.decay) {
+                    y_ = p.sustain;
+                    enter_(p, kSustain);
+                    return;
+                }
+                if (p.shape == BlockADSRParams::kExponential) {
+                    a_ = p.decayCoef;
+                    b_ = p.sustain * (1.f - p.decayCoef);
+                } else {
+                    b_ = (p.sustain - y_) / static_cast<float>(p.decay);
+                }
+                remaining_ = p.decay;
+                break;
+            case kRelease:
+                if (!p.release) {
+                    y_ = 0.f;
+                    enter_(p, kIdle);
+                    return;
+                }
+                if (p.shape == BlockADSRParams::kExponential) {
+                    a_ = p.releaseCoef;
+                } else {
+                    b_ = -y_ / static_cast<float>(p.release);
+                }
+                remaining_ = p.release;
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+
+/**
+ * @brief A BlockADSRVoice with its own settings, for a single envelope.
+ */
+class BlockADSR : public BlockADSRVoice {
+public:
+    void setup(float attackMs, float decayMs, float sustainLevel, float releaseMs,
+               float sampleRate, BlockADSRParams::Shape shape = BlockADSRParams::kLinear) {
+        params_.setup(attackMs, decayMs, sustainLevel, releaseMs, sampleRate, shape);
+    }
+
+    inline void process(float *out, size_t n) {
+        BlockADSRVoice::process(params_, out, n);
+    }
+
+protected:
+    BlockADSRParams params_;
+};
+
+
+/**
+ * @brief N voice envelopes with shared settings, rendered together.
+ *
+ * Output is voice-major: voice v's samples are out[v * n .. v * n + n).
+ * Idle voices are a fill of zeros.
+ *
+ * @tparam N Number of voices.
+ */
+template<size_t N>
+class BlockADSRBank {
+public:
+    void setup(float attackMs, float decayMs, float sustainLevel, float releaseMs,
+               float sampleRate, BlockADSRParams::Shape shape = BlockADSRParams::kLinear) {
+        params_.setup(attackMs, decayMs, sustainLevel, releaseMs, sampleRate, shape);
+    }
+
+    inline void trigger(size_t voice, float velocity, uint32_t offset = 0) {
+        voices_[voice].trigger(velocity, offset);
+    }
+
+    inline void release(size_t voice, uint32_t offset = 0) {
+        voices_[voice].release(offset);
+    }
+
+    inline bool isActive(size_t voice) const { return voices_[voice].isActive(); }
+    inline float value(size_t voice) const { return voices_[voice].value(); }
+
+    void process(float *out, size_t n) {
+        for (size_t v = 0; v < N; v++) {
+            if (voices_[v].isActive()) {
+                voices_[v].process(params_, out + v * n, n);
+            } else {
+                std::fill(out + v * n, out + (v + 1) * n, 0.f);
+            }
+        }
+    }
+
+protected:
+    BlockADSRParams params_;
+    BlockADSRVoice voices_[N];
+};
+
+#endif // MEMLLIB_SYNTH_ADSRLITE_HPP
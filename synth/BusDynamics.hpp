@@ -0,0 +1,278 @@
+#pragma once
+
+#include "maximilian.h"
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// DynLog2 / DynExp2
+// Cheap log2 and exp2 for gain computation. log2 is within 0.005 (0.03 dB),
+// exp2 within 0.01%; plenty for a gain curve, and no libm calls.
+// ─────────────────────────────────────────────────────────────────────────────
+static float __force_inline DynLog2(float x) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    // Exponent less one, as the polynomial gives 1 + log2(m) for m in [1, 2)
+    const float e = static_cast<float>(static_cast<int32_t>((bits >> 23) & 0xff) - 128);
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    return e + (-0.34484843f * m + 2.02466578f) * m - 0.67487759f;
+}
+
+static float __force_inline DynExp2(float x) {
+    x = std::clamp(x, -126.f, 126.f);
+    const float fl = floorf(x);
+    const float f = x - fl;
+    const float p = 1.f + f * (0.69583355f + f * (0.22606716f + f * 0.07944023f));
+    uint32_t bits;
+    std::memcpy(&bits, &p, sizeof(bits));
+    bits += static_cast<uint32_t>(static_cast<int32_t>(fl)) << 23;
+    float y;
+    std::memcpy(&y, &bits, sizeof(y));
+    return y;
+}
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Detector policies (stereo-linked)
+// Accumulate() runs per sample and must stay branch-free; Level() runs once
+// per control period and returns log2 of the level it measured.
+//   DynPeak  larger of |L| and |R| over the period
+//   DynRMS   mean of L² and R², smoothed over a window (setWindow, ms)
+// ─────────────────────────────────────────────────────────────────────────────
+struct DynPeak {
+    void setWindow(float, float) {}
+
+    void __force_inline Accumulate(float l, float r) {
+        peak_ = fmaxf(peak_, fmaxf(fabsf(l), fabsf(r)));
+    }
+
+    float __force_inline Level(size_t) {
+        const float lvl = DynLog2(peak_ + 1e-9f);
+        peak_ = 0.f;
+        return lvl;
+    }
+
+private:
+    float peak_ = 0.f;
+};
+
+struct DynRMS {
+    // windowMs at controlRate ticks per second
+    void setWindow(float windowMs, float controlRate) {
+        coef_ = 1.f - expf(-1000.f / (std::max(windowMs, 0.1f) * controlRate));
+    }
+
+    void __force_inline Accumulate(float l, float r) {
+        sum_ += l * l + r * r;
+    }
+
+    float __force_inline Level(size_t n) {
+        ms_ += (sum_ * (0.5f / static_cast<float>(n)) - ms_) * coef_;
+        sum_ = 0.f;
+        return 0.5f * DynLog2(ms_ + 1e-18f);
+    }
+
+private:
+    float sum_ = 0.f;
+    float ms_ = 0.f;
+    float coef_ = 1.f;
+};
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Knee policies
+// Gain change (log2 units, <= 0) for a level x above threshold, with
+// slope = 1 - 1/ratio and knee width w (log2 units, > 0).
+//   DynHardKnee  -slope * max(x, 0)
+//   DynSoftKnee  quadratic across the knee, same line outside it
+// ─────────────────────────────────────────────────────────────────────────────
+struct DynHardKnee {
+    static float __force_inline Gain(float x, float slope, float) {
+        return -slope * fmaxf(x, 0.f);
+    }
+};
+
+struct DynSoftKnee {
+    static float __force_inline Gain(float x, float slope, float w) {
+        const float t = std::clamp(x + 0.5f * w, 0.f, w);
+        return -slope * (t * t / (2.f * w) + fmaxf(x - 0.5f * w, 0.f));
+    }
+};
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// BusDynamics
+// Stereo-linked compressor/limiter for a master bus. Detector and knee are
+// template policies, so the per-sample path is a detector accumulate, a
+// ring write/read and a gain multiply: no std::function, no branches.
+// Gain is computed in the log domain once per DECIM samples, smoothed by
+// attack/release there, and interpolated linearly across the next period.
+// The lookahead ring has a fixed capacity of LOOKAHEAD frames; release is
+// held off until a peak has passed through it.
+//   processBlock(l, r, n)   in place, any n
+//   play(l, r)              per sample, in place
+// For a brick-wall limiter use DynPeak, ratio >= 100, attack 0 and a
+// lookahead of at least 2 * DECIM samples: the gain has then reached its
+// target before the peak leaves the ring.
+// ─────────────────────────────────────────────────────────────────────────────
+template<typename Detector = DynRMS, typename Knee = DynSoftKnee,
+         size_t LOOKAHEAD = 256, size_t DECIM = 16>
+class BusDynamics {
+    static_assert((LOOKAHEAD & (LOOKAHEAD - 1)) == 0, "LOOKAHEAD must be a power of 2");
+    static_assert(DECIM > 0, "DECIM must be at least 1");
+public:
+    static constexpr float kDbPerLog2 = 6.0205999f;
+
+    BusDynamics() {
+        std::fill(std::begin(ringL_), std::end(ringL_), 0.f);
+        std::fill(std::begin(ringR_), std::end(ringR_), 0.f);
+        setup(maxiSettings::sampleRate);
+    }
+
+    // Recomputes time constants; call again if the sample rate changes
+    void setup(float sampleRate) {
+        sampleRate_ = sampleRate;
+        controlRate_ = sampleRate / static_cast<float>(DECIM);
+        setAttack(attackMs_);
+        setRelease(releaseMs_);
+        setWindow(windowMs_);
+        setLookahead(lookaheadMs_);
+    }
+
+    inline void setThreshold(float db) { threshold_ = db / kDbPerLog2; }
+
+    // 1 = no compression; >= 100 is treated as infinite (limiting)
+    inline void setRatio(float ratio) {
+        slope_ = ratio >= 100.f ? 1.f : (ratio <= 1.f ? 0.f : 1.f - 1.f / ratio);
+    }
+
+    inline void setKnee(float db) { knee_ = std::max(db, 0.01f) / kDbPerLog2; }
+
+    inline void setMakeup(float db) { makeup_ = db / kDbPerLog2; }
+
+    inline void setAttack(float ms) {
+        attackMs_ = ms;
+        attack_ = timeToCoef_(ms);
+    }
+
+    inline void setRelease(float ms) {
+        releaseMs_ = ms;
+        release_ = timeToCoef_(ms);
+    }
+
+    // Detector window (DynRMS only)
+    inline void setWindow(float ms) {
+        windowMs_ = ms;
+        detector_.setWindow(ms, controlRate_);
+    }
+
+    // Clamped to the ring's capacity
+    inline void setLookahead(float ms) {
+        lookaheadMs_ = ms;
+        delay_ = std::min(static_cast<size_t>(ms * 0.001f * sampleRate_), LOOKAHEAD - 1);
+        holdTicks_ = delay_ > 0 ? delay_ / DECIM + 1 : 0;
+    }
+
+    inline size_t getLookaheadSamples() const { return delay_; }
+
+    // Current gain reduction, in dB (<= 0), for metering
+    inline float getGainReduction() const { return reduction_ * kDbPerLog2; }
+
+    inline void reset() {
+        std::fill(std::begin(ringL_), std::end(ringL_), 0.f);
+        std::fill(std::begin(ringR_), std::end(ringR_), 0.f);
+        reduction_ = 0.f;
+        phase_ = 0;
+        hold_ = 0;
+        gain_ = DynExp2(makeup_);
+        gainStep_ = 0.f;
+    }
+
+    void __force_inline play(float &l, float &r) {
+        tick_(l, r);
+        if (++phase_ == DECIM) {
+            phase_ = 0;
+            control_();
+        }
+    }
+
+    void processBlock(float *l, float *r, size_t n) {
+        size_t i = 0;
+        while (i < n) {
+            const size_t run = std::min(n - i, DECIM - phase_);
+            for (size_t j = i; j < i + run; j++) {
+                tick_(l[j], r[j]);
+            }
+            i += run;
+            phase_ += run;
+            if (phase_ == DECIM) {
+                phase_ = 0;
+                control_();
+            }
+        }
+    }
+
+private:
+    static constexpr size_t kMask = LOOKAHEAD - 1;
+
+    Detector detector_;
+    float ringL_[LOOKAHEAD];
+    float ringR_[LOOKAHEAD];
+    size_t pos_ = 0;
+    size_t delay_ = 0;
+    size_t phase_ = 0;
+    size_t hold_ = 0;               // Control periods left before release
+    size_t holdTicks_ = 0;
+
+    float gain_ = 1.f;              // Linear, interpolated per sample
+    float gainStep_ = 0.f;
+    float reduction_ = 0.f;         // Smoothed, log2 units
+
+    // Parameters in log2 units
+    float threshold_ = -12.f / kDbPerLog2;
+    float slope_ = 0.75f;
+    float knee_ = 6.f / kDbPerLog2;
+    float makeup_ = 0.f;
+    float attack_ = 1.f, release_ = 1.f;
+
+    float sampleRate_ = 48000.f;
+    float controlRate_ = 3000.f;
+    float attackMs_ = 5.f, releaseMs_ = 150.f, windowMs_ = 30.f, lookaheadMs_ = 0.f;
+
+    inline float timeToCoef_(float ms) const {
+        return ms <= 0.f ? 1.f : 1.f - expf(-1000.f / (ms * controlRate_));
+    }
+
+    void __force_inline tick_(float &l, float &r) {
+        detector_.Accumulate(l, r);
+        ringL_[pos_] = l;
+        ringR_[pos_] = r;
+        const size_t rd = (pos_ - delay_) & kMask;
+        pos_ = (pos_ + 1) & kMask;
+        gain_ += gainStep_;
+        l = ringL_[rd] * gain_;
+        r = ringR_[rd] * gain_;
+    }
+
+    // Once per DECIM samples: new target gain, ramped over the next period
+    inline void control_() {
+        const float target = Knee::Gain(detector_.Level(DECIM) - threshold_, slope_, knee_);
+        // Hold the reduction while the peak that caused it is still in the
+        // lookahead ring, then release
+        if (target < reduction_) {
+            reduction_ += (target - reduction_) * attack_;
+            hold_ = holdTicks_;
+        } else if (hold_ > 0) {
+            hold_--;
+        } else {
+            reduction_ += (target - reduction_) * release_;
+        }
+        gainStep_ = (DynExp2(reduction_ + makeup_) - gain_) * (1.f / static_cast<float>(DECIM));
+    }
+};
+
+// Peak, hard knee: set ratio 100, attack 0 and a lookahead of 1 ms or more
+using BusLimiter = BusDynamics<DynPeak, DynHardKnee, 256, 16>;
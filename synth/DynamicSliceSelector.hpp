@@ -5,8 +5,12 @@
 #include <cstdint>
 #include <cmath>
 #include <algorithm>
+#include <cstring>
 #include "pico/critical_section.h"
 #include "pico/time.h"
+#include "SampleStream.hpp"
+#include "SliceEngine.hpp"
+#include "../utils/TripleBuffer.hpp"
 
 class DynamicSliceSelector {
 public:
@@ -35,11 +39,18 @@ private:
     float phrase_awareness_;     // How much to respect phrase structure
     float grid_tightness_;       // How strictly to follow the grid
 
-    // Thread-safe double buffer for slice points
-    std::array<SlicePoint, kMaxSlices> slice_points_a_;
-    std::array<SlicePoint, kMaxSlices> slice_points_b_;
-    const std::array<SlicePoint, kMaxSlices>* active_slices_;
-    std::array<SlicePoint, kMaxSlices>* update_slices_;
+    // Slice points handed from the main thread to the ISR without locking
+    struct SliceSet {
+        std::array<SlicePoint, kMaxSlices> points;
+        int count;
+    };
+    TripleBuffer<SliceSet> slice_sets_;
+    const SliceSet* active_slices_;      // ISR side
+    const SliceSet* latest_slices_;      // Main thread side, last generated
+
+    // Optional onsets (e.g. SamplePack::Info::slices) that grid starts snap to
+    const uint32_t* onsets_;
+    uint32_t num_onsets_;
 
     // Playback state (accessed in ISR)
     uint32_t playback_position_;         // Current position in drum loop
@@ -48,10 +59,8 @@ private:
     uint32_t slice_end_position_;        // Where current slice ends
     bool slice_transition_pending_;      // Flag for slice boundary crossing
 
-    // Thread synchronization
+    // Thread synchronization for loop and stream changes
     critical_section_t cs_;
-    volatile bool update_pending_;       // Flag that new slices are ready
-    volatile int active_num_slices_;     // Thread-safe copy of slice count
 
     // Crossfade state for smooth transitions
     static constexpr int kCrossfadeSamples = 64;  // Short crossfade for glitch-free transitions
@@ -65,6 +74,12 @@ private:
 
     DrumLoop drum_loop_;
 
+    // Optional SRAM read-ahead for the drum loop
+    static constexpr uint32_t kStreamBlockShift = 7;   // 128 floats = 512 bytes per block
+    static constexpr uint32_t kStreamBlockMask = (1u << kStreamBlockShift) - 1;
+    SampleStream* stream_;
+    uint32_t jump_position_;             // Where playback goes after the current slice
+
     // Phrase awareness weights (higher = more likely to slice)
     static constexpr std::array<float, kPhraseLength> phrase_weights_ = {
         1.0f, 0.6f, 0.8f, 0.6f,  // Beat 1: strong, off-beats weaker
@@ -114,14 +129,15 @@ private:
 
     void UpdatePlaybackState() {
         // Check if we need to handle slice updates (called from ISR)
-        if (update_pending_) {
+        if (slice_sets_.Update()) {
+            active_slices_ = &slice_sets_.Front();
             // Find current slice based on new slice configuration
             bool found_current_slice = false;
 
-            for (int i = 0; i < active_num_slices_; ++i) {
-                if ((*active_slices_)[i].active) {
-                    uint32_t slice_start = (*active_slices_)[i].start_sample;
-                    uint32_t slice_end = slice_start + (*active_slices_)[i].length_samples;
+            for (int i = 0; i < active_slices_->count; ++i) {
+                if (active_slices_->points[i].active) {
+                    uint32_t slice_start = active_slices_->points[i].start_sample;
+                    uint32_t slice_end = slice_start + active_slices_->points[i].length_samples;
 
                     // Check if current playback position falls within this slice
                     if (playback_position_ >= slice_start && playback_position_ < slice_end) {
@@ -144,27 +160,89 @@ private:
             }
 
             // If no slice found, default to first slice
-            if (!found_current_slice && active_num_slices_ > 0) {
+            if (!found_current_slice && active_slices_->count > 0) {
                 current_slice_idx_ = 0;
-                slice_start_position_ = (*active_slices_)[0].start_sample;
-                slice_end_position_ = slice_start_position_ + (*active_slices_)[0].length_samples;
+                slice_start_position_ = active_slices_->points[0].start_sample;
+                slice_end_position_ = slice_start_position_ + active_slices_->points[0].length_samples;
                 playback_position_ = slice_start_position_;
             }
 
-            update_pending_ = false;
+            UpdateJumpTarget();
+        }
+    }
+
+    // Read one sample, through the stream if attached (0 beyond the loop)
+    float ReadSample(uint32_t pos) {
+        if (pos >= drum_loop_.length_samples) {
+            return 0.0f;
+        }
+        if (stream_) {
+            const uint32_t block = pos >> kStreamBlockShift;
+            const uint8_t* buffered = stream_->Acquire(block);
+            if (buffered) {
+                float value;
+                memcpy(&value, buffered + (pos & kStreamBlockMask) * sizeof(float), sizeof(float));
+                if (stream_->Release(block, buffered)) {
+                    return value;
+                }
+            }
+        }
+        return drum_loop_.samples[pos];
+    }
+
+    // Find the slice playback will jump to when the current one ends
+    void UpdateJumpTarget() {
+        jump_position_ = 0;
+        for (int i = 0; i < active_slices_->count; ++i) {
+            if (active_slices_->points[i].active &&
+                active_slices_->points[i].start_sample >= slice_end_position_) {
+                jump_position_ = active_slices_->points[i].start_sample;
+                return;
+            }
+        }
+        if (active_slices_->count > 0 && active_slices_->points[0].active) {
+            jump_position_ = active_slices_->points[0].start_sample;
+        }
+    }
+
+    void ConfigureStream() {
+        if (stream_ && drum_loop_.samples && drum_loop_.length_samples > 0) {
+            const size_t bytes = drum_loop_.length_samples * sizeof(float);
+            stream_->Configure(reinterpret_cast<const uint8_t*>(drum_loop_.samples), bytes,
+                               (kStreamBlockMask + 1) * sizeof(float),
+                               0, (drum_loop_.length_samples - 1) >> kStreamBlockShift);
+        }
+    }
+
+    // Nearest onset to pos, if it is within max_distance samples
+    uint32_t SnapToOnset(uint32_t pos, float max_distance) const {
+        if (!onsets_ || num_onsets_ == 0) {
+            return pos;
+        }
+        const uint32_t* next = std::lower_bound(onsets_, onsets_ + num_onsets_, pos);
+        uint32_t best = pos;
+        float best_distance = max_distance;
+        if (next != onsets_ + num_onsets_ && float(*next - pos) <= best_distance) {
+            best = *next;
+            best_distance = float(*next - pos);
+        }
+        if (next != onsets_ && float(pos - next[-1]) <= best_distance) {
+            best = next[-1];
         }
+        return best;
     }
 
     float GetCrossfadedSample(uint32_t pos_a, uint32_t pos_b, float mix) {
-        float sample_a = (pos_a < drum_loop_.length_samples) ? drum_loop_.samples[pos_a] : 0.0f;
-        float sample_b = (pos_b < drum_loop_.length_samples) ? drum_loop_.samples[pos_b] : 0.0f;
+        float sample_a = ReadSample(pos_a);
+        float sample_b = ReadSample(pos_b);
 
         return sample_a * (1.0f - mix) + sample_b * mix;
     }
 
     void GenerateSlicePoints() {
-        // Work on the update buffer
-        auto& slice_points = *update_slices_;
+        // Work on the writer's buffer
+        SliceSet& set = slice_sets_.Back();
+        auto& slice_points = set.points;
         int num_slices = 0;
 
         if (drum_loop_.samples == nullptr || drum_loop_.length_samples == 0) {
@@ -195,9 +273,11 @@ private:
                 float jitter = (FastRandom() - 0.5f) * samples_per_grid * 0.1f * (1.0f - grid_tightness_);
 
                 uint32_t start_sample = uint32_t(std::max(0.0f, base_sample + jitter));
+                start_sample = SnapToOnset(start_sample, samples_per_grid * 0.25f);
 
-                // Ensure we don't exceed bounds
-                if (start_sample < drum_loop_.length_samples) {
+                // Ensure we don't exceed bounds, and snapping kept starts ascending
+                if (start_sample < drum_loop_.length_samples &&
+                    (num_slices == 0 || start_sample > slice_points[num_slices - 1].start_sample)) {
                     slice_points[num_slices].start_sample = start_sample;
                     slice_points[num_slices].active = true;
                     slice_points[num_slices].probability = final_probability;
@@ -230,12 +310,10 @@ private:
             slice_points[i].active = false;
         }
 
-        // Atomically update the active buffer
-        critical_section_enter_blocking(&cs_);
-        std::swap(active_slices_, update_slices_);
-        active_num_slices_ = num_slices;
-        update_pending_ = true;
-        critical_section_exit(&cs_);
+        // Hand the new slices to the ISR
+        set.count = num_slices;
+        latest_slices_ = &set;
+        slice_sets_.Publish();
     }
 
 public:
@@ -244,39 +322,40 @@ public:
         clustering_factor_(0.5f),
         phrase_awareness_(0.7f),
         grid_tightness_(0.8f),
-        active_slices_(&slice_points_a_),
-        update_slices_(&slice_points_b_),
+        active_slices_(nullptr),
+        latest_slices_(nullptr),
+        onsets_(nullptr),
+        num_onsets_(0),
         playback_position_(0),
         current_slice_idx_(0),
         slice_start_position_(0),
         slice_end_position_(0),
         slice_transition_pending_(false),
-        active_num_slices_(0),
-        update_pending_(false),
         crossfade_position_(0),
         crossfading_(false),
         loop_start_time_(0),
         loop_active_(false),
         drum_loop_{nullptr, 0, 44100},
+        stream_(nullptr),
+        jump_position_(0),
         rng_state_(12345) {
 
         // Initialize critical section
         critical_section_init(&cs_);
 
         // Initialize slice points
-        for (auto& slice : slice_points_a_) {
-            slice.start_sample = 0;
-            slice.length_samples = 0;
-            slice.active = false;
-            slice.probability = 0.0f;
-        }
-
-        for (auto& slice : slice_points_b_) {
-            slice.start_sample = 0;
-            slice.length_samples = 0;
-            slice.active = false;
-            slice.probability = 0.0f;
+        for (size_t i = 0; i < 3; ++i) {
+            SliceSet& set = slice_sets_.Raw(i);
+            for (auto& slice : set.points) {
+                slice.start_sample = 0;
+                slice.length_samples = 0;
+                slice.active = false;
+                slice.probability = 0.0f;
+            }
+            set.count = 0;
         }
+        active_slices_ = &slice_sets_.Front();
+        latest_slices_ = active_slices_;
 
         // Initialize crossfade buffer
         for (int i = 0; i < kCrossfadeSamples; ++i) {
@@ -303,6 +382,7 @@ public:
         slice_end_position_ = length_samples;
         crossfading_ = false;
         loop_active_ = true;
+        ConfigureStream();
 
         critical_section_exit(&cs_);
 
@@ -310,6 +390,36 @@ public:
         GenerateSlicePoints();
     }
 
+    // Read the drum loop through an SRAM read-ahead stream, so the audio
+    // callback does not touch flash/PSRAM. Add the stream to a SampleStreamer
+    // serviced from the other core. Call from the main thread, like SetDrumLoop.
+    void SetStream(SampleStream* stream) {
+        critical_section_enter_blocking(&cs_);
+        stream_ = stream;
+        ConfigureStream();
+        critical_section_exit(&cs_);
+    }
+
+    // Snap generated slice starts to the nearest onset within a quarter of a
+    // grid step, e.g. the onsets stored in the sample pack
+    // (SamplePack::Info::slices). Ascending; must stay valid. Main thread only.
+    void SetOnsets(const uint32_t* onsets, uint32_t count) {
+        onsets_ = onsets;
+        num_onsets_ = onsets ? count : 0;
+        GenerateSlicePoints();
+    }
+
+    // Copy the current slices into a SliceTable for SlicedLoop, with a
+    // pattern that plays them in order over num_steps steps. Main thread only.
+    void FillSliceTable(SliceTable& table, size_t num_steps = kGridResolution) const {
+        uint32_t starts[kMaxSlices];
+        size_t count = 0;
+        for (int i = 0; i < latest_slices_->count; ++i) {
+            starts[count++] = latest_slices_->points[i].start_sample;
+        }
+        table.SetFromOnsets(starts, count, drum_loop_.length_samples, num_steps);
+    }
+
     void ProcessParams(const std::vector<float>& params) {
         if (params.size() != kN_Params) return;
 
@@ -336,8 +446,7 @@ public:
         // Handle crossfading between slices
         if (crossfading_) {
             // Get current sample and previous slice sample for crossfade
-            float current_sample = (playback_position_ < drum_loop_.length_samples) ?
-                drum_loop_.samples[playback_position_] : 0.0f;
+            float current_sample = ReadSample(playback_position_);
 
             float fade_ratio = float(crossfade_position_) / float(kCrossfadeSamples);
 
@@ -352,8 +461,7 @@ public:
             }
         } else {
             // Normal playback
-            output_sample = (playback_position_ < drum_loop_.length_samples) ?
-                drum_loop_.samples[playback_position_] : 0.0f;
+            output_sample = ReadSample(playback_position_);
         }
 
         // Advance playback position
@@ -365,22 +473,22 @@ public:
             bool found_next_slice = false;
 
             // First, try to find a slice that starts at or after current position
-            for (int i = 0; i < active_num_slices_; ++i) {
-                if ((*active_slices_)[i].active &&
-                    (*active_slices_)[i].start_sample >= playback_position_) {
+            for (int i = 0; i < active_slices_->count; ++i) {
+                if (active_slices_->points[i].active &&
+                    active_slices_->points[i].start_sample >= playback_position_) {
 
                     // Prepare crossfade buffer with current slice end
                     for (int j = 0; j < kCrossfadeSamples && j < slice_end_position_ - slice_start_position_; ++j) {
                         uint32_t pos = slice_end_position_ - kCrossfadeSamples + j;
-                        crossfade_buffer_[j] = (pos < drum_loop_.length_samples) ?
-                            drum_loop_.samples[pos] : 0.0f;
+                        crossfade_buffer_[j] = ReadSample(pos);
                     }
 
                     // Jump to new slice
                     current_slice_idx_ = i;
-                    slice_start_position_ = (*active_slices_)[i].start_sample;
-                    slice_end_position_ = slice_start_position_ + (*active_slices_)[i].length_samples;
+                    slice_start_position_ = active_slices_->points[i].start_sample;
+                    slice_end_position_ = slice_start_position_ + active_slices_->points[i].length_samples;
                     playback_position_ = slice_start_position_;
+                    UpdateJumpTarget();
 
                     crossfading_ = true;
                     crossfade_position_ = 0;
@@ -394,36 +502,41 @@ public:
                 // Prepare crossfade buffer
                 for (int j = 0; j < kCrossfadeSamples; ++j) {
                     uint32_t pos = slice_end_position_ - kCrossfadeSamples + j;
-                    crossfade_buffer_[j] = (pos < drum_loop_.length_samples) ?
-                        drum_loop_.samples[pos] : 0.0f;
+                    crossfade_buffer_[j] = ReadSample(pos);
                 }
 
                 // Go to first slice
                 current_slice_idx_ = 0;
-                if (active_num_slices_ > 0 && (*active_slices_)[0].active) {
-                    slice_start_position_ = (*active_slices_)[0].start_sample;
-                    slice_end_position_ = slice_start_position_ + (*active_slices_)[0].length_samples;
+                if (active_slices_->count > 0 && active_slices_->points[0].active) {
+                    slice_start_position_ = active_slices_->points[0].start_sample;
+                    slice_end_position_ = slice_start_position_ + active_slices_->points[0].length_samples;
                 } else {
                     slice_start_position_ = 0;
                     slice_end_position_ = drum_loop_.length_samples;
                 }
 
                 playback_position_ = slice_start_position_;
+                UpdateJumpTarget();
                 crossfading_ = true;
                 crossfade_position_ = 0;
             }
         }
 
+        if (stream_) {
+            stream_->SetPlayhead(playback_position_ >> kStreamBlockShift, 1,
+                                 jump_position_ >> kStreamBlockShift);
+        }
+
         return output_sample;
     }
 
     // Get current slice configuration (thread-safe)
     const SlicePoint* GetSlicePoints() const {
-        return active_slices_->data();
+        return active_slices_->points.data();
     }
 
     int GetNumActiveSlices() const {
-        return active_num_slices_;
+        return active_slices_->count;
     }
 
     // Get current playback info (for debugging/visualization)
@@ -437,11 +550,11 @@ public:
 
     // Get slice at specific position (for external playback systems)
     const SlicePoint* GetSliceAtPosition(uint32_t sample_position) const {
-        for (int i = 0; i < active_num_slices_; ++i) {
-            if ((*active_slices_)[i].active &&
-                sample_position >= (*active_slices_)[i].start_sample &&
-                sample_position < (*active_slices_)[i].start_sample + (*active_slices_)[i].length_samples) {
-                return &(*active_slices_)[i];
+        for (int i = 0; i < active_slices_->count; ++i) {
+            if (active_slices_->points[i].active &&
+                sample_position >= active_slices_->points[i].start_sample &&
+                sample_position < active_slices_->points[i].start_sample + active_slices_->points[i].length_samples) {
+                return &active_slices_->points[i];
             }
         }
         return nullptr;
@@ -452,11 +565,11 @@ public:
         critical_section_enter_blocking(const_cast<critical_section_t*>(&cs_));
 
         // Only implement if you have debug output capability
-        // for (int i = 0; i < active_num_slices_; ++i) {
+        // for (int i = 0; i < active_slices_->count; ++i) {
         //     printf("Slice %d: start=%u, length=%u, prob=%.2f\n",
-        //            i, (*active_slices_)[i].start_sample,
-        //            (*active_slices_)[i].length_samples,
-        //            (*active_slices_)[i].probability);
+        //            i, active_slices_->points[i].start_sample,
+        //            active_slices_->points[i].length_samples,
+        //            active_slices_->points[i].probability);
         // }
         // printf("Playback: pos=%u, slice=%d, crossfade=%d\n",
         //        playback_position_, current_slice_idx_, crossfading_);
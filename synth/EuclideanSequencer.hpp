@@ -0,0 +1,436 @@
+#ifndef __EUCLIDEAN_SEQUENCER_HPP__
+#define __EUCLIDEAN_SEQUENCER_HPP__
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#include "../utils/TripleBuffer.hpp"
+#include "../utils/SPSCRing.hpp"
+
+
+/**
+ * @brief Euclidean rhythms as bitsets: bit i is set if step i is a hit.
+ *
+ * Every pattern up to kMaxSteps steps is worked out at compile time (the
+ * same distribution as EuclideanAudioApp::euclidean()), so a pattern
+ * change is a table lookup and a rotation.
+ */
+namespace Euclidean {
+
+constexpr size_t kMaxSteps = 32;
+
+constexpr uint32_t Compute(size_t hits, size_t steps) {
+    uint32_t bits = 0;
+    if (hits == 0 || steps == 0 || hits > steps) {
+        return 0;
+    }
+    for (size_t i = 0; i < steps; i++) {
+        if ((i * hits) / steps != (((i + steps - 1) % steps) * hits) / steps) {
+            bits |= 1u << i;
+        }
+    }
+    return bits;
+}
+
+constexpr std::array<uint32_t, (kMaxSteps + 1) * (kMaxSteps + 1)> MakeTable_() {
+    std::array<uint32_t, (kMaxSteps + 1) * (kMaxSteps + 1)> table{};
+    for (size_t steps = 1; steps <= kMaxSteps; steps++) {
+        for (size_t hits = 0; hits <= steps; hits++) {
+            table[steps * (kMaxSteps + 1) + hits] = Compute(hits, steps);
+        }
+    }
+    return table;
+}
+
+inline constexpr auto kTable = MakeTable_();
+
+/**
+ * @brief E(hits, steps), rotated left by rotation steps (any rotation of
+ * the necklace).
+ */
+inline uint32_t Pattern(size_t hits, size_t steps, size_t rotation = 0) {
+    if (steps == 0) {
+        return 0;
+    }
+    steps = steps > kMaxSteps ? kMaxSteps : steps;
+    hits = hits > steps ? steps : hits;
+    const uint32_t bits = kTable[steps * (kMaxSteps + 1) + hits];
+    rotation %= steps;
+    if (!rotation) {
+        return bits;
+    }
+    const uint32_t mask = steps == 32 ? 0xFFFFFFFFu : (1u << steps) - 1;
+    return ((bits >> rotation) | (bits << (steps - rotation))) & mask;
+}
+
+} // namespace Euclidean
+
+
+/**
+ * @brief Per-step timing and velocity offsets, applied when events are
+ * scheduled. Indexed by step within the bar.
+ */
+struct GrooveTemplate {
+    static constexpr size_t kSteps = 16;
+
+    float timing[kSteps];       // Delay, as a fraction of a step, 0 to < 1
+    float velocity[kSteps];     // Velocity scale
+
+    static GrooveTemplate Straight() {
+        GrooveTemplate g{};
+        for (size_t i = 0; i < kSteps; i++) {
+            g.velocity[i] = 1.f;
+        }
+        return g;
+    }
+
+    /**
+     * @brief MPC-style swing: the off-beat sixteenths land at amount of the
+     * way through each eighth. 0.5 is straight, 0.67 triplet, 0.75 the most.
+     */
+    static GrooveTemplate Swing(float amount) {
+        GrooveTemplate g = Straight();
+        amount = amount < 0.5f ? 0.5f : (amount > 0.75f ? 0.75f : amount);
+        for (size_t i = 1; i < kSteps; i += 2) {
+            g.timing[i] = (amount - 0.5f) * 2.f;
+        }
+        return g;
+    }
+};
+
+
+/**
+ * @brief Everything the sequencer plays, swapped in as a whole at a bar
+ * line.
+ *
+ * Tracks may have different lengths (polymeter); each restarts from its
+ * first step at the bar where the patterns were swapped in.
+ */
+struct SequencerPatterns {
+    static constexpr size_t kMaxTracks = 16;
+
+    struct Track {
+        uint32_t bits;      // Bit i: hit on step i
+        uint8_t length;     // Steps before the pattern repeats, 0 = track off
+        uint8_t note;       // MIDI note
+        uint8_t channel;    // MIDI channel 1-16, 0 = no MIDI
+        uint8_t velocity;   // 1-127
+        float gate;         // MIDI note length, as a fraction of a step
+    };
+
+    Track tracks[kMaxTracks];
+    GrooveTemplate groove;
+
+    SequencerPatterns() : groove(GrooveTemplate::Straight()) {
+        for (size_t t = 0; t < kMaxTracks; t++) {
+            // General MIDI drums from the kick up
+            tracks[t] = { 0, 0, static_cast<uint8_t>(36 + t), 10, 100, 0.5f };
+        }
+    }
+
+    void SetEuclid(size_t track, size_t hits, size_t steps, size_t rotation = 0) {
+        if (track < kMaxTracks) {
+            steps = steps > Euclidean::kMaxSteps ? Euclidean::kMaxSteps : steps;
+            tracks[track].bits = Euclidean::Pattern(hits, steps, rotation);
+            tracks[track].length = static_cast<uint8_t>(steps);
+        }
+    }
+
+    void SetBits(size_t track, uint32_t bits, size_t steps) {
+        if (track < kMaxTracks) {
+            tracks[track].bits = bits;
+            tracks[track].length = static_cast<uint8_t>(
+                steps > Euclidean::kMaxSteps ? Euclidean::kMaxSteps : steps);
+        }
+    }
+};
+
+
+/**
+ * @brief Multi-track step sequencer driven by the audio sample clock.
+ *
+ * Process() is called once per audio block and returns the hits falling
+ * in that block with their sample offsets, ready for offset-aware
+ * triggers such as BlockADSRVoice::trigger(). Timing comes from a Q32
+ * step position advanced per block, so it does not depend on when loops
+ * or callbacks run: events land within a sample of the grid and the tempo
+ * is exact to about a part per million. Groove delays are added per
+ * event, and can push an event into a later block.
+ *
+ * Tracks with a MIDI channel also produce note on/off messages stamped
+ * with their sample time, into a lock-free ring. SendMIDI() (main loop or
+ * the other core) sends the ones that are due, so a constant latency of
+ * at least a block keeps MIDI in time with the audio:
+ *
+ *     seq.SendMIDI(*midi, seq.Time() - latency);
+ *     midi->flushQueue();
+ *
+ * Patterns are edited with EditPatterns() and PublishPatterns() and take
+ * effect at the next bar line (see TripleBuffer).
+ *
+ * @tparam kMIDIRing MIDI ring capacity in messages, power of 2.
+ */
+template<size_t kMIDIRing = 256>
+class EuclideanSequencer {
+public:
+    static constexpr size_t kMaxTracks = SequencerPatterns::kMaxTracks;
+    static constexpr float kStepsPerBeat = 4.f;
+
+    struct Event {
+        uint32_t offset;    // Sample in the block
+        uint8_t track;
+        float velocity;     // 0-1, groove applied
+    };
+
+    struct MIDIEvent {
+        uint32_t time;      // Sample clock, see Time()
+        uint8_t status;     // Note on or off, with channel
+        uint8_t note;
+        uint8_t velocity;
+    };
+
+    EuclideanSequencer() :
+        sample_rate_(48000.f),
+        inc_(0),
+        steps_per_bar_(16),
+        table_(nullptr),
+        pos_(0),
+        next_step_(0),
+        origin_(0),
+        time_(0),
+        off_pending_(0),
+        dropped_(0),
+        run_(false),
+        restart_(false),
+        running_(false) {
+        table_ = &patterns_.Front();
+        SetTempo(120.f);
+    }
+
+    /**
+     * @brief Call before Start().
+     */
+    void Setup(float sample_rate, size_t steps_per_bar = 16) {
+        sample_rate_ = sample_rate;
+        steps_per_bar_ = steps_per_bar ? static_cast<uint32_t>(steps_per_bar) : 16;
+        SetTempo(bpm_);
+    }
+
+    void SetTempo(float bpm) {
+        if (bpm <= 0.f || bpm > 999.f) {
+            return;
+        }
+        bpm_ = bpm;
+        // Steps per sample, Q32
+        inc_ = static_cast<uint32_t>(bpm * (kStepsPerBeat / 60.f) / sample_rate_ * 4294967296.f);
+    }
+
+    /**
+     * @brief Start from the first step of a bar at the next Process() call.
+     */
+    void Start() {
+        restart_ = true;
+        run_ = true;
+    }
+
+    /**
+     * @brief Stop at the next Process() call, ending any MIDI notes.
+     */
+    void Stop() {
+        run_ = false;
+    }
+
+    bool IsRunning() const { return run_; }
+
+    /**
+     * @brief Sample clock at the end of the last block.
+     */
+    uint32_t Time() const { return time_; }
+
+    /**
+     * @brief MIDI messages dropped because the ring was full.
+     */
+    uint32_t DroppedMIDI() const { return dropped_; }
+
+    /**
+     * @brief Main loop: the patterns to edit. They start as a copy of the
+     * last published ones.
+     */
+    SequencerPatterns &EditPatterns() { return patterns_.Back(); }
+
+    /**
+     * @brief Main loop: hand the edited patterns to the audio side, for
+     * the next bar.
+     */
+    void PublishPatterns() {
+        const SequencerPatterns *sent = &patterns_.Back();
+        patterns_.Publish();
+        // The reader never writes, so the one just sent can be read
+        patterns_.Back() = *sent;
+    }
+
+    /**
+     * @brief Audio side: advance by one block of n samples.
+     *
+     * @param events Filled with the hits in this block, in time order.
+     * @param max_events Size of events; further hits are not reported.
+     * @return Number of events.
+     */
+    size_t Process(size_t n, Event *events, size_t max_events) {
+        size_t count = 0;
+        const uint32_t t0 = time_;
+        if (restart_) {
+            restart_ = false;
+            EndNotes_(t0);
+            pos_ = 0;
+            next_step_ = 0;
+            origin_ = 0;
+            running_ = true;
+        }
+        if (running_ && !run_) {
+            running_ = false;
+            EndNotes_(t0);
+        }
+        if (running_ && n) {
+            const uint32_t inc = inc_;
+            const float inv_inc = 1.f / static_cast<float>(inc);
+            const uint64_t p0 = pos_;
+            const uint64_t p1 = p0 + static_cast<uint64_t>(inc) * n;
+            for (;;) {
+                const uint32_t s = next_step_;
+                const uint32_t in_bar = s % steps_per_bar_;
+                if (in_bar == 0 && patterns_.Update()) {
+                    table_ = &patterns_.Front();
+                    origin_ = s;
+                }
+                const GrooveTemplate &groove = table_->groove;
+                const size_t g = in_bar % GrooveTemplate::kSteps;
+                const float delay = groove.timing[g] < 0.f ? 0.f :
+                    (groove.timing[g] > 0.999f ? 0.999f : groove.timing[g]);
+                const uint64_t at = (static_cast<uint64_t>(s) << 32) +
+                                    static_cast<uint32_t>(delay * 4294967296.f);
+                if (at >= p1) {
+                    break;
+                }
+                uint32_t offset = at <= p0 ? 0 :
+                    static_cast<uint32_t>(static_cast<float>(at - p0) * inv_inc);
+                offset = offset < n ? offset : static_cast<uint32_t>(n - 1);
+                Step_(s, offset, t0, groove.velocity[g], inv_inc, events, max_events, count);
+                next_step_ = s + 1;
+            }
+            pos_ = p1;
+        }
+        EndNotes_(t0 + static_cast<uint32_t>(n) - 1, false);
+        time_ = t0 + static_cast<uint32_t>(n);
+        return count;
+    }
+
+    /**
+     * @brief Send the MIDI messages stamped at or before now (sample
+     * clock). Call from one place only, e.g. the MIDI core's loop.
+     *
+     * @tparam MIDI MIDIInOut or anything with the same queueNoteOn(),
+     * queueNoteOff() and SetMIDINoteChannel().
+     * @return Number of messages queued.
+     */
+    template<typename MIDI>
+    size_t SendMIDI(MIDI &midi, uint32_t now) {
+        MIDIEvent e;
+        size_t sent = 0;
+        while (midi_.Peek(e) && static_cast<int32_t>(e.time - now) <= 0) {
+            midi_.Pop(&e, 1);
+            midi.SetMIDINoteChannel((e.status & 0x0F) + 1);
+            if ((e.status & 0xF0) == 0x90) {
+                midi.queueNoteOn(e.note, e.velocity);
+            } else {
+                midi.queueNoteOff(e.note, 0);
+            }
+            sent++;
+        }
+        return sent;
+    }
+
+protected:
+    float sample_rate_;
+    float bpm_ = 120.f;
+    volatile uint32_t inc_;
+    uint32_t steps_per_bar_;
+    TripleBuffer<SequencerPatterns> patterns_;
+    const SequencerPatterns *table_;
+    uint64_t pos_;                  // Step position, Q32
+    uint32_t next_step_;            // First step not yet played
+    uint32_t origin_;               // Step the current patterns started on
+    volatile uint32_t time_;
+    uint32_t off_pending_;          // Tracks with a MIDI note to end
+    uint32_t off_time_[kMaxTracks];
+    uint8_t off_status_[kMaxTracks];
+    uint8_t off_note_[kMaxTracks];
+    volatile uint32_t dropped_;
+    volatile bool run_;
+    volatile bool restart_;
+    bool running_;
+    SPSCRing<MIDIEvent, kMIDIRing> midi_;
+
+    inline void Push_(uint32_t time, uint8_t status, uint8_t note, uint8_t velocity) {
+        if (!midi_.Push({ time, status, note, velocity })) {
+            dropped_ = dropped_ + 1;
+        }
+    }
+
+    // Note offs due by until, oldest first; with all set, every pending
+    // note ends at until
+    void EndNotes_(uint32_t until, bool all = true) {
+        while (off_pending_) {
+            size_t first = kMaxTracks;
+            for (size_t t = 0; t < kMaxTracks; t++) {
+                if ((off_pending_ >> t) & 1) {
+                    if (first == kMaxTracks ||
+                        static_cast<int32_t>(off_time_[t] - off_time_[first]) < 0) {
+                        first = t;
+                    }
+                }
+            }
+            const bool due = static_cast<int32_t>(off_time_[first] - until) <= 0;
+            if (!due && !all) {
+                return;
+            }
+            Push_(due ? off_time_[first] : until, off_status_[first], off_note_[first], 0);
+            off_pending_ &= ~(1u << first);
+        }
+    }
+
+    void Step_(uint32_t s, uint32_t offset, uint32_t t0, float groove_velocity, float inv_inc,
+               Event *events, size_t max_events, size_t &count) {
+        const uint32_t time = t0 + offset;
+        for (size_t t = 0; t < kMaxTracks; t++) {
+            const SequencerPatterns::Track &track = table_->tracks[t];
+            if (!track.length || !((track.bits >> ((s - origin_) % track.length)) & 1)) {
+                continue;
+            }
+            float velocity = static_cast<float>(track.velocity) * groove_velocity;
+            velocity = velocity < 1.f ? 1.f : (velocity > 127.f ? 127.f : velocity);
+            if (count < max_events) {
+                events[count++] = { offset, static_cast<uint8_t>(t), velocity * (1.f / 127.f) };
+            }
+            if (track.channel < 1 || track.channel > 16) {
+                continue;
+            }
+            // Offs due first, then this track's own note if it is still on
+            EndNotes_(time, false);
+            if ((off_pending_ >> t) & 1) {
+                Push_(time, off_status_[t], off_note_[t], 0);
+            }
+            const uint8_t channel = static_cast<uint8_t>(track.channel - 1);
+            Push_(time, static_cast<uint8_t>(0x90 | channel), track.note,
+                  static_cast<uint8_t>(velocity + 0.5f));
+            const float gate = track.gate * inv_inc * 4294967296.f;
+            off_time_[t] = time + (gate < 1.f ? 1u : static_cast<uint32_t>(gate));
+            off_status_[t] = static_cast<uint8_t>(0x80 | channel);
+            off_note_[t] = track.note;
+            off_pending_ |= 1u << t;
+        }
+    }
+};
+
+#endif // __EUCLIDEAN_SEQUENCER_HPP__
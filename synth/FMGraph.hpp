@@ -0,0 +1,334 @@
+#pragma once
+
+#include "maximilian.h"
+#include <cstdint>
+#include <utility>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// FM algorithms
+// An algorithm is a struct of constants: kOps operators, numbered from 0
+// (output side) up. kMods[i] is a bitmask of the operators that modulate
+// operator i, which must all have higher numbers, so one pass from the top
+// operator down evaluates the graph. kCarriers is a bitmask of the
+// operators summed to the output; kFeedback is the operator fed back into
+// itself. All of it is resolved at compile time by FMVoice.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// 3 → 2 → 1 → 0
+struct FMAlgo4Stack {
+    static constexpr size_t kOps = 4;
+    static constexpr uint32_t kMods[kOps] = {0b0010, 0b0100, 0b1000, 0};
+    static constexpr uint32_t kCarriers = 0b0001;
+    static constexpr size_t kFeedback = 3;
+};
+
+// (3 + 2) → 1 → 0
+struct FMAlgo4Branch {
+    static constexpr size_t kOps = 4;
+    static constexpr uint32_t kMods[kOps] = {0b0010, 0b1100, 0, 0};
+    static constexpr uint32_t kCarriers = 0b0001;
+    static constexpr size_t kFeedback = 3;
+};
+
+// 3 → 2, 1 → 0: two 2-op pairs, as FMSynth
+struct FMAlgo4Pairs {
+    static constexpr size_t kOps = 4;
+    static constexpr uint32_t kMods[kOps] = {0b0010, 0, 0b1000, 0};
+    static constexpr uint32_t kCarriers = 0b0101;
+    static constexpr size_t kFeedback = 3;
+};
+
+// 3 → (2, 1, 0)
+struct FMAlgo4Fan {
+    static constexpr size_t kOps = 4;
+    static constexpr uint32_t kMods[kOps] = {0b1000, 0b1000, 0b1000, 0};
+    static constexpr uint32_t kCarriers = 0b0111;
+    static constexpr size_t kFeedback = 3;
+};
+
+// DX7 algorithm 1: 1 → 0, 5 → 4 → 3 → 2
+struct FMAlgo6DX1 {
+    static constexpr size_t kOps = 6;
+    static constexpr uint32_t kMods[kOps] = {0b000010, 0, 0b001000, 0b010000, 0b100000, 0};
+    static constexpr uint32_t kCarriers = 0b000101;
+    static constexpr size_t kFeedback = 5;
+};
+
+// DX7 algorithm 5: 1 → 0, 3 → 2, 5 → 4
+struct FMAlgo6DX5 {
+    static constexpr size_t kOps = 6;
+    static constexpr uint32_t kMods[kOps] = {0b000010, 0, 0b001000, 0, 0b100000, 0};
+    static constexpr uint32_t kCarriers = 0b010101;
+    static constexpr size_t kFeedback = 5;
+};
+
+// DX7 algorithm 32: six sines, additive
+struct FMAlgo6Additive {
+    static constexpr size_t kOps = 6;
+    static constexpr uint32_t kMods[kOps] = {0, 0, 0, 0, 0, 0};
+    static constexpr uint32_t kCarriers = 0b111111;
+    static constexpr size_t kFeedback = 5;
+};
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// FMEnvelope
+// ADSR advanced once per block: linear attack, exponential decay and
+// release. FMVoice interpolates each operator's gain across the block.
+// ─────────────────────────────────────────────────────────────────────────────
+class FMEnvelope {
+public:
+    enum Stage { kIdle, kAttack, kDecay, kSustain, kRelease };
+
+    // Times in ms; blockRate is blocks per second
+    void set(float attack, float decay, float sustain, float release, float blockRate) {
+        attackStep_ = attack <= 0.f ? 1.f : 1000.f / (attack * blockRate);
+        decayCoef_ = timeToCoef_(decay, blockRate);
+        sustain_ = sustain;
+        releaseCoef_ = timeToCoef_(release, blockRate);
+    }
+
+    inline void gate(bool on) {
+        stage_ = on ? kAttack : (stage_ == kIdle ? kIdle : kRelease);
+    }
+
+    inline float level() const { return level_; }
+    inline bool idle() const { return stage_ == kIdle; }
+
+    float advance() {
+        switch (stage_) {
+            case kAttack:
+                level_ += attackStep_;
+                if (level_ >= 1.f) {
+                    level_ = 1.f;
+                    stage_ = kDecay;
+                }
+                break;
+            case kDecay:
+                level_ = sustain_ + (level_ - sustain_) * decayCoef_;
+                if (level_ - sustain_ < 1e-4f) {
+                    level_ = sustain_;
+                    stage_ = kSustain;
+                }
+                break;
+            case kRelease:
+                level_ *= releaseCoef_;
+                if (level_ < 1e-4f) {
+                    level_ = 0.f;
+                    stage_ = kIdle;
+                }
+                break;
+            default:
+                break;
+        }
+        return level_;
+    }
+
+private:
+    Stage stage_ = kIdle;
+    float level_ = 0.f;
+    float attackStep_ = 1.f;
+    float decayCoef_ = 0.f;
+    float sustain_ = 1.f;
+    float releaseCoef_ = 0.f;
+
+    // Per-block factor that falls to -80 dB in the given time
+    static float timeToCoef_(float ms, float blockRate) {
+        return ms <= 0.f ? 0.f : expf(-9.21f * 1000.f / (ms * blockRate));
+    }
+};
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// FMVoice
+// One FM voice with its operator graph fixed by Algo (see above). Operators
+// are 32-bit phase accumulators reading the 512-point sineBuffer with
+// linear interpolation; modulation is added to the phase in radians (an
+// operator's level is its modulation index when it modulates).
+// Envelopes, levels and feedback are updated once per BLOCK samples and
+// ramped across it, so the per-sample work is the unrolled graph only.
+//   setOperator(op, ratio, detuneHz, level)
+//   setEnvelope(op, attackMs, decayMs, sustain, releaseMs)
+//   noteOn(freq, velocity) / noteOff() / setFrequency(freq)
+//   process(out, n)   writes n samples, any n
+// ─────────────────────────────────────────────────────────────────────────────
+template<typename Algo, size_t BLOCK = 32>
+class FMVoice {
+    static constexpr size_t N = Algo::kOps;
+
+    static constexpr bool validGraph_() {
+        for (size_t i = 0; i < N; i++) {
+            if (Algo::kMods[i] & ((2u << i) - 1u)) return false;   // Only higher operators
+            if (Algo::kMods[i] >> N) return false;
+        }
+        return Algo::kCarriers != 0 && (Algo::kCarriers >> N) == 0 && Algo::kFeedback < N;
+    }
+    static_assert(N >= 1 && N <= 16, "1 to 16 operators");
+    static_assert(validGraph_(), "Operators may only be modulated by higher-numbered operators");
+
+public:
+    static constexpr size_t kOps = N;
+
+    FMVoice() {
+        st_.fb = st_.fbPrev = 0.f;
+        for (size_t i = 0; i < N; i++) {
+            ratio_[i] = 1.f;
+            detune_[i] = 0.f;
+            level_[i] = isCarrier_(i) ? 1.f / static_cast<float>(__builtin_popcount(Algo::kCarriers)) : 1.f;
+            st_.phase[i] = 0;
+            st_.gain[i] = 0.f;
+            st_.out[i] = 0.f;
+            inc_[i] = 0;
+            gainStep_[i] = 0.f;
+            setEnvelope(i, 5.f, 300.f, 0.7f, 200.f);
+        }
+    }
+
+    inline void setOperator(size_t op, float ratio, float detune, float level) {
+        ratio_[op] = ratio;
+        detune_[op] = detune;
+        level_[op] = level;
+        updateIncs_();
+    }
+
+    inline void setEnvelope(size_t op, float attack, float decay, float sustain, float release) {
+        env_[op].set(attack, decay, sustain, release,
+                     maxiSettings::sampleRate / static_cast<float>(BLOCK));
+    }
+
+    // Feedback on operator Algo::kFeedback, as a modulation index
+    inline void setFeedback(float fb) { fbTarget_ = fb; }
+
+    inline void setFrequency(float freq) {
+        freq_ = freq;
+        updateIncs_();
+    }
+
+    void noteOn(float freq, float velocity = 1.f) {
+        velocity_ = velocity;
+        setFrequency(freq);
+        for (auto &e : env_) {
+            e.gate(true);
+        }
+    }
+
+    void noteOff() {
+        for (auto &e : env_) {
+            e.gate(false);
+        }
+    }
+
+    // False once every carrier has finished its release
+    bool isActive() const {
+        for (size_t i = 0; i < N; i++) {
+            if (isCarrier_(i) && !env_[i].idle()) return true;
+        }
+        return false;
+    }
+
+    void process(float *out, size_t n) {
+        while (n > 0) {
+            if (remaining_ == 0) {
+                control_();
+            }
+            const size_t run = n < remaining_ ? n : remaining_;
+            // Work on a local copy, so the state lives in registers
+            State st = st_;
+            for (size_t s = 0; s < run; s++) {
+                out[s] = tick_(st, std::make_index_sequence<N>{});
+            }
+            st_ = st;
+            out += run;
+            n -= run;
+            remaining_ -= run;
+        }
+    }
+
+private:
+    static constexpr float kPhaseScale = 4294967296.f;                // 2^32
+    static constexpr float kRadToQ24 = 16777216.f * 0.159154943f;     // 2^24 / 2pi
+    static constexpr float kMaxMod = 800.f;                            // Radians
+
+    // Per-sample state
+    struct State {
+        uint32_t phase[N];
+        float gain[N];
+        float out[N];
+        float fb, fbPrev;
+    };
+
+    State st_;
+    float ratio_[N], detune_[N], level_[N];
+    uint32_t inc_[N];
+    float gainStep_[N];
+    FMEnvelope env_[N];
+    float freq_ = 440.f;
+    float velocity_ = 1.f;
+    float fbStep_ = 0.f, fbTarget_ = 0.f;
+    size_t remaining_ = 0;
+
+    static constexpr bool isCarrier_(size_t i) { return (Algo::kCarriers >> i) & 1u; }
+    static constexpr bool modulates_(size_t by, size_t i) { return (Algo::kMods[i] >> by) & 1u; }
+
+    void updateIncs_() {
+        const float scale = kPhaseScale * maxiSettings::one_over_sampleRate;
+        for (size_t i = 0; i < N; i++) {
+            float f = freq_ * ratio_[i] + detune_[i];
+            f = f < 0.f ? 0.f : (f > 0.5f * maxiSettings::sampleRate ? 0.5f * maxiSettings::sampleRate : f);
+            inc_[i] = static_cast<uint32_t>(f * scale);
+        }
+    }
+
+    // Once per block: envelope levels become per-sample gain ramps
+    void control_() {
+        const float inv = 1.f / static_cast<float>(BLOCK);
+        for (size_t i = 0; i < N; i++) {
+            const float target = env_[i].advance() * level_[i] * (isCarrier_(i) ? velocity_ : 1.f);
+            gainStep_[i] = (target - st_.gain[i]) * inv;
+        }
+        fbStep_ = (fbTarget_ - st_.fb) * inv;
+        remaining_ = BLOCK;
+    }
+
+    static float __force_inline sine_(uint32_t p) {
+        const uint32_t i = p >> 23;                                        // 512 points
+        const float frac = static_cast<float>(p & 0x7fffffu) * (1.f / 8388608.f);
+        return sineBuffer[i] + frac * (sineBuffer[i + 1] - sineBuffer[i]);
+    }
+
+    // Phase offset for a modulation in radians: Q24 cycles in an int32
+    // (±128 cycles), shifted up so the whole cycles wrap away
+    static uint32_t __force_inline modPhase_(float rad) {
+        rad = rad > kMaxMod ? kMaxMod : (rad < -kMaxMod ? -kMaxMod : rad);
+        return static_cast<uint32_t>(static_cast<int32_t>(rad * kRadToQ24)) << 8;
+    }
+
+    // Sums over operators use -0 as the empty term: x + -0 is exactly x,
+    // so the compiler drops the terms the graph doesn't have
+    template<size_t I, size_t... J>
+    static float __force_inline modSum_(const State &st, std::index_sequence<J...>) {
+        return (-0.f + ... + (modulates_(J, I) ? st.out[J] : -0.f));
+    }
+
+    template<size_t I>
+    void __force_inline op_(State &st) const {
+        float mod = modSum_<I>(st, std::make_index_sequence<N>{});
+        if constexpr (I == Algo::kFeedback) {
+            // Average of the last two outputs, as in the DX7, to tame the
+            // feedback loop's tendency to oscillate
+            mod += st.fb * 0.5f * (st.out[I] + st.fbPrev);
+            st.fbPrev = st.out[I];
+        }
+        st.gain[I] += gainStep_[I];
+        const uint32_t p = st.phase[I] + (Algo::kMods[I] || I == Algo::kFeedback ? modPhase_(mod) : 0u);
+        st.out[I] = sine_(p) * st.gain[I];
+        st.phase[I] += inc_[I];
+    }
+
+    template<size_t... I>
+    float __force_inline tick_(State &st, std::index_sequence<I...>) const {
+        st.fb += fbStep_;
+        (op_<N - 1 - I>(st), ...);                                          // Top operator first
+        return (-0.f + ... + (isCarrier_(I) ? st.out[I] : -0.f));
+    }
+};
@@ -31,14 +31,18 @@ void FMSynth::UpdateParams() {
 }
 
 FMSynth::FMSynth(float sample_rate) :
-    smoother_(100.f, sample_rate),
-    envelope_smoother_(10.f, sample_rate),
+    smoother_(sample_rate),
+    envelope_target_(0),
     note_freq_(0),
     note_amplitude_(0),
     play_note_(false),
     midi_enabled_(false)
 {
     // std::srand(0);
+    for (size_t i = 0; i < kN_synthparams; i++) {
+        smoother_.Register(100.f);
+    }
+    smoother_.Register(10.f);
     maxiSettings::setup(sample_rate, 1, 16);
     UpdateParams();
     std::vector<float> randParams(kN_synthparams);
@@ -80,7 +84,7 @@ void FMSynth::mapParameters(const std::vector<float> &params) {
 
     *dest_ptr++ = (*(params_ptr++) * 200);
 
-
+    smoother_.SetTargets(synthparams.data(), kN_synthparams);
 }
 
 inline float midiNoteToFrequency(int midiNote) {
@@ -99,7 +103,7 @@ maxiOsc tmposc;
 float FMSynth::process()
 {
     // Smooth all parameters before using them
-    smoother_.Process(synthparams.data(), synthparams_smoothed.data());
+    smoother_.Tick();
 
     float carrier_1, carrier_2, envelope;
 
@@ -119,23 +123,25 @@ float FMSynth::process()
             envelope = note_amplitude_;
         }
         // Smooth envelope
-        float envelope_smoothed;
-        envelope_smoother_.Process(&envelope, &envelope_smoothed);
-        envelope = envelope_smoothed;
+        if (envelope != envelope_target_) {
+            envelope_target_ = envelope;
+            smoother_.SetTarget(kEnvelope, envelope);
+        }
+        envelope = smoother_.Get(kEnvelope);
     } else {
-        carrier_1 = synthparams_smoothed[0] * 0.2f;
-        carrier_2 = synthparams_smoothed[7] * 0.6;
+        carrier_1 = smoother_.Get(0) * 0.2f;
+        carrier_2 = smoother_.Get(7) * 0.6;
         envelope = 1.0f;
     }
 
 #if 1
     float w = op1.play(carrier_1 +
-        (op2.play(synthparams_smoothed[3],synthparams_smoothed[4],synthparams_smoothed[5]) * synthparams_smoothed[6]),
-        synthparams_smoothed[1], synthparams_smoothed[2]);
+        (op2.play(smoother_.Get(3),smoother_.Get(4),smoother_.Get(5)) * smoother_.Get(6)),
+        smoother_.Get(1), smoother_.Get(2));
 
     float w2 = op3.play(carrier_2 +
-        (op4.play(synthparams_smoothed[10],synthparams_smoothed[11],synthparams_smoothed[12]) * synthparams_smoothed[13]),
-        synthparams_smoothed[8], synthparams_smoothed[9]);
+        (op4.play(smoother_.Get(10),smoother_.Get(11),smoother_.Get(12)) * smoother_.Get(13)),
+        smoother_.Get(8), smoother_.Get(9));
 
     float y = (w + w2) * envelope;
 
@@ -127,13 +127,14 @@ class FMSynth {
  private:
     FMOperator op1, op2, op3, op4;
     synthparams_array synthparams;
-    synthparams_array synthparams_smoothed;
     // FMOperator fmops[10];
-    OnePoleSmoother<kN_synthparams> smoother_;
+    // Synth parameters, then the MIDI envelope
+    static constexpr size_t kEnvelope = kN_synthparams;
+    ParamSmoother<kN_synthparams + 1> smoother_;
 
     // MIDI
     // RingBuffer<ts_midi_note, kN_notes> note_buffer_;
-    OnePoleSmoother<1> envelope_smoother_;
+    float envelope_target_;
     float note_freq_;
     float note_amplitude_;
     bool play_note_;
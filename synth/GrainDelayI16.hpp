@@ -5,7 +5,9 @@
 #include "maximilian.h"
 #include "../audio/AudioDriver.hpp"
 
-template<size_t BUFSIZE = 16384, size_t NGRAINS = 4>
+// Storage (BufferStorage.hpp) selects SRAM or PSRAM for the grain buffer; PSRAM with a
+// hot cache suits long buffers where most grains start near the write head.
+template<size_t BUFSIZE = 16384, size_t NGRAINS = 4, typename Storage = SRAMStorage>
 class GrainDelayI16 {
     static_assert((BUFSIZE & (BUFSIZE - 1)) == 0, "BUFSIZE must be a power of 2");
     static constexpr size_t kEnvSize = 512;
@@ -287,7 +289,7 @@ public:
     }
 
 private:
-    DynamicDelayI16<BUFSIZE> buf_;
+    DynamicDelayI16<BUFSIZE, Storage> buf_;
     float env_[kEnvSize] = {};
     float phase_[NGRAINS]    = {};
     float read_pos_[NGRAINS] = {};
@@ -0,0 +1,157 @@
+#ifndef __IMA_ADPCM_HPP__
+#define __IMA_ADPCM_HPP__
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief IMA/DVI ADPCM, 4 bits per sample.
+ *
+ * Blocks are self-contained so any block can be decoded on its own:
+ *
+ *     [0..1]  predictor (int16, little endian) before the first sample
+ *     [2]     step index (0..88)
+ *     [3]     reserved (0)
+ *     [4..]   block_samples nibbles, low nibble first
+ *
+ * Block size in bytes is kHeaderBytes + block_samples / 2.
+ */
+class IMAADPCM
+{
+public:
+    static constexpr size_t kHeaderBytes = 4;
+
+    static constexpr size_t BlockBytes(size_t block_samples) {
+        return kHeaderBytes + block_samples / 2;
+    }
+
+    struct State {
+        int32_t predictor;
+        int32_t index;
+    };
+
+    /**
+     * @brief Decode one nibble, updating the state.
+     */
+    static inline int16_t DecodeNibble(uint8_t nibble, State &s) {
+        const int32_t step = kStepTable_[s.index];
+        int32_t diff = step >> 3;
+        if (nibble & 4) diff += step;
+        if (nibble & 2) diff += step >> 1;
+        if (nibble & 1) diff += step >> 2;
+        s.predictor += (nibble & 8) ? -diff : diff;
+        if (s.predictor > 32767) s.predictor = 32767;
+        else if (s.predictor < -32768) s.predictor = -32768;
+        s.index += kIndexTable_[nibble & 0x0F];
+        if (s.index < 0) s.index = 0;
+        else if (s.index > 88) s.index = 88;
+        return static_cast<int16_t>(s.predictor);
+    }
+
+    /**
+     * @brief Encode one sample, updating the state exactly as the decoder will.
+     */
+    static inline uint8_t EncodeSample(int16_t sample, State &s) {
+        const int32_t step = kStepTable_[s.index];
+        int32_t diff = static_cast<int32_t>(sample) - s.predictor;
+        uint8_t nibble = 0;
+        if (diff < 0) {
+            nibble = 8;
+            diff = -diff;
+        }
+        int32_t threshold = step;
+        for (uint8_t bit = 4; bit > 0; bit >>= 1) {
+            if (diff >= threshold) {
+                nibble |= bit;
+                diff -= threshold;
+            }
+            threshold >>= 1;
+        }
+        DecodeNibble(nibble, s);
+        return nibble;
+    }
+
+    /**
+     * @brief Decode a block (or its first n_samples).
+     *
+     * @param block Start of the block header.
+     * @param n_samples Number of samples to decode (<= block_samples).
+     * @param out Destination.
+     */
+    static inline void DecodeBlock(const uint8_t *block, size_t n_samples, int16_t *out) {
+        State s {
+            static_cast<int16_t>(block[0] | (block[1] << 8)),
+            block[2] > 88 ? 88 : block[2]
+        };
+        const uint8_t *data = block + kHeaderBytes;
+
+        size_t i = 0;
+        for (; i + 1 < n_samples; i += 2) {
+            const uint8_t byte = *data++;
+            out[i] = DecodeNibble(byte & 0x0F, s);
+            out[i + 1] = DecodeNibble(byte >> 4, s);
+        }
+        if (i < n_samples) {
+            out[i] = DecodeNibble(*data & 0x0F, s);
+        }
+    }
+
+    /**
+     * @brief Decode a block (or its first n_samples) to float in [-1, 1).
+     */
+    static inline void DecodeBlock(const uint8_t *block, size_t n_samples, float *out) {
+        constexpr float kScale = 1.f / 32768.f;
+        State s {
+            static_cast<int16_t>(block[0] | (block[1] << 8)),
+            block[2] > 88 ? 88 : block[2]
+        };
+        const uint8_t *data = block + kHeaderBytes;
+
+        size_t i = 0;
+        for (; i + 1 < n_samples; i += 2) {
+            const uint8_t byte = *data++;
+            out[i] = DecodeNibble(byte & 0x0F, s) * kScale;
+            out[i + 1] = DecodeNibble(byte >> 4, s) * kScale;
+        }
+        if (i < n_samples) {
+            out[i] = DecodeNibble(*data & 0x0F, s) * kScale;
+        }
+    }
+
+    /**
+     * @brief Encode block_samples int16 samples (block_samples even) into one block.
+     *
+     * @param state Running encoder state, carried from block to block.
+     * @return Bytes written.
+     */
+    static inline size_t EncodeBlock(const int16_t *in, size_t block_samples, State &state, uint8_t *out) {
+        out[0] = static_cast<uint8_t>(state.predictor & 0xFF);
+        out[1] = static_cast<uint8_t>((state.predictor >> 8) & 0xFF);
+        out[2] = static_cast<uint8_t>(state.index);
+        out[3] = 0;
+        uint8_t *data = out + kHeaderBytes;
+        for (size_t i = 0; i + 1 < block_samples; i += 2) {
+            uint8_t lo = EncodeSample(in[i], state);
+            uint8_t hi = EncodeSample(in[i + 1], state);
+            *data++ = static_cast<uint8_t>(lo | (hi << 4));
+        }
+        return BlockBytes(block_samples);
+    }
+
+private:
+    static constexpr int16_t kStepTable_[89] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+        50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+        253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+        1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+        3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+        11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+        32767
+    };
+    static constexpr int8_t kIndexTable_[16] = {
+        -1, -1, -1, -1, 2, 4, 6, 8,
+        -1, -1, -1, -1, 2, 4, 6, 8
+    };
+};
+
+#endif  // __IMA_ADPCM_HPP__
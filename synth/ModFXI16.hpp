@@ -36,8 +36,9 @@ private:
 // different rate for a richer, detuned character.
 // process(input, delayBaseSamples, depth, rateHz, feedback, mix)
 //   mix 0 = dry, mix 1 = 1/3 dry + 1/3 voice1 + 1/3 voice2
+//   Storage: buffer placement policy from BufferStorage.hpp (default SRAM)
 // ─────────────────────────────────────────────────────────────────────────────
-template<size_t BUFSIZE = 4096>
+template<size_t BUFSIZE = 4096, typename Storage = SRAMStorage>
 class ChorusI16 {
     static_assert((BUFSIZE & (BUFSIZE - 1)) == 0, "BUFSIZE must be a power of 2");
 public:
@@ -61,7 +62,7 @@ public:
     }
 
 private:
-    DynamicDelayI16<BUFSIZE> buf1_, buf2_;
+    DynamicDelayI16<BUFSIZE, Storage> buf1_, buf2_;
     maxiOsc lfo1_, lfo2_;
 };
 
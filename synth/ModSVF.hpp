@@ -0,0 +1,249 @@
+#pragma once
+
+#include "maximilian.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// SVFTan
+// g = tan(pi * cutoff / fs) from a 512-point table with linear interpolation,
+// for cutoffs up to 0.49 fs. Relative error in g (tools/svf_bench.cpp) is
+// under 0.001% below fs/4 and 0.21% at 0.49 fs, where tan is steep enough
+// that the cutoff itself is off by well under a cent.
+// ─────────────────────────────────────────────────────────────────────────────
+class SVFTan {
+public:
+    static constexpr size_t kSize = 512;
+    static constexpr float kMaxW = 0.49f;   // Highest cutoff / sample rate
+
+    // Fills the table on first use; safe to call from every constructor
+    static void Init() {
+        if (ready_) return;
+        for (size_t i = 0; i <= kSize; i++) {
+            table_[i] = tanf(PI * kMaxW * static_cast<float>(i) / static_cast<float>(kSize));
+        }
+        table_[kSize + 1] = table_[kSize];
+        ready_ = true;
+    }
+
+    // w = cutoff / sample rate, clamped to [0, kMaxW]
+    static float __force_inline Lookup(float w) {
+        float pos = w * (static_cast<float>(kSize) / kMaxW);
+        pos = pos < 0.f ? 0.f : (pos > static_cast<float>(kSize) ? static_cast<float>(kSize) : pos);
+        const size_t i = static_cast<size_t>(pos);
+        const float frac = pos - static_cast<float>(i);
+        return table_[i] + frac * (table_[i + 1] - table_[i]);
+    }
+
+private:
+    inline static float table_[kSize + 2];
+    inline static bool ready_ = false;
+};
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ModSVF
+// Trapezoidal state variable filter (same response as maxiSVF) for audio-rate
+// cutoff modulation. No tanf: setCutoff() is a table lookup, and coefficients
+// are derived from (g, k) with one division per sample only while they move.
+//   processBlock(in, out, n)          ramps g and k from their previous values
+//                                     to the last setCutoff/setResonance over
+//                                     the block (no zipper noise)
+//   processBlock(in, out, n, cutoff)  per-sample cutoff in Hz (LFO, envelope)
+//   play(x) / play(x, cutoffHz)       per sample
+// Mix gains as in maxiSVF::play: lowpass, bandpass, highpass, notch.
+// ─────────────────────────────────────────────────────────────────────────────
+class ModSVF {
+public:
+    ModSVF() {
+        SVFTan::Init();
+        setCutoff(1000.f);
+        setResonance(1.f);
+        g_ = gT_;
+        k_ = kT_;
+        updateCoeffs_();
+    }
+
+    inline void setCutoff(float cutoff) {
+        gT_ = SVFTan::Lookup(cutoff * maxiSettings::one_over_sampleRate);
+    }
+
+    // q from 0 upwards, as maxiSVF::setResonance (0 = no damping)
+    inline void setResonance(float q) {
+        kT_ = q == 0.f ? 0.f : 1.0f / q;
+    }
+
+    inline void setMix(float lpmix, float bpmix, float hpmix, float notchmix) {
+        lp_ = lpmix;
+        bp_ = bpmix;
+        hp_ = hpmix;
+        notch_ = notchmix;
+    }
+
+    inline void reset() {
+        ic1_ = ic2_ = 0.f;
+    }
+
+    // Jumps straight to the current cutoff and resonance
+    float __force_inline play(float w) {
+        if (g_ != gT_ || k_ != kT_) {
+            g_ = gT_;
+            k_ = kT_;
+            updateCoeffs_();
+        }
+        return tick_(w, a1_, a2_, a3_, k_);
+    }
+
+    float __force_inline play(float w, float cutoff) {
+        g_ = gT_ = SVFTan::Lookup(cutoff * maxiSettings::one_over_sampleRate);
+        k_ = kT_;
+        updateCoeffs_();
+        return tick_(w, a1_, a2_, a3_, k_);
+    }
+
+    void processBlock(const float *in, float *out, size_t n, const float *cutoff = nullptr) {
+        if (n == 0) return;
+        const float kStep = (kT_ - k_) / static_cast<float>(n);
+        if (cutoff) {
+            const float oneOverSR = maxiSettings::one_over_sampleRate;
+            float k = k_;
+            for (size_t i = 0; i < n; i++) {
+                k += kStep;
+                const float g = SVFTan::Lookup(cutoff[i] * oneOverSR);
+                const float a1 = 1.0f / (1.0f + g * (g + k));
+                const float a2 = g * a1;
+                out[i] = tick_(in[i], a1, a2, g * a2, k);
+            }
+            gT_ = SVFTan::Lookup(cutoff[n - 1] * oneOverSR);
+        } else if (g_ != gT_ || kStep != 0.f) {
+            const float gStep = (gT_ - g_) / static_cast<float>(n);
+            float g = g_;
+            float k = k_;
+            for (size_t i = 0; i < n; i++) {
+                g += gStep;
+                k += kStep;
+                const float a1 = 1.0f / (1.0f + g * (g + k));
+                const float a2 = g * a1;
+                out[i] = tick_(in[i], a1, a2, g * a2, k);
+            }
+        } else {
+            // Static: cached coefficients, no division
+            for (size_t i = 0; i < n; i++) {
+                out[i] = tick_(in[i], a1_, a2_, a3_, k_);
+            }
+            return;
+        }
+        g_ = gT_;
+        k_ = kT_;
+        updateCoeffs_();
+    }
+
+private:
+    float ic1_ = 0.f, ic2_ = 0.f;           // Integrator states
+    float g_, k_;                           // Coefficients in use
+    float gT_, kT_;                         // Targets
+    float a1_, a2_, a3_;
+    float lp_ = 1.f, bp_ = 0.f, hp_ = 0.f, notch_ = 0.f;
+
+    inline void updateCoeffs_() {
+        a1_ = 1.0f / (1.0f + g_ * (g_ + k_));
+        a2_ = g_ * a1_;
+        a3_ = g_ * a2_;
+    }
+
+    float __force_inline tick_(float v0, float a1, float a2, float a3, float k) {
+        const float v3 = v0 - ic2_;
+        const float band = a1 * ic1_ + a2 * v3;
+        const float low = ic2_ + a2 * ic1_ + a3 * v3;
+        ic1_ = 2.0f * band - ic1_;
+        ic2_ = 2.0f * low - ic2_;
+        const float notch = v0 - k * band;
+        const float high = notch - low;
+        return (low * lp_) + (band * bp_) + (high * hp_) + (notch * notch_);
+    }
+};
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ModSVFBank
+// N ModSVF voices with their state in parallel arrays, processed a sample at
+// a time across all voices (the inner loop over voices unrolls and keeps the
+// shared mix gains in registers). Buffers are frame-major: x[i * N + voice].
+// ─────────────────────────────────────────────────────────────────────────────
+template<size_t N>
+class ModSVFBank {
+public:
+    ModSVFBank() {
+        SVFTan::Init();
+        for (size_t v = 0; v < N; v++) {
+            setCutoff(v, 1000.f);
+            setResonance(v, 1.f);
+            g_[v] = gT_[v];
+            k_[v] = kT_[v];
+            ic1_[v] = ic2_[v] = 0.f;
+        }
+    }
+
+    inline void setCutoff(size_t voice, float cutoff) {
+        gT_[voice] = SVFTan::Lookup(cutoff * maxiSettings::one_over_sampleRate);
+    }
+
+    inline void setResonance(size_t voice, float q) {
+        kT_[voice] = q == 0.f ? 0.f : 1.0f / q;
+    }
+
+    inline void setMix(float lpmix, float bpmix, float hpmix, float notchmix) {
+        lp_ = lpmix;
+        bp_ = bpmix;
+        hp_ = hpmix;
+        notch_ = notchmix;
+    }
+
+    inline void reset(size_t voice) {
+        ic1_[voice] = ic2_[voice] = 0.f;
+    }
+
+    // Ramps every voice to its targets over the block, or follows a
+    // per-sample, per-voice cutoff in Hz
+    void processBlock(const float *in, float *out, size_t n, const float *cutoff = nullptr) {
+        if (n == 0) return;
+        const float invN = 1.0f / static_cast<float>(n);
+        float gStep[N], kStep[N];
+        for (size_t v = 0; v < N; v++) {
+            gStep[v] = (gT_[v] - g_[v]) * invN;
+            kStep[v] = (kT_[v] - k_[v]) * invN;
+        }
+        const float oneOverSR = maxiSettings::one_over_sampleRate;
+        for (size_t i = 0; i < n; i++) {
+            const float *x = in + i * N;
+            float *y = out + i * N;
+            for (size_t v = 0; v < N; v++) {
+                k_[v] += kStep[v];
+                const float g = cutoff ? SVFTan::Lookup(cutoff[i * N + v] * oneOverSR) : (g_[v] += gStep[v]);
+                const float k = k_[v];
+                const float a1 = 1.0f / (1.0f + g * (g + k));
+                const float a2 = g * a1;
+                const float a3 = g * a2;
+                const float v3 = x[v] - ic2_[v];
+                const float band = a1 * ic1_[v] + a2 * v3;
+                const float low = ic2_[v] + a2 * ic1_[v] + a3 * v3;
+                ic1_[v] = 2.0f * band - ic1_[v];
+                ic2_[v] = 2.0f * low - ic2_[v];
+                const float notch = x[v] - k * band;
+                y[v] = (low * lp_) + (band * bp_) + ((notch - low) * hp_) + (notch * notch_);
+            }
+        }
+        for (size_t v = 0; v < N; v++) {
+            if (cutoff) {
+                gT_[v] = SVFTan::Lookup(cutoff[(n - 1) * N + v] * oneOverSR);
+            }
+            // Land exactly on the targets despite rounding in the ramp
+            g_[v] = gT_[v];
+            k_[v] = kT_[v];
+        }
+    }
+
+private:
+    float ic1_[N], ic2_[N];
+    float g_[N], k_[N];
+    float gT_[N], kT_[N];
+    float lp_ = 1.f, bp_ = 0.f, hp_ = 0.f, notch_ = 0.f;
+};
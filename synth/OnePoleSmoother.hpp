@@ -1,7 +1,9 @@
 #ifndef ONEPOLESMOOTHER_H
 #define ONEPOLESMOOTHER_H
 
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 
 template<size_t n_channels>
 class OnePoleSmoother {
@@ -44,4 +46,185 @@ class OnePoleSmoother {
 };
 
 
-#endif
\ No newline at end of file
+/**
+ * Parameter smoothing service: each parameter is registered once with its
+ * own smoothing time and curve, and only the ones still converging cost
+ * anything. Settled parameters are tracked in a bitmask and skipped; the
+ * moving ones are advanced once per BLOCK samples (one-pole: the exact
+ * BLOCK-step decay, linear: a fixed step per block), with a linear ramp
+ * across the block for per-sample readers.
+ *
+ * Block-based code calls ProcessBlock() once per BLOCK samples and reads
+ * GetBlock() or Ramp(); per-sample code calls Tick() once per sample and
+ * reads Get(), which is a multiply-add. SetTarget() may be called from
+ * the other core (e.g. from ProcessParams in loop()).
+ */
+template<size_t n_params, size_t BLOCK = 32>
+class ParamSmoother {
+ public:
+    enum Curve { kOnePole, kLinear };
+
+    ParamSmoother(float sample_rate = 48000.f) : sample_rate_(sample_rate) {
+        for (auto &w : pending_) {
+            w.store(0, std::memory_order_relaxed);
+        }
+        for (size_t w = 0; w < kWords; w++) {
+            active_[w] = ramping_[w] = 0;
+        }
+    }
+
+    void Setup(float sample_rate) {
+        sample_rate_ = sample_rate;
+        for (size_t i = 0; i < count_; i++) {
+            SetTimeMs(i, time_ms_[i]);
+        }
+    }
+
+    /**
+     * Adds a parameter, returns its id (ids count up from 0, so registering
+     * in order gives id == index), or -1 when all n_params are taken.
+     */
+    int Register(float time_ms, Curve curve = kOnePole, float initial = 0.f) {
+        if (count_ >= n_params) {
+            return -1;
+        }
+        const size_t id = count_++;
+        curve_[id] = curve;
+        y_[id] = start_[id] = target_[id] = initial;
+        step_[id] = 0.f;
+        lin_inc_[id] = 0.f;
+        SetTimeMs(id, time_ms);
+        return static_cast<int>(id);
+    }
+
+    void SetTimeMs(size_t id, float time_ms) {
+        time_ms_[id] = time_ms;
+        const float samples = time_ms * 0.001f * sample_rate_;
+        // Same curve as OnePoleSmoother::SetTimeMs, BLOCK steps at a time
+        coef_[id] = samples > 0.f ? powf(0.1f, static_cast<float>(BLOCK) / samples) : 0.f;
+        blocks_[id] = samples > static_cast<float>(BLOCK) ? samples / static_cast<float>(BLOCK) : 1.f;
+    }
+
+    // Tolerance at which a parameter snaps to its target and is skipped
+    inline void SetTolerance(float tol) { tol_ = tol; }
+
+    inline void SetTarget(size_t id, float x) {
+        target_[id] = x;
+        pending_[id >> 5].fetch_or(1u << (id & 31), std::memory_order_release);
+    }
+
+    void SetTargets(const float *x, size_t n) {
+        n = n < count_ ? n : count_;
+        for (size_t i = 0; i < n; i++) {
+            SetTarget(i, x[i]);
+        }
+    }
+
+    /**
+     * Advances the moving parameters by one block.
+     */
+    void ProcessBlock() {
+        constexpr float kInvBlock = 1.f / static_cast<float>(BLOCK);
+        for (size_t w = 0; w < kWords; w++) {
+            uint32_t pending = pending_[w].exchange(0, std::memory_order_acquire);
+            while (pending) {
+                const size_t id = (w << 5) + __builtin_ctz(pending);
+                pending &= pending - 1;
+                lin_inc_[id] = (target_[id] - y_[id]) / blocks_[id];
+                if (target_[id] != y_[id]) {
+                    active_[w] |= 1u << (id & 31);
+                } else {
+                    active_[w] &= ~(1u << (id & 31));
+                }
+            }
+            // Last block's ramps end where they were heading
+            uint32_t ramping = ramping_[w] & ~active_[w];
+            while (ramping) {
+                const size_t id = (w << 5) + __builtin_ctz(ramping);
+                ramping &= ramping - 1;
+                start_[id] = y_[id];
+                step_[id] = 0.f;
+            }
+            ramping_[w] = active_[w];
+
+            uint32_t active = active_[w];
+            while (active) {
+                const size_t bit = __builtin_ctz(active);
+                const size_t id = (w << 5) + bit;
+                active &= active - 1;
+                const float x = target_[id];
+                const float y0 = y_[id];
+                float y = curve_[id] == kLinear ? y0 + lin_inc_[id] : x + (y0 - x) * coef_[id];
+                // Linear steps can pass the target; either curve snaps to it
+                // once within tolerance, or once rounding stops it moving
+                // (large values, e.g. frequencies, stall an ulp short)
+                if (fabsf(x - y) <= tol_ || (x - y) * (x - y0) < 0.f || y == y0) {
+                    y = x;
+                    active_[w] &= ~(1u << bit);
+                }
+                start_[id] = y0;
+                step_[id] = (y - y0) * kInvBlock;
+                y_[id] = y;
+            }
+        }
+    }
+
+    /**
+     * Per-sample use: call once at the start of every sample.
+     */
+    inline __attribute__((always_inline)) void Tick() {
+        if (phase_ == BLOCK) {
+            ProcessBlock();
+            phase_ = 0;
+        }
+        phase_++;
+    }
+
+    // Value for the current sample (after Tick)
+    inline float Get(size_t id) const {
+        return start_[id] + step_[id] * static_cast<float>(phase_);
+    }
+
+    // Value at the end of the current block
+    inline float GetBlock(size_t id) const { return y_[id]; }
+
+    // The current block's ramp, BLOCK samples ending at GetBlock(id)
+    void Ramp(size_t id, float *out) const {
+        const float start = start_[id], step = step_[id];
+        for (size_t i = 0; i < BLOCK; i++) {
+            out[i] = start + step * static_cast<float>(i + 1);
+        }
+    }
+
+    inline bool IsSettled(size_t id) const {
+        return !((active_[id >> 5] | ramping_[id >> 5]) >> (id & 31) & 1u);
+    }
+
+    inline size_t Count() const { return count_; }
+
+ protected:
+    static constexpr size_t kWords = (n_params + 31) / 32;
+
+    float sample_rate_;
+    float tol_ = 1e-5f;
+    size_t count_ = 0;
+    size_t phase_ = BLOCK;
+
+    // SoA state
+    float y_[n_params];             // Value at the end of the block
+    float start_[n_params];         // Ramp start, for Get() and Ramp()
+    float step_[n_params];
+    float target_[n_params];
+    float coef_[n_params];
+    float lin_inc_[n_params];
+    float blocks_[n_params];
+    float time_ms_[n_params];
+    Curve curve_[n_params];
+
+    std::atomic<uint32_t> pending_[kWords];     // Targets set since the last block
+    uint32_t active_[kWords];                   // Still converging
+    uint32_t ramping_[kWords];                  // Ramping within the current block
+};
+
+
+#endif
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "maximilian.h"
+#include <cstring>
+#include <cmath>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Half-band coefficients
+// Kaiser-windowed (beta 6) half-band FIRs. Only the odd taps either side of
+// the 0.5 centre tap are non-zero; kCoef holds them from the centre out.
+//   HalfBand47  2x stage at 48 kHz: 0.007 dB ripple to 20 kHz, -62 dB from
+//               28 kHz (the image of 20 kHz)
+//   HalfBand15  4x stage: same figures for the 2x → 4x step, which has a
+//               much wider transition band
+// ─────────────────────────────────────────────────────────────────────────────
+struct HalfBand47 {
+    static constexpr size_t kTaps = 12;
+    static constexpr float kCoef[kTaps] = {
+        3.166664892e-01f, -1.012575569e-01f, 5.585914810e-02f, -3.509569751e-02f,
+        2.290114812e-02f, -1.492488258e-02f, 9.484152400e-03f, -5.757889586e-03f,
+        3.262062586e-03f, -1.664347988e-03f, 7.124100060e-04f, -2.058404453e-04f,
+    };
+};
+
+struct HalfBand15 {
+    static constexpr size_t kTaps = 4;
+    static constexpr float kCoef[kTaps] = {
+        3.009392352e-01f, -6.274017115e-02f, 1.271851404e-02f, -6.763328916e-04f,
+    };
+};
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// HalfBandUp / HalfBandDown
+// Polyphase 2x interpolator and decimator for a fixed block size. History
+// and the block share one linear buffer (no ring wrap in the inner loop);
+// the history is moved down once per block. The odd phase is a symmetric
+// FIR (kTaps multiplies per output), the even phase is the delayed input.
+//   HalfBandUp::process(in[BLOCK], out[2 * BLOCK])
+//   HalfBandDown::process(in[2 * BLOCK], out[BLOCK])
+// Latency is kTaps input samples up, kTaps - 1 output samples down.
+// ─────────────────────────────────────────────────────────────────────────────
+template<typename Coeffs, size_t BLOCK>
+class HalfBandUp {
+    static constexpr size_t K = Coeffs::kTaps;
+    static constexpr size_t kHist = 2 * K;
+public:
+    static constexpr size_t kLatency = K;
+
+    HalfBandUp() { reset(); }
+
+    inline void reset() { std::fill(std::begin(buf_), std::end(buf_), 0.f); }
+
+    void process(const float *in, float *out) {
+        std::memcpy(buf_ + kHist, in, BLOCK * sizeof(float));
+        for (size_t b = 0; b < BLOCK; b++) {
+            const float *c = buf_ + K + b;
+            float acc = 0.f;
+            for (size_t j = 0; j < K; j++) {
+                acc += Coeffs::kCoef[j] * (c[-static_cast<ptrdiff_t>(j)] + c[j + 1]);
+            }
+            out[2 * b] = c[0];
+            out[2 * b + 1] = 2.f * acc;
+        }
+        std::memmove(buf_, buf_ + BLOCK, kHist * sizeof(float));
+    }
+
+private:
+    float buf_[kHist + BLOCK];
+};
+
+template<typename Coeffs, size_t BLOCK>
+class HalfBandDown {
+    static constexpr size_t K = Coeffs::kTaps;
+    static constexpr size_t kHist = 4 * K - 2;
+public:
+    static constexpr size_t kLatency = K - 1;
+
+    HalfBandDown() { reset(); }
+
+    inline void reset() { std::fill(std::begin(buf_), std::end(buf_), 0.f); }
+
+    void process(const float *in, float *out) {
+        std::memcpy(buf_ + kHist, in, 2 * BLOCK * sizeof(float));
+        for (size_t b = 0; b < BLOCK; b++) {
+            const float *c = buf_ + 2 * K + 2 * b;
+            float acc = 0.5f * c[0];
+            for (size_t j = 0; j < K; j++) {
+                const ptrdiff_t o = static_cast<ptrdiff_t>(2 * j + 1);
+                acc += Coeffs::kCoef[j] * (c[-o] + c[o]);
+            }
+            out[b] = acc;
+        }
+        std::memmove(buf_, buf_ + 2 * BLOCK, kHist * sizeof(float));
+    }
+
+private:
+    float buf_[kHist + 2 * BLOCK];
+};
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Oversampler
+// Runs a waveshaper at 2x or 4x the sample rate on blocks of BLOCK samples:
+//   os.process(in, out, [&](float x) { return nl.softclip(x * drive); });
+// The shaper is any callable float(float), and may keep state (e.g. ADAA1).
+// in and out may be the same buffer. latency() is in base-rate samples.
+// ─────────────────────────────────────────────────────────────────────────────
+template<size_t FACTOR, size_t BLOCK>
+class Oversampler {
+    static_assert(FACTOR == 2 || FACTOR == 4, "FACTOR must be 2 or 4");
+public:
+    static constexpr float latency() {
+        return FACTOR == 2
+            ? static_cast<float>(HalfBand47::kTaps + HalfBand47::kTaps - 1)
+            : static_cast<float>(HalfBand47::kTaps + HalfBand47::kTaps - 1) +
+              0.5f * static_cast<float>(HalfBand15::kTaps + HalfBand15::kTaps - 1);
+    }
+
+    inline void reset() {
+        up1_.reset();
+        down1_.reset();
+        up2_.reset();
+        down2_.reset();
+    }
+
+    template<typename Shaper>
+    void process(const float *in, float *out, Shaper &&shaper) {
+        up1_.process(in, x2_);
+        if constexpr (FACTOR == 4) {
+            up2_.process(x2_, x4_);
+            for (size_t i = 0; i < 4 * BLOCK; i++) {
+                x4_[i] = shaper(x4_[i]);
+            }
+            down2_.process(x4_, x2_);
+        } else {
+            for (size_t i = 0; i < 2 * BLOCK; i++) {
+                x2_[i] = shaper(x2_[i]);
+            }
+        }
+        down1_.process(x2_, out);
+    }
+
+private:
+    static constexpr size_t kX4 = FACTOR == 4 ? 4 * BLOCK : 1;
+
+    HalfBandUp<HalfBand47, BLOCK> up1_;
+    HalfBandDown<HalfBand47, BLOCK> down1_;
+    HalfBandUp<HalfBand15, 2 * BLOCK> up2_;
+    HalfBandDown<HalfBand15, 2 * BLOCK> down2_;
+    float x2_[2 * BLOCK];
+    float x4_[kX4];
+};
+
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ADAA1
+// First-order antiderivative anti-aliasing for a static curve, at the base
+// rate or inside an Oversampler:
+//   y[n] = (F(x[n]) - F(x[n-1])) / (x[n] - x[n-1])
+// falling back to f at the midpoint when the step is too small for the
+// difference of F to be accurate in float. Adds half a sample of delay.
+// A Curve provides static f(x) and its antiderivative F(x).
+// ─────────────────────────────────────────────────────────────────────────────
+template<typename Curve>
+class ADAA1 {
+public:
+    ADAA1() { reset(); }
+
+    inline void reset() {
+        x1_ = 0.f;
+        F1_ = Curve::F(0.f);
+    }
+
+    float __force_inline operator()(float x) {
+        const float F = Curve::F(x);
+        const float dx = x - x1_;
+        // F grows up to x²/2, so its rounding error grows with x²
+        const float y = fabsf(dx) > 1e-3f * (1.f + x * x)
+            ? (F - F1_) / dx
+            : Curve::f(0.5f * (x + x1_));
+        x1_ = x;
+        F1_ = F;
+        return y;
+    }
+
+private:
+    float x1_, F1_;
+};
+
+// maxiNonlinearity::hardclip
+struct ADAAHardClip {
+    static float __force_inline f(float x) {
+        return x >= 1.f ? 1.f : (x <= -1.f ? -1.f : x);
+    }
+    static float __force_inline F(float x) {
+        const float a = fabsf(x);
+        return a <= 1.f ? 0.5f * x * x : a - 0.5f;
+    }
+};
+
+// maxiNonlinearity::softclip: (3/2)(x - x³/3) inside ±1, ±1 outside
+struct ADAASoftClip {
+    static float __force_inline f(float x) {
+        return x >= 1.f ? 1.f : (x <= -1.f ? -1.f : 1.5f * x - 0.5f * x * x * x);
+    }
+    static float __force_inline F(float x) {
+        const float a = fabsf(x);
+        const float x2 = x * x;
+        return a < 1.f ? 0.75f * x2 - 0.125f * x2 * x2 : a - 0.375f;
+    }
+};
+
+// ReverbI16::softLimit: x - (4/27)x³ inside ±1.5, ±1 outside
+struct ADAACubicLimit {
+    static float __force_inline f(float x) {
+        return x > 1.5f ? 1.f : (x < -1.5f ? -1.f : x - x * x * x * (4.f / 27.f));
+    }
+    static float __force_inline F(float x) {
+        const float a = fabsf(x);
+        const float x2 = x * x;
+        return a <= 1.5f ? 0.5f * x2 - x2 * x2 * (1.f / 27.f) : a - 0.5625f;
+    }
+};
+
+// ReverbI16 tail saturation: x(27 + x²) / (27 + 9x²) = x/9 + 24x / (27 + 9x²)
+struct ADAAFastTanh {
+    static float __force_inline f(float x) {
+        const float x2 = x * x;
+        return x * (27.f + x2) / (27.f + 9.f * x2);
+    }
+    static float __force_inline F(float x) {
+        return x * x * (1.f / 18.f) + (4.f / 3.f) * logf(1.f + x * x * (1.f / 3.f));
+    }
+};
+
+// maxiNonlinearity::fastatan: x / (1 + 0.28x²)
+struct ADAAFastAtan {
+    static float __force_inline f(float x) {
+        return x / (1.f + 0.28f * x * x);
+    }
+    static float __force_inline F(float x) {
+        return logf(1.f + 0.28f * x * x) * (1.f / 0.56f);
+    }
+};
@@ -2,119 +2,234 @@
 #define __PLAYLOOP_HPP__
 
 #include "stdint.h"
+#include <cmath>
+#include <cstring>
 
 #include "../PicoDefs.hpp"
-
-
-// Flash memory address where audio data is loaded
-#define AUDIO_FLASH_ADDRESS    0x10200000U
-#define AUDIO_MAGIC            0x4F434950U  // 'PICO'
-#define AUDIO_VERSION          1U
-
-
+#include "SamplePack.hpp"
+#include "IMAADPCM.hpp"
+#include "SampleStream.hpp"
+
+
+/**
+ * @brief Looping sample player reading from the flash sample pack.
+ *
+ * Playback speed is fractional (and may be negative), with linear
+ * interpolation. Files recorded at a different rate from the audio driver
+ * are resampled once SetOutputRate() has been called. Files play from the
+ * start, then cycle between their loop points.
+ *
+ * Data is decoded a block at a time into a small SRAM cache with two
+ * slots (even and odd blocks), so the interpolator can straddle a block
+ * boundary without decoding the same block twice. Blocks come straight
+ * from flash unless a SampleStream is attached, in which case they come
+ * from its SRAM read-ahead window and the audio callback never waits on
+ * XIP (see SampleStreamer).
+ */
 class PlayLoop {
 
 public:
 
-    PlayLoop(const char *filename) :
-        sample_info_{0},
-        phase_(0.f)
+    static constexpr size_t kCacheSamples = 128;    ///< Largest block, power of 2
+
+    PlayLoop(const char *filename,
+             const uint8_t *pack = reinterpret_cast<const uint8_t *>(AUDIO_FLASH_ADDRESS)) :
+        sample_info_{},
+        pos_(0),
+        frac_(0.f),
+        speed_(1.f),
+        rate_ratio_(1.f),
+        increment_(1.f),
+        block_shift_(0),
+        block_bytes_(0),
+        data_bytes_(0),
+        cached_block_{ kNoBlock_, kNoBlock_ },
+        stream_(nullptr)
     {
-        if (!get_sample_info(filename, &sample_info_)) {
+        if (!SamplePack::Find(filename, sample_info_, pack)) {
             DEBUG_PRINTLN("Error: Sample  not found in audio data.");
-        }else{
-            DEBUG_PRINTLN("Sample found: " + String(sample_info_.name) + ", count: " + String(sample_info_.sample_count) + ", duration: " + String(sample_info_.duration));
+            return;
+        }
+        const size_t block = sample_info_.encoding == SamplePack::kIMAADPCM ?
+            sample_info_.block_samples : kCacheSamples;
+        if (block == 0 || block > kCacheSamples || (block & (block - 1)) != 0) {
+            DEBUG_PRINTLN("Error: Unsupported block size " + String(block));
+            sample_info_.found = false;
+            return;
+        }
+        while ((1u << block_shift_) < block) {
+            block_shift_++;
+        }
+        switch (sample_info_.encoding) {
+        case SamplePack::kFloat32:
+            block_bytes_ = block * sizeof(float);
+            data_bytes_ = sample_info_.sample_count * sizeof(float);
+            break;
+        case SamplePack::kInt16:
+            block_bytes_ = block * sizeof(int16_t);
+            data_bytes_ = sample_info_.sample_count * sizeof(int16_t);
+            break;
+        default:
+            block_bytes_ = IMAADPCM::BlockBytes(block);
+            data_bytes_ = ((sample_info_.sample_count + block - 1) >> block_shift_) * block_bytes_;
+            break;
+        }
+        DEBUG_PRINTLN("Sample found: " + String(sample_info_.name) +
+                      ", count: " + String(sample_info_.sample_count) +
+                      ", rate: " + String(sample_info_.sample_rate) +
+                      ", encoding: " + String(sample_info_.encoding));
+    }
+
+    /**
+     * @brief Read blocks through an SRAM read-ahead stream.
+     * The stream must then be added to a SampleStreamer that is serviced
+     * regularly; call before playback starts.
+     *
+     * @return false if the sample is not loaded or its blocks are too large.
+     */
+    bool AttachStream(SampleStream *stream) {
+        if (!stream || !IsLoaded() ||
+            !stream->Configure(sample_info_.data, data_bytes_, block_bytes_,
+                               sample_info_.loop_start >> block_shift_,
+                               (sample_info_.loop_end - 1) >> block_shift_)) {
+            return false;
         }
+        stream_ = stream;
+        return true;
     }
 
+    /**
+     * @brief Tell the player the audio driver's sample rate so files
+     * recorded at other rates play at their natural pitch.
+     */
+    void SetOutputRate(float sample_rate) {
+        if (sample_rate > 0.f && sample_info_.sample_rate > 0) {
+            rate_ratio_ = static_cast<float>(sample_info_.sample_rate) / sample_rate;
+            increment_ = speed_ * rate_ratio_;
+        }
+    }
+
+    /**
+     * @brief Playback speed, 1 = natural, 0.5 = octave down, negative = reverse.
+     */
+    void SetSpeed(float speed) {
+        speed_ = speed;
+        increment_ = speed_ * rate_ratio_;
+    }
+
+    float GetSpeed() const { return speed_; }
+
+    /**
+     * @brief Restart from the first sample.
+     */
+    void Reset() {
+        pos_ = 0;
+        frac_ = 0.f;
+    }
+
+    bool IsLoaded() const { return sample_info_.found && sample_info_.sample_count > 0; }
+
     float __force_inline Process() {
-        if (!sample_info_.found || !sample_info_.samples || sample_info_.sample_count == 0) {
+        if (!sample_info_.found || sample_info_.sample_count == 0) {
             return 0.f; // Return silence if sample not found
         }
 
-        // Read sample at current phase
-        float y = sample_info_.samples[phase_];
+        // Interpolate between the current and next sample
+        const float y0 = Sample_(pos_);
+        const float y1 = Sample_(Wrap_(static_cast<int32_t>(pos_) + 1));
+        const float y = y0 + frac_ * (y1 - y0);
+
         // Update phase
-        phase_++;
-        if (phase_ >= sample_info_.sample_count) {
-            phase_ = 0;
-        }
+        frac_ += increment_;
+        const float whole = floorf(frac_);
+        frac_ -= whole;
+        pos_ = Wrap_(static_cast<int32_t>(pos_) + static_cast<int32_t>(whole));
 
         return y;
     }
 
 protected:
 
-    // Sample information structure
-    typedef struct {
-        const char* name;           // File name
-        const float* samples;       // Pointer to audio samples
-        uint32_t sample_count;      // Number of samples
-        float duration;             // Duration in seconds
-        bool found;                 // Whether the file was found
-    } sample_info_t;
-
-    // Binary format structures
-    typedef struct {
-        uint32_t magic;        // 'PICO' magic number
-        uint32_t version;      // Format version
-        uint32_t file_count;   // Number of audio files
-        uint32_t sample_rate;  // Sample rate in Hz
-    } audio_header_t;
-
-    typedef struct {
-        char name[16];         // Null-terminated filename
-        uint32_t offset;       // Offset to audio data
-        uint32_t sample_count; // Number of samples
-        float duration;        // Duration in seconds
-        uint32_t reserved;     // Reserved for future use
-    } audio_file_entry_t;
-
-    sample_info_t sample_info_;
-    unsigned int phase_;
+    static constexpr uint32_t kNoBlock_ = 0xFFFFFFFF;
+
+    SamplePack::Info sample_info_;
+    uint32_t pos_;
+    float frac_;
+    float speed_;
+    float rate_ratio_;
+    float increment_;
+    uint32_t block_shift_;
+    size_t block_bytes_;
+    size_t data_bytes_;
+    uint32_t cached_block_[2];
+    float cache_[2][kCacheSamples];
+    SampleStream *stream_;
 
     /**
-     * Get sample information by filename (without .wav extension)
-     *
-     * @param filename Name of the file without .wav extension (e.g., "intro", "beep")
-     * @param info Pointer to sample_info_t structure to fill
-     * @return true if file found, false otherwise
+     * @brief Fold a position back into the loop.
      */
-    static bool get_sample_info(const char* filename, sample_info_t* info) {
-        DEBUG_PRINTLN("get_sample_info called with filename: " + String(filename));
-        if (!filename || !info) {
-            return false;
+    inline uint32_t Wrap_(int32_t pos) const {
+        const int32_t start = static_cast<int32_t>(sample_info_.loop_start);
+        const int32_t end = static_cast<int32_t>(sample_info_.loop_end);
+        const int32_t len = end - start;
+        if (pos >= end) {
+            pos = start + (pos - end) % len;
+        } else if (pos < 0 || (pos < start && increment_ < 0.f)) {
+            pos = end - 1 - (start - 1 - pos) % len;
         }
+        return static_cast<uint32_t>(pos);
+    }
 
-        // Initialize info structure
-        memset(info, 0, sizeof(sample_info_t));
-
-        // Read pointers from memory based on flash address
-        const uint8_t* binary_data = (const uint8_t*)AUDIO_FLASH_ADDRESS;
-        const audio_header_t* header = (const audio_header_t*)binary_data;
-        const audio_file_entry_t* file_table = (const audio_file_entry_t*)(binary_data + 16);
-
-        // Verify binary is valid
-        if (header->magic != AUDIO_MAGIC) {
-            return false;
+    inline float Sample_(uint32_t idx) {
+        const uint32_t block = idx >> block_shift_;
+        const size_t slot = block & 1;
+        if (cached_block_[slot] != block) {
+            LoadBlock_(block, slot);
         }
+        return cache_[slot][idx - (block << block_shift_)];
+    }
 
-        // Search for the file by name
-        for (uint32_t i = 0; i < header->file_count; i++) {
-            if (strcmp(file_table[i].name, filename) == 0) {
-                // Found the file!
-                info->name = file_table[i].name;
-                info->samples = (const float*)(binary_data + file_table[i].offset);
-                info->sample_count = file_table[i].sample_count;
-                info->duration = file_table[i].duration;
-                info->found = true;
-                return true;
+    /**
+     * @brief Decode one block into a cache slot, from the stream if it
+     * has it, otherwise from flash.
+     */
+    void LoadBlock_(uint32_t block, size_t slot) {
+        const size_t block_samples = 1u << block_shift_;
+        const size_t remaining = sample_info_.sample_count - (block << block_shift_);
+        const size_t n = remaining < block_samples ? remaining : block_samples;
+        const uint8_t *direct = sample_info_.data + block * block_bytes_;
+
+        if (stream_) {
+            stream_->SetPlayhead(block, increment_ < 0.f ? -1 : 1);
+            const uint8_t *buffered = stream_->Acquire(block);
+            if (buffered) {
+                Decode_(buffered, n, cache_[slot]);
+                if (stream_->Release(block, buffered)) {
+                    cached_block_[slot] = block;
+                    return;
+                }
             }
         }
+        Decode_(direct, n, cache_[slot]);
+        cached_block_[slot] = block;
+    }
 
-        // File not found
-        info->found = false;
-        return false;
+    inline void Decode_(const uint8_t *src, size_t n, float *out) const {
+        switch (sample_info_.encoding) {
+        case SamplePack::kFloat32:
+            std::memcpy(out, src, n * sizeof(float));
+            break;
+        case SamplePack::kInt16:
+            for (size_t i = 0; i < n; i++) {
+                int16_t v;
+                std::memcpy(&v, src + i * sizeof(int16_t), sizeof(v));
+                out[i] = v * (1.f / 32768.f);
+            }
+            break;
+        default:
+            IMAADPCM::DecodeBlock(src, n, out);
+            break;
+        }
     }
 
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "maximilian.h"
+#include "Oversampler.hpp"
 #include <utility>
 #include <cmath>
 
@@ -8,7 +9,8 @@
 // 4 parallel LP-filtered feedback combs → 2 serial Schroeder allpasses → stereo out.
 // COMB_SIZE must be a power of 2 (DynamicDelayI16 bitmask requirement).
 // At default COMB_SIZE=4096: ~40 KB RAM, ~75 ops/sample ≈ 1.5% CPU at 200MHz/48kHz.
-template<size_t COMB_SIZE = 4096>
+// Storage (BufferStorage.hpp) moves the delay lines to PSRAM, e.g. for larger COMB_SIZE.
+template<size_t COMB_SIZE = 4096, typename Storage = SRAMStorage>
 class ReverbI16 {
     static_assert((COMB_SIZE & (COMB_SIZE - 1)) == 0, "COMB_SIZE must be a power of 2");
     static constexpr size_t AP_SIZE    = COMB_SIZE / 4;  // 1024
@@ -20,9 +22,9 @@ class ReverbI16 {
     static constexpr float kCombBases[4] = {0.0500f, 0.0561f, 0.0625f, 0.0688f};
     // Allpass fixed times live as SRAM statics in processCore() (hot path) — see note there.
 
-    DynamicDelayI16<COMB_SIZE> combs_[4];
-    DynamicDelayI16<AP_SIZE>   aps_[2];
-    DynamicDelayI16<PRE_SIZE>  preDelay_;
+    DynamicDelayI16<COMB_SIZE, Storage> combs_[4];
+    DynamicDelayI16<AP_SIZE, Storage>   aps_[2];
+    DynamicDelayI16<PRE_SIZE, Storage>  preDelay_;
     DynamicDelayI16<DECOR_SIZE> decorR_;
 
     float dampState_[4] = {};
@@ -45,6 +47,10 @@ class ReverbI16 {
     float satDrive_        = 0.f;
     float sampleRate_      = 48000.f;
 
+    // Antiderivative anti-aliasing for the tail saturation (costs a logf per sample)
+    bool satAntialias_ = false;
+    ADAA1<ADAAFastTanh> satAA_;
+
     // Cheap cubic soft-clip (no divide): ~unity for |x|<1, smoothly reaches ±1 at ±1.5,
     // hard-limits beyond. Applied to the recirculating writes so overload saturates gently
     // instead of the int16 delay line's harsh ±1 hard-clamp.
@@ -82,6 +88,7 @@ public:
     void setLowCut(float v)      { hpfCoeff_        = v * 0.05f; }
     void setStereoWidth(float v) { width_           = v; }
     void setSaturation(float v)  { satDrive_        = v * 4.f; }
+    void setSaturationAntialias(bool on) { satAntialias_ = on; satAA_.reset(); }
 
     // Shared mono reverb core: HPF → predelay → 4 LP-combs → saturation → 2 allpasses.
     // Returns the wet mono signal; process()/processMono() build their output from it.
@@ -130,8 +137,12 @@ public:
         // Optional tail saturation (normalised fasttanh)
         if (satDrive_ > 0.f) {
             const float xd = combSum * satDrive_;
-            const float x2 = xd * xd;
-            combSum = (xd * (kSatA + x2) / (kSatA + kSatB * x2)) / satDrive_;
+            if (satAntialias_) {
+                combSum = satAA_(xd) / satDrive_;
+            } else {
+                const float x2 = xd * xd;
+                combSum = (xd * (kSatA + x2) / (kSatA + kSatB * x2)) / satDrive_;
+            }
         }
 
         // 2 serial Schroeder allpasses
@@ -166,7 +177,7 @@ public:
 //   input diffusion (2 allpasses) → 8 LP-combs split into L/R banks → per-channel
 //   allpass chains → width. ~2x the RAM/CPU of ReverbI16 (~78 KB, ~3% CPU at COMB_SIZE
 //   4096). Pick per mode by choosing the class: DJFX uses this; SaxFX uses ReverbI16.
-template<size_t COMB_SIZE = 4096>
+template<size_t COMB_SIZE = 4096, typename Storage = SRAMStorage>
 class ReverbI16Large {
     static_assert((COMB_SIZE & (COMB_SIZE - 1)) == 0, "COMB_SIZE must be a power of 2");
     // AP/PRE/DIFF are fixed (independent of COMB_SIZE) so the allpass/predelay/diffuser
@@ -184,11 +195,11 @@ class ReverbI16Large {
     // Per-sample-read allpass/diffuser times + gain live as SRAM statics in process()
     // (avoid flash literal-pool reads in the hot loop). kCombBases stays — read only in setSize.
 
-    DynamicDelayI16<COMB_SIZE> combs_[8];
-    DynamicDelayI16<AP_SIZE>   apsL_[2];
-    DynamicDelayI16<AP_SIZE>   apsR_[2];
-    DynamicDelayI16<DIFF_SIZE> inDiff_[2];
-    DynamicDelayI16<PRE_SIZE>  preDelay_;
+    DynamicDelayI16<COMB_SIZE, Storage> combs_[8];
+    DynamicDelayI16<AP_SIZE, Storage>   apsL_[2];
+    DynamicDelayI16<AP_SIZE, Storage>   apsR_[2];
+    DynamicDelayI16<DIFF_SIZE, Storage> inDiff_[2];
+    DynamicDelayI16<PRE_SIZE, Storage>  preDelay_;
 
     float dampState_[8] = {};
     float hpfLpState_   = 0.f;
@@ -206,6 +217,9 @@ class ReverbI16Large {
     float satDrive_        = 0.f;
     float sampleRate_      = 48000.f;
 
+    bool satAntialias_ = false;
+    ADAA1<ADAAFastTanh> satAAL_, satAAR_;
+
     float __force_inline saturate(float x) const {
         static float kA = 27.f, kB = 9.f;  // SRAM, not flash literals
         const float xd = x * satDrive_;
@@ -251,6 +265,7 @@ public:
     void setLowCut(float v)      { hpfCoeff_        = v * 0.05f; }
     void setStereoWidth(float v) { width_           = v; }
     void setSaturation(float v)  { satDrive_        = v * 4.f; }
+    void setSaturationAntialias(bool on) { satAntialias_ = on; satAAL_.reset(); satAAR_.reset(); }
 
     std::pair<float, float> __force_inline process(float in) {
         // Hot-path constants in SRAM (non-const static) — avoid flash literal-pool reads.
@@ -300,7 +315,15 @@ public:
         combL *= kCombScale;
         combR *= kCombScale;
 
-        if (satDrive_ > 0.f) { combL = saturate(combL); combR = saturate(combR); }
+        if (satDrive_ > 0.f) {
+            if (satAntialias_) {
+                combL = satAAL_(combL * satDrive_) / satDrive_;
+                combR = satAAR_(combR * satDrive_) / satDrive_;
+            } else {
+                combL = saturate(combL);
+                combR = saturate(combR);
+            }
+        }
 
         // Per-channel allpass chains (stereo diffusion)
         for (int k = 0; k < 2; ++k) {
@@ -0,0 +1,387 @@
+#include "SDSampler.hpp"
+#include <cstdlib>
+#include <cstring>
+#include "../utils/PSRAMArena.hpp"
+
+
+static inline uint16_t LE16_(const uint8_t *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t LE32_(const uint8_t *p) {
+    return static_cast<uint32_t>(LE16_(p)) | (static_cast<uint32_t>(LE16_(p + 2)) << 16);
+}
+
+
+SDSampler::SDSampler(FileSource &fs, float preload_ms) :
+    fs_(fs),
+    preload_ms_(preload_ms),
+    output_rate_(48000.f),
+    trigger_count_(0),
+    underruns_(0),
+    steals_(0),
+    reads_(0),
+    chunks_loaded_(0),
+    bytes_read_(0),
+    opens_(0),
+    preload_bytes_(0)
+{
+    for (Voice &v : voices_) {
+        for (size_t i = 0; i < kSlots; i++) {
+            v.slot_tag[i] = kNoTag;
+        }
+        v.gen = 0;
+        v.play_sample = kNoSample;
+        v.play_chunk = 0;
+        v.active = false;
+        v.frame = 0;
+        v.frac = 0.f;
+        v.step = 1.f;
+        v.gain = 0.f;
+        v.age = 0;
+        v.handle = -1;
+        v.open_sample = kNoSample;
+        v.failed_gen = kNoTag;
+    }
+}
+
+
+SDSampler::~SDSampler() {
+    for (Voice &v : voices_) {
+        if (v.handle >= 0) {
+            fs_.Close(v.handle);
+        }
+    }
+    PSRAMArena &arena = PSRAMArena::Default();
+    for (Sample &s : samples_) {
+        if (arena.Owns(s.preload)) {
+            arena.Free(s.preload, s.preload_frames * s.frame_bytes);
+        } else {
+            std::free(s.preload);
+        }
+    }
+}
+
+
+int SDSampler::Load(const char *path) {
+    const int handle = fs_.Open(path);
+    if (handle < 0) {
+        DEBUG_PRINTF("SDSampler: can't open %s\n", path);
+        return -1;
+    }
+    opens_++;
+
+    Sample s{};
+    s.path = path;
+    uint32_t data_offset, data_bytes;
+    if (!ParseWav_(handle, s, data_offset, data_bytes)) {
+        DEBUG_PRINTF("SDSampler: %s is not 16-bit PCM WAV\n", path);
+        fs_.Close(handle);
+        return -1;
+    }
+    s.frames = data_bytes / s.frame_bytes;
+    data_bytes = s.frames * s.frame_bytes;
+
+    uint32_t head = static_cast<uint32_t>(preload_ms_ * 0.001f * static_cast<float>(s.sample_rate)) * s.frame_bytes;
+    // Stretch the head so the streamed part starts on a sector boundary
+    const uint32_t aligned = ((data_offset + head + kSectorBytes - 1) / kSectorBytes) * kSectorBytes - data_offset;
+    if (aligned % s.frame_bytes == 0) {
+        head = aligned;
+    }
+    if (head > data_bytes) {
+        head = data_bytes;
+    }
+    s.preload_frames = head / s.frame_bytes;
+    head = s.preload_frames * s.frame_bytes;
+
+    if (head > 0) {
+        s.preload = static_cast<int16_t *>(PSRAMArena::Default().Allocate(head, alignof(int16_t)));
+        if (!s.preload) {
+            s.preload = static_cast<int16_t *>(std::malloc(head));
+        }
+        if (!s.preload || fs_.ReadAt(handle, data_offset, s.preload, head) != head) {
+            DEBUG_PRINTF("SDSampler: can't preload %s\n", path);
+            PSRAMArena &arena = PSRAMArena::Default();
+            if (arena.Owns(s.preload)) {
+                arena.Free(s.preload, head);
+            } else {
+                std::free(s.preload);
+            }
+            fs_.Close(handle);
+            return -1;
+        }
+        bytes_read_ += head;
+        reads_++;
+    }
+    fs_.Close(handle);
+
+    s.stream_offset = data_offset + head;
+    s.stream_bytes = data_bytes - head;
+    s.n_chunks = static_cast<uint32_t>((s.stream_bytes + kChunkBytes - 1) / kChunkBytes);
+    samples_.push_back(s);
+    preload_bytes_ += head;
+    return static_cast<int>(samples_.size() - 1);
+}
+
+
+bool SDSampler::ParseWav_(int handle, Sample &s, uint32_t &data_offset, uint32_t &data_bytes) {
+    uint8_t riff[12];
+    if (fs_.ReadAt(handle, 0, riff, sizeof(riff)) != sizeof(riff) ||
+        std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    const uint32_t size = fs_.Size(handle);
+    uint32_t offset = 12;
+    bool have_format = false;
+    while (offset + 8 <= size) {
+        uint8_t chunk[8];
+        if (fs_.ReadAt(handle, offset, chunk, sizeof(chunk)) != sizeof(chunk)) {
+            return false;
+        }
+        const uint32_t length = LE32_(chunk + 4);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (length < sizeof(fmt) || fs_.ReadAt(handle, offset + 8, fmt, sizeof(fmt)) != sizeof(fmt)) {
+                return false;
+            }
+            const uint16_t format = LE16_(fmt);
+            s.channels = LE16_(fmt + 2);
+            s.sample_rate = LE32_(fmt + 4);
+            const uint16_t bits = LE16_(fmt + 14);
+            // 1 = PCM, 0xFFFE = WAVE_FORMAT_EXTENSIBLE (checked by bit depth)
+            if ((format != 1 && format != 0xFFFE) || bits != 16 ||
+                s.channels < 1 || s.channels > 2 || s.sample_rate == 0) {
+                return false;
+            }
+            s.frame_bytes = static_cast<uint16_t>(s.channels * sizeof(int16_t));
+            have_format = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!have_format) {
+                return false;
+            }
+            data_offset = offset + 8;
+            data_bytes = length < size - data_offset ? length : size - data_offset;
+            return true;
+        }
+        offset += 8 + length + (length & 1);
+    }
+    return false;
+}
+
+
+int SDSampler::Trigger(int sample, float gain, float speed) {
+    if (sample < 0 || sample >= static_cast<int>(samples_.size()) || speed <= 0.f) {
+        return -1;
+    }
+
+    size_t voice = 0;
+    bool free_voice = false;
+    for (size_t i = 0; i < kVoices; i++) {
+        if (!voices_[i].active) {
+            voice = i;
+            free_voice = true;
+            break;
+        }
+        if (voices_[i].age < voices_[voice].age) {
+            voice = i;
+        }
+    }
+    if (!free_voice) {
+        steals_ = steals_ + 1;
+    }
+
+    Voice &v = voices_[voice];
+    const Sample &s = samples_[sample];
+    v.active = false;
+    v.frame = 0;
+    v.frac = 0.f;
+    v.step = speed * static_cast<float>(s.sample_rate) / output_rate_;
+    v.gain = gain;
+    v.age = ++trigger_count_;
+    v.play_sample = static_cast<uint32_t>(sample);
+    v.play_chunk = 0;
+    // Tags keep only 8 bits of the generation, so a slot left over from an
+    // earlier note would match again 256 triggers later; clear them all
+    for (size_t i = 0; i < kSlots; i++) {
+        v.slot_tag[i] = kNoTag;
+    }
+    __dmb();
+    // Slots a read in flight tags with the old generation never match
+    v.gen = v.gen + 1;
+    __dmb();
+    v.active = true;
+    return static_cast<int>(voice);
+}
+
+
+void SDSampler::Stop(int voice) {
+    if (voice >= 0 && voice < static_cast<int>(kVoices)) {
+        voices_[voice].active = false;
+    }
+}
+
+
+void SDSampler::StopAll() {
+    for (Voice &v : voices_) {
+        v.active = false;
+    }
+}
+
+
+float SDSampler::Process() {
+    float out = 0.f;
+    for (Voice &v : voices_) {
+        if (!v.active) {
+            continue;
+        }
+        const Sample &s = samples_[v.play_sample];
+        if (v.frame >= s.frames) {
+            v.active = false;
+            continue;
+        }
+
+        const float a = ReadFrame_(v, s, v.frame);
+        const float b = ReadFrame_(v, s, v.frame + 1);
+        out += v.gain * (a + (b - a) * v.frac);
+
+        v.frac += v.step;
+        const uint32_t advance = static_cast<uint32_t>(v.frac);
+        v.frame += advance;
+        v.frac -= static_cast<float>(advance);
+
+        if (v.frame >= s.preload_frames) {
+            v.play_chunk = static_cast<uint32_t>((v.frame - s.preload_frames) * s.frame_bytes / kChunkBytes);
+        }
+    }
+    return out;
+}
+
+
+size_t SDSampler::Missing_(const Voice &v, uint32_t gen, uint32_t sample, uint32_t chunk, uint32_t &first) const {
+    const Sample &s = samples_[sample];
+    for (size_t d = 0; d < kSlots; d++) {
+        const uint32_t c = chunk + static_cast<uint32_t>(d);
+        if (c >= s.n_chunks) {
+            break;
+        }
+        if (v.slot_tag[c % kSlots] != Tag_(gen, c)) {
+            first = c;
+            return d;
+        }
+    }
+    return kSlots;
+}
+
+
+bool SDSampler::Load_(Voice &v, uint32_t gen, uint32_t sample, uint32_t play_chunk, uint32_t first) {
+    const Sample &s = samples_[sample];
+
+    if (v.open_sample != sample) {
+        if (v.handle >= 0) {
+            fs_.Close(v.handle);
+        }
+        v.handle = fs_.Open(s.path.c_str());
+        v.open_sample = v.handle >= 0 ? sample : kNoSample;
+        opens_++;
+        if (v.handle < 0) {
+            return false;
+        }
+    }
+
+    // Take following missing chunks too while their slots are contiguous,
+    // so one command reads several chunks
+    uint32_t last = first;
+    while (last + 1 < s.n_chunks && last + 1 < play_chunk + kSlots && (last + 1) % kSlots != 0 &&
+           v.slot_tag[(last + 1) % kSlots] != Tag_(gen, last + 1)) {
+        last++;
+    }
+
+    for (uint32_t c = first; c <= last; c++) {
+        v.slot_tag[c % kSlots] = kNoTag;
+    }
+    __dmb();
+
+    const uint32_t offset = first * static_cast<uint32_t>(kChunkBytes);
+    size_t bytes = (last - first + 1) * kChunkBytes;
+    if (offset + bytes > s.stream_bytes) {
+        bytes = s.stream_bytes - offset;
+    }
+    const size_t got = fs_.ReadAt(v.handle, s.stream_offset + offset, v.slots[first % kSlots], bytes);
+    reads_++;
+    bytes_read_ += got;
+    __dmb();
+
+    if (got != bytes) {
+        return false;
+    }
+    if (v.gen != gen) {
+        // Retriggered during the read: the data belongs to the old note
+        return true;
+    }
+    for (uint32_t c = first; c <= last; c++) {
+        v.slot_tag[c % kSlots] = Tag_(gen, c);
+        chunks_loaded_++;
+    }
+    return true;
+}
+
+
+size_t SDSampler::Service(size_t max_reads) {
+    size_t n = 0;
+    while (max_reads == 0 || n < max_reads) {
+        int best = -1;
+        size_t best_distance = kSlots;
+        uint32_t best_gen = 0, best_sample = 0, best_chunk = 0, best_first = 0;
+
+        for (size_t i = 0; i < kVoices; i++) {
+            const Voice &v = voices_[i];
+            if (!v.active) {
+                continue;
+            }
+            const uint32_t gen = v.gen;
+            __dmb();
+            const uint32_t sample = v.play_sample;
+            const uint32_t chunk = v.play_chunk;
+            if (sample >= samples_.size() || gen == v.failed_gen) {
+                continue;
+            }
+            uint32_t first;
+            const size_t distance = Missing_(v, gen, sample, chunk, first);
+            if (distance < best_distance) {
+                best = static_cast<int>(i);
+                best_distance = distance;
+                best_gen = gen;
+                best_sample = sample;
+                best_chunk = chunk;
+                best_first = first;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+
+        Voice &v = voices_[best];
+        if (!Load_(v, best_gen, best_sample, best_chunk, best_first)) {
+            DEBUG_PRINTF("SDSampler: read failed for %s\n", samples_[best_sample].path.c_str());
+            // Don't retry this note; the voice plays silence until retriggered
+            v.failed_gen = best_gen;
+        }
+        n++;
+    }
+    return n;
+}
+
+
+SDSampler::Stats SDSampler::GetStats() const {
+    Stats s;
+    s.underruns = underruns_;
+    s.reads = reads_;
+    s.chunks_loaded = chunks_loaded_;
+    s.bytes_read = bytes_read_;
+    s.opens = opens_;
+    s.steals = steals_;
+    s.preload_bytes = preload_bytes_;
+    return s;
+}
@@ -0,0 +1,215 @@
+#ifndef __SD_SAMPLER_HPP__
+#define __SD_SAMPLER_HPP__
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "hardware/sync.h"
+
+#include "../PicoDefs.hpp"
+#include "../interface/FileSource.hpp"
+
+
+/**
+ * @brief Polyphonic one-shot sampler streaming 16-bit WAV files from disk.
+ *
+ * Load() keeps the first preload_ms of every sample in PSRAM, so a trigger
+ * starts sounding immediately. While that head plays, Service() (on the
+ * core that does not run audio) opens the file and reads ahead into the
+ * voice's SRAM chunk slots, and playback carries on from there.
+ *
+ * The preload length is adjusted so that every streamed chunk starts on a
+ * 512-byte sector of the file; each read is one or more whole chunks
+ * (several sectors, one command). Chunk c of a voice always lives in slot
+ * c % kSlots, and slots are tagged with the voice's trigger generation and
+ * chunk number, checked by the audio side before and after reading (as in
+ * SampleStream). Trigger() clears a voice's tags, so a tag can only match
+ * data loaded for the current note. A missing chunk plays silence and
+ * counts as an underrun.
+ *
+ * Mono or stereo (mixed to mono) 16-bit PCM, any sample rate.
+ */
+class SDSampler
+{
+public:
+    static constexpr size_t kVoices = 8;
+    static constexpr size_t kSlots = 4;
+    static constexpr size_t kChunkBytes = 2048;
+    static constexpr size_t kSectorBytes = 512;
+
+    static_assert(kChunkBytes % kSectorBytes == 0, "Chunks must be whole sectors");
+
+    struct Stats {
+        uint32_t underruns;         ///< Sample reads that found no data
+        uint32_t reads;             ///< Read commands issued
+        uint32_t chunks_loaded;
+        uint64_t bytes_read;
+        uint32_t opens;
+        uint32_t steals;            ///< Triggers that took over a playing voice
+        size_t preload_bytes;       ///< PSRAM used by sample heads
+    };
+
+    /**
+     * @param fs Where samples are read from (SDCard, MockFileSource).
+     * @param preload_ms Length of the resident head of each sample.
+     */
+    explicit SDSampler(FileSource &fs, float preload_ms = 100.f);
+    ~SDSampler();
+
+    void SetOutputRate(float sample_rate) { output_rate_ = sample_rate; }
+
+    /**
+     * @brief Register a WAV file and preload its head. Setup time only.
+     * @return Sample index, or -1.
+     */
+    int Load(const char *path);
+
+    inline size_t GetSampleCount() const { return samples_.size(); }
+
+    // Audio side
+
+    /**
+     * @brief Start a sample on a free voice (or the oldest one).
+     *
+     * @param speed Playback rate relative to the file's own rate.
+     * @return Voice index, or -1 for a bad sample.
+     */
+    int Trigger(int sample, float gain = 1.f, float speed = 1.f);
+
+    void Stop(int voice);
+    void StopAll();
+
+    inline bool IsPlaying(int voice) const {
+        return voice >= 0 && voice < static_cast<int>(kVoices) && voices_[voice].active;
+    }
+
+    /**
+     * @brief Mix of all voices for one output sample.
+     */
+    float Process();
+
+    // Servicing side
+
+    /**
+     * @brief Read ahead for playing voices, most urgent first.
+     *
+     * @param max_reads Stop after this many read commands (0 = until every
+     * window is full).
+     * @return Read commands issued.
+     */
+    size_t Service(size_t max_reads = 0);
+
+    Stats GetStats() const;
+
+protected:
+    static constexpr uint32_t kNoTag = 0xFFFFFFFF;
+    static constexpr uint32_t kNoSample = 0xFFFFFFFF;
+
+    struct Sample {
+        std::string path;
+        uint32_t frames;
+        uint32_t sample_rate;
+        uint16_t channels;
+        uint16_t frame_bytes;
+        int16_t *preload;           ///< First preload_frames frames (PSRAM)
+        uint32_t preload_frames;
+        uint32_t stream_offset;     ///< File offset of chunk 0
+        uint32_t stream_bytes;      ///< Bytes after the preload
+        uint32_t n_chunks;
+    };
+
+    struct Voice {
+        uint8_t slots[kSlots][kChunkBytes] __attribute__((aligned(4)));
+        volatile uint32_t slot_tag[kSlots];
+
+        // Published by the audio side
+        volatile uint32_t gen;
+        volatile uint32_t play_sample;
+        volatile uint32_t play_chunk;
+        volatile bool active;
+
+        // Audio side only
+        uint32_t frame;
+        float frac;
+        float step;
+        float gain;
+        uint32_t age;
+
+        // Servicing side only
+        int handle;
+        uint32_t open_sample;
+        uint32_t failed_gen;        ///< Trigger whose file could not be read
+    };
+
+    FileSource &fs_;
+    float preload_ms_;
+    float output_rate_;
+    std::vector<Sample> samples_;
+    Voice voices_[kVoices];
+    uint32_t trigger_count_;
+
+    volatile uint32_t underruns_;
+    volatile uint32_t steals_;
+    uint32_t reads_;
+    uint32_t chunks_loaded_;
+    uint64_t bytes_read_;
+    uint32_t opens_;
+    size_t preload_bytes_;
+
+    static inline uint32_t Tag_(uint32_t gen, uint32_t chunk) {
+        return ((gen & 0xFF) << 24) | (chunk & 0xFFFFFF);
+    }
+
+    /**
+     * @brief One frame of a voice's sample, mixed to mono, or 0 past the end.
+     */
+    float __force_inline ReadFrame_(Voice &v, const Sample &s, uint32_t frame) {
+        if (frame >= s.frames) {
+            return 0.f;
+        }
+        int32_t a, b;
+        if (frame < s.preload_frames) {
+            const int16_t *p = s.preload + frame * s.channels;
+            a = p[0];
+            b = s.channels > 1 ? p[1] : a;
+        } else {
+            const uint32_t byte = (frame - s.preload_frames) * s.frame_bytes;
+            const uint32_t chunk = byte / kChunkBytes;
+            const size_t slot = chunk % kSlots;
+            const uint32_t tag = Tag_(v.gen, chunk);
+            if (v.slot_tag[slot] != tag) {
+                underruns_ = underruns_ + 1;
+                return 0.f;
+            }
+            __dmb();
+            const int16_t *p = reinterpret_cast<const int16_t *>(v.slots[slot] + byte % kChunkBytes);
+            a = p[0];
+            b = s.channels > 1 ? p[1] : a;
+            __dmb();
+            if (v.slot_tag[slot] != tag) {
+                underruns_ = underruns_ + 1;
+                return 0.f;
+            }
+        }
+        return static_cast<float>(a + b) * (0.5f / 32768.f);
+    }
+
+    /**
+     * @brief Parse the WAV header; fills format, frames and the data offset.
+     */
+    bool ParseWav_(int handle, Sample &s, uint32_t &data_offset, uint32_t &data_bytes);
+
+    /**
+     * @brief First chunk in a voice's window that is not loaded, as a
+     * distance from the playhead, or kSlots if the window is full.
+     */
+    size_t Missing_(const Voice &v, uint32_t gen, uint32_t sample, uint32_t chunk, uint32_t &first) const;
+
+    /**
+     * @brief Load consecutive missing chunks starting at `first`.
+     */
+    bool Load_(Voice &v, uint32_t gen, uint32_t sample, uint32_t play_chunk, uint32_t first);
+};
+
+#endif  // __SD_SAMPLER_HPP__
@@ -0,0 +1,200 @@
+#ifndef __SAMPLE_PACK_HPP__
+#define __SAMPLE_PACK_HPP__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+
+// Flash memory address where audio data is loaded
+#ifndef AUDIO_FLASH_ADDRESS
+#define AUDIO_FLASH_ADDRESS    0x10200000U
+#endif
+#ifndef AUDIO_MAGIC
+#define AUDIO_MAGIC            0x4F434950U  // 'PICO'
+#endif
+
+
+/**
+ * @brief Read-only sample pack stored in flash (built by tools/build_sample_pack.py).
+ *
+ * v1 packs: 16-byte header, then 32-byte entries searched by name, float32
+ * samples at the pack's sample rate.
+ *
+ * v2 packs: 32-byte header, then 64-byte entries at index_offset, sorted by
+ * FNV-1a hash of the name so lookup is a binary search. Each entry has its
+ * own sample rate, loop points and encoding (float32, int16 or IMA-ADPCM).
+ * Sample data offsets are relative to the start of the pack and 4-byte
+ * aligned. An entry may carry a table of slice start points (onsets found
+ * offline by build_sample_pack.py --slices), stored after its data.
+ */
+namespace SamplePack {
+
+enum Encoding : uint8_t {
+    kFloat32 = 0,
+    kInt16 = 1,
+    kIMAADPCM = 2
+};
+
+constexpr uint32_t kVersion1 = 1;
+constexpr uint32_t kVersion2 = 2;
+constexpr size_t kMaxNameLength = 23;
+
+typedef struct {
+    uint32_t magic;        // 'PICO' magic number
+    uint32_t version;      // Format version
+    uint32_t file_count;   // Number of audio files
+    uint32_t sample_rate;  // Sample rate in Hz
+} header_v1_t;
+
+typedef struct {
+    char name[16];         // Null-terminated filename
+    uint32_t offset;       // Offset to audio data
+    uint32_t sample_count; // Number of samples
+    float duration;        // Duration in seconds
+    uint32_t reserved;     // Reserved for future use
+} entry_v1_t;
+
+typedef struct {
+    uint32_t magic;        // 'PICO' magic number
+    uint32_t version;      // 2
+    uint32_t file_count;   // Number of audio files
+    uint32_t sample_rate;  // Default sample rate in Hz
+    uint32_t index_offset; // Offset to the entry table
+    uint32_t reserved[3];
+} header_v2_t;
+
+typedef struct {
+    char name[kMaxNameLength + 1];  // Null-terminated filename
+    uint32_t name_hash;     // FNV-1a of name, table is sorted by this
+    uint32_t offset;        // Offset to encoded data
+    uint32_t data_bytes;    // Size of encoded data
+    uint32_t sample_count;  // Number of samples
+    uint32_t sample_rate;   // Sample rate in Hz
+    uint32_t loop_start;    // First sample of the loop
+    uint32_t loop_end;      // One past the last sample of the loop
+    uint16_t block_samples; // Samples per ADPCM block (power of 2)
+    uint8_t encoding;       // Encoding
+    uint8_t channels;       // Always 1 for now
+    uint32_t slice_offset;  // Offset to slice start points (uint32), 0 if none
+    uint32_t slice_count;   // Number of slice start points
+} entry_v2_t;
+
+static_assert(sizeof(header_v2_t) == 32, "Unexpected v2 header size");
+static_assert(sizeof(entry_v2_t) == 64, "Unexpected v2 entry size");
+
+/**
+ * @brief Everything a player needs to know about one file.
+ */
+struct Info {
+    const char *name;
+    const uint8_t *data;
+    uint32_t sample_count;
+    uint32_t sample_rate;
+    uint32_t loop_start;
+    uint32_t loop_end;
+    uint16_t block_samples;
+    Encoding encoding;
+    const uint32_t *slices;     // Slice start points, ascending, or nullptr
+    uint32_t slice_count;
+    bool found;
+};
+
+/**
+ * @brief 32-bit FNV-1a hash of a null-terminated name.
+ */
+inline uint32_t Hash(const char *name) {
+    uint32_t h = 2166136261u;
+    while (*name) {
+        h ^= static_cast<uint8_t>(*name++);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Look up a file by name (without .wav extension).
+ *
+ * @param filename Name to look for.
+ * @param info Filled in; info.found is false if the file is not there.
+ * @param pack Start of the pack, AUDIO_FLASH_ADDRESS by default.
+ * @return true if found.
+ */
+inline bool Find(const char *filename, Info &info,
+                 const uint8_t *pack = reinterpret_cast<const uint8_t *>(AUDIO_FLASH_ADDRESS)) {
+    std::memset(&info, 0, sizeof(info));
+    if (!filename || !pack) {
+        return false;
+    }
+
+    const header_v1_t *header = reinterpret_cast<const header_v1_t *>(pack);
+    if (header->magic != AUDIO_MAGIC) {
+        return false;
+    }
+
+    if (header->version == kVersion1) {
+        const entry_v1_t *table = reinterpret_cast<const entry_v1_t *>(pack + sizeof(header_v1_t));
+        for (uint32_t i = 0; i < header->file_count; i++) {
+            if (std::strncmp(table[i].name, filename, sizeof(table[i].name)) == 0) {
+                info.name = table[i].name;
+                info.data = pack + table[i].offset;
+                info.sample_count = table[i].sample_count;
+                info.sample_rate = header->sample_rate;
+                info.loop_start = 0;
+                info.loop_end = table[i].sample_count;
+                info.encoding = kFloat32;
+                info.found = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (header->version != kVersion2) {
+        return false;
+    }
+
+    const header_v2_t *header2 = reinterpret_cast<const header_v2_t *>(pack);
+    const entry_v2_t *table = reinterpret_cast<const entry_v2_t *>(pack + header2->index_offset);
+    const uint32_t hash = Hash(filename);
+
+    // Lower bound on hash, then check names of equal-hash entries
+    uint32_t lo = 0;
+    uint32_t hi = header2->file_count;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (table[mid].name_hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (; lo < header2->file_count && table[lo].name_hash == hash; lo++) {
+        const entry_v2_t &e = table[lo];
+        if (std::strncmp(e.name, filename, sizeof(e.name)) != 0) {
+            continue;
+        }
+        if (e.encoding > kIMAADPCM) {
+            return false;
+        }
+        info.name = e.name;
+        info.data = pack + e.offset;
+        info.sample_count = e.sample_count;
+        info.sample_rate = e.sample_rate ? e.sample_rate : header2->sample_rate;
+        info.loop_end = (e.loop_end == 0 || e.loop_end > e.sample_count) ? e.sample_count : e.loop_end;
+        info.loop_start = e.loop_start < info.loop_end ? e.loop_start : 0;
+        info.block_samples = e.block_samples;
+        info.encoding = static_cast<Encoding>(e.encoding);
+        if (e.slice_offset && e.slice_count) {
+            info.slices = reinterpret_cast<const uint32_t *>(pack + e.slice_offset);
+            info.slice_count = e.slice_count;
+        }
+        info.found = true;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace SamplePack
+
+#endif  // __SAMPLE_PACK_HPP__
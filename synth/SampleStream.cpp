@@ -0,0 +1,206 @@
+#include "SampleStream.hpp"
+#include "hardware/dma.h"
+
+
+SampleStream::SampleStream() :
+    last_slot_(0),
+    source_(nullptr),
+    total_bytes_(0),
+    block_bytes_(0),
+    n_blocks_(0),
+    loop_first_(0),
+    loop_last_(0),
+    play_block_(0),
+    direction_(1),
+    jump_block_(kNoBlock),
+    underruns_(0),
+    loads_(0)
+{
+    for (size_t i = 0; i < kSlots; i++) {
+        slot_block_[i] = kNoBlock;
+    }
+}
+
+bool SampleStream::Configure(const uint8_t *source, size_t total_bytes, size_t block_bytes,
+                             uint32_t loop_first_block, uint32_t loop_last_block)
+{
+    if (!source || block_bytes == 0 || block_bytes > kMaxBlockBytes || total_bytes == 0) {
+        DEBUG_PRINTLN("SampleStream: invalid configuration");
+        return false;
+    }
+
+    for (size_t i = 0; i < kSlots; i++) {
+        slot_block_[i] = kNoBlock;
+    }
+    source_ = source;
+    total_bytes_ = total_bytes;
+    block_bytes_ = block_bytes;
+    n_blocks_ = static_cast<uint32_t>((total_bytes + block_bytes - 1) / block_bytes);
+    loop_last_ = loop_last_block < n_blocks_ ? loop_last_block : n_blocks_ - 1;
+    loop_first_ = loop_first_block <= loop_last_ ? loop_first_block : 0;
+    play_block_ = 0;
+    direction_ = 1;
+    jump_block_ = kNoBlock;
+    return true;
+}
+
+uint32_t SampleStream::Step_(uint32_t block, int32_t direction) const
+{
+    if (direction >= 0) {
+        return (block >= loop_last_ || block + 1 >= n_blocks_) ? loop_first_ : block + 1;
+    }
+    return (block == loop_first_ || block == 0) ? loop_last_ : block - 1;
+}
+
+size_t SampleStream::Window_(uint32_t *wanted) const
+{
+    const uint32_t current = play_block_ < n_blocks_ ? play_block_ : 0;
+    const int32_t direction = direction_;
+    const uint32_t jump = jump_block_;
+
+    size_t n = 0;
+    auto push = [&](uint32_t block) {
+        for (size_t i = 0; i < n; i++) {
+            if (wanted[i] == block) {
+                return;
+            }
+        }
+        wanted[n++] = block;
+    };
+
+    push(current);
+    uint32_t ahead = current;
+    for (size_t i = 0; i < kSlots - 3; i++) {
+        ahead = Step_(ahead, direction);
+        push(ahead);
+    }
+    if (jump < n_blocks_) {
+        push(jump);
+    }
+    push(Step_(current, -direction));
+    return n;
+}
+
+int SampleStream::Find_(uint32_t block) const
+{
+    for (size_t i = 0; i < kSlots; i++) {
+        if (slot_block_[i] == block) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int SampleStream::Victim_(const uint32_t *wanted, size_t n_wanted) const
+{
+    int victim = -1;
+    for (size_t i = 0; i < kSlots; i++) {
+        const uint32_t block = slot_block_[i];
+        if (block == kNoBlock) {
+            return static_cast<int>(i);
+        }
+        bool in_window = false;
+        for (size_t w = 0; w < n_wanted; w++) {
+            if (wanted[w] == block) {
+                in_window = true;
+                break;
+            }
+        }
+        if (!in_window && victim < 0) {
+            victim = static_cast<int>(i);
+        }
+    }
+    return victim;
+}
+
+
+SampleStreamer::SampleStreamer() :
+    dma_channel_(-1),
+    streams_{},
+    n_streams_(0),
+    blocks_loaded_(0)
+{
+}
+
+SampleStreamer::~SampleStreamer()
+{
+    if (dma_channel_ >= 0) {
+        dma_channel_unclaim(dma_channel_);
+    }
+}
+
+bool SampleStreamer::Begin()
+{
+    if (dma_channel_ < 0) {
+        dma_channel_ = dma_claim_unused_channel(false);
+    }
+    if (dma_channel_ < 0) {
+        DEBUG_PRINTLN("SampleStreamer: no DMA channel, using memcpy");
+        return false;
+    }
+    return true;
+}
+
+bool SampleStreamer::Add(SampleStream *stream)
+{
+    if (!stream || n_streams_ >= kMaxStreams) {
+        return false;
+    }
+    for (size_t i = 0; i < n_streams_; i++) {
+        if (streams_[i] == stream) {
+            return true;
+        }
+    }
+    streams_[n_streams_++] = stream;
+    return true;
+}
+
+void SampleStreamer::Remove(SampleStream *stream)
+{
+    for (size_t i = 0; i < n_streams_; i++) {
+        if (streams_[i] == stream) {
+            streams_[i] = streams_[--n_streams_];
+            streams_[n_streams_] = nullptr;
+            return;
+        }
+    }
+}
+
+size_t SampleStreamer::Service()
+{
+    size_t n = 0;
+    for (size_t i = 0; i < n_streams_; i++) {
+        n += streams_[i]->Fill([this](uint8_t *dst, const uint8_t *src, size_t bytes) {
+            Copy_(dst, src, bytes);
+        });
+    }
+    blocks_loaded_ += n;
+    return n;
+}
+
+uint32_t SampleStreamer::GetUnderruns() const
+{
+    uint32_t total = 0;
+    for (size_t i = 0; i < n_streams_; i++) {
+        total += streams_[i]->GetUnderruns();
+    }
+    return total;
+}
+
+void SampleStreamer::Copy_(uint8_t *dst, const uint8_t *src, size_t bytes)
+{
+    if (dma_channel_ < 0) {
+        memcpy(dst, src, bytes);
+        return;
+    }
+
+    // Word transfers when both ends allow it (pack data is 4-byte aligned)
+    const bool words = ((reinterpret_cast<uintptr_t>(src) | reinterpret_cast<uintptr_t>(dst) | bytes) & 3) == 0;
+
+    dma_channel_config c = dma_channel_get_default_config(dma_channel_);
+    channel_config_set_transfer_data_size(&c, words ? DMA_SIZE_32 : DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    dma_channel_configure(dma_channel_, &c, dst, src, words ? bytes / 4 : bytes, true);
+    dma_channel_wait_for_finish_blocking(dma_channel_);
+}
@@ -0,0 +1,250 @@
+#ifndef __SAMPLE_STREAM_HPP__
+#define __SAMPLE_STREAM_HPP__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "hardware/sync.h"
+
+#include "../PicoDefs.hpp"
+
+
+/**
+ * @brief SRAM read-ahead window over one voice's sample data in flash or PSRAM.
+ *
+ * The data is split into fixed-size blocks. The audio side publishes which
+ * block it is playing (and which block it will jump to next, if it knows),
+ * and a SampleStreamer running outside the audio interrupt copies the
+ * blocks around the playhead into kSlots SRAM slots:
+ *
+ *     one block behind, the current block, kSlots - 3 blocks ahead
+ *     (following the loop points and direction), the jump target
+ *
+ * Each slot is tagged with the block it holds. The streamer clears the tag
+ * before overwriting a slot and sets it after the copy completes, so the
+ * audio side checks the tag before and after reading. A miss counts as an
+ * underrun and the caller reads the block straight from Source() instead,
+ * so a late prefetch costs time rather than a glitch.
+ */
+class SampleStream
+{
+public:
+    static constexpr size_t kSlots = 5;
+    static constexpr size_t kMaxBlockBytes = 512;
+    static constexpr uint32_t kNoBlock = 0xFFFFFFFF;
+
+    static_assert(kSlots >= 4, "Need room for behind, current, ahead and jump blocks");
+
+    SampleStream();
+
+    /**
+     * @brief Point the stream at new data. Call while the stream is not
+     * being serviced (before SampleStreamer::Add, or from the servicing core).
+     *
+     * @param source Start of the data in flash or PSRAM.
+     * @param total_bytes Data size; the last block may be short.
+     * @param block_bytes Block size, at most kMaxBlockBytes.
+     * @param loop_first_block Block that playback wraps to.
+     * @param loop_last_block Block that playback wraps from.
+     * @return false if the block size is too large.
+     */
+    bool Configure(const uint8_t *source, size_t total_bytes, size_t block_bytes,
+                   uint32_t loop_first_block, uint32_t loop_last_block);
+
+    inline bool IsConfigured() const { return source_ != nullptr; }
+
+    // Audio side
+
+    /**
+     * @brief Publish the playhead.
+     *
+     * @param block Block being played.
+     * @param direction Playback direction, +1 or -1.
+     * @param jump_block Block playback will jump to next, or kNoBlock.
+     */
+    void __force_inline SetPlayhead(uint32_t block, int32_t direction, uint32_t jump_block = kNoBlock) {
+        play_block_ = block;
+        direction_ = direction < 0 ? -1 : 1;
+        jump_block_ = jump_block;
+    }
+
+    /**
+     * @brief Find a block in SRAM.
+     *
+     * @return The block's bytes, or nullptr (counted as an underrun).
+     */
+    __force_inline const uint8_t *Acquire(uint32_t block) {
+        if (slot_block_[last_slot_] != block) {
+            size_t i = 0;
+            while (i < kSlots && slot_block_[i] != block) {
+                i++;
+            }
+            if (i == kSlots) {
+                underruns_ = underruns_ + 1;
+                return nullptr;
+            }
+            last_slot_ = i;
+        }
+        __dmb();
+        return slots_[last_slot_];
+    }
+
+    /**
+     * @brief Check that a block returned by Acquire() was not replaced
+     * while it was being read.
+     *
+     * @return true if the data read is valid; false counts an underrun.
+     */
+    bool __force_inline Release(uint32_t block, const uint8_t *data) {
+        __dmb();
+        const size_t slot = static_cast<size_t>((data - slots_[0]) / kMaxBlockBytes);
+        if (slot_block_[slot] == block) {
+            return true;
+        }
+        underruns_ = underruns_ + 1;
+        return false;
+    }
+
+    /**
+     * @brief Direct pointer to a block in flash/PSRAM, for misses.
+     */
+    inline const uint8_t *Source(uint32_t block) const {
+        return source_ + static_cast<size_t>(block) * block_bytes_;
+    }
+
+    inline size_t GetBlockBytes() const { return block_bytes_; }
+
+    uint32_t GetUnderruns() const { return underruns_; }
+    uint32_t GetLoads() const { return loads_; }
+    void ResetCounters() { underruns_ = 0; loads_ = 0; }
+
+    // Servicing side
+
+    /**
+     * @brief Copy any missing blocks of the current window into SRAM.
+     *
+     * @param copy Callable copy(dst, src, bytes), e.g. a DMA transfer.
+     * @return Number of blocks copied.
+     */
+    template<typename CopyFn>
+    size_t Fill(CopyFn copy) {
+        if (!source_) {
+            return 0;
+        }
+
+        uint32_t wanted[kSlots];
+        const size_t n_wanted = Window_(wanted);
+
+        size_t n_loaded = 0;
+        for (size_t w = 0; w < n_wanted; w++) {
+            if (Find_(wanted[w]) >= 0) {
+                continue;
+            }
+            const int victim = Victim_(wanted, n_wanted);
+            if (victim < 0) {
+                break;
+            }
+
+            const size_t offset = static_cast<size_t>(wanted[w]) * block_bytes_;
+            const size_t remaining = total_bytes_ - offset;
+            const size_t n = remaining < block_bytes_ ? remaining : block_bytes_;
+
+            slot_block_[victim] = kNoBlock;
+            __dmb();
+            copy(slots_[victim], source_ + offset, n);
+            __dmb();
+            slot_block_[victim] = wanted[w];
+
+            loads_ = loads_ + 1;
+            n_loaded++;
+        }
+        return n_loaded;
+    }
+
+protected:
+    uint8_t slots_[kSlots][kMaxBlockBytes] __attribute__((aligned(4)));
+    volatile uint32_t slot_block_[kSlots];
+    size_t last_slot_;
+
+    const uint8_t *source_;
+    size_t total_bytes_;
+    size_t block_bytes_;
+    uint32_t n_blocks_;
+    uint32_t loop_first_;
+    uint32_t loop_last_;
+
+    volatile uint32_t play_block_;
+    volatile int32_t direction_;
+    volatile uint32_t jump_block_;
+
+    volatile uint32_t underruns_;
+    volatile uint32_t loads_;
+
+    /**
+     * @brief Next block in playback order, following the loop points.
+     */
+    uint32_t Step_(uint32_t block, int32_t direction) const;
+
+    /**
+     * @brief Blocks that should be resident, most urgent first.
+     */
+    size_t Window_(uint32_t *wanted) const;
+
+    int Find_(uint32_t block) const;
+
+    /**
+     * @brief A slot holding nothing, or a block outside the window.
+     */
+    int Victim_(const uint32_t *wanted, size_t n_wanted) const;
+};
+
+
+/**
+ * @brief Keeps a set of SampleStreams topped up.
+ *
+ * Service() is called from a main loop, ideally on the core that does not
+ * run the audio callback. Copies use one DMA channel when available (the
+ * calling core waits for each block, which is a few microseconds) and
+ * fall back to memcpy otherwise. Add() and Remove() must be called from
+ * the same core as Service().
+ */
+class SampleStreamer
+{
+public:
+    static constexpr size_t kMaxStreams = 32;
+
+    SampleStreamer();
+    ~SampleStreamer();
+
+    /**
+     * @brief Claim a DMA channel for copies.
+     * @return false if none was free (memcpy is used instead).
+     */
+    bool Begin();
+
+    bool Add(SampleStream *stream);
+    void Remove(SampleStream *stream);
+
+    /**
+     * @brief Refill every stream's window.
+     * @return Number of blocks copied.
+     */
+    size_t Service();
+
+    /**
+     * @brief Underruns summed over all streams.
+     */
+    uint32_t GetUnderruns() const;
+
+    uint32_t GetBlocksLoaded() const { return blocks_loaded_; }
+
+protected:
+    int dma_channel_;
+    SampleStream *streams_[kMaxStreams];
+    size_t n_streams_;
+    uint32_t blocks_loaded_;
+
+    void Copy_(uint8_t *dst, const uint8_t *src, size_t bytes);
+};
+
+#endif  // __SAMPLE_STREAM_HPP__
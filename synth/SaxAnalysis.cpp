@@ -143,7 +143,8 @@ SaxAnalysis::parameters_t AUDIO_FUNC(SaxAnalysis::Process)(const float x) {
     params.energy = ef_y;
     params.attack = ef_d_dy;
     params.brightness = br_high;
-    params.energy_crude = std::abs(x);
+    ec_window_.Process(x);
+    params.energy_crude = ec_window_.RMS();
 
     return params;
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "../audio/AudioDriver.hpp"
 #include "../utils/MedianFilter.h"
 #include "../utils/CircularBuffer.hpp"
+#include "../utils/WindowStats.hpp"
 #include "maximilian.h"
 
 #include <cmath>
@@ -52,6 +53,8 @@ protected:
     maxiBiquad br_hpf2_;
     maxiBiquad br_lpf2_;
     maxiEnvelopeFollowerF br_follower_[kBR_NBands];
+    // Crude energy: RMS of the raw input over ~5 ms
+    WindowStats<256> ec_window_;
 
 };
 
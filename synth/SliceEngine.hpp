@@ -0,0 +1,522 @@
+#ifndef __SLICE_ENGINE_HPP__
+#define __SLICE_ENGINE_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#include "SamplePack.hpp"
+#include "../utils/TripleBuffer.hpp"
+
+
+/**
+ * @brief How a sliced loop is cut up and sequenced.
+ *
+ * slices are regions of the loop (usually starting at onsets), steps is
+ * the pattern: one entry per grid step, either the slice to trigger there,
+ * kTie (let the current slice carry on) or kRest (fade it out). Each slice
+ * has its own playback rate (pitch), gain, direction and stutter count
+ * (retriggers spread evenly across the step).
+ */
+struct SliceTable {
+    static constexpr size_t kMaxSlices = 64;
+    static constexpr size_t kMaxSteps = 64;
+    static constexpr int8_t kTie = -1;
+    static constexpr int8_t kRest = -2;
+
+    struct Slice {
+        uint32_t start;     // First sample
+        uint32_t length;    // Samples up to the next slice
+        float rate;         // Playback speed, 1 = natural, 2 = octave up
+        float gain;
+        uint8_t stutter;    // Triggers per step, 1 = no stutter
+        bool reverse;
+    };
+
+    Slice slices[kMaxSlices];
+    int8_t steps[kMaxSteps];
+    uint8_t num_slices;
+    uint8_t num_steps;
+
+    /**
+     * @brief One slice per onset, and a pattern that plays the loop as it
+     * was recorded: each step triggers the slice starting within half a
+     * step of it, or ties.
+     *
+     * @param onsets Slice start points, ascending (e.g. SamplePack::Info::slices).
+     * @param count Number of onsets; onsets beyond kMaxSlices are dropped.
+     * @param loop_length Loop length in samples.
+     * @param steps_per_loop Number of grid steps, up to kMaxSteps.
+     */
+    void SetFromOnsets(const uint32_t *onsets, size_t count, uint32_t loop_length,
+                       size_t steps_per_loop = 16) {
+        num_slices = 0;
+        for (size_t i = 0; i < count && num_slices < kMaxSlices; i++) {
+            if (onsets[i] >= loop_length ||
+                (num_slices && onsets[i] <= slices[num_slices - 1].start)) {
+                continue;
+            }
+            slices[num_slices++] = { onsets[i], 0, 1.f, 1.f, 1, false };
+        }
+        if (!num_slices) {
+            slices[num_slices++] = { 0, 0, 1.f, 1.f, 1, false };
+        }
+        for (size_t i = 0; i < num_slices; i++) {
+            const uint32_t end = i + 1 < num_slices ? slices[i + 1].start : loop_length;
+            slices[i].length = end - slices[i].start;
+        }
+
+        num_steps = static_cast<uint8_t>(steps_per_loop < 1 ? 1 :
+                                         (steps_per_loop > kMaxSteps ? kMaxSteps : steps_per_loop));
+        const uint32_t half = loop_length / (2 * num_steps);
+        size_t j = 0;
+        for (size_t s = 0; s < num_steps; s++) {
+            const uint32_t grid = static_cast<uint32_t>(
+                static_cast<uint64_t>(s) * loop_length / num_steps);
+            while (j < num_slices && slices[j].start + half < grid) {
+                j++;
+            }
+            steps[s] = (j < num_slices && slices[j].start <= grid + half) ?
+                static_cast<int8_t>(j) : kTie;
+        }
+        if (steps[0] == kTie) {
+            steps[0] = 0;
+        }
+    }
+};
+
+
+/**
+ * @brief Plays a loop from a SliceTable, in time with a tempo.
+ *
+ * The loop is retriggered on the grid rather than time-stretched: each
+ * step lasts loop_beats / num_steps beats at the current tempo (the
+ * fractional part of a step is carried over, so the grid does not drift)
+ * and triggers its slice from the start. Slice changes crossfade over
+ * kFadeSamples: the outgoing slice becomes a tail that fades out while
+ * the new one fades in.
+ *
+ * Rendering is a block at a time. Steps and stutters split the block into
+ * runs, and within a run each playing slice is one contiguous,
+ * interpolated read whose length was worked out when it was triggered, so
+ * the inner loop has no bounds checks or wrapping.
+ *
+ * The table is edited from the main loop with EditTable() and
+ * PublishTable(); the audio side picks up the new one at its next step,
+ * with no locking (see TripleBuffer). SetLoop() is for setup, before
+ * playback starts.
+ *
+ * @tparam Sample float or int16_t sample data, read in place (flash, PSRAM
+ * or SRAM). IMA-ADPCM is not supported, as slices need random access.
+ */
+template<typename Sample = float>
+class SlicedLoop {
+    static_assert(std::is_same<Sample, float>::value || std::is_same<Sample, int16_t>::value,
+                  "Sample must be float or int16_t");
+
+public:
+    static constexpr uint32_t kFadeSamples = 64;
+
+    SlicedLoop() :
+        data_(nullptr),
+        length_(0),
+        sample_rate_(48000.f),
+        rate_ratio_(1.f),
+        samples_per_beat_(24000.f),
+        loop_beats_(4.f),
+        gain_(1.f),
+        table_(nullptr),
+        step_(0),
+        slice_(0),
+        event_left_(0),
+        sub_length_(0),
+        subs_left_(0),
+        step_carry_(0.f),
+        playing_(false),
+        restart_(false),
+        cur_{},
+        tail_{} {}
+
+    /**
+     * @brief Output sample rate; call before SetLoop() and SetTempo().
+     */
+    void Setup(float sample_rate) {
+        sample_rate_ = sample_rate;
+    }
+
+    /**
+     * @brief Loop data and its slice points; resets the table to play the
+     * loop as recorded over num_steps steps.
+     *
+     * @param data Samples, which must stay valid while the loop plays.
+     * @param length Number of samples.
+     * @param loop_rate Sample rate the loop was recorded at.
+     * @param onsets Slice start points, or nullptr for a single slice.
+     * @return false if there is nothing to play.
+     */
+    bool SetLoop(const Sample *data, uint32_t length, float loop_rate,
+                 const uint32_t *onsets = nullptr, size_t onset_count = 0,
+                 size_t num_steps = 16) {
+        if (!data || length < 2) {
+            return false;
+        }
+        playing_ = false;
+        cur_.active = tail_.active = false;
+        data_ = data;
+        length_ = length;
+        rate_ratio_ = loop_rate / sample_rate_;
+        const uint32_t whole = 0;
+        if (!onsets || !onset_count) {
+            onsets = &whole;
+            onset_count = 1;
+        }
+        for (size_t i = 0; i < 3; i++) {
+            tables_.Raw(i).SetFromOnsets(onsets, onset_count, length, num_steps);
+        }
+        table_ = &tables_.Front();
+        return true;
+    }
+
+    /**
+     * @brief Loop from a sample pack entry, sliced at its stored onsets
+     * (tools/build_sample_pack.py --slices).
+     *
+     * @return false if not found or not in this player's Sample encoding.
+     */
+    bool SetLoop(const SamplePack::Info &info, size_t num_steps = 16) {
+        const SamplePack::Encoding encoding = std::is_same<Sample, float>::value ?
+            SamplePack::kFloat32 : SamplePack::kInt16;
+        if (!info.found || info.encoding != encoding) {
+            return false;
+        }
+        return SetLoop(reinterpret_cast<const Sample *>(info.data), info.sample_count,
+                       static_cast<float>(info.sample_rate), info.slices, info.slice_count,
+                       num_steps);
+    }
+
+    void SetTempo(float bpm) {
+        if (bpm > 0.f) {
+            samples_per_beat_ = 60.f * sample_rate_ / bpm;
+        }
+    }
+
+    /**
+     * @brief How many beats one pass of the step pattern lasts.
+     */
+    void SetLoopBeats(float beats) {
+        if (beats > 0.f) {
+            loop_beats_ = beats;
+        }
+    }
+
+    void SetGain(float gain) {
+        gain_ = gain;
+    }
+
+    /**
+     * @brief Start from step 0 at the next Process() call.
+     */
+    void Start() {
+        restart_ = true;
+        playing_ = true;
+    }
+
+    /**
+     * @brief Fade out and stop stepping.
+     */
+    void Stop() {
+        playing_ = false;
+    }
+
+    bool IsPlaying() const { return playing_; }
+
+    /**
+     * @brief Step that plays next (audio side, for display).
+     */
+    size_t GetStep() const { return step_; }
+
+    /**
+     * @brief Main loop: the table to edit. It starts as a copy of the last
+     * published one.
+     */
+    SliceTable &EditTable() { return tables_.Back(); }
+
+    /**
+     * @brief Main loop: hand the edited table to the audio side.
+     */
+    void PublishTable() {
+        const SliceTable *sent = &tables_.Back();
+        tables_.Publish();
+        // The reader never writes tables, so the one just sent can be read
+        tables_.Back() = *sent;
+    }
+
+    void SetTable(const SliceTable &table) {
+        tables_.Back() = table;
+        PublishTable();
+    }
+
+    /**
+     * @brief Adds n samples of the loop to out.
+     */
+    void ProcessAdd(float *out, size_t n) {
+        if (!data_) {
+            return;
+        }
+        if (restart_) {
+            restart_ = false;
+            step_ = 0;
+            event_left_ = 0;
+            subs_left_ = 0;
+            step_carry_ = 0.f;
+        }
+        const bool playing = playing_;
+        if (!playing && cur_.active) {
+            FadeOut_(cur_);
+            tail_ = cur_;
+            cur_.active = false;
+        }
+        size_t i = 0;
+        while (i < n) {
+            uint32_t run = static_cast<uint32_t>(n - i);
+            if (playing) {
+                if (!event_left_) {
+                    Event_();
+                }
+                run = event_left_ < run ? event_left_ : run;
+                event_left_ -= run;
+            }
+            Render_(cur_, out + i, run);
+            Render_(tail_, out + i, run);
+            i += run;
+        }
+    }
+
+    void Process(float *out, size_t n) {
+        std::fill(out, out + n, 0.f);
+        ProcessAdd(out, n);
+    }
+
+protected:
+
+    // One slice being played: fixed-point position, a bounded number of
+    // samples left, and a gain ramp
+    struct Reader_ {
+        int32_t idx;
+        uint32_t frac;
+        int32_t inc_int;
+        uint32_t inc_frac;
+        uint32_t left;
+        uint32_t ramp_left;
+        float gain;
+        float gain_step;
+        float level;
+        bool active;
+    };
+
+    static constexpr float kSampleScale = std::is_same<Sample, float>::value ? 1.f : 1.f / 32768.f;
+
+    const Sample *data_;
+    uint32_t length_;
+    float sample_rate_;
+    float rate_ratio_;
+    float samples_per_beat_;
+    float loop_beats_;
+    float gain_;
+    TripleBuffer<SliceTable> tables_;
+    const SliceTable *table_;
+    size_t step_;
+    size_t slice_;
+    uint32_t event_left_;
+    uint32_t sub_length_;
+    uint32_t subs_left_;
+    float step_carry_;
+    volatile bool playing_;
+    volatile bool restart_;
+    Reader_ cur_;
+    Reader_ tail_;
+
+    // A step or stutter boundary
+    void Event_() {
+        if (subs_left_) {
+            subs_left_--;
+            Trigger_(table_->slices[slice_]);
+            event_left_ = sub_length_;
+            return;
+        }
+        if (tables_.Update()) {
+            table_ = &tables_.Front();
+        }
+        if (step_ >= table_->num_steps) {
+            step_ = 0;
+        }
+        const float length = samples_per_beat_ * loop_beats_ / static_cast<float>(table_->num_steps) +
+                             step_carry_;
+        uint32_t step_length = static_cast<uint32_t>(length);
+        step_carry_ = length - static_cast<float>(step_length);
+        step_length = step_length ? step_length : 1;
+        event_left_ = step_length;
+
+        const int8_t s = table_->steps[step_++];
+        if (s >= 0 && s < table_->num_slices) {
+            slice_ = static_cast<size_t>(s);
+            const SliceTable::Slice &slice = table_->slices[slice_];
+            Trigger_(slice);
+            const uint32_t subs = slice.stutter > 1 ? slice.stutter : 1;
+            sub_length_ = step_length / subs;
+            subs_left_ = sub_length_ ? subs - 1 : 0;
+            // The first trigger takes the remainder
+            event_left_ = step_length - sub_length_ * subs_left_;
+        } else if (s == SliceTable::kRest && cur_.active) {
+            FadeOut_(cur_);
+            tail_ = cur_;
+            cur_.active = false;
+        }
+    }
+
+    void Trigger_(const SliceTable::Slice &slice) {
+        if (cur_.active) {
+            FadeOut_(cur_);
+            tail_ = cur_;
+        }
+        Reader_ &r = cur_;
+        r.active = false;
+        const float speed = slice.rate * rate_ratio_;
+        const int64_t inc = static_cast<int64_t>(speed * 4294967296.f);
+        // Forward slices may run on into the rest of the loop; reverse
+        // ones start at their end and stop at their start
+        const uint32_t lo = slice.start;
+        const uint32_t hi = slice.reverse ? slice.start + slice.length : length_;
+        if (inc <= 0 || hi > length_ || hi < lo + 2) {
+            return;
+        }
+        // Number of output samples whose reads (idx, idx + 1) stay in [lo, hi)
+        uint64_t left;
+        if (slice.reverse) {
+            r.idx = static_cast<int32_t>(hi - 2);
+            left = (static_cast<uint64_t>(hi - 2 - lo) << 32) / static_cast<uint64_t>(inc) + 1;
+            r.inc_int = static_cast<int32_t>((-inc) >> 32);
+            r.inc_frac = static_cast<uint32_t>(-inc);
+        } else {
+            r.idx = static_cast<int32_t>(lo);
+            const uint64_t dist = static_cast<uint64_t>(hi - 1 - lo) << 32;
+            left = (dist + static_cast<uint64_t>(inc) - 1) / static_cast<uint64_t>(inc);
+            r.inc_int = static_cast<int32_t>(inc >> 32);
+            r.inc_frac = static_cast<uint32_t>(inc);
+        }
+        r.frac = 0;
+        r.left = left > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(left);
+        r.level = slice.gain * gain_ * kSampleScale;
+        r.gain = 0.f;
+        r.gain_step = r.level * (1.f / static_cast<float>(kFadeSamples));
+        r.ramp_left = kFadeSamples;
+        r.active = true;
+    }
+
+    static inline void FadeOut_(Reader_ &r) {
+        r.level = 0.f;
+        r.gain_step = -r.gain * (1.f / static_cast<float>(kFadeSamples));
+        r.ramp_left = kFadeSamples;
+        r.left = r.left < kFadeSamples ? r.left : kFadeSamples;
+    }
+
+    inline void Render_(Reader_ &r, float *out, uint32_t n) {
+        if (!r.active) {
+            return;
+        }
+        const uint32_t m = n < r.left ? n : r.left;
+        const uint32_t ramp = m < r.ramp_left ? m : r.ramp_left;
+        if (ramp) {
+            Run_<true>(r, out, ramp);
+            r.ramp_left -= ramp;
+            if (!r.ramp_left) {
+                r.gain = r.level;
+            }
+        }
+        Run_<false>(r, out + ramp, m - ramp);
+        r.left -= m;
+        if (!r.left) {
+            r.active = false;
+        }
+    }
+
+    template<bool kRamp>
+    inline void Run_(Reader_ &r, float *out, uint32_t n) {
+        const Sample *d = data_;
+        int32_t idx = r.idx;
+        uint32_t frac = r.frac;
+        const int32_t inc_int = r.inc_int;
+        const uint32_t inc_frac = r.inc_frac;
+        float g = r.gain;
+        const float dg = r.gain_step;
+        for (uint32_t j = 0; j < n; j++) {
+            const float y0 = static_cast<float>(d[idx]);
+            const float y1 = static_cast<float>(d[idx + 1]);
+            const float f = static_cast<float>(frac >> 8) * (1.f / 16777216.f);
+            out[j] += g * (y0 + f * (y1 - y0));
+            if constexpr (kRamp) {
+                g += dg;
+            }
+            const uint32_t prev = frac;
+            frac += inc_frac;
+            idx += inc_int + (frac < prev);
+        }
+        r.idx = idx;
+        r.frac = frac;
+        r.gain = g;
+    }
+};
+
+
+/**
+ * @brief N sliced loops on one clock.
+ *
+ * Tempo and transport are shared, so loops with the same step length stay
+ * sample-locked, and others stay within a sample of the grid. Each loop
+ * has its own data, table, length in beats and gain (see Loop()).
+ *
+ * @tparam N Number of loops.
+ */
+template<size_t N, typename Sample = float>
+class SliceEngine {
+public:
+    void Setup(float sample_rate) {
+        for (auto &loop : loops_) {
+            loop.Setup(sample_rate);
+        }
+    }
+
+    SlicedLoop<Sample> &Loop(size_t i) { return loops_[i]; }
+
+    void SetTempo(float bpm) {
+        for (auto &loop : loops_) {
+            loop.SetTempo(bpm);
+        }
+    }
+
+    void Start() {
+        for (auto &loop : loops_) {
+            loop.Start();
+        }
+    }
+
+    void Stop() {
+        for (auto &loop : loops_) {
+            loop.Stop();
+        }
+    }
+
+    void Process(float *out, size_t n) {
+        std::fill(out, out + n, 0.f);
+        for (auto &loop : loops_) {
+            loop.ProcessAdd(out, n);
+        }
+    }
+
+protected:
+    SlicedLoop<Sample> loops_[N];
+};
+
+#endif // __SLICE_ENGINE_HPP__
@@ -71,6 +71,34 @@ static t_tabpoint __not_in_flash("paf") paf_cauchy[TABSIZE];
 static bool tabsGenerated = false;
 
 
+static void paf_maketabs()
+{
+    if (tabsGenerated) return;
+    const float CAUCHYFAKEAT3  =
+        (CAUCHYVAL + ADDSQ * TABRANGE * TABRANGE);
+    const float CAUCHYRESIZE = (1./ (1. - CAUCHYFAKEAT3));
+    for (size_t i = 0; i <= TABSIZE; i++)
+    {
+        float f = i * ((float)TABRANGE/(float)TABSIZE);
+        float gauss = expf(-f * f);
+        float cauchygenuine = 1.f / (1.f + f * f);
+        float cauchyfake = cauchygenuine + ADDSQ * f * f;
+        float cauchyrenorm = (cauchyfake - 1.) * CAUCHYRESIZE + 1.;
+        if (i != TABSIZE)
+        {
+            paf_gauss[i].p_y = gauss;
+            paf_cauchy[i].p_y = cauchyrenorm;
+        }
+        if (i != 0)
+        {
+            paf_gauss[i-1].p_diff = gauss - paf_gauss[i-1].p_y;
+            paf_cauchy[i-1].p_diff = cauchyrenorm - paf_cauchy[i-1].p_y;
+        }
+    }
+    tabsGenerated = true;
+}
+
+
 class maxiPAFOperator {
 public:
 
@@ -85,31 +113,7 @@ public:
 
     void init()
     {
-        int i;
-            if (!tabsGenerated) {
-            const float CAUCHYFAKEAT3  =
-                (CAUCHYVAL + ADDSQ * TABRANGE * TABRANGE);
-            const float CAUCHYRESIZE = (1./ (1. - CAUCHYFAKEAT3));
-            for (i = 0; i <= TABSIZE; i++)
-            {
-                float f = i * ((float)TABRANGE/(float)TABSIZE);
-                float gauss = expf(-f * f);
-                float cauchygenuine = 1.f / (1.f + f * f);
-                float cauchyfake = cauchygenuine + ADDSQ * f * f;
-                float cauchyrenorm = (cauchyfake - 1.) * CAUCHYRESIZE + 1.;
-                if (i != TABSIZE)
-                {
-                    paf_gauss[i].p_y = gauss;
-                    paf_cauchy[i].p_y = cauchyrenorm;
-                    /* post("%f", cauchyrenorm); */
-                }
-                if (i != 0)
-                {
-                    paf_gauss[i-1].p_diff = gauss - paf_gauss[i-1].p_y;
-                    paf_cauchy[i-1].p_diff = cauchyrenorm - paf_cauchy[i-1].p_y;
-                }
-            }
-        }
+        paf_maketabs();
         // linenv_init(x_freqenv);
         // linenv_init(x_cfenv);
         // linenv_init(x_bwenv);
@@ -306,4 +310,211 @@ private:
 };
 
 
+/*
+ * Vowel presets for maxiPAFBank: five formants per vowel (a, e, i, o, u),
+ * centre frequency and bandwidth in Hz, amplitude linear (from the usual
+ * tenor and soprano formant tables, F1 = 0 dB).
+ */
+typedef struct _pafvowel
+{
+    float v_freq[5];
+    float v_bw[5];
+    float v_amp[5];
+} t_pafvowel;
+
+constexpr size_t PAFNVOWELS = 5;
+
+constexpr t_pafvowel paf_vowels_tenor[PAFNVOWELS] = {
+    {{650, 1080, 2650, 2900, 3250}, {80, 90, 120, 130, 140}, {1.f, 0.5012f, 0.4467f, 0.3981f, 0.07943f}},
+    {{400, 1700, 2600, 3200, 3580}, {70, 80, 100, 120, 120}, {1.f, 0.1995f, 0.2512f, 0.1995f, 0.1f}},
+    {{290, 1870, 2800, 3250, 3540}, {40, 90, 100, 120, 120}, {1.f, 0.1778f, 0.1259f, 0.1f, 0.03162f}},
+    {{400, 800, 2600, 2800, 3000}, {40, 80, 100, 120, 120}, {1.f, 0.3162f, 0.2512f, 0.2512f, 0.05012f}},
+    {{350, 600, 2700, 2900, 3300}, {40, 60, 100, 120, 120}, {1.f, 0.1f, 0.1413f, 0.1995f, 0.05012f}},
+};
+
+constexpr t_pafvowel paf_vowels_soprano[PAFNVOWELS] = {
+    {{800, 1150, 2900, 3900, 4950}, {80, 90, 120, 130, 140}, {1.f, 0.5012f, 0.02512f, 0.1f, 0.003162f}},
+    {{350, 2000, 2800, 3600, 4950}, {60, 100, 120, 150, 200}, {1.f, 0.1f, 0.1778f, 0.01f, 0.001585f}},
+    {{270, 2140, 2950, 3900, 4950}, {60, 90, 100, 120, 120}, {1.f, 0.2512f, 0.05012f, 0.05012f, 0.00631f}},
+    {{450, 800, 2830, 3800, 4950}, {70, 80, 100, 130, 135}, {1.f, 0.2818f, 0.07943f, 0.07943f, 0.003162f}},
+    {{325, 700, 2700, 3800, 4950}, {50, 60, 170, 180, 200}, {1.f, 0.1585f, 0.01778f, 0.01f, 0.001f}},
+};
+
+
+/*
+ * maxiPAFBank: NF phase-aligned formants on one fundamental, rendered a
+ * block at a time. The fundamental and carrier phases are 32-bit fixed
+ * point, so the carrier phase is just phase * harmonic (wrapping for
+ * free) and there is no floorf per sample. The formants share the
+ * fundamental phase, the bell argument and the tables: cosines come from
+ * the SRAM sineBuffer, bells from paf_gauss / paf_cauchy.
+ * Centre frequencies and bandwidths are latched at the start of each
+ * period, as in maxiPAFOperator; amplitudes ramp linearly over a block.
+ * Frequency and vibrato are applied per block.
+ *   setVowel(pos)   0 = a, 1 = e, 2 = i, 3 = o, 4 = u, interpolated between
+ *   play(out, n)    writes n samples
+ */
+template<size_t NF = 5>
+class maxiPAFBank {
+public:
+    static_assert(NF >= 1 && NF <= 5, "maxiPAFBank has 1 to 5 formants");
+
+    maxiPAFBank()
+    {
+        paf_maketabs();
+        for (size_t k = 0; k < NF; k++)
+        {
+            x_cf[k] = 500.f * (k + 1);
+            x_bw[k] = 100.f;
+            x_amp[k] = x_ampcur[k] = 0.f;
+            x_intcar[k] = 0;
+            x_fraccar[k] = 0.f;
+            x_bwquotient[k] = 0.f;
+        }
+        setFrequency(110.f);
+    }
+
+    inline void setFrequency(const float freq) { x_freq = freq > 1.f ? freq : 1.f; }
+
+    inline void setFormant(const size_t k, const float cf, const float bw, const float amp)
+    {
+        x_cf[k] = cf;
+        x_bw[k] = bw > 0.f ? bw : 0.f;
+        x_amp[k] = amp;
+    }
+
+    // pos from 0 (a) to 4 (u); fractional positions interpolate neighbours
+    void setVowel(float pos, const t_pafvowel *vowels = paf_vowels_tenor)
+    {
+        pos = pos < 0.f ? 0.f : (pos > PAFNVOWELS - 1 ? PAFNVOWELS - 1 : pos);
+        const size_t i = pos >= PAFNVOWELS - 1 ? PAFNVOWELS - 2 : static_cast<size_t>(pos);
+        const float frac = pos - i;
+        const t_pafvowel &a = vowels[i], &b = vowels[i + 1];
+        for (size_t k = 0; k < NF; k++)
+        {
+            setFormant(k, a.v_freq[k] + frac * (b.v_freq[k] - a.v_freq[k]),
+                          a.v_bw[k] + frac * (b.v_bw[k] - a.v_bw[k]),
+                          x_gain * (a.v_amp[k] + frac * (b.v_amp[k] - a.v_amp[k])));
+        }
+    }
+
+    // Output gain applied by setVowel
+    inline void setGain(const float gain) { x_gain = gain; }
+
+    // depth as a fraction of the frequency, rate in Hz
+    inline void setVibrato(const float depth, const float rate)
+    {
+        x_vibdepth = depth;
+        x_vibrate = rate;
+    }
+
+    inline void setCauchy(const bool cauchy) { x_table = cauchy ? paf_cauchy : paf_gauss; }
+
+    // Restart the period, latching the current formants on the next sample
+    inline void trigger()
+    {
+        x_phase = 0;
+        x_triggerme = true;
+    }
+
+    void play(float *out, const size_t n)
+    {
+        if (n == 0) return;
+
+        // Vibrato, once per block (parabolic sine, as maxiPAFOperator)
+        x_vibphase += n * maxiSettings::one_over_sampleRate * x_vibrate;
+        x_vibphase -= floorf(x_vibphase);
+        const float sinvib = x_vibphase > 0.5f
+            ? 1.0f - 16.0f * (0.75f - x_vibphase) * (0.75f - x_vibphase)
+            : -1.0f + 16.0f * (0.25f - x_vibphase) * (0.25f - x_vibphase);
+        const float freq = x_freq * (1.0f + x_vibdepth * sinvib);
+        const uint32_t inc = static_cast<uint32_t>(freq * maxiSettings::one_over_sampleRate * 4294967296.f);
+
+        // Values latched at the next period start
+        const float inv_freq = 1.0f / freq;
+        uint32_t intcar[NF];
+        float fraccar[NF], bwquotient[NF], ampstep[NF];
+        const float inv_n = 1.0f / n;
+        for (size_t k = 0; k < NF; k++)
+        {
+            const float cf_over_freq = x_cf[k] * inv_freq;
+            intcar[k] = static_cast<uint32_t>(cf_over_freq);
+            fraccar[k] = cf_over_freq - intcar[k];
+            bwquotient[k] = x_bw[k] * inv_freq;
+            ampstep[k] = (x_amp[k] - x_ampcur[k]) * inv_n;
+        }
+
+        constexpr float TABSCALE = (TABSIZE * TABRANGERCPR);
+        const t_tabpoint *table = x_table;
+        uint32_t phase = x_phase;
+        bool latch = x_triggerme;
+        x_triggerme = false;
+        for (size_t i = 0; i < n; i++)
+        {
+            phase += inc;
+            if (phase < inc || latch) [[unlikely]]
+            {
+                latch = false;
+                for (size_t k = 0; k < NF; k++)
+                {
+                    x_intcar[k] = intcar[k];
+                    x_fraccar[k] = fraccar[k];
+                    x_bwquotient[k] = bwquotient[k];
+                }
+            }
+            const float fphase = phase * (1.f / 2147483648.f) - 1.0f;
+            const float bell = 1.0f - fphase * fphase;
+
+            float sum = 0.f;
+            for (size_t k = 0; k < NF; k++)
+            {
+                const uint32_t carphase1 = phase * x_intcar[k];
+                const float cos1 = cos_(carphase1);
+                const float cos2 = cos_(carphase1 + phase);
+                const float carrier = cos1 + x_fraccar[k] * (cos2 - cos1);
+
+                float halfsine = x_bwquotient[k] * bell;
+                halfsine = halfsine < HALFSINELIM ? halfsine : HALFSINELIM;
+                const float scaled = halfsine * TABSCALE;
+                const size_t index = static_cast<size_t>(scaled);
+                const t_tabpoint *p = table + index;
+
+                x_ampcur[k] += ampstep[k];
+                sum += x_ampcur[k] * carrier * (p->p_y + (scaled - index) * p->p_diff);
+            }
+            out[i] = sum;
+        }
+        x_phase = phase;
+        for (size_t k = 0; k < NF; k++)
+        {
+            x_ampcur[k] = x_amp[k];
+        }
+    }
+
+private:
+    // Cosine of a 32-bit phase from the 512-point sineBuffer
+    static float __force_inline cos_(uint32_t phase)
+    {
+        phase += 0x40000000u;
+        const uint32_t i = phase >> 23;
+        const float frac = (phase & 0x7fffffu) * (1.f / 8388608.f);
+        return sineBuffer[i] + frac * (sineBuffer[i + 1] - sineBuffer[i]);
+    }
+
+    float x_freq;
+    float x_cf[NF], x_bw[NF], x_amp[NF];
+    float x_ampcur[NF];
+    uint32_t x_intcar[NF];
+    float x_fraccar[NF];
+    float x_bwquotient[NF];
+    uint32_t x_phase = 0;
+    float x_vibphase = 0.f;
+    float x_vibdepth = 0.f;
+    float x_vibrate = 0.f;
+    float x_gain = 1.f;
+    bool x_triggerme = true;
+    const t_tabpoint *x_table = paf_gauss;
+};
+
+
 #endif // MAXIPAF_HPP
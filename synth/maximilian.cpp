@@ -1109,5 +1109,10 @@ maxiRingBuf::maxiRingBuf() {}
 maxiPoll::maxiPoll() {}
 maxiRMS::maxiRMS() {}
 maxiZeroCrossingRate::maxiZeroCrossingRate() {
-	buf.setup(maxiSettings::sampleRate);
+	setup();
+}
+
+void maxiZeroCrossingRate::setup() {
+	window.SetWindow(maxiSettings::sampleRate);
+	scale = static_cast<float>(maxiSettings::sampleRate) / static_cast<float>(window.GetWindow());
 }
\ No newline at end of file
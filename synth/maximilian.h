@@ -42,6 +42,8 @@
 #include "../PicoDefs.hpp"
 #include "../utils/MedianFilter.h"
 #include "../utils/CircularBuffer.hpp"
+#include "../utils/BufferStorage.hpp"
+#include "../utils/WindowStats.hpp"
 
 
 
@@ -1313,24 +1315,18 @@ private:
 class maxiZeroCrossingRate {
     public:
         maxiZeroCrossingRate();
-        void setup() {
-            buf.setup(maxiSettings::sampleRate+1);
-        }
-        /*!Calculate the zero cross rate \param signal a signal \returns the zero crossing rate in Hz*/
+        void setup();
+        /*!Calculate the zero cross rate \param signal a signal \returns the zero crossings in the last second (Hz)*/
         float play(float signal) {
-            if (zxd.zx(signal)) {
-                buf.push(1);
-                runningCount++;
-            }else{
-                buf.push(0);
-            }
-            runningCount -= buf.tail(maxiSettings::sampleRate);
-            return runningCount;
+            window.Process(zxd.zx(signal));
+            return static_cast<float>(window.Count()) * scale;
         }
 
     private:
-        maxiRingBuf buf;
-        float runningCount=0;
+        //one bit per sample for up to a second at 65.5kHz; at higher rates
+        //the window is shorter than a second and the count is scaled to Hz
+        WindowCount<65536> window;
+        float scale = 1.f;
         maxiZeroCrossingDetector zxd;
 };
 
@@ -1439,11 +1435,11 @@ inline float maxiNonlinearity::asymclip(float x, float a, float b)
     }
     else if (x < 0)
     {
-        x = -(std::powf(-x, a));
+        x = -(powf(-x, a));
     }
     else
     {
-        x = std::powf(x, b);
+        x = powf(x, b);
     }
     return x;
 }
@@ -1466,7 +1462,9 @@ inline float maxiNonlinearity::softclip(float x)
     }
     else
     {
-        x = (2.f / 3.0f) * (x - std::powf(x, 3.f) / 3.0f);
+        // (3/2)(x - x³/3) meets ±1 at ±1 with zero slope; the old 2/3 factor
+        // jumped from 4/9 to 1 there and aliased heavily
+        x = 1.5f * x - 0.5f * x * x * x;
     }
     return x;
 }
@@ -3135,7 +3133,7 @@ class maxiRMS {
                 windowSize = windowSizeInSamples;
                 windowSizeInv = 1.f / static_cast<float>(windowSize);
             }
-            runningRMS = 0;
+            resum();
         }
 
         /*!Find out the size of the analysis window (in ms)*/
@@ -3149,7 +3147,15 @@ class maxiRMS {
             runningRMS -= buf.tail(windowSize);
             buf.push(sigPow2);
             runningRMS += sigPow2;
-            return sqrtf(runningRMS * windowSizeInv);
+            //a fresh sum of the window, built alongside and swapped in once per window,
+            //so rounding in the running add/subtract can't accumulate
+            freshSum += sigPow2;
+            if (++sinceResum >= windowSize) {
+                runningRMS = freshSum;
+                freshSum = 0;
+                sinceResum = 0;
+            }
+            return sqrtf(std::max(runningRMS, 0.f) * windowSizeInv);
         }
 
     private:
@@ -3157,6 +3163,18 @@ class maxiRMS {
         size_t windowSize=0; // in samples
         float windowSizeInv=1.f;
         float runningRMS=0;
+        float freshSum=0;
+        size_t sinceResum=0;
+
+        void resum() {
+            double sum = 0;
+            for (size_t i = 1; i <= windowSize; i++) {
+                sum += buf.tail(i);
+            }
+            runningRMS = static_cast<float>(sum);
+            freshSum = 0;
+            sinceResum = 0;
+        }
 };
 
 
@@ -3534,7 +3552,8 @@ private:
     float smooth_coeff = 0.997f;
 };
 
-template<size_t DELAYTIME>
+// Storage is a policy from BufferStorage.hpp (SRAM by default, or PSRAM).
+template<size_t DELAYTIME, typename Storage = SRAMStorage>
 class DynamicDelayI16 {
     static_assert((DELAYTIME & (DELAYTIME - 1)) == 0, "DELAYTIME must be a power of 2");
     static constexpr size_t MASK = DELAYTIME - 1;
@@ -3556,14 +3575,14 @@ public:
         float frac = read_pos - static_cast<float>(i1);
         size_t i2 = (i1 + 1) & MASK;
 
-        float s1 = static_cast<float>(delay_line[i1]) * kRcpScale;
-        float s2 = static_cast<float>(delay_line[i2]) * kRcpScale;
+        float s1 = static_cast<float>(delay_line.Read(i1)) * kRcpScale;
+        float s2 = static_cast<float>(delay_line.Read(i2)) * kRcpScale;
         return s1 + frac * (s2 - s1);
     }
 
     void __force_inline write(float input) {
         input = fminf(fmaxf(input, -1.f), 1.f);
-        delay_line[write_index] = static_cast<int16_t>(input * kScale);
+        delay_line.Write(write_index, static_cast<int16_t>(input * kScale));
         write_index = (write_index + 1) & MASK;
     }
 
@@ -3572,8 +3591,8 @@ public:
         size_t i1 = static_cast<size_t>(abs_pos) & MASK;
         float frac = abs_pos - static_cast<float>(i1);
         size_t i2 = (i1 + 1) & MASK;
-        float s1 = static_cast<float>(delay_line[i1]) * kRcpScale;
-        float s2 = static_cast<float>(delay_line[i2]) * kRcpScale;
+        float s1 = static_cast<float>(delay_line.Read(i1)) * kRcpScale;
+        float s2 = static_cast<float>(delay_line.Read(i2)) * kRcpScale;
         return s1 + frac * (s2 - s1);
     }
 
@@ -3583,19 +3602,24 @@ public:
         size_t pos = 0;
         while (pos < DELAYTIME) {
             const size_t chunk = std::min(cycleLen, DELAYTIME - pos);
-            memcpy(&delay_line[pos], cycle, chunk * sizeof(int16_t));
+            delay_line.WriteBlock(pos, cycle, chunk);
             pos += chunk;
         }
         write_index = 0;
     }
 
 private:
-    std::array<int16_t, DELAYTIME> delay_line{};
+    typename Storage::template Buffer<int16_t, DELAYTIME> delay_line;
     size_t write_index = 0;
     float smoothed_size;
     float smooth_coeff = 0.997f;
 };
 
+// Long int16 delay line: the newest HEAD samples in SRAM, the rest in PSRAM
+// (see PSRAMTieredStorage). Short taps cost the same as the all-SRAM line.
+template<size_t DELAYTIME, size_t HEAD = 2048>
+using TieredDelayI16 = DynamicDelayI16<DELAYTIME, PSRAMTieredStorage<HEAD>>;
+
 class maxiDynamicsLite {
 
     public:
@@ -0,0 +1,338 @@
+#!/usr/bin/env python3
+"""
+Build a v2 sample pack for PlayLoop (see synth/SamplePack.hpp).
+
+    build_sample_pack.py -o pack.bin [--encoding adpcm] [--loop name=start:end] [--slices] a.wav b.wav ...
+
+Each WAV (8/16/24/32-bit PCM) is mixed down to mono and stored at its own
+sample rate. The pack is flashed to AUDIO_FLASH_ADDRESS, e.g. with
+`picotool load -o 0x10200000 pack.bin`.
+
+--slices runs onset detection on every file and stores the onsets as slice
+start points alongside its data, for SlicedLoop (synth/SliceEngine.hpp).
+
+--verify decodes every entry back from the written pack, exactly as the
+firmware does, and prints the SNR against the source, so the encoders can
+be checked without hardware.
+"""
+
+import argparse
+import math
+import os
+import struct
+import sys
+import wave
+
+MAGIC = 0x4F434950
+VERSION = 2
+HEADER_BYTES = 32
+ENTRY_BYTES = 64
+MAX_NAME = 23
+
+MAX_SLICES = 64  # SliceTable::kMaxSlices
+
+ENCODINGS = {"float32": 0, "int16": 1, "adpcm": 2}
+BYTES_PER_SAMPLE = {0: 4, 1: 2}
+
+STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+]
+INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def fnv1a(name):
+    h = 2166136261
+    for b in name.encode("ascii"):
+        h ^= b
+        h = (h * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def read_wav(path):
+    """Return (mono float samples in [-1, 1), sample rate)."""
+    with wave.open(path, "rb") as w:
+        channels = w.getnchannels()
+        width = w.getsampwidth()
+        rate = w.getframerate()
+        raw = w.readframes(w.getnframes())
+
+    n = len(raw) // width
+    if width == 1:
+        values = [(b - 128) / 128.0 for b in raw]
+    elif width == 2:
+        values = [v / 32768.0 for v in struct.unpack("<%dh" % n, raw)]
+    elif width == 3:
+        values = []
+        for i in range(0, len(raw), 3):
+            v = raw[i] | (raw[i + 1] << 8) | (raw[i + 2] << 16)
+            if v & 0x800000:
+                v -= 1 << 24
+            values.append(v / 8388608.0)
+    elif width == 4:
+        values = [v / 2147483648.0 for v in struct.unpack("<%di" % n, raw)]
+    else:
+        raise ValueError("%s: unsupported sample width %d" % (path, width))
+
+    mono = [sum(values[i:i + channels]) / channels for i in range(0, len(values), channels)]
+    return mono, rate
+
+
+def to_int16(x):
+    return max(-32768, min(32767, int(round(x * 32768.0))))
+
+
+# IMA-ADPCM, matching synth/IMAADPCM.hpp
+
+def adpcm_decode_nibble(nibble, state):
+    step = STEP_TABLE[state[1]]
+    diff = step >> 3
+    if nibble & 4:
+        diff += step
+    if nibble & 2:
+        diff += step >> 1
+    if nibble & 1:
+        diff += step >> 2
+    pred = state[0] - diff if nibble & 8 else state[0] + diff
+    state[0] = max(-32768, min(32767, pred))
+    state[1] = max(0, min(88, state[1] + INDEX_TABLE[nibble]))
+    return state[0]
+
+
+def adpcm_encode_sample(sample, state):
+    step = STEP_TABLE[state[1]]
+    diff = sample - state[0]
+    nibble = 0
+    if diff < 0:
+        nibble = 8
+        diff = -diff
+    threshold = step
+    bit = 4
+    while bit:
+        if diff >= threshold:
+            nibble |= bit
+            diff -= threshold
+        threshold >>= 1
+        bit >>= 1
+    adpcm_decode_nibble(nibble, state)
+    return nibble
+
+
+def adpcm_encode(samples, block_samples):
+    out = bytearray()
+    state = [0, 0]
+    for start in range(0, len(samples), block_samples):
+        block = samples[start:start + block_samples]
+        block += [block[-1]] * (block_samples - len(block))
+        out += struct.pack("<hBB", state[0], state[1], 0)
+        for i in range(0, block_samples, 2):
+            lo = adpcm_encode_sample(block[i], state)
+            hi = adpcm_encode_sample(block[i + 1], state)
+            out.append(lo | (hi << 4))
+    return bytes(out)
+
+
+def adpcm_decode(data, count, block_samples):
+    block_bytes = 4 + block_samples // 2
+    out = []
+    for start in range(0, len(data), block_bytes):
+        pred, index, _ = struct.unpack_from("<hBB", data, start)
+        state = [pred, min(index, 88)]
+        for byte in data[start + 4:start + block_bytes]:
+            out.append(adpcm_decode_nibble(byte & 0x0F, state))
+            out.append(adpcm_decode_nibble(byte >> 4, state))
+    return [v / 32768.0 for v in out[:count]]
+
+
+def encode(samples, encoding, block_samples):
+    if encoding == 0:
+        return struct.pack("<%df" % len(samples), *samples)
+    ints = [to_int16(x) for x in samples]
+    if encoding == 1:
+        return struct.pack("<%dh" % len(ints), *ints)
+    return adpcm_encode(ints, block_samples)
+
+
+def decode(data, count, encoding, block_samples):
+    if encoding == 0:
+        return list(struct.unpack_from("<%df" % count, data))
+    if encoding == 1:
+        return [v / 32768.0 for v in struct.unpack_from("<%dh" % count, data)]
+    return adpcm_decode(data, count, block_samples)
+
+
+def detect_onsets(samples, rate, threshold_db=6.0, min_gap_ms=60.0):
+    """Slice start points (sample indices, ascending, starting with 0).
+
+    Energy of the first difference (which favours transients) in 5 ms
+    hops; an onset is a rise in log energy that is a local peak and
+    threshold_db above the median rise around it. Each onset is moved back
+    to the quietest sample in the preceding hop, so a slice starts just
+    before its attack rather than in it.
+    """
+    hop = max(1, rate // 200)
+    hops = len(samples) // hop
+    if hops < 3:
+        return [0]
+    energy = []
+    prev = 0.0
+    for k in range(hops):
+        e = 0.0
+        for x in samples[k * hop:(k + 1) * hop]:
+            d = x - prev
+            e += d * d
+            prev = x
+        energy.append(10 * math.log10(e / hop + 1e-12))
+    rise = [0.0] + [max(0.0, energy[k] - energy[k - 1]) for k in range(1, hops)]
+
+    span = 10
+    min_gap = int(min_gap_ms * 0.001 * rate)
+    candidates = []
+    for k in range(1, hops - 1):
+        if rise[k] < rise[k - 1] or rise[k] < rise[k + 1]:
+            continue
+        local = sorted(rise[max(0, k - span):k + span + 1])
+        if rise[k] >= local[len(local) // 2] + threshold_db:
+            candidates.append((rise[k], k))
+
+    # Strongest first, so the gap rule and the table size keep the best
+    onsets = [0]
+    for _, k in sorted(candidates, reverse=True):
+        start = (k - 1) * hop
+        quiet = min(range(start, k * hop), key=lambda i: abs(samples[i]))
+        if all(abs(quiet - o) >= min_gap for o in onsets):
+            onsets.append(quiet)
+        if len(onsets) == MAX_SLICES:
+            break
+    return sorted(onsets)
+
+
+def parse_loops(specs):
+    loops = {}
+    for spec in specs or []:
+        try:
+            name, points = spec.split("=")
+            start, end = points.split(":")
+            loops[name] = (int(start), int(end))
+        except ValueError:
+            raise SystemExit("Bad --loop '%s', expected name=start:end" % spec)
+    return loops
+
+
+def build(files, encoding, block_samples, loops, default_rate, slices=False, slice_threshold=6.0):
+    entries = []
+    for path in files:
+        name = os.path.splitext(os.path.basename(path))[0]
+        if len(name) > MAX_NAME:
+            raise SystemExit("%s: name longer than %d characters" % (name, MAX_NAME))
+        samples, rate = read_wav(path)
+        loop_start, loop_end = loops.get(name, (0, len(samples)))
+        if not 0 <= loop_start < loop_end <= len(samples):
+            raise SystemExit("%s: loop %d:%d outside 0:%d" % (name, loop_start, loop_end, len(samples)))
+        entries.append({
+            "name": name,
+            "hash": fnv1a(name),
+            "samples": samples,
+            "rate": rate,
+            "loop": (loop_start, loop_end),
+            "data": encode(samples, encoding, block_samples),
+            "slices": detect_onsets(samples, rate, slice_threshold) if slices else [],
+        })
+
+    names = [e["name"] for e in entries]
+    if len(set(names)) != len(names):
+        raise SystemExit("Duplicate file names")
+
+    # Sorted by hash for binary search on the device
+    entries.sort(key=lambda e: (e["hash"], e["name"]))
+
+    offset = HEADER_BYTES + ENTRY_BYTES * len(entries)
+    table = bytearray()
+    blob = bytearray()
+    for e in entries:
+        e["offset"] = offset + len(blob)
+        blob += e["data"]
+        blob += b"\0" * (-len(blob) % 4)
+        slice_offset = offset + len(blob) if e["slices"] else 0
+        blob += struct.pack("<%dI" % len(e["slices"]), *e["slices"])
+        table += struct.pack(
+            "<24sIIIIIIIHBBII",
+            e["name"].encode("ascii"), e["hash"], e["offset"], len(e["data"]),
+            len(e["samples"]), e["rate"], e["loop"][0], e["loop"][1],
+            block_samples if encoding == 2 else 0, encoding, 1,
+            slice_offset, len(e["slices"]))
+
+    header = struct.pack("<IIIII12x", MAGIC, VERSION, len(entries), default_rate, HEADER_BYTES)
+    return bytes(header + table + blob), entries
+
+
+def verify(pack, entries):
+    """Read every entry back out of the packed bytes and report the SNR."""
+    magic, version, count, _, index_offset = struct.unpack_from("<IIIII", pack, 0)
+    assert magic == MAGIC and version == VERSION and count == len(entries)
+    hashes = []
+    ok = True
+    for i in range(count):
+        (name, h, offset, nbytes, n, rate, loop_start, loop_end, block, encoding,
+         _, slice_offset, slice_count) = struct.unpack_from("<24sIIIIIIIHBBII", pack,
+                                                            index_offset + i * ENTRY_BYTES)
+        name = name.rstrip(b"\0").decode("ascii")
+        hashes.append(h)
+        src = next(e for e in entries if e["name"] == name)
+        assert h == fnv1a(name) and n == len(src["samples"]) and rate == src["rate"]
+        out = decode(pack[offset:offset + nbytes], n, encoding, block)
+        signal = sum(x * x for x in src["samples"])
+        noise = sum((a - b) ** 2 for a, b in zip(src["samples"], out))
+        snr = float("inf") if noise == 0 else 10 * math.log10(max(signal, 1e-30) / noise)
+        slices = list(struct.unpack_from("<%dI" % slice_count, pack, slice_offset)) if slice_count else []
+        assert slices == src["slices"]
+        print("  %-24s %7d samples %6d Hz  loop %d:%d  %2d slices  SNR %.1f dB"
+              % (name, n, rate, loop_start, loop_end, len(slices), snr))
+        if encoding != 0 and snr < 20:
+            ok = False
+    if hashes != sorted(hashes):
+        print("Index is not sorted")
+        ok = False
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("wavs", nargs="+", help="WAV files; the name without .wav is the lookup key")
+    parser.add_argument("-o", "--output", required=True)
+    parser.add_argument("--encoding", choices=ENCODINGS.keys(), default="int16")
+    parser.add_argument("--block-samples", type=int, default=128,
+                        help="ADPCM block length, power of 2 and <= PlayLoop::kCacheSamples")
+    parser.add_argument("--loop", action="append", metavar="NAME=START:END")
+    parser.add_argument("--sample-rate", type=int, default=48000, help="Default rate stored in the header")
+    parser.add_argument("--slices", action="store_true", help="Store onset-detected slice points")
+    parser.add_argument("--slice-threshold", type=float, default=6.0,
+                        help="Onset threshold in dB above the local median rise")
+    parser.add_argument("--verify", action="store_true")
+    args = parser.parse_args()
+
+    b = args.block_samples
+    if b < 2 or b > 128 or b & (b - 1):
+        raise SystemExit("--block-samples must be a power of 2 between 2 and 128")
+
+    encoding = ENCODINGS[args.encoding]
+    pack, entries = build(args.wavs, encoding, b, parse_loops(args.loop), args.sample_rate,
+                          args.slices, args.slice_threshold)
+    with open(args.output, "wb") as f:
+        f.write(pack)
+
+    raw = sum(len(e["samples"]) * 4 for e in entries)
+    print("%s: %d files, %d bytes (%.1fx smaller than float32)"
+          % (args.output, len(entries), len(pack), raw / max(len(pack), 1)))
+
+    if args.verify and not verify(pack, entries):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,133 @@
+/*
+ * Host benchmark for BusDynamics against a pair of maxiDynamics.
+ *
+ *     g++ -std=c++20 -O2 -Itools/host tools/dynamics_bench.cpp synth/maximilian.cpp -o dynamics_bench
+ *     ./dynamics_bench [seconds]
+ *
+ * Input is stereo noise with a slow amplitude envelope and occasional
+ * clicks, at 48 kHz in 64-frame blocks. Timings are host nanoseconds per
+ * stereo frame: useful for comparing the two, not as RP2350 figures. The
+ * limiter check reports the loudest output sample against its ceiling,
+ * and the static check the gain reduction against the ideal curve.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../synth/BusDynamics.hpp"
+
+static constexpr size_t kBlock = 64;
+
+template<typename F>
+static double TimeNs(size_t n_frames, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(n_frames);
+}
+
+int main(int argc, char **argv) {
+    const float seconds = argc > 1 ? static_cast<float>(std::atof(argv[1])) : 10.f;
+    maxiSettings::setup(48000, 2, kBlock);
+    const size_t n = static_cast<size_t>(seconds * 48000.f) / kBlock * kBlock;
+
+    std::vector<float> inL(n), inR(n), l(n), r(n);
+    srand(1);
+    for (size_t i = 0; i < n; i++) {
+        const float env = 0.5f + 0.5f * std::sin(2.f * static_cast<float>(M_PI) * 0.5f * i / 48000.f);
+        const float click = (i % 9601 < 8) ? 3.f : 1.f;
+        inL[i] = click * env * (static_cast<float>(rand()) / RAND_MAX * 2.f - 1.f);
+        inR[i] = click * env * (static_cast<float>(rand()) / RAND_MAX * 2.f - 1.f);
+    }
+
+    volatile float sink = 0;
+
+    maxiDynamics maxiL, maxiR;
+    for (auto *m : {&maxiL, &maxiR}) {
+        m->setAttackHigh(5.f);
+        m->setReleaseHigh(150.f);
+        m->setLookAhead(2.f);
+    }
+    const double t_maxi = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i++) {
+            sink = sink + maxiL.compress(inL[i], -12.f, 4.f, 6.f);
+            sink = sink + maxiR.compress(inR[i], -12.f, 4.f, 6.f);
+        }
+    });
+
+    BusDynamics<> comp;
+    comp.setThreshold(-12.f);
+    comp.setRatio(4.f);
+    comp.setKnee(6.f);
+    comp.setLookahead(2.f);
+    l = inL;
+    r = inR;
+    const double t_comp = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i += kBlock) {
+            comp.processBlock(&l[i], &r[i], kBlock);
+        }
+    });
+
+    BusLimiter lim;
+    lim.setThreshold(-1.f);
+    lim.setRatio(100.f);
+    lim.setAttack(0.f);
+    lim.setRelease(80.f);
+    lim.setLookahead(1.f);
+    l = inL;
+    r = inR;
+    const double t_lim = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i += kBlock) {
+            lim.processBlock(&l[i], &r[i], kBlock);
+        }
+    });
+    float peak_in = 0, peak_out = 0;
+    for (size_t i = 0; i < n; i++) {
+        peak_in = std::max({peak_in, std::fabs(inL[i]), std::fabs(inR[i])});
+        peak_out = std::max({peak_out, std::fabs(l[i]), std::fabs(r[i])});
+    }
+
+    BusLimiter lim_ps;
+    lim_ps.setThreshold(-1.f);
+    lim_ps.setRatio(100.f);
+    lim_ps.setAttack(0.f);
+    lim_ps.setLookahead(1.f);
+    const double t_lim_ps = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i++) {
+            float a = inL[i], b = inR[i];
+            lim_ps.play(a, b);
+            sink = sink + a;
+        }
+    });
+
+    std::printf("%-40s %8s %8s\n", "", "ns/frame", "speedup");
+    std::printf("%-40s %8.2f %8s\n", "2 x maxiDynamics::compress (RMS)", t_maxi, "1.0x");
+    std::printf("%-40s %8.2f %7.1fx\n", "BusDynamics<> processBlock (RMS, soft)", t_comp, t_maxi / t_comp);
+    std::printf("%-40s %8.2f %7.1fx\n", "BusLimiter processBlock", t_lim, t_maxi / t_lim);
+    std::printf("%-40s %8.2f %7.1fx\n", "BusLimiter play", t_lim_ps, t_maxi / t_lim_ps);
+
+    std::printf("\nlimiter: input peak %+.2f dBFS, output peak %+.2f dBFS, ceiling -1.00 dBFS\n",
+                20.0 * std::log10(peak_in), 20.0 * std::log10(peak_out));
+
+    // Static curve: steady full-scale square wave, both channels, into a
+    // hard-knee peak compressor with no smoothing
+    BusDynamics<DynPeak, DynHardKnee> stat;
+    stat.setThreshold(-20.f);
+    stat.setRatio(4.f);
+    stat.setAttack(0.f);
+    stat.setRelease(0.f);
+    double worst = 0;
+    for (float level_db = -30.f; level_db <= 0.f; level_db += 0.37f) {
+        const float a = std::pow(10.f, level_db / 20.f);
+        for (size_t i = 0; i < 256; i++) {
+            float x = (i & 1) ? a : -a, y = x;
+            stat.play(x, y);
+        }
+        const double ideal = level_db > -20.f ? -(level_db + 20.f) * 0.75 : 0.0;
+        worst = std::max(worst, std::fabs(stat.getGainReduction() - ideal));
+    }
+    std::printf("static curve: worst gain error %.3f dB\n", worst);
+    return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Host benchmark for BlockADSRBank against per-sample ADSRLite::play().
+ *
+ *     g++ -std=c++20 -O2 -Itools/host tools/envelope_bench.cpp synth/maximilian.cpp -o envelope_bench
+ *     ./envelope_bench [seconds]
+ *
+ * kVoices envelopes play overlapping notes, with note events at arbitrary
+ * frames inside 64-sample blocks. Timings are host nanoseconds per voice
+ * per sample: useful for comparing the variants, not as absolute RP2350
+ * figures. Accuracy is the largest difference between a linear BlockADSR
+ * and ADSRLite given the same events, which should be within one sample's
+ * step at the segment ends.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../synth/maximilian.h"
+#include "../synth/ADSRLite.hpp"
+
+static constexpr size_t kBlock = 64;
+static constexpr size_t kVoices = 8;
+
+template<typename F>
+static double TimeNs(size_t n_samples, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(n_samples);
+}
+
+// Voice v starts a note every 9600 samples, offset by v * 1201, held for 4000
+static inline bool NoteOn(size_t i, size_t v) { return (i + v * 1201) % 9600 == 0; }
+static inline bool NoteOff(size_t i, size_t v) { return (i + v * 1201) % 9600 == 4000; }
+
+int main(int argc, char **argv) {
+    const float seconds = argc > 1 ? static_cast<float>(std::atof(argv[1])) : 10.f;
+    maxiSettings::setup(48000, 1, kBlock);
+    const size_t n = static_cast<size_t>(seconds * 48000.f) / kBlock * kBlock;
+
+    // Accuracy: one envelope, events at frames 17 and 4017 + 33
+    {
+        ADSRLite lite;
+        lite.setup(10.f, 50.f, 0.5f, 100.f, 48000.f);
+        BlockADSR block;
+        block.setup(10.f, 50.f, 0.5f, 100.f, 48000.f);
+        std::vector<float> a(16384), b(16384);
+        block.trigger(1.f, 17);
+        block.release(4050);
+        for (size_t i = 0; i < a.size(); i += kBlock) {
+            block.process(&b[i], kBlock);
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (i == 17) lite.trigger(1.f);
+            if (i == 4050) lite.release();
+            a[i] = lite.play();
+        }
+        float worst = 0.f;
+        for (size_t i = 0; i < a.size(); i++) {
+            worst = std::max(worst, std::fabs(a[i] - b[i]));
+        }
+        std::printf("BlockADSR against ADSRLite, linear: largest difference %.5f\n\n", worst);
+    }
+
+    volatile float sink = 0;
+    std::vector<ADSRLite> lites(kVoices);
+    for (auto &e : lites) {
+        e.setup(10.f, 200.f, 0.6f, 300.f, 48000.f);
+    }
+    std::vector<float> out(kBlock * kVoices);
+    const double t_lite = TimeNs(n * kVoices, [&] {
+        for (size_t i = 0; i < n; i += kBlock) {
+            for (size_t v = 0; v < kVoices; v++) {
+                for (size_t s = 0; s < kBlock; s++) {
+                    if (NoteOn(i + s, v)) lites[v].trigger(0.8f);
+                    if (NoteOff(i + s, v)) lites[v].release();
+                    out[v * kBlock + s] = lites[v].play();
+                }
+            }
+            sink = sink + out[0];
+        }
+    });
+
+    // The bank gets the same events as frame offsets, found once per block
+    auto run_bank = [&](BlockADSRParams::Shape shape) {
+        BlockADSRBank<kVoices> bank;
+        bank.setup(10.f, 200.f, 0.6f, 300.f, 48000.f, shape);
+        return TimeNs(n * kVoices, [&] {
+            for (size_t i = 0; i < n; i += kBlock) {
+                for (size_t v = 0; v < kVoices; v++) {
+                    const size_t on = (9600 - (i + v * 1201) % 9600) % 9600;
+                    const size_t off = (9600 + 4000 - (i + v * 1201) % 9600) % 9600;
+                    if (on < kBlock) bank.trigger(v, 0.8f, on);
+                    if (off < kBlock) bank.release(v, off);
+                }
+                bank.process(out.data(), kBlock);
+                sink = sink + out[0];
+            }
+        });
+    };
+    const double t_linear = run_bank(BlockADSRParams::kLinear);
+    const double t_exp = run_bank(BlockADSRParams::kExponential);
+
+    std::printf("%-40s %8s %8s\n", "", "ns/smp", "speedup");
+    std::printf("%-40s %8.2f %8s\n", "ADSRLite::play per sample", t_lite, "1.0x");
+    std::printf("%-40s %8.2f %7.1fx\n", "BlockADSRBank, linear", t_linear, t_lite / t_linear);
+    std::printf("%-40s %8.2f %7.1fx\n", "BlockADSRBank, exponential", t_exp, t_lite / t_exp);
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*
+ * Host test and benchmark for FlashModelStore on its simulated NOR region.
+ *
+ *     g++ -std=c++20 -O2 -Itools/host tools/flash_model_store_bench.cpp hardware/FlashModelStore.cpp -o flash_model_store_bench
+ *     ./flash_model_store_bench [iterations]
+ *
+ * Checks install and recall (weights, extra data, header fields), slot
+ * capacity limits, that mode tags and names are compared in full and that
+ * 16-character ones are refused, that a flipped weight byte fails the CRC,
+ * that an install cut off before its header page leaves the slot empty,
+ * and which regions CheckRegion() accepts (firmware image, filesystem,
+ * alignment, end of flash). Then times Find() with and without the CRC
+ * and CopyWeights() on a full slot: host figures, useful for comparing the
+ * two lookups, not as absolute XIP timings. Exits non-zero on any failure.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../hardware/FlashModelStore.hpp"
+
+static int failures = 0;
+
+static void Check(bool ok, const char *what) {
+    if (!ok) {
+        std::printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+// Reaches the simulated flash and the raw erase/program steps
+class TestStore : public FlashModelStore {
+public:
+    using FlashModelStore::FlashModelStore;
+    uint8_t *Raw(size_t slot) { return sim_.data() + slot * slot_bytes_; }
+    void EraseRaw(size_t slot) { Erase_(static_cast<uint32_t>(slot * slot_bytes_), kSectorBytes); }
+    void ProgramRaw(size_t slot, size_t at, const uint8_t *data, size_t bytes) {
+        Program_(static_cast<uint32_t>(slot * slot_bytes_ + at), data, bytes);
+    }
+};
+
+static std::vector<float> Weights(size_t n, float seed) {
+    std::vector<float> w(n);
+    for (size_t i = 0; i < n; i++) {
+        w[i] = seed + 0.001f * static_cast<float>(i);
+    }
+    return w;
+}
+
+static void Records() {
+    TestStore store;
+    const uint8_t extra[] = { 1, 2, 3, 4, 5 };
+    const std::vector<float> w = Weights(1000, 0.5f);
+    const uint32_t hash = 0x12345678u;
+
+    Check(store.IsUsable(), "default region usable");
+    Check(store.Find(0) == nullptr, "empty slot has no record");
+    Check(store.Install(0, "VerbFX", "pad", 3, hash, w.data(), w.size(), extra, sizeof(extra)), "install");
+    const FlashModelStore::RecordHeader *r = store.Find(0);
+    Check(r && r->n_weights == w.size() && r->layout_hash == hash && r->format_version == 3, "header fields");
+    Check(r && std::memcmp(store.Weights(r), w.data(), w.size() * sizeof(float)) == 0, "weights in place");
+    Check(r && r->extra_size == sizeof(extra) && std::memcmp(store.Extra(r), extra, sizeof(extra)) == 0,
+          "extra data");
+    Check(r && reinterpret_cast<uintptr_t>(store.Weights(r)) % FlashModelStore::kWeightAlign == 0,
+          "weights aligned");
+    std::vector<float> copy(w.size());
+    Check(r && store.CopyWeights(r, copy.data(), copy.size()) && copy == w, "CopyWeights");
+    Check(r && !store.CopyWeights(r, copy.data(), copy.size() - 1), "CopyWeights size mismatch refused");
+
+    // Names and tags: whole strings, and nothing that loses its terminator
+    Check(r && FlashModelStore::FieldEquals(r->mode_tag, "VerbFX") && FlashModelStore::FieldEquals(r->name, "pad"),
+          "fields match");
+    Check(r && !FlashModelStore::FieldEquals(r->name, "pa") && !FlashModelStore::FieldEquals(r->name, "pads"),
+          "prefixes do not match");
+    const char *fifteen = "abcdefghijklmno";
+    Check(store.Install(1, "VerbFX", fifteen, 3, hash, w.data(), 10), "15-character name installs");
+    const FlashModelStore::RecordHeader *r1 = store.Find(1);
+    Check(r1 && FlashModelStore::FieldEquals(r1->name, fifteen), "15-character name matches");
+    Check(r1 && !FlashModelStore::FieldEquals(r1->name, "abcdefghijklmnoX"), "longer name does not match");
+    Check(!store.Install(1, "VerbFX", "abcdefghijklmnop", 3, hash, w.data(), 10), "16-character name refused");
+    Check(!store.Install(1, "ABCDEFGHIJKLMNOPQ", "x", 3, hash, w.data(), 10), "long mode tag refused");
+    Check(store.Find(1) == r1, "refused install leaves the slot alone");
+
+    // Capacity
+    const size_t cap = store.Capacity(sizeof(extra));
+    const std::vector<float> big = Weights(cap + 1, 1.f);
+    Check(store.Install(2, "t", "full", 1, hash, big.data(), cap, extra, sizeof(extra)), "full slot installs");
+    Check(!store.Install(2, "t", "over", 1, hash, big.data(), cap + 1, extra, sizeof(extra)), "oversize refused");
+    Check(!store.Install(store.GetSlotCount(), "t", "x", 1, hash, w.data(), 1), "slot out of range");
+    Check(store.Find(2) && FlashModelStore::FieldEquals(store.Find(2)->name, "full"), "full slot kept");
+
+    // Reinstall over a record (NOR needs the erase)
+    const std::vector<float> w2 = Weights(500, -2.f);
+    Check(store.Install(0, "VerbFX", "lead", 3, hash, w2.data(), w2.size()), "reinstall");
+    r = store.Find(0);
+    Check(r && r->n_weights == w2.size() && std::memcmp(store.Weights(r), w2.data(), w2.size() * 4) == 0,
+          "reinstalled weights");
+
+    // A flipped weight byte fails the CRC (found only without verify)
+    store.Raw(0)[r->weights_offset + 17] ^= 0x04;
+    Check(store.Find(0, true) == nullptr && store.Find(0, false) != nullptr, "corrupt weights fail the CRC");
+
+    // Install cut off before the header page: the slot reads as empty
+    store.EraseRaw(3);
+    std::vector<uint8_t> body(FlashModelStore::kPageBytes, 0x5A);
+    store.ProgramRaw(3, FlashModelStore::kPageBytes, body.data(), body.size());
+    Check(store.Find(3, false) == nullptr, "interrupted install leaves no record");
+
+    Check(store.Erase(2) && store.Find(2) == nullptr, "erase");
+
+    TestStore unaligned(MODEL_STORE_FLASH_OFFSET + 256);
+    Check(!unaligned.IsUsable() && !unaligned.Install(0, "t", "x", 1, hash, w.data(), 1) && !unaligned.Erase(0),
+          "unaligned region refuses writes");
+}
+
+static void Regions() {
+    const uintptr_t xip = 0x10000000u;
+    const uintptr_t flash_end = xip + 4u * 1024u * 1024u;
+    const uintptr_t start = xip + MODEL_STORE_FLASH_OFFSET;
+    const size_t bytes = MODEL_STORE_SLOTS * MODEL_STORE_SLOT_BYTES;
+    const uintptr_t fs_start = flash_end - 512u * 1024u;
+
+    Check(FlashModelStore::CheckRegion(start, bytes, flash_end, xip + 0x100000u, fs_start, flash_end),
+          "region after the image and before the filesystem");
+    Check(FlashModelStore::CheckRegion(start, bytes, flash_end, start, fs_start, flash_end),
+          "image ending exactly at the region");
+    Check(!FlashModelStore::CheckRegion(start, bytes, flash_end, start + 1, fs_start, flash_end),
+          "image running into the region");
+    Check(!FlashModelStore::CheckRegion(start, bytes, flash_end, xip + 0x1F0000u, fs_start, flash_end),
+          "image covering the region");
+    Check(!FlashModelStore::CheckRegion(start, bytes, flash_end, xip, start + 4096, flash_end),
+          "filesystem starting inside the region");
+    Check(!FlashModelStore::CheckRegion(start, bytes, flash_end, xip, xip + 0x100000u, start + 4096),
+          "filesystem ending inside the region");
+    Check(FlashModelStore::CheckRegion(start, bytes, flash_end, xip, fs_start, fs_start), "no filesystem");
+    Check(!FlashModelStore::CheckRegion(start + 512, bytes, flash_end, xip, fs_start, flash_end), "unaligned");
+    Check(!FlashModelStore::CheckRegion(flash_end - 4096, 8192, flash_end, xip, flash_end, flash_end),
+          "past the end of flash");
+}
+
+template<typename F>
+static double MicrosPer(size_t n, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i++) {
+        f();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / static_cast<double>(n);
+}
+
+int main(int argc, char **argv) {
+    const size_t iterations = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 2000;
+    Records();
+    Regions();
+
+    FlashModelStore store;
+    const size_t n = store.Capacity(0);
+    const std::vector<float> w = Weights(n, 0.25f);
+    store.Install(0, "bench", "full", 1, 0, w.data(), n);
+    std::vector<float> dst(n);
+    volatile uintptr_t sink = 0;
+    const double find_us = MicrosPer(iterations, [&] { sink = sink + reinterpret_cast<uintptr_t>(store.Find(0, false)); });
+    const double crc_us = MicrosPer(iterations, [&] { sink = sink + reinterpret_cast<uintptr_t>(store.Find(0, true)); });
+    const double copy_us = MicrosPer(iterations, [&] {
+        store.CopyWeights(store.Find(0, false), dst.data(), n);
+        sink = sink + static_cast<uintptr_t>(dst[n - 1]);
+    });
+
+    std::printf("%zu-byte slot, %zu weights\n", static_cast<size_t>(MODEL_STORE_SLOT_BYTES), n);
+    std::printf("%-28s %10s\n", "", "us");
+    std::printf("%-28s %10.3f\n", "Find, header only", find_us);
+    std::printf("%-28s %10.3f\n", "Find with CRC", crc_us);
+    std::printf("%-28s %10.3f\n", "CopyWeights (memcpy)", copy_us);
+    std::printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
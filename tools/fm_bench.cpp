@@ -0,0 +1,141 @@
+/*
+ * Host benchmark for FMVoice against maxiOsc-based FM as in FMSynth.
+ *
+ *     g++ -std=c++20 -O2 -Itools/host tools/fm_bench.cpp synth/maximilian.cpp -o fm_bench
+ *     ./fm_bench [seconds]
+ *
+ * The baseline is FMSynth's graph (two modulator → carrier pairs on
+ * maxiOsc::sinebuf, frequency modulation in Hz) with an ADSR per
+ * operator advanced every sample.
+ * Timings are host nanoseconds per sample: useful for comparing the
+ * variants, not as absolute RP2350 figures. Accuracy is a 2-op voice
+ * against sin(wc t + I sin(wm t)) computed in double.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../synth/FMGraph.hpp"
+
+static constexpr size_t kBlock = 64;
+
+template<typename F>
+static double TimeNs(size_t n_samples, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(n_samples);
+}
+
+// 1 → 0 only, for the accuracy check
+struct FMAlgo2 {
+    static constexpr size_t kOps = 2;
+    static constexpr uint32_t kMods[kOps] = {0b10, 0};
+    static constexpr uint32_t kCarriers = 0b01;
+    static constexpr size_t kFeedback = 1;
+};
+
+template<typename Voice>
+static double RunVoice(Voice &voice, std::vector<float> &out) {
+    const size_t n = out.size();
+    for (size_t op = 0; op < Voice::kOps; op++) {
+        voice.setOperator(op, 1.f + op, 0.5f * op, op == 0 ? 0.5f : 2.f);
+        voice.setEnvelope(op, 10.f, 500.f, 0.6f, 300.f);
+    }
+    voice.setFeedback(0.8f);
+    return TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i += kBlock) {
+            // A new note every half second
+            if (i % 24000 == 0) {
+                voice.noteOn(110.f * (1 + (i / 24000) % 4), 0.8f);
+            } else if (i % 24000 == 12032) {
+                voice.noteOff();
+            }
+            voice.process(&out[i], kBlock);
+        }
+    });
+}
+
+int main(int argc, char **argv) {
+    const float seconds = argc > 1 ? static_cast<float>(std::atof(argv[1])) : 10.f;
+    maxiSettings::setup(48000, 1, kBlock);
+    const size_t n = static_cast<size_t>(seconds * 48000.f) / kBlock * kBlock;
+    std::vector<float> out(n);
+
+    // Accuracy: 220 Hz carrier, 440 Hz modulator, index 3
+    {
+        FMVoice<FMAlgo2> voice;
+        voice.setOperator(0, 1.f, 0.f, 1.f);
+        voice.setOperator(1, 2.f, 0.f, 3.f);
+        voice.setEnvelope(0, 0.f, 0.f, 1.f, 0.f);
+        voice.setEnvelope(1, 0.f, 0.f, 1.f, 0.f);
+        voice.noteOn(220.f);
+        std::vector<float> y(48000);
+        voice.process(y.data(), y.size());
+        // Skip the first block, where the gains ramp up
+        const double inc = static_cast<double>(static_cast<uint32_t>(220.f * 4294967296.f / 48000.f)) / 4294967296.0;
+        double err = 0, ref = 0;
+        for (size_t i = kBlock; i < y.size(); i++) {
+            // The modulator's output is one sample behind its phase, as
+            // the carrier reads it before it advances
+            const double t = static_cast<double>(i);
+            const double m = 3.0 * std::sin(2.0 * M_PI * 2.0 * inc * t);
+            const double x = std::sin(2.0 * M_PI * inc * t + m);
+            err += (y[i] - x) * (y[i] - x);
+            ref += x * x;
+        }
+        std::printf("2-op FM (index 3) against double precision: error %.1f dB\n\n",
+                    10.0 * std::log10(err / ref));
+    }
+
+    // Baseline: FMSynth's pairs on maxiOsc, with an ADSR per operator
+    // advanced every sample
+    maxiOsc osc[4];
+    FMEnvelope env[4];
+    for (auto &e : env) {
+        e.set(10.f, 500.f, 0.6f, 300.f, 48000.f);
+    }
+    const double t_maxi = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i++) {
+            if (i % 24000 == 0 || i % 24000 == 12032) {
+                for (auto &e : env) {
+                    e.gate(i % 24000 == 0);
+                }
+            }
+            const float f = 110.f * (1 + (i / 24000) % 4);
+            float g[4];
+            for (size_t op = 0; op < 4; op++) {
+                g[op] = env[op].advance();
+            }
+            const float m1 = osc[1].sinebuf(f * 2.f) * g[1];
+            const float c1 = osc[0].sinebuf(f + m1 * f * 2.f) * g[0];
+            const float m2 = osc[3].sinebuf(f * 4.f) * g[3];
+            const float c2 = osc[2].sinebuf(f * 3.f + m2 * f * 4.f) * g[2];
+            out[i] = c1 + c2;
+        }
+    });
+
+    FMVoice<FMAlgo4Pairs> pairs;
+    const double t_pairs = RunVoice(pairs, out);
+    FMVoice<FMAlgo4Stack> stack;
+    const double t_stack = RunVoice(stack, out);
+    FMVoice<FMAlgo6DX1> dx1;
+    const double t_dx1 = RunVoice(dx1, out);
+    FMVoice<FMAlgo6DX5> dx5;
+    const double t_dx5 = RunVoice(dx5, out);
+
+    volatile float sink = 0;
+    for (float x : out) {
+        sink = sink + x;
+    }
+
+    std::printf("%-44s %8s %8s\n", "", "ns/smp", "speedup");
+    std::printf("%-44s %8.2f %8s\n", "maxiOsc, 4 ops as FMSynth, per-sample ADSR", t_maxi, "1.0x");
+    std::printf("%-44s %8.2f %7.1fx\n", "FMVoice<FMAlgo4Pairs>", t_pairs, t_maxi / t_pairs);
+    std::printf("%-44s %8.2f %7.1fx\n", "FMVoice<FMAlgo4Stack>", t_stack, t_maxi / t_stack);
+    std::printf("%-44s %8.2f %7.1fx\n", "FMVoice<FMAlgo6DX1>", t_dx1, t_maxi / t_dx1);
+    std::printf("%-44s %8.2f %7.1fx\n", "FMVoice<FMAlgo6DX5>", t_dx5, t_maxi / t_dx5);
+    return 0;
+}
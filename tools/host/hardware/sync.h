@@ -0,0 +1,3 @@
+// Host stand-in: single-threaded tools need no barriers.
+#pragma once
+static inline void __dmb() {}
@@ -0,0 +1,7 @@
+// Minimal stand-ins for the pico-sdk definitions used by the host tools.
+#pragma once
+#include <cstdint>
+#include <cstring>
+#define __not_in_flash_func(x) x
+#define __not_in_flash(x)
+#define __force_inline inline __attribute__((always_inline))
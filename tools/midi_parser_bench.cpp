@@ -0,0 +1,203 @@
+/*
+ * Host test and benchmark for MIDIParser fed through LoopbackMIDITransport.
+ *
+ *     g++ -std=c++20 -O2 tools/midi_parser_bench.cpp -o midi_parser_bench
+ *     ./midi_parser_bench [megabytes]
+ *
+ * First a set of short streams checks the parser against the messages they
+ * should produce: running status, real-time bytes inside a message and
+ * inside SysEx, System Common cancelling running status, one-byte messages
+ * and stray data bytes. Then several MB of synthetic traffic (notes and CC
+ * mostly under running status, a 0xF8 clock byte every 24 bytes wherever
+ * it lands, occasional SysEx) is replayed through the transport and read
+ * back in 64-byte blocks as MIDIInOut does. The generator records the
+ * messages it wrote, and every decoded message is checked in order against
+ * that list. Throughput is host MB/s: useful
+ * for seeing that parsing is far from the bottleneck, not as absolute
+ * RP2350 figures.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../interface/MIDIParser.hpp"
+#include "../interface/MIDITransport.hpp"
+
+using Message = MIDIParser::Message;
+
+static bool Same(const Message &a, const Message &b) {
+    return a.type == b.type && a.channel == b.channel && a.data1 == b.data1 && a.data2 == b.data2;
+}
+
+// Replay bytes through a transport, read them back in blocks and parse
+static std::vector<Message> Parse(LoopbackMIDITransport &port, MIDIParser &parser,
+                                  std::span<const uint8_t> bytes, size_t block) {
+    std::vector<Message> out;
+    port.Replay(bytes);
+    uint8_t buf[256];
+    while (port.Pending()) {
+        const size_t n = port.Read(buf, block);
+        for (size_t i = 0; i < n; i++) {
+            Message msg;
+            if (parser.Process(buf[i], msg) != MIDIParser::kNone) {
+                out.push_back(msg);
+            }
+        }
+    }
+    return out;
+}
+
+struct Case {
+    const char *name;
+    std::vector<uint8_t> bytes;
+    std::vector<Message> expected;
+};
+
+static int RunCases() {
+    const Case cases[] = {
+        { "running status",
+          { 0x90, 60, 100, 62, 101, 64, 0 },
+          { { 0x90, 1, 60, 100 }, { 0x90, 1, 62, 101 }, { 0x90, 1, 64, 0 } } },
+        { "clock between status and data",
+          { 0x93, 0xF8, 60, 0xF8, 100, 0xF8 },
+          { { 0xF8, 0, 0, 0 }, { 0xF8, 0, 0, 0 }, { 0x90, 4, 60, 100 }, { 0xF8, 0, 0, 0 } } },
+        { "clock under running status",
+          { 0xB0, 7, 1, 0xF8, 7, 0xFA, 2, 10, 0xFC, 64 },
+          { { 0xB0, 1, 7, 1 }, { 0xF8, 0, 0, 0 }, { 0xFA, 0, 0, 0 }, { 0xB0, 1, 7, 2 },
+            { 0xFC, 0, 0, 0 }, { 0xB0, 1, 10, 64 } } },
+        { "one data byte, running",
+          { 0xC5, 3, 4, 0xF8, 5, 0xD0, 90, 91 },
+          { { 0xC0, 6, 3, 0 }, { 0xC0, 6, 4, 0 }, { 0xF8, 0, 0, 0 }, { 0xC0, 6, 5, 0 },
+            { 0xD0, 1, 90, 0 }, { 0xD0, 1, 91, 0 } } },
+        { "realtime inside SysEx",
+          { 0x90, 60, 100, 0xF0, 1, 2, 0xF8, 3, 0xF7, 61, 100, 0x80, 60, 0 },
+          { { 0x90, 1, 60, 100 }, { 0xF8, 0, 0, 0 }, { 0x80, 1, 60, 0 } } },
+        { "System Common cancels running status",
+          { 0xE2, 0, 64, 0xF2, 1, 2, 3, 4, 0xE2, 5, 6 },
+          { { 0xE0, 3, 0, 64 }, { 0xE0, 3, 5, 6 } } },
+        { "data bytes before any status",
+          { 1, 2, 3, 0xF8, 0x9F, 1, 2 },
+          { { 0xF8, 0, 0, 0 }, { 0x90, 16, 1, 2 } } },
+    };
+
+    int failures = 0;
+    for (const Case &c : cases) {
+        // One byte per read, then the whole case in one read
+        for (size_t block : { size_t(1), size_t(64) }) {
+            LoopbackMIDITransport port;
+            MIDIParser parser;
+            const std::vector<Message> got = Parse(port, parser, c.bytes, block);
+            bool ok = got.size() == c.expected.size();
+            for (size_t i = 0; ok && i < got.size(); i++) {
+                ok = Same(got[i], c.expected[i]);
+            }
+            if (!ok) {
+                std::printf("FAIL %s (%zu-byte reads): %zu messages, expected %zu\n",
+                            c.name, block, got.size(), c.expected.size());
+                failures++;
+            }
+        }
+    }
+    std::printf("%zu parser cases, %d failures\n", sizeof(cases) / sizeof(cases[0]), failures);
+    return failures;
+}
+
+// Synthetic traffic and the messages it should decode to
+static void MakeTraffic(size_t target_bytes, std::vector<uint8_t> &bytes, std::vector<Message> &expected) {
+    uint32_t seed = 7;
+    uint8_t status = 0;
+    size_t since_clock = 0;
+    // complete, if set, is the message this byte finishes: it decodes
+    // before a clock that follows the byte
+    auto put = [&](uint8_t b, const Message *complete = nullptr) {
+        bytes.push_back(b);
+        if (complete) {
+            expected.push_back(*complete);
+        }
+        if (++since_clock == 24) {
+            // Clock lands wherever it falls, including mid-message
+            bytes.push_back(0xF8);
+            expected.push_back({ 0xF8, 0, 0, 0 });
+            since_clock = 0;
+        }
+    };
+    while (bytes.size() < target_bytes) {
+        seed = seed * 1664525u + 1013904223u;
+        const uint32_t r = seed >> 16;
+        if (r % 200 == 0) {
+            put(0xF0);
+            for (uint32_t i = 0; i < 8 + r % 16; i++) {
+                put(static_cast<uint8_t>((r + i) & 0x7F));
+            }
+            put(0xF7);
+            status = 0;
+            continue;
+        }
+        static const uint8_t kTypes[] = { 0x90, 0x90, 0x80, 0xB0, 0xB0, 0xE0, 0xC0 };
+        const uint8_t type = kTypes[r % 7];
+        // Mostly stay on one status so running status is exercised
+        const uint8_t next = (r & 0x300) ? (status ? status : type) : (type | ((r >> 4) & 0x0F));
+        if (next != status) {
+            status = next;
+            put(status);
+        }
+        const uint8_t d1 = static_cast<uint8_t>((r >> 3) & 0x7F);
+        const uint8_t d2 = static_cast<uint8_t>((r >> 9) & 0x7F);
+        const bool one = (status & 0xF0) == 0xC0;
+        const Message msg{ static_cast<uint8_t>(status & 0xF0), static_cast<uint8_t>((status & 0x0F) + 1),
+                           d1, static_cast<uint8_t>(one ? 0 : d2) };
+        if (one) {
+            put(d1, &msg);
+        } else {
+            put(d1);
+            put(d2, &msg);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const double megabytes = argc > 1 ? std::atof(argv[1]) : 16.0;
+    int failures = RunCases();
+
+    std::vector<uint8_t> bytes;
+    std::vector<Message> expected;
+    MakeTraffic(static_cast<size_t>(megabytes * 1e6), bytes, expected);
+
+    LoopbackMIDITransport port;
+    MIDIParser parser;
+    port.Replay(bytes);
+    std::vector<Message> got;
+    got.reserve(expected.size());
+    uint8_t buf[64];
+    const auto start = std::chrono::steady_clock::now();
+    while (port.Pending()) {
+        const size_t n = port.Read(buf, sizeof(buf));
+        for (size_t i = 0; i < n; i++) {
+            Message msg;
+            if (parser.Process(buf[i], msg) != MIDIParser::kNone) {
+                got.push_back(msg);
+            }
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const double us = std::chrono::duration<double, std::micro>(end - start).count();
+
+    size_t mismatched = got.size() != expected.size();
+    for (size_t i = 0; i < got.size() && i < expected.size(); i++) {
+        mismatched += !Same(got[i], expected[i]);
+    }
+    size_t clocks = 0;
+    for (const Message &m : got) {
+        clocks += m.type == 0xF8;
+    }
+    failures += mismatched != 0;
+
+    std::printf("%.1f MB through the loopback in 64-byte reads: %zu messages (%zu clocks), "
+                "%zu expected, %zu mismatched\n",
+                port.GetBytesRead() / 1e6, got.size(), clocks, expected.size(), mismatched);
+    std::printf("%.1f MB/s, %.1f M messages/s, %.1f ns/message "
+                "(DIN MIDI is 3125 bytes/s)\n",
+                bytes.size() / us, got.size() / us, us * 1e3 / static_cast<double>(got.size()));
+    return failures ? 1 : 0;
+}
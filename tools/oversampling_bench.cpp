@@ -0,0 +1,167 @@
+/*
+ * Host benchmark for Oversampler and ADAA1: aliasing and CPU per factor.
+ *
+ *     g++ -std=c++20 -O2 -Itools/host tools/oversampling_bench.cpp synth/maximilian.cpp -o oversampling_bench
+ *     ./oversampling_bench [drive]
+ *
+ * Sine sweep: for each test frequency a bin-centred sine at 48 kHz, driven
+ * into maxiNonlinearity::hardclip and softclip (drive 4 by default), is
+ * run through each variant in 64-sample blocks. Over a 4096-point FFT of
+ * the settled output, power at the true harmonics is signal and power at
+ * any other bin below 20 kHz is aliasing (the half-band filters let some
+ * through between 20 and 24 kHz, by design); the figure is aliasing
+ * relative to the fundamental. Bins are odd, so aliases never land on
+ * harmonics. Timings are host ns per base-rate sample with the
+ * hardclip shaper, for comparing factors rather than as RP2350 figures.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../synth/Oversampler.hpp"
+
+static constexpr size_t kBlock = 64;
+static constexpr size_t kFFT = 4096;
+static constexpr float kRate = 48000.f;
+
+static void FFT(std::vector<std::complex<double>> &a) {
+    const size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(a[i], a[j]);
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const std::complex<double> w = std::polar(1.0, -2.0 * M_PI / static_cast<double>(len));
+        for (size_t i = 0; i < n; i += len) {
+            std::complex<double> wn = 1;
+            for (size_t k = 0; k < len / 2; k++) {
+                const auto u = a[i + k], v = a[i + k + len / 2] * wn;
+                a[i + k] = u + v;
+                a[i + k + len / 2] = u - v;
+                wn *= w;
+            }
+        }
+    }
+}
+
+// Aliasing power relative to the fundamental, in dB
+static double AliasDb(const std::vector<float> &y, size_t bin) {
+    std::vector<std::complex<double>> a(y.begin(), y.end());
+    FFT(a);
+    double fund = 0, alias = 0;
+    const size_t audible = static_cast<size_t>(20000.f / kRate * kFFT);
+    for (size_t k = 1; k < audible; k++) {
+        const double p = std::norm(a[k]);
+        if (k == bin) {
+            fund = p;
+        } else if (k % bin != 0) {
+            alias += p;
+        }
+    }
+    return 10.0 * std::log10(alias / fund + 1e-30);
+}
+
+enum class Mode { Base, ADAA, X2, X4, X2ADAA };
+static const char *kModeNames[] = {"1x", "1x ADAA", "2x", "4x", "2x ADAA"};
+
+template<typename Curve>
+static std::vector<float> Run(Mode mode, size_t bin, float drive) {
+    const size_t n = kFFT * 4;
+    std::vector<float> x(n), y(n);
+    const double w = 2.0 * M_PI * static_cast<double>(bin) / kFFT;
+    for (size_t i = 0; i < n; i++) {
+        x[i] = drive * static_cast<float>(std::sin(w * static_cast<double>(i)));
+    }
+    Oversampler<2, kBlock> os2;
+    Oversampler<4, kBlock> os4;
+    ADAA1<Curve> aa;
+    auto plain = [](float v) { return Curve::f(v); };
+    for (size_t i = 0; i < n; i += kBlock) {
+        switch (mode) {
+            case Mode::Base:
+                for (size_t j = 0; j < kBlock; j++) y[i + j] = Curve::f(x[i + j]);
+                break;
+            case Mode::ADAA:
+                for (size_t j = 0; j < kBlock; j++) y[i + j] = aa(x[i + j]);
+                break;
+            case Mode::X2:
+                os2.process(&x[i], &y[i], plain);
+                break;
+            case Mode::X4:
+                os4.process(&x[i], &y[i], plain);
+                break;
+            case Mode::X2ADAA:
+                os2.process(&x[i], &y[i], aa);
+                break;
+        }
+    }
+    return std::vector<float>(y.end() - kFFT, y.end());
+}
+
+template<typename Curve>
+static void Sweep(const char *name, float drive) {
+    static const float kFreqs[] = {1000.f, 3000.f, 5000.f, 8000.f, 12000.f, 16000.f};
+    std::printf("\n%s, drive %.1f: aliasing relative to the fundamental (dB)\n", name, drive);
+    std::printf("%-10s", "Hz");
+    for (const char *m : kModeNames) std::printf("%10s", m);
+    std::printf("\n");
+    for (float f : kFreqs) {
+        const size_t bin = static_cast<size_t>(f / kRate * kFFT) | 1;
+        std::printf("%-10.0f", static_cast<double>(bin) * kRate / kFFT);
+        for (int m = 0; m < 5; m++) {
+            std::printf("%10.1f", AliasDb(Run<Curve>(static_cast<Mode>(m), bin, drive), bin));
+        }
+        std::printf("\n");
+    }
+}
+
+template<typename F>
+static double TimeNs(size_t n, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(n);
+}
+
+int main(int argc, char **argv) {
+    const float drive = argc > 1 ? static_cast<float>(std::atof(argv[1])) : 4.f;
+    maxiSettings::setup(48000, 1, kBlock);
+
+    Sweep<ADAAHardClip>("hardclip", drive);
+    Sweep<ADAASoftClip>("softclip", drive);
+
+    const size_t n = 48000 * 20 / kBlock * kBlock;
+    std::vector<float> x(n), y(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = drive * std::sin(2.f * static_cast<float>(M_PI) * 440.f * i / kRate);
+    }
+    volatile float sink = 0;
+    maxiNonlinearity nl;
+    Oversampler<2, kBlock> os2;
+    Oversampler<4, kBlock> os4;
+    ADAA1<ADAAHardClip> aa;
+    auto clip = [&](float v) { return nl.hardclip(v); };
+    const double t_base = TimeNs(n, [&] { for (size_t i = 0; i < n; i++) y[i] = nl.hardclip(x[i]); });
+    sink = sink + y[n / 2];
+    const double t_adaa = TimeNs(n, [&] { for (size_t i = 0; i < n; i++) y[i] = aa(x[i]); });
+    sink = sink + y[n / 2];
+    const double t_2x = TimeNs(n, [&] { for (size_t i = 0; i < n; i += kBlock) os2.process(&x[i], &y[i], clip); });
+    sink = sink + y[n / 2];
+    const double t_4x = TimeNs(n, [&] { for (size_t i = 0; i < n; i += kBlock) os4.process(&x[i], &y[i], clip); });
+    sink = sink + y[n / 2];
+    const double t_2xaa = TimeNs(n, [&] { for (size_t i = 0; i < n; i += kBlock) os2.process(&x[i], &y[i], aa); });
+    sink = sink + y[n / 2];
+
+    std::printf("\nCPU, hardclip, ns per sample (latency in samples at the base rate)\n");
+    std::printf("%-10s %8.2f   %4.1f\n", "1x", t_base, 0.0);
+    std::printf("%-10s %8.2f   %4.1f\n", "1x ADAA", t_adaa, 0.5);
+    std::printf("%-10s %8.2f   %4.1f\n", "2x", t_2x, Oversampler<2, kBlock>::latency());
+    std::printf("%-10s %8.2f   %4.1f\n", "4x", t_4x, Oversampler<4, kBlock>::latency());
+    std::printf("%-10s %8.2f   %4.1f\n", "2x ADAA", t_2xaa, Oversampler<2, kBlock>::latency() + 0.25);
+    return 0;
+}
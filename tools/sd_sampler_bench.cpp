@@ -0,0 +1,149 @@
+/*
+ * Host benchmark for SDSampler: how many streaming voices a card of a given
+ * speed sustains.
+ *
+ *     g++ -std=c++20 -O2 -Itools/host tools/sd_sampler_bench.cpp synth/SDSampler.cpp -o sd_sampler_bench
+ *     ./sd_sampler_bench [seconds]
+ *
+ * Samples live in a MockFileSource. Each 64-frame audio block gives the
+ * reader one block's worth of simulated card time; reads that take longer
+ * delay the next blocks' reads, so a slow card shows up as underruns.
+ *
+ * First, a voice is streamed a loud sample, then retriggered 256 times
+ * with a silent one and never serviced: every streamed frame must play
+ * silence (an underrun), not the loud sample's chunks left in its slots.
+ * Exits non-zero if it does not.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../synth/SDSampler.hpp"
+
+static constexpr float kSampleRate = 48000.f;
+static constexpr size_t kBlock = 64;
+static constexpr size_t kFiles = 16;
+
+static std::vector<uint8_t> MakeWav(size_t frames, uint16_t channels, float freq) {
+    const uint32_t data_bytes = static_cast<uint32_t>(frames * channels * 2);
+    std::vector<uint8_t> wav(44 + data_bytes);
+    auto put16 = [&](size_t at, uint16_t v) { wav[at] = v & 0xFF; wav[at + 1] = v >> 8; };
+    auto put32 = [&](size_t at, uint32_t v) { put16(at, v & 0xFFFF); put16(at + 2, v >> 16); };
+    std::memcpy(&wav[0], "RIFF", 4);
+    put32(4, 36 + data_bytes);
+    std::memcpy(&wav[8], "WAVEfmt ", 8);
+    put32(16, 16);
+    put16(20, 1);
+    put16(22, channels);
+    put32(24, static_cast<uint32_t>(kSampleRate));
+    put32(28, static_cast<uint32_t>(kSampleRate) * channels * 2);
+    put16(32, channels * 2);
+    put16(34, 16);
+    std::memcpy(&wav[36], "data", 4);
+    put32(40, data_bytes);
+    for (size_t i = 0; i < frames * channels; i++) {
+        const int16_t v = static_cast<int16_t>(8000.f * std::sin(freq * static_cast<float>(i / channels)));
+        put16(44 + i * 2, static_cast<uint16_t>(v));
+    }
+    return wav;
+}
+
+// Slots loaded for an old note must not match a later trigger
+static bool StaleSlots() {
+    MockFileSource fs;
+    const size_t frames = static_cast<size_t>(kSampleRate);
+    fs.AddFile("/loud.wav", MakeWav(frames, 1, 0.01f));
+    fs.AddFile("/silent.wav", MakeWav(frames, 1, 0.f));
+
+    SDSampler sampler(fs, 10.f);
+    sampler.SetOutputRate(kSampleRate);
+    const int loud = sampler.Load("/loud.wav");
+    const int quiet = sampler.Load("/silent.wav");
+    const int voice = sampler.Trigger(loud);
+    sampler.Service();
+    sampler.Stop(voice);
+
+    // The 256th trigger after the loud note has the same 8-bit generation
+    for (int i = 0; i < 255; i++) {
+        sampler.Stop(sampler.Trigger(quiet));
+    }
+    sampler.Trigger(quiet);
+    float peak = 0.f;
+    for (size_t i = 0; i < frames / 4; i++) {
+        peak = std::fmax(peak, std::fabs(sampler.Process()));
+    }
+    std::printf("retriggered 256 times, unserviced: peak %.4f, %u underruns\n\n",
+                peak, sampler.GetStats().underruns);
+    if (peak != 0.f) {
+        std::printf("FAIL stale slots played after 256 retriggers\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const float seconds = argc > 1 ? static_cast<float>(std::atof(argv[1])) : 10.f;
+    const bool stale_ok = StaleSlots();
+    const float rates[] = {0.5f, 1.f, 2.5f, 5.f, 10.f};   // MB/s
+
+    std::printf("%ds of continuous %d-frame blocks, 3 s stereo samples, %zu-byte chunks x %zu slots\n\n",
+                static_cast<int>(seconds), static_cast<int>(kBlock), SDSampler::kChunkBytes, SDSampler::kSlots);
+    std::printf("%8s", "MB/s");
+    for (size_t v = 1; v <= SDSampler::kVoices; v++) {
+        std::printf("%9zuv", v);
+    }
+    std::printf("\n");
+
+    for (float rate : rates) {
+        std::printf("%8.1f", rate);
+        for (size_t n_voices = 1; n_voices <= SDSampler::kVoices; n_voices++) {
+            MockFileSource fs({3000.f, 400.f, rate});
+            char path[32];
+            for (size_t f = 0; f < kFiles; f++) {
+                std::snprintf(path, sizeof(path), "/s%zu.wav", f);
+                fs.AddFile(path, MakeWav(static_cast<size_t>(3.f * kSampleRate), 2, 0.01f + 0.001f * f));
+            }
+
+            SDSampler *sampler = new SDSampler(fs, 100.f);
+            sampler->SetOutputRate(kSampleRate);
+            for (size_t f = 0; f < kFiles; f++) {
+                std::snprintf(path, sizeof(path), "/s%zu.wav", f);
+                sampler->Load(path);
+            }
+            fs.ResetStats();
+
+            // Keep n_voices playing, staggered so they don't start together
+            const size_t n_blocks = static_cast<size_t>(seconds * kSampleRate / kBlock);
+            const double block_us = 1e6 * kBlock / kSampleRate;
+            double budget_us = 0;
+            size_t next = 0;
+            std::vector<int> voices(n_voices, -1);
+            for (size_t b = 0; b < n_blocks; b++) {
+                for (size_t v = 0; v < n_voices; v++) {
+                    if ((voices[v] < 0 && b >= v * 40) || (voices[v] >= 0 && !sampler->IsPlaying(voices[v]))) {
+                        voices[v] = sampler->Trigger(static_cast<int>(next++ % kFiles));
+                    }
+                }
+                for (size_t i = 0; i < kBlock; i++) {
+                    sampler->Process();
+                }
+                budget_us += block_us;
+                while (fs.GetBusyUs() < budget_us && sampler->Service(1) > 0) {
+                }
+                if (fs.GetBusyUs() < budget_us) {
+                    // Idle time is not banked
+                    budget_us = fs.GetBusyUs();
+                }
+            }
+
+            const SDSampler::Stats stats = sampler->GetStats();
+            const double reads = static_cast<double>(n_blocks * kBlock * n_voices * 2);
+            std::printf("%9.2f%%", 100.0 * stats.underruns / reads);
+            delete sampler;
+        }
+        std::printf("\n");
+    }
+    std::printf("\n(share of sample reads that underran)\n");
+    return stale_ok ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/*
+ * Host test and benchmark for the sensor board v2 protocol: StreamSimulator
+ * through SLIPDecoder into SensorProtocolV2::Parse, as UARTInput does.
+ *
+ *     g++ -std=c++20 -O2 -fsanitize=address,undefined tools/sensor_v2_bench.cpp -o sensor_v2_bench
+ *     ./sensor_v2_bench [frames]
+ *
+ * For float32 and int16, at 1x1 up to the largest batch (32 channels x 16
+ * samples), every decoded value and timestamp is checked against the
+ * simulator's signal. Every 7th frame is corrupted and must fail the CRC;
+ * frames cut short must be rejected; a batch over kMaxValues must not
+ * encode, and Frame::Channel past the last column must return
+ * kMaxChannels. Throughput is host MB/s of SLIP input and includes the
+ * value checks (a sinf per value), so it is a lower bound: useful for
+ * comparing formats, not as absolute RP2350 figures. Exits non-zero on
+ * any failure.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../interface/SensorProtocolV2.hpp"
+#include "../utils/SLIPDecoder.hpp"
+
+using namespace SensorProtocolV2;
+
+static int failures = 0;
+
+static void Check(bool ok, const char *what) {
+    if (!ok) {
+        std::printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+struct Result {
+    size_t good = 0, bad = 0, bytes = 0;
+    double mb_per_s = 0.0;
+};
+
+static Result Run(uint32_t mask, uint8_t samples, SampleFormat format, size_t n_frames) {
+    static uint8_t encoded[StreamSimulator::kMaxEncodedBytes];
+    static float values[kMaxValues];
+    const uint32_t rate = 1000;
+    const uint16_t period_us = static_cast<uint16_t>(1000000 / rate);
+    const float tol = format == kInt16 ? 1.5f / 32768.f : 0.f;
+
+    StreamSimulator sim(mask, rate, samples, format);
+    sim.SetCorruptEvery(7);
+    std::vector<uint8_t> stream;
+    for (size_t f = 0; f < n_frames; f++) {
+        const size_t n = sim.NextFrame(encoded);
+        stream.insert(stream.end(), encoded, encoded + n);
+    }
+
+    Result r;
+    r.bytes = stream.size();
+    size_t frame = 0;
+    bool values_ok = true, times_ok = true;
+    SLIPDecoder<kMaxFrameBytes> slip(false);
+    const auto start = std::chrono::steady_clock::now();
+    slip.Feed(std::span<const uint8_t>(stream), [&](std::span<const uint8_t> payload) {
+        const size_t index = frame++;
+        Frame decoded;
+        if (!Parse(payload, decoded, values)) {
+            r.bad++;
+            return;
+        }
+        r.good++;
+        // Corrupted frames that parsed would fail here, as would any drift
+        const uint32_t first = static_cast<uint32_t>(index * samples);
+        times_ok &= decoded.timestamp_us == first * period_us;
+        for (size_t s = 0; s < decoded.n_samples; s++) {
+            // As StreamSimulator computes it, so float32 matches exactly
+            const float t = static_cast<float>(first + s) * period_us * 1e-6f;
+            for (size_t col = 0; col < decoded.n_channels; col++) {
+                const size_t ch = decoded.Channel(col);
+                const float x = 0.9f * sinf(6.2831853f * (1.f + ch) * t);
+                values_ok &= std::fabs(decoded.samples[s * decoded.n_channels + col] - x) <= tol;
+            }
+        }
+    });
+    const auto end = std::chrono::steady_clock::now();
+    r.mb_per_s = static_cast<double>(r.bytes) / std::chrono::duration<double, std::micro>(end - start).count();
+
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s %zux%u: values", format == kInt16 ? "int16" : "float32",
+                  static_cast<size_t>(__builtin_popcount(mask)), samples);
+    Check(values_ok, label);
+    std::snprintf(label, sizeof(label), "%s %zux%u: timestamps", format == kInt16 ? "int16" : "float32",
+                  static_cast<size_t>(__builtin_popcount(mask)), samples);
+    Check(times_ok, label);
+    std::snprintf(label, sizeof(label), "%s %zux%u: every 7th frame rejected", format == kInt16 ? "int16" : "float32",
+                  static_cast<size_t>(__builtin_popcount(mask)), samples);
+    Check(r.bad == n_frames / 7 && r.good == n_frames - n_frames / 7, label);
+    return r;
+}
+
+static void Truncated() {
+    static uint8_t payload[kMaxFrameBytes];
+    static float values[kMaxValues];
+    float in[kMaxValues];
+    for (size_t i = 0; i < kMaxValues; i++) {
+        in[i] = 0.001f * static_cast<float>(i);
+    }
+    for (SampleFormat format : { kFloat32, kInt16 }) {
+        const size_t len = Encode(1234, 0xFFFFFFFFu, 1000, 16, format, in, payload);
+        Check(len == kHeaderBytes + kMaxValues * (format == kInt16 ? 2 : 4) + kCRCBytes, "full frame length");
+        Frame decoded;
+        Check(Parse(std::span<const uint8_t>(payload, len), decoded, values), "full frame parses");
+        bool rejected = true;
+        for (size_t cut = 1; cut < len; cut++) {
+            rejected &= !Parse(std::span<const uint8_t>(payload, len - cut), decoded, values);
+        }
+        Check(rejected, "every truncation rejected");
+        Check(decoded.Channel(31) == 31 && decoded.Channel(32) == kMaxChannels, "Channel past the last column");
+    }
+    Check(Encode(0, 0xFFFFFFFFu, 1000, 17, kFloat32, in, payload) == 0, "oversize batch not encoded");
+    Frame empty{};
+    Check(empty.Channel(0) == kMaxChannels, "Channel of an empty mask");
+}
+
+int main(int argc, char **argv) {
+    const size_t n_frames = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 7000;
+    Truncated();
+
+    std::printf("%-24s %10s %10s %8s %8s\n", "", "decoded", "rejected", "MB/s", "kvals/s");
+    struct Config { uint32_t mask; uint8_t samples; };
+    for (SampleFormat format : { kFloat32, kInt16 }) {
+        for (Config c : { Config{ 0x1u, 1 }, Config{ 0xFFu, 4 }, Config{ 0xFFFFFFFFu, 16 } }) {
+            const Result r = Run(c.mask, c.samples, format, n_frames);
+            const size_t n_values = static_cast<size_t>(__builtin_popcount(c.mask)) * c.samples;
+            char label[48];
+            std::snprintf(label, sizeof(label), "%s %ux%u", format == kInt16 ? "int16" : "float32",
+                          __builtin_popcount(c.mask), c.samples);
+            std::printf("%-24s %10zu %10zu %8.1f %8.0f\n", label, r.good, r.bad, r.mb_per_s,
+                        r.mb_per_s * 1e3 * static_cast<double>(r.good * n_values) / static_cast<double>(r.bytes));
+        }
+    }
+    std::printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
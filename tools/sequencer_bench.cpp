@@ -0,0 +1,158 @@
+/*
+ * Host benchmark for EuclideanSequencer against per-sample gate evaluation
+ * as in EuclideanAudioApp.
+ *
+ *     g++ -std=c++20 -O2 -Itools/host tools/sequencer_bench.cpp -o sequencer_bench
+ *     ./sequencer_bench [seconds]
+ *
+ * The baseline is EuclideanAudioApp::Process() for 16 tracks: every sample
+ * it works out each gate from a float phase, and on a change copies the
+ * gates into a std::vector for the callback (which EuclideanMIDI turns
+ * into notes). Timing accuracy compares each event's sample with its exact
+ * position on the sequencer's grid, with swing. Timings are host
+ * nanoseconds per sample: useful for comparing the two, not as absolute
+ * RP2350 figures.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+#include "../synth/EuclideanSequencer.hpp"
+
+static constexpr size_t kBlock = 64;
+static constexpr float kRate = 48000.f;
+static constexpr size_t kTracks = 16;
+
+template<typename F>
+static double TimeNs(size_t n_samples, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(n_samples);
+}
+
+// EuclideanAudioApp::euclidean()
+static bool Gate(float phase, size_t n, size_t k, size_t offset, float pulse_width) {
+    if (n == 0 || k == 0 || k > n) {
+        return false;
+    }
+    const float fi = phase * static_cast<float>(n);
+    size_t step = static_cast<size_t>(fi);
+    const float rem = fi - static_cast<float>(step);
+    if (step >= n) {
+        step = n - 1;
+    }
+    step = (step + offset) % n;
+    const bool is_pulse_step = ((step * k) / n) != (((step - 1 + n) % n) * k) / n;
+    return is_pulse_step && rem < pulse_width;
+}
+
+struct MIDICounter {
+    size_t on = 0, off = 0;
+    void SetMIDINoteChannel(uint8_t) {}
+    bool queueNoteOn(uint8_t, uint8_t) { on++; return true; }
+    bool queueNoteOff(uint8_t, uint8_t) { off++; return true; }
+};
+
+int main(int argc, char **argv) {
+    const float seconds = argc > 1 ? static_cast<float>(std::atof(argv[1])) : 10.f;
+    const size_t n = static_cast<size_t>(seconds * kRate) / kBlock * kBlock;
+    static const size_t kHits[kTracks] = { 4, 3, 5, 7, 2, 9, 5, 3, 11, 1, 6, 5, 7, 3, 13, 4 };
+    static const size_t kSteps[kTracks] = { 16, 8, 16, 12, 16, 16, 8, 16, 16, 4, 16, 12, 16, 9, 16, 8 };
+
+    // Baseline: per-sample gates, vector copy on change
+    size_t calls = 0;
+    std::function<void(const std::vector<float> &)> callback =
+        [&](const std::vector<float> &v) { calls += v.size(); };
+    float previous[kTracks] = {};
+    float phase = 0.f;
+    const float phase_inc = (137.f / 60.f) / kRate;
+    const double t_sample = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i++) {
+            phase += phase_inc;
+            if (phase >= 1.f) {
+                phase -= 1.f;
+            }
+            float gates[kTracks];
+            for (size_t t = 0; t < kTracks; t++) {
+                gates[t] = static_cast<float>(Gate(phase, kSteps[t], kHits[t], t % 3, 0.5f));
+            }
+            bool changed = false;
+            for (size_t t = 0; t < kTracks; t++) {
+                if (gates[t] != previous[t]) {
+                    previous[t] = gates[t];
+                    changed = true;
+                }
+            }
+            if (changed) {
+                std::vector<float> v(gates, gates + kTracks);
+                callback(v);
+            }
+        }
+    });
+
+    // Sequencer: 16 tracks with MIDI, swung, drained every block
+    EuclideanSequencer<1024> seq;
+    seq.Setup(kRate);
+    seq.SetTempo(137.f);
+    {
+        SequencerPatterns &p = seq.EditPatterns();
+        for (size_t t = 0; t < kTracks; t++) {
+            p.SetEuclid(t, kHits[t], kSteps[t], t % 3);
+        }
+        p.groove = GrooveTemplate::Swing(0.62f);
+        seq.PublishPatterns();
+    }
+    seq.Start();
+    MIDICounter midi;
+    EuclideanSequencer<1024>::Event events[kTracks * 4];
+    size_t hits = 0;
+    const double t_seq = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i += kBlock) {
+            hits += seq.Process(kBlock, events, kTracks * 4);
+            seq.SendMIDI(midi, seq.Time() - kBlock);
+        }
+    });
+
+    // Timing: every event against its exact grid position
+    EuclideanSequencer<1024> check;
+    check.Setup(kRate);
+    check.SetTempo(137.f);
+    check.EditPatterns() = seq.EditPatterns();
+    check.PublishPatterns();
+    check.Start();
+    const GrooveTemplate groove = GrooveTemplate::Swing(0.62f);
+    const double inc = static_cast<double>(static_cast<uint32_t>(
+        137.f * (4.f / 60.f) / kRate * 4294967296.f));
+    const double exact_step = 4294967296.0 / inc;
+    double worst = 0.0;
+    size_t checked = 0, missing = 0;
+    uint32_t step = 0;
+    for (size_t i = 0; i < n; i += kBlock) {
+        const size_t count = check.Process(kBlock, events, kTracks * 4);
+        for (size_t e = 0; e < count; e++) {
+            const double t = static_cast<double>(i + events[e].offset);
+            // Step this event belongs to: the latest whose grooved time is not after it
+            while ((step + 1) * exact_step + groove.timing[(step + 1) % 16] * exact_step <= t + 1.0) {
+                step++;
+            }
+            const double ideal = (step + static_cast<double>(groove.timing[step % 16])) * exact_step;
+            worst = std::fmax(worst, std::fabs(t - ideal));
+            const SequencerPatterns::Track &tr = seq.EditPatterns().tracks[events[e].track];
+            missing += !((tr.bits >> (step % tr.length)) & 1);
+            checked++;
+        }
+    }
+
+    std::printf("%zu events over %.0f s at 137 bpm with 62%% swing: worst %.2f samples from the grid, "
+                "%zu not on a hit\n", checked, seconds, worst, missing);
+    std::printf("%zu hits, %zu note ons, %zu note offs, %u MIDI dropped (baseline callbacks: %zu)\n\n",
+                hits, midi.on, midi.off, seq.DroppedMIDI(), calls / kTracks);
+    std::printf("%-48s %8s %8s\n", "", "ns/smp", "speedup");
+    std::printf("%-48s %8.2f %8s\n", "16 tracks, per-sample gates (EuclideanAudioApp)", t_sample, "1.0x");
+    std::printf("%-48s %8.2f %7.0fx\n", "EuclideanSequencer, 16 tracks + MIDI", t_seq, t_sample / t_seq);
+    return 0;
+}
@@ -0,0 +1,222 @@
+/*
+ * Host benchmark for SliceEngine against per-sample slice playback as in
+ * DynamicSliceSelector.
+ *
+ *     g++ -std=c++20 -O2 -Itools/host tools/slice_bench.cpp -o slice_bench
+ *     ./slice_bench [seconds]
+ *
+ * The loop is a synthetic 2 s, 4-beat drum pattern at 48 kHz with hits on
+ * some of its sixteenth notes. The baseline is DynamicSliceSelector's
+ * Process() loop (bounds-checked read, slice search and crossfade buffer,
+ * one sample per call), without its pico locking or streaming, at natural
+ * speed only. SliceEngine interpolates, so is doing more per sample.
+ * Timings are host nanoseconds per output sample for four loops: useful
+ * for comparing the two, not as absolute RP2350 figures.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../synth/SliceEngine.hpp"
+
+static constexpr size_t kBlock = 64;
+static constexpr uint32_t kRate = 48000;
+static constexpr uint32_t kLoop = 2 * kRate;
+static constexpr size_t kLoops = 4;
+
+template<typename F>
+static double TimeNs(size_t n_samples, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(n_samples);
+}
+
+// Decaying tone and noise hits on a sixteenth grid
+static std::vector<float> MakeLoop(uint32_t seed, std::vector<uint32_t> &onsets) {
+    std::vector<float> x(kLoop, 0.f);
+    const uint32_t step = kLoop / 16;
+    for (uint32_t s = 0; s < 16; s++) {
+        seed = seed * 1664525u + 1013904223u;
+        if (s && (seed >> 28) < 6) {
+            continue;
+        }
+        onsets.push_back(s * step);
+        for (uint32_t i = 0; i < step; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            const float noise = static_cast<float>(static_cast<int32_t>(seed)) * (1.f / 2147483648.f);
+            const float tone = std::sin(static_cast<float>(i) * (s % 4 ? 0.2f : 0.02f));
+            x[s * step + i] += std::exp(-static_cast<float>(i) / 1500.f) * (s % 2 ? noise : tone) * 0.5f;
+        }
+    }
+    return x;
+}
+
+// DynamicSliceSelector::Process, without the locking and stream
+class PerSampleSlicer {
+public:
+    static constexpr int kCrossfadeSamples = 64;
+
+    void Set(const float *samples, uint32_t length, const std::vector<uint32_t> &starts) {
+        samples_ = samples;
+        length_ = length;
+        num_ = static_cast<int>(starts.size());
+        for (int i = 0; i < num_; i++) {
+            start_[i] = starts[i];
+            len_[i] = (i + 1 < num_ ? starts[i + 1] : length) - starts[i];
+        }
+        pos_ = 0;
+        slice_start_ = 0;
+        slice_end_ = len_[0];
+    }
+
+    float Read(uint32_t pos) const {
+        return pos < length_ ? samples_[pos] : 0.f;
+    }
+
+    float Process() {
+        float out;
+        if (crossfading_) {
+            const float current = Read(pos_);
+            const float fade = float(xpos_) / float(kCrossfadeSamples);
+            out = xbuf_[xpos_] * (1.f - fade) + current * fade;
+            if (++xpos_ >= kCrossfadeSamples) {
+                crossfading_ = false;
+                xpos_ = 0;
+            }
+        } else {
+            out = Read(pos_);
+        }
+        pos_++;
+        if (pos_ >= slice_end_) {
+            int next = 0;
+            for (int i = 0; i < num_; i++) {
+                if (start_[i] >= pos_) {
+                    next = i;
+                    break;
+                }
+            }
+            for (int j = 0; j < kCrossfadeSamples; j++) {
+                xbuf_[j] = Read(slice_end_ - kCrossfadeSamples + j);
+            }
+            slice_start_ = start_[next];
+            slice_end_ = slice_start_ + len_[next];
+            pos_ = slice_start_;
+            crossfading_ = true;
+            xpos_ = 0;
+        }
+        return out;
+    }
+
+private:
+    const float *samples_ = nullptr;
+    uint32_t length_ = 0;
+    uint32_t start_[64], len_[64];
+    int num_ = 0;
+    uint32_t pos_ = 0, slice_start_ = 0, slice_end_ = 0;
+    float xbuf_[kCrossfadeSamples];
+    int xpos_ = 0;
+    bool crossfading_ = false;
+};
+
+int main(int argc, char **argv) {
+    const float seconds = argc > 1 ? static_cast<float>(std::atof(argv[1])) : 10.f;
+    const size_t n = static_cast<size_t>(seconds * kRate) / kBlock * kBlock;
+    std::vector<float> out(n);
+
+    std::vector<float> loops[kLoops];
+    std::vector<uint32_t> onsets[kLoops];
+    for (size_t l = 0; l < kLoops; l++) {
+        loops[l] = MakeLoop(12345u + 777u * l, onsets[l]);
+    }
+
+    // At the loop's own tempo, with the table made from its onsets, the
+    // engine should give back the loop, apart from the fade in from
+    // silence at the start of each pass (the end of the loop has run out)
+    {
+        SlicedLoop<float> loop;
+        loop.Setup(kRate);
+        loop.SetLoop(loops[0].data(), kLoop, kRate, onsets[0].data(), onsets[0].size(), 16);
+        loop.SetTempo(120.f);
+        loop.SetLoopBeats(4.f);
+        loop.Start();
+        std::vector<float> y(2 * kLoop);
+        for (size_t i = 0; i < y.size(); i += kBlock) {
+            loop.Process(&y[i], kBlock);
+        }
+        double err = 0, ref = 0;
+        for (size_t i = 0; i < y.size(); i++) {
+            if (i % kLoop < SlicedLoop<float>::kFadeSamples) {
+                continue;
+            }
+            const double x = loops[0][i % kLoop];
+            err += (y[i] - x) * (y[i] - x);
+            ref += x * x;
+        }
+        std::printf("%zu slices, two passes at the loop's tempo against the loop: error %.1f dB\n\n",
+                    onsets[0].size(), 10.0 * std::log10(err / ref + 1e-30));
+    }
+
+    // Baseline: four per-sample slicers
+    PerSampleSlicer slicers[kLoops];
+    for (size_t l = 0; l < kLoops; l++) {
+        slicers[l].Set(loops[l].data(), kLoop, onsets[l]);
+    }
+    const double t_sample = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i++) {
+            float y = 0.f;
+            for (auto &s : slicers) {
+                y += s.Process();
+            }
+            out[i] = y;
+        }
+    });
+
+    // SliceEngine at natural speed, then with a rearranged pattern:
+    // pitch, reverse and stutter
+    SliceEngine<kLoops> engine;
+    engine.Setup(kRate);
+    for (size_t l = 0; l < kLoops; l++) {
+        engine.Loop(l).SetLoop(loops[l].data(), kLoop, kRate, onsets[l].data(), onsets[l].size(), 16);
+    }
+    engine.SetTempo(120.f);
+    engine.Start();
+    const double t_plain = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i += kBlock) {
+            engine.Process(&out[i], kBlock);
+        }
+    });
+
+    for (size_t l = 0; l < kLoops; l++) {
+        SliceTable &t = engine.Loop(l).EditTable();
+        for (size_t s = 0; s < t.num_steps; s++) {
+            t.steps[s] = static_cast<int8_t>((s * 5 + l) % t.num_slices);
+        }
+        for (size_t k = 0; k < t.num_slices; k++) {
+            t.slices[k].rate = k % 3 ? 1.f : 1.5f;
+            t.slices[k].reverse = k % 4 == 1;
+            t.slices[k].stutter = k % 5 == 2 ? 4 : 1;
+        }
+        engine.Loop(l).PublishTable();
+    }
+    engine.SetTempo(137.f);
+    const double t_edit = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i += kBlock) {
+            engine.Process(&out[i], kBlock);
+        }
+    });
+
+    volatile float sink = 0;
+    for (float x : out) {
+        sink = sink + x;
+    }
+
+    std::printf("%-48s %8s %8s\n", "", "ns/smp", "speedup");
+    std::printf("%-48s %8.2f %8s\n", "4 loops, per sample (DynamicSliceSelector)", t_sample, "1.0x");
+    std::printf("%-48s %8.2f %7.1fx\n", "SliceEngine<4>, as recorded", t_plain, t_sample / t_plain);
+    std::printf("%-48s %8.2f %7.1fx\n", "SliceEngine<4>, pitch/reverse/stutter at 137 bpm", t_edit,
+                t_sample / t_edit);
+    return 0;
+}
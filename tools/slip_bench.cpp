@@ -0,0 +1,213 @@
+/*
+ * Host benchmark for SLIPDecoder against the byte-at-a-time state machine
+ * UARTInput used before it.
+ *
+ *     g++ -std=c++20 -O2 tools/slip_bench.cpp -o slip_bench
+ *     ./slip_bench [megabytes]
+ *
+ * The traffic is SLIP-encoded sensor frames of 1-32 float32 values with a
+ * CRC-16 trailer, with END and ESC bytes planted in the payload so about
+ * one byte in twenty is escaped. Every 50th frame has a payload byte
+ * flipped (a CRC error) and every 97th a bad escape. The decoder is fed
+ * as a DMA ring would feed it (FeedRing over a 4 KB ring) and in 64-byte
+ * reads. The baseline collects raw bytes up to END, then unescapes the
+ * frame into a second buffer and checks the CRC. Throughput is host MB/s
+ * of encoded input: useful for comparing the two, not as absolute RP2350
+ * figures.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../utils/SLIPDecoder.hpp"
+
+static constexpr uint8_t END = 192;
+static constexpr uint8_t ESC = 219;
+static constexpr size_t kMaxValues = 32;
+static constexpr size_t kMaxFrame = kMaxValues * sizeof(float) + 2;
+
+static void Encode(const uint8_t *src, size_t n, std::vector<uint8_t> &out) {
+    out.push_back(END);
+    for (size_t i = 0; i < n; i++) {
+        if (src[i] == END) {
+            out.push_back(ESC);
+            out.push_back(220);
+        } else if (src[i] == ESC) {
+            out.push_back(ESC);
+            out.push_back(221);
+        } else {
+            out.push_back(src[i]);
+        }
+    }
+    out.push_back(END);
+}
+
+struct Traffic {
+    std::vector<uint8_t> bytes;
+    size_t good = 0, crc = 0, escapes = 0;
+};
+
+static Traffic MakeTraffic(size_t target_bytes) {
+    Traffic t;
+    uint32_t seed = 1;
+    uint8_t frame[kMaxFrame];
+    for (size_t f = 0; t.bytes.size() < target_bytes; f++) {
+        seed = seed * 1664525u + 1013904223u;
+        const size_t n = 1 + (seed >> 27);
+        float values[kMaxValues];
+        for (size_t i = 0; i < n; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            values[i] = static_cast<float>(seed >> 8) * (1.f / 16777216.f);
+        }
+        size_t len = n * sizeof(float);
+        std::memcpy(frame, values, len);
+        for (size_t i = 0; i < len; i += 10) {
+            frame[i] = (i / 10) & 1 ? END : ESC;
+        }
+        const uint16_t crc = CRC16::compute(frame, len);
+        frame[len++] = static_cast<uint8_t>(crc);
+        frame[len++] = static_cast<uint8_t>(crc >> 8);
+        if (f % 97 == 96) {
+            // ESC followed by a plain byte
+            t.bytes.push_back(END);
+            t.bytes.push_back(1);
+            t.bytes.push_back(ESC);
+            t.bytes.push_back(2);
+            t.bytes.push_back(END);
+            t.escapes++;
+        }
+        if (f % 50 == 49) {
+            frame[1] ^= 0x01;
+            t.crc++;
+        } else {
+            t.good++;
+        }
+        Encode(frame, len, t.bytes);
+    }
+    return t;
+}
+
+// The pre-SLIPDecoder UARTInput loop: buffer raw bytes to END, then
+// unescape into a second buffer
+class RawThenDecode {
+public:
+    size_t frames = 0, errors = 0;
+    float sum = 0.f;
+
+    void Byte(uint8_t b) {
+        if (idx_ >= sizeof(raw_)) {
+            idx_ = 0;
+            errors++;
+        }
+        raw_[idx_++] = b;
+        if (b != END) {
+            return;
+        }
+        uint8_t out[kMaxFrame];
+        size_t n = 0;
+        bool ok = true;
+        for (size_t i = 0; i < idx_; i++) {
+            uint8_t c = raw_[i];
+            if (c == END) {
+                continue;
+            }
+            if (c == ESC) {
+                c = ++i < idx_ ? raw_[i] : 0;
+                if (c == 220) {
+                    c = END;
+                } else if (c == 221) {
+                    c = ESC;
+                } else {
+                    ok = false;
+                    break;
+                }
+            }
+            if (n < sizeof(out)) {
+                out[n++] = c;
+            }
+        }
+        idx_ = 0;
+        if (n == 0) {
+            return;
+        }
+        if (!ok || n <= 2 || CRC16::compute(out, n - 2) != (out[n - 2] | (out[n - 1] << 8))) {
+            errors++;
+            return;
+        }
+        float values[kMaxValues];
+        std::memcpy(values, out, n - 2);
+        sum += values[0];
+        frames++;
+    }
+
+private:
+    uint8_t raw_[2 * kMaxFrame + 2];
+    size_t idx_ = 0;
+};
+
+template<typename F>
+static double MBps(size_t bytes, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return static_cast<double>(bytes) / std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+int main(int argc, char **argv) {
+    const double megabytes = argc > 1 ? std::atof(argv[1]) : 32.0;
+    const Traffic t = MakeTraffic(static_cast<size_t>(megabytes * 1e6));
+    const size_t total = t.bytes.size();
+
+    RawThenDecode base;
+    const double mb_base = MBps(total, [&] {
+        for (uint8_t b : t.bytes) {
+            base.Byte(b);
+        }
+    });
+
+    float values[kMaxValues];
+    float sum = 0.f;
+    auto on_frame = [&](std::span<const uint8_t> frame) {
+        SLIPDecoder<kMaxFrame>::ParseFloats(frame, values, kMaxValues);
+        sum += values[0];
+    };
+
+    SLIPDecoder<kMaxFrame> block(true);
+    const double mb_block = MBps(total, [&] {
+        for (size_t i = 0; i < total; i += 64) {
+            const size_t n = total - i < 64 ? total - i : 64;
+            block.Feed(std::span<const uint8_t>(t.bytes.data() + i, n), on_frame);
+        }
+    });
+
+    // A DMA ring, filled 1 KB at a time and drained after each fill
+    static constexpr size_t kRing = 4096;
+    static uint8_t ring[kRing];
+    SLIPDecoder<kMaxFrame> dma(true);
+    uint32_t read_pos = 0, write_pos = 0;
+    const double mb_ring = MBps(total, [&] {
+        for (size_t i = 0; i < total; i += 1024) {
+            const size_t n = total - i < 1024 ? total - i : 1024;
+            for (size_t j = 0; j < n; j++) {
+                ring[(write_pos + j) & (kRing - 1)] = t.bytes[i + j];
+            }
+            write_pos = (write_pos + n) & (kRing - 1);
+            dma.FeedRing(ring, kRing, read_pos, write_pos, on_frame);
+        }
+    });
+
+    const auto &s = dma.GetStats();
+    std::printf("%.1f MB, %zu good frames, %zu corrupted, %zu bad escapes\n",
+                total / 1e6, t.good, t.crc, t.escapes);
+    std::printf("decoder: %u frames, %u CRC errors, %u bad escapes, %u overruns (block feed: %u frames)\n",
+                s.frames, s.crc_errors, s.bad_escapes, s.overruns, block.GetStats().frames);
+    std::printf("baseline: %zu frames, %zu errors\n\n", base.frames, base.errors);
+    std::printf("%-40s %8s %8s\n", "", "MB/s", "speedup");
+    std::printf("%-40s %8.1f %8s\n", "byte at a time, buffer then unescape", mb_base, "1.0x");
+    std::printf("%-40s %8.1f %7.1fx\n", "SLIPDecoder, 64-byte reads", mb_block, mb_block / mb_base);
+    std::printf("%-40s %8.1f %7.1fx\n", "SLIPDecoder, FeedRing from a 4 KB ring", mb_ring, mb_ring / mb_base);
+    volatile float sink = sum + base.sum;
+    (void)sink;
+    return 0;
+}
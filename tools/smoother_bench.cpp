@@ -0,0 +1,97 @@
+/*
+ * Host benchmark for ParamSmoother against OnePoleSmoother::Process.
+ *
+ *     g++ -std=c++20 -O2 -Itools/host tools/smoother_bench.cpp -o smoother_bench
+ *     ./smoother_bench [seconds]
+ *
+ * kParams parameters (as MLDrummer's neural network outputs) get new
+ * targets every 10 ms; the audio side reads every parameter every sample.
+ * Scenarios: no parameter moves, 4 move, all move. Timings are host
+ * nanoseconds per sample: useful for comparing the variants, not as
+ * absolute RP2350 figures. Accuracy is the largest difference from the
+ * per-sample one-pole, whose curve the block version follows exactly at
+ * block ends.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../synth/OnePoleSmoother.hpp"
+
+static constexpr size_t kParams = 32;
+static constexpr size_t kUpdate = 480;
+
+template<typename F>
+static double TimeNs(size_t n_samples, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(n_samples);
+}
+
+int main(int argc, char **argv) {
+    const float seconds = argc > 1 ? static_cast<float>(std::atof(argv[1])) : 10.f;
+    const size_t n = static_cast<size_t>(seconds * 48000.f);
+    volatile float sink = 0;
+
+    std::printf("%-28s %12s %12s %9s %10s\n", "", "OnePole ns", "Service ns", "speedup", "max diff");
+    for (size_t moving : {size_t(0), size_t(4), kParams}) {
+        std::vector<float> targets(kParams, 0.5f), smoothed(kParams, 0.f);
+        srand(1);
+
+        OnePoleSmoother<kParams> one_pole(150.f, 48000.f);
+        std::vector<float> ref(n);
+        const double t_one = TimeNs(n, [&] {
+            for (size_t i = 0; i < n; i++) {
+                if (i % kUpdate == 0) {
+                    for (size_t p = 0; p < moving; p++) {
+                        targets[p] = static_cast<float>(rand()) / RAND_MAX;
+                    }
+                }
+                one_pole.Process(targets.data(), smoothed.data());
+                float sum = 0.f;
+                for (size_t p = 0; p < kParams; p++) {
+                    sum += smoothed[p];
+                }
+                ref[i] = smoothed[0];
+                sink = sink + sum;
+            }
+        });
+
+        srand(1);
+        std::fill(targets.begin(), targets.end(), 0.5f);
+        ParamSmoother<kParams> service(48000.f);
+        for (size_t p = 0; p < kParams; p++) {
+            service.Register(150.f);
+        }
+        std::vector<float> out(n);
+        const double t_service = TimeNs(n, [&] {
+            for (size_t i = 0; i < n; i++) {
+                if (i % kUpdate == 0) {
+                    for (size_t p = 0; p < moving; p++) {
+                        targets[p] = static_cast<float>(rand()) / RAND_MAX;
+                    }
+                    service.SetTargets(targets.data(), kParams);
+                }
+                service.Tick();
+                float sum = 0.f;
+                for (size_t p = 0; p < kParams; p++) {
+                    sum += service.Get(p);
+                }
+                out[i] = service.Get(0);
+                sink = sink + sum;
+            }
+        });
+
+        float worst = 0.f;
+        for (size_t i = 0; i < n; i++) {
+            worst = std::max(worst, std::fabs(out[i] - ref[i]));
+        }
+        char label[32];
+        std::snprintf(label, sizeof(label), "%zu of %zu moving", moving, kParams);
+        std::printf("%-28s %12.2f %12.2f %8.1fx %10.5f\n", label, t_one, t_service, t_one / t_service, worst);
+    }
+    return 0;
+}
@@ -0,0 +1,201 @@
+/*
+ * Host test and benchmark for StateStore on SimFlashJournalBackend.
+ *
+ *     g++ -std=c++20 -O2 -Itools/host tools/state_store_bench.cpp hardware/StateStore.cpp -o state_store_bench
+ *     ./state_store_bench [minutes]
+ *
+ * Checks that a torn append (a failed write that left part of a record)
+ * is never followed by appended records Begin() would not reach, that a
+ * journal cut short by power loss reloads everything before the cut, and
+ * that a flash whose writes keep failing is retried with a doubling
+ * backoff rather than on every poll. Then compares flash wear and busy
+ * time for a knob turned continuously and for occasional changes, with
+ * the debounced Service() against a flush per change. Busy time comes
+ * from the simulator's timing model, Begin() from the host clock: useful
+ * for comparing strategies, not as absolute RP2350 figures. Exits
+ * non-zero on any failure.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "../hardware/StateStore.hpp"
+
+static int failures = 0;
+
+static void Check(bool ok, const char *what) {
+    if (!ok) {
+        std::printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+static bool Has(const StateStore &store, const char *key, uint32_t expected) {
+    uint32_t v = 0;
+    return store.GetValue(key, v) && v == expected;
+}
+
+static void TornAppend() {
+    SimFlashJournalBackend flash;
+    StateStore store(flash);
+    store.Begin();
+    store.SetValue<uint32_t>("a", 1);
+    store.SetValue<uint32_t>("b", 2);
+    Check(store.Flush(), "first flush");
+
+    // The append fails after writing 5 bytes of the record
+    flash.FailWrites(1, 5);
+    store.SetValue<uint32_t>("c", 3);
+    Check(!store.Flush(), "torn append reported");
+    store.SetValue<uint32_t>("d", 4);
+    Check(store.Flush(), "flush after a torn append");
+    Check(store.GetStats().compactions == 1, "flush after a torn append compacts");
+
+    StateStore reloaded(flash);
+    Check(reloaded.Begin(), "reload after a torn append");
+    Check(Has(reloaded, "a", 1) && Has(reloaded, "b", 2) && Has(reloaded, "c", 3) && Has(reloaded, "d", 4),
+          "all keys survive a torn append");
+    Check(reloaded.GetStats().bad_records == 0, "no bad records after recovery");
+
+    // A failed append that wrote nothing recovers the same way
+    flash.FailWrites(1, 0);
+    reloaded.SetValue<uint32_t>("e", 5);
+    Check(!reloaded.Flush() && reloaded.Flush(), "empty failed append, then flush");
+    StateStore again(flash);
+    again.Begin();
+    Check(Has(again, "e", 5) && Has(again, "d", 4), "keys after an empty failed append");
+}
+
+static void PowerLoss() {
+    SimFlashJournalBackend flash;
+    StateStore store(flash);
+    store.Begin();
+    for (uint32_t i = 0; i < 10; i++) {
+        store.SetValue<uint32_t>(("k" + std::to_string(i)).c_str(), i);
+    }
+    store.Flush();
+    store.SetValue<uint32_t>("late", 99);
+    store.Flush();
+    flash.Truncate(flash.Size() - 3);
+
+    StateStore reloaded(flash);
+    reloaded.Begin();
+    bool early = true;
+    for (uint32_t i = 0; i < 10; i++) {
+        early &= Has(reloaded, ("k" + std::to_string(i)).c_str(), i);
+    }
+    Check(early && !reloaded.Find("late"), "records before the cut reload, the cut one is dropped");
+    Check(reloaded.GetStats().bad_records == 1 && reloaded.GetStats().compactions == 1,
+          "damaged tail counted and compacted away");
+    StateStore clean(flash);
+    clean.Begin();
+    Check(clean.GetStats().bad_records == 0, "journal clean after the compaction");
+}
+
+static void Backoff() {
+    SimFlashJournalBackend flash;
+    StateStore store(flash);
+    store.Begin();
+    flash.FailWrites(1000000);
+    store.SetValue<uint32_t>("x", 1);
+    // 300 s of 10 ms polling against a flash that always fails
+    for (uint32_t t = 0; t < 300000; t += 10) {
+        store.Service(t);
+    }
+    const uint32_t attempts = store.GetStats().write_errors;
+    std::printf("failing flash, 300 s of 10 ms polls: %u write attempts\n", attempts);
+    // debounce 2 s, then waits of 2, 4, 8, 16, 32 s and 60 s from there on
+    Check(attempts == 9, "backoff doubles to 60 s");
+
+    flash.FailWrites(0);
+    for (uint32_t t = 300000; t < 310000; t += 10) {
+        store.Service(t);
+    }
+    Check(!store.IsDirty(), "pending change written once the flash recovers");
+    store.SetValue<uint32_t>("x", 2);
+    uint32_t t = 310000;
+    while (store.IsDirty() && t < 320000) {
+        store.Service(t);
+        t += 10;
+    }
+    Check(t - 10 - 310000 == 2000, "next change flushes after the normal debounce");
+}
+
+// One key changed every period_ms for `ms`, with Service() every 10 ms or
+// a Flush() after every change
+static SimFlashJournalBackend::Stats Wear(uint32_t ms, uint32_t period_ms, bool debounced) {
+    SimFlashJournalBackend flash;
+    StateStore store(flash);
+    store.Begin();
+    for (uint32_t i = 0; i < 16; i++) {
+        store.SetValue<uint32_t>(("setting" + std::to_string(i)).c_str(), i);
+    }
+    store.Flush();
+    flash.ResetStats();
+
+    uint32_t value = 0;
+    for (uint32_t t = 0; t < ms; t += 10) {
+        if (t % period_ms == 0) {
+            store.SetValue<float>("knob", static_cast<float>(value++) * 0.01f);
+            if (!debounced) {
+                store.Flush();
+            }
+        }
+        store.Service(t);
+    }
+    store.Flush();
+    return flash.GetStats();
+}
+
+int main(int argc, char **argv) {
+    const float minutes = argc > 1 ? static_cast<float>(std::atof(argv[1])) : 10.f;
+    const uint32_t ms = static_cast<uint32_t>(minutes * 60000.f);
+    TornAppend();
+    PowerLoss();
+    Backoff();
+
+    std::printf("\n%.0f min, 64 blocks of 4 KB, 16 other keys\n", minutes);
+    std::printf("%-34s %8s %8s %10s %10s %12s\n", "", "commits", "erases", "max wear", "busy ms", "days/100k");
+    struct Scenario { const char *name; uint32_t period_ms; bool debounced; };
+    const Scenario scenarios[] = {
+        { "knob every 20 ms, flush each", 20, false },
+        { "knob every 20 ms, debounced", 20, true },
+        { "change every 5 s, flush each", 5000, false },
+        { "change every 5 s, debounced", 5000, true },
+    };
+    double continuous_erases[2] = {};
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        const Scenario &s = scenarios[i];
+        const SimFlashJournalBackend::Stats r = Wear(ms, s.period_ms, s.debounced);
+        // Most worn block reaching 100k erase cycles, at this rate around the clock
+        const double per_day = r.max_block_erases * (1440.0 / minutes);
+        std::printf("%-34s %8u %8u %10u %10.0f %12.1f\n", s.name, r.commits, r.erases,
+                    r.max_block_erases, r.busy_ms, per_day > 0 ? 100000.0 / per_day : 0.0);
+        if (i < 2) {
+            continuous_erases[i] = r.erases;
+        }
+    }
+    Check(continuous_erases[1] * 100 < continuous_erases[0], "debouncing a turning knob saves over 99% of erases");
+
+    // Begin() on a journal of 200 keys plus 4x as many superseded records
+    SimFlashJournalBackend flash;
+    StateStore store(flash, { 2000, 10000, 1u << 20, 100.f });
+    store.Begin();
+    for (int pass = 0; pass < 5; pass++) {
+        for (uint32_t k = 0; k < 200; k++) {
+            store.SetValue<uint32_t>(("key" + std::to_string(k)).c_str(), k + 1000u * pass);
+        }
+        store.Flush();
+    }
+    StateStore reloaded(flash);
+    const auto start = std::chrono::steady_clock::now();
+    reloaded.Begin();
+    const auto end = std::chrono::steady_clock::now();
+    Check(reloaded.GetStats().keys == 200 && Has(reloaded, "key199", 4199), "reload of a long journal");
+    std::printf("\nBegin() over a %zu-byte journal, %zu keys: %.0f us\n", flash.Size(), reloaded.GetStats().keys,
+                std::chrono::duration<double, std::micro>(end - start).count());
+
+    std::printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * Host benchmark for ModSVF against maxiSVF with per-sample setCutoff().
+ *
+ *     g++ -std=c++20 -O2 -Itools/host tools/svf_bench.cpp synth/maximilian.cpp -o svf_bench
+ *     ./svf_bench [seconds]
+ *
+ * The cutoff is swept by a 5 Hz LFO between 100 Hz and 8 kHz, as a synth
+ * voice would modulate it. Timings are host nanoseconds per sample: useful
+ * for comparing the variants, not as absolute RP2350 figures. Accuracy is
+ * the tan table's worst relative error and the output difference from a
+ * maxiSVF fed the same per-sample cutoff.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../synth/ModSVF.hpp"
+
+static constexpr size_t kBlock = 64;
+static constexpr size_t kVoices = 8;
+
+template<typename F>
+static double TimeNs(size_t n_samples, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(n_samples);
+}
+
+int main(int argc, char **argv) {
+    const float seconds = argc > 1 ? static_cast<float>(std::atof(argv[1])) : 10.f;
+    maxiSettings::setup(48000, 1, kBlock);
+    const size_t n = static_cast<size_t>(seconds * 48000.f) / kBlock * kBlock;
+
+    std::vector<float> in(n), cutoff(n), out(n);
+    srand(1);
+    for (size_t i = 0; i < n; i++) {
+        in[i] = static_cast<float>(rand()) / RAND_MAX * 2.f - 1.f;
+        const float lfo = 0.5f + 0.5f * std::sin(2.f * static_cast<float>(M_PI) * 5.f * i / 48000.f);
+        cutoff[i] = 100.f * std::pow(80.f, lfo);
+    }
+
+    // Table accuracy
+    SVFTan::Init();
+    double worst_low = 0, worst_high = 0;
+    for (int i = 1; i < 100000; i++) {
+        const double w = SVFTan::kMaxW * i / 100000.0;
+        const double exact = std::tan(M_PI * w);
+        const double err = std::fabs(SVFTan::Lookup(static_cast<float>(w)) - exact) / exact;
+        double &worst = w < 0.25 ? worst_low : worst_high;
+        worst = std::max(worst, err);
+    }
+    std::printf("tan table: worst relative error %.4f%% below fs/4, %.4f%% up to %.2f fs\n\n",
+                100.0 * worst_low, 100.0 * worst_high, SVFTan::kMaxW);
+
+    volatile float sink = 0;
+    std::vector<float> reference(n);
+
+    maxiSVF maxi;
+    maxi.setResonance(4.f);
+    const double t_maxi = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i++) {
+            maxi.setCutoff(cutoff[i]);
+            reference[i] = maxi.play(in[i], 1.f, 0.f, 0.f, 0.f);
+        }
+    });
+
+    ModSVF per_sample;
+    per_sample.setResonance(4.f);
+    const double t_play = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = per_sample.play(in[i], cutoff[i]);
+        }
+    });
+
+    ModSVF block;
+    block.setResonance(4.f);
+    const double t_block = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i += kBlock) {
+            block.processBlock(&in[i], &out[i], kBlock, &cutoff[i]);
+        }
+    });
+    double err = 0, ref = 0;
+    for (size_t i = 0; i < n; i++) {
+        err += (out[i] - reference[i]) * (out[i] - reference[i]);
+        ref += reference[i] * reference[i];
+    }
+
+    ModSVF ramp;
+    ramp.setResonance(4.f);
+    const double t_ramp = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i += kBlock) {
+            ramp.setCutoff(cutoff[i + kBlock - 1]);
+            ramp.processBlock(&in[i], &out[i], kBlock);
+        }
+    });
+
+    ModSVF fixed;
+    fixed.setResonance(4.f);
+    fixed.setCutoff(1000.f);
+    const double t_fixed = TimeNs(n, [&] {
+        for (size_t i = 0; i < n; i += kBlock) {
+            fixed.processBlock(&in[i], &out[i], kBlock);
+        }
+    });
+
+    // kVoices voices, each with its own cutoff
+    std::vector<maxiSVF> maxis(kVoices);
+    std::vector<float> in_n(kBlock * kVoices), cut_n(kBlock * kVoices), out_n(kBlock * kVoices);
+    const double t_maxi_n = TimeNs(n * kVoices, [&] {
+        for (size_t i = 0; i < n; i++) {
+            for (size_t v = 0; v < kVoices; v++) {
+                maxis[v].setCutoff(cutoff[i] * (1.f + 0.1f * v));
+                sink = sink + maxis[v].play(in[i], 1.f, 0.f, 0.f, 0.f);
+            }
+        }
+    });
+
+    ModSVFBank<kVoices> bank;
+    const double t_bank = TimeNs(n * kVoices, [&] {
+        for (size_t i = 0; i < n; i += kBlock) {
+            for (size_t s = 0; s < kBlock; s++) {
+                for (size_t v = 0; v < kVoices; v++) {
+                    in_n[s * kVoices + v] = in[i + s];
+                    cut_n[s * kVoices + v] = cutoff[i + s] * (1.f + 0.1f * v);
+                }
+            }
+            bank.processBlock(in_n.data(), out_n.data(), kBlock, cut_n.data());
+            sink = sink + out_n[0];
+        }
+    });
+
+    std::printf("%-44s %8s %8s\n", "", "ns/smp", "speedup");
+    std::printf("%-44s %8.2f %8s\n", "maxiSVF setCutoff + play", t_maxi, "1.0x");
+    std::printf("%-44s %8.2f %7.1fx\n", "ModSVF play(x, cutoff)", t_play, t_maxi / t_play);
+    std::printf("%-44s %8.2f %7.1fx\n", "ModSVF processBlock, per-sample cutoff", t_block, t_maxi / t_block);
+    std::printf("%-44s %8.2f %7.1fx\n", "ModSVF processBlock, ramped per block", t_ramp, t_maxi / t_ramp);
+    std::printf("%-44s %8.2f %7.1fx\n", "ModSVF processBlock, fixed cutoff", t_fixed, t_maxi / t_fixed);
+    std::printf("%-44s %8.2f %8s\n", "8 x maxiSVF setCutoff + play (per voice)", t_maxi_n, "1.0x");
+    std::printf("%-44s %8.2f %7.1fx\n", "ModSVFBank<8>, per-sample cutoff (per voice)", t_bank, t_maxi_n / t_bank);
+    // With a fixed cutoff the two agree to about -100 dB; under modulation
+    // their different state variables respond slightly differently
+    std::printf("\nper-sample cutoff output vs maxiSVF: %.1f dB difference\n", 10.0 * std::log10(err / ref));
+    return 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * Long-run drift test for WindowStats, WindowPeak, WindowCount and the
+ * re-summing maxiRMS.
+ *
+ *     g++ -std=c++20 -O2 -Itools/host tools/window_stats_drift.cpp synth/maximilian.cpp -o window_stats_drift
+ *     ./window_stats_drift [hours]
+ *
+ * Runs hours of 48 kHz noise whose level moves between loud passages and
+ * near-silence (where a drifting running sum shows most). Every 10 s of
+ * audio each analyser is checked against the window recomputed from
+ * scratch in double. The float add/subtract running sum maxiRMS used to
+ * keep is run alongside for comparison. Exits non-zero on failure.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include "../synth/maximilian.h"
+
+static constexpr size_t kRate = 48000;
+static constexpr size_t kWindow = 4800;          // 100 ms
+static constexpr size_t kCheckEvery = 10 * kRate;
+
+// xorshift, so runs are repeatable and cheap
+static uint32_t rng_state = 1;
+static inline float Noise() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return static_cast<float>(rng_state) * (2.f / 4294967296.f) - 1.f;
+}
+
+static inline double RelErr(double got, double ref) {
+    return std::fabs(got - ref) / std::max(ref, 1e-6);
+}
+
+int main(int argc, char **argv) {
+    const double hours = argc > 1 ? std::atof(argv[1]) : 3.0;
+    const uint64_t n = static_cast<uint64_t>(hours * 3600.0 * kRate);
+    maxiSettings::setup(kRate, 1, 64);
+
+    WindowStats<8192> stats(kWindow);
+    WindowPeak<8192> peak(kWindow);
+    WindowCount<8192> count(kWindow);
+    maxiRMS rms;
+    rms.setup(200.f, 100.f);
+
+    // The old maxiRMS running sum, for comparison
+    std::vector<float> legacy_ring(kWindow, 0.f);
+    float legacy_sum = 0.f;
+
+    std::vector<float> history(kWindow, 0.f);
+    size_t hpos = 0;
+
+    double worst_rms = 0, worst_mean = 0, worst_var = 0, worst_maxi = 0, worst_legacy = 0;
+    size_t peak_errors = 0, count_errors = 0, checks = 0;
+    float legacy_min = 0.f;
+
+    for (uint64_t i = 0; i < n; i++) {
+        // Level alternates every 37 s between loud and about -80 dBFS
+        const bool loud = (i / (37 * kRate)) % 2 == 0;
+        const float x = (loud ? 0.9f : 1e-4f) * Noise() + (loud ? 0.05f : 0.f);
+
+        stats.Process(x);
+        peak.Process(x);
+        count.Process(x > 0.5f);
+        const float maxi = rms.play(x);
+
+        const float sq = x * x;
+        legacy_sum -= legacy_ring[hpos];
+        legacy_ring[hpos] = sq;
+        legacy_sum += sq;
+        legacy_min = std::min(legacy_min, legacy_sum);
+
+        history[hpos] = x;
+        hpos = (hpos + 1) % kWindow;
+
+        if (i % kCheckEvery == kCheckEvery - 1) {
+            double s = 0, ss = 0, mx = 0;
+            size_t c = 0;
+            for (float h : history) {
+                s += h;
+                ss += static_cast<double>(h) * h;
+                mx = std::max(mx, static_cast<double>(std::fabs(h)));
+                c += h > 0.5f;
+            }
+            const double mean = s / kWindow;
+            const double ms = ss / kWindow;
+            const double rms_ref = std::sqrt(ms);
+            worst_rms = std::max(worst_rms, RelErr(stats.RMS(), rms_ref));
+            worst_mean = std::max(worst_mean, std::fabs(stats.Mean() - mean));
+            worst_var = std::max(worst_var, RelErr(stats.Variance(), ms - mean * mean));
+            worst_maxi = std::max(worst_maxi, RelErr(maxi, rms_ref));
+            worst_legacy = std::max(worst_legacy, RelErr(std::sqrt(std::max(legacy_sum, 0.f) / kWindow), rms_ref));
+            peak_errors += peak.Peak() != static_cast<float>(mx);
+            count_errors += count.Count() != c;
+            checks++;
+        }
+    }
+
+    std::printf("%.1f hours, %zu checks\n", hours, checks);
+    std::printf("WindowStats RMS       worst relative error %.2e\n", worst_rms);
+    std::printf("WindowStats mean      worst absolute error %.2e\n", worst_mean);
+    std::printf("WindowStats variance  worst relative error %.2e\n", worst_var);
+    std::printf("WindowPeak            %zu mismatches\n", peak_errors);
+    std::printf("WindowCount           %zu mismatches\n", count_errors);
+    std::printf("maxiRMS (re-summing)  worst relative error %.2e\n", worst_maxi);
+    std::printf("old running float sum worst relative error %.2e, minimum sum %.3e\n", worst_legacy, legacy_min);
+
+    // Q23 quantisation bounds the error on the quiet passages (-80 dBFS
+    // is ~840 LSB); the float paths are limited by float precision
+    const bool ok = worst_rms < 1e-3 && worst_mean < 1e-6 && worst_var < 2e-3 &&
+                    peak_errors == 0 && count_errors == 0 && worst_maxi < 1e-2;
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,331 @@
+#ifndef MEMLLIB_UTILS_BUFFER_STORAGE_HPP
+#define MEMLLIB_UTILS_BUFFER_STORAGE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include "PSRAMArena.hpp"
+#include "../PicoDefs.hpp"
+
+#if defined(ARDUINO_ARCH_RP2040)
+#include "hardware/dma.h"
+#endif
+
+
+/**
+ * Storage policies for large power-of-2 ring buffers (delay lines, grain
+ * buffers). A policy provides Buffer<T, N> with Read(i) and Write(i, v);
+ * DSP templates take the policy as a parameter and default to SRAM:
+ *
+ *     ReverbI16<4096>                                  // SRAM, as before
+ *     ReverbI16<16384, PSRAMStorage>                   // buffers in PSRAM
+ *     GrainDelayI16<65536, 4, PSRAMHotCacheStorage<1024>>
+ *     GrainDelayI16<262144, 4, PSRAMTieredStorage<2048>>
+ *
+ * PSRAM buffers come from PSRAMArena::Default(), so construct them after
+ * the arena is usable (PSRAM is mapped by the core at boot; PSRAMManager
+ * only changes its timing).
+ */
+
+
+/**
+ * @brief Buffer held inside the object (wherever the object lives).
+ */
+struct SRAMStorage {
+    template<typename T, size_t N>
+    class Buffer {
+    public:
+        T __force_inline Read(size_t i) const { return data_[i]; }
+        void __force_inline Write(size_t i, T v) { data_[i] = v; }
+
+        /**
+         * @brief Write n consecutive samples from `start` (start + n <= N).
+         */
+        void WriteBlock(size_t start, const T *src, size_t n) {
+            std::memcpy(&data_[start], src, n * sizeof(T));
+        }
+
+    protected:
+        std::array<T, N> data_{};
+    };
+};
+
+
+/**
+ * @brief Buffer allocated from the PSRAM arena (C heap if the arena is full).
+ */
+struct PSRAMStorage {
+    template<typename T, size_t N>
+    class Buffer {
+    public:
+        Buffer() {
+            data_ = PSRAMArena::Default().AllocateArray<T>(N);
+            if (!data_) {
+                DEBUG_PRINTLN("PSRAMStorage: arena full, using heap");
+                data_ = static_cast<T *>(std::malloc(N * sizeof(T)));
+                if (!data_) {
+                    PSRAMOutOfMemory("PSRAMStorage");
+                }
+            }
+            std::memset(data_, 0, N * sizeof(T));
+        }
+
+        ~Buffer() {
+            PSRAMArena &arena = PSRAMArena::Default();
+            if (arena.Owns(data_)) {
+                arena.Free(data_, N * sizeof(T));
+            } else {
+                std::free(data_);
+            }
+        }
+
+        Buffer(const Buffer &) = delete;
+        Buffer &operator=(const Buffer &) = delete;
+
+        T __force_inline Read(size_t i) const { return data_[i]; }
+        void __force_inline Write(size_t i, T v) { data_[i] = v; }
+
+        /**
+         * @brief Write n consecutive samples from `start` (start + n <= N).
+         */
+        void WriteBlock(size_t start, const T *src, size_t n) {
+            std::memcpy(data_ + start, src, n * sizeof(T));
+        }
+
+    protected:
+        T *data_;
+    };
+};
+
+
+/**
+ * @brief PSRAM buffer with the kHot most recently written samples mirrored
+ * in SRAM. Reads within kHot of the write head (short delays, chorus,
+ * allpasses) never touch PSRAM; longer reads fall through to it.
+ *
+ * @tparam kHot Mirror size, power of 2.
+ */
+template<size_t kHot>
+struct PSRAMHotCacheStorage {
+    static_assert((kHot & (kHot - 1)) == 0, "kHot must be a power of 2");
+
+    template<typename T, size_t N>
+    class Buffer : public PSRAMStorage::Buffer<T, N> {
+        static_assert(kHot <= N, "Hot cache larger than the buffer");
+
+    public:
+        Buffer() : last_write_(N - 1), hot_{} {}
+
+        T __force_inline Read(size_t i) const {
+            if (((last_write_ - i) & (N - 1)) < kHot) {
+                return hot_[i & (kHot - 1)];
+            }
+            return this->data_[i];
+        }
+
+        void __force_inline Write(size_t i, T v) {
+            this->data_[i] = v;
+            hot_[i & (kHot - 1)] = v;
+            last_write_ = i;
+        }
+
+        /**
+         * @brief Write n consecutive samples from `start` (start + n <= N).
+         */
+        void WriteBlock(size_t start, const T *src, size_t n) {
+            if (n == 0) {
+                return;
+            }
+            std::memcpy(this->data_ + start, src, n * sizeof(T));
+            for (size_t j = n > kHot ? n - kHot : 0; j < n; j++) {
+                hot_[(start + j) & (kHot - 1)] = src[j];
+            }
+            last_write_ = start + n - 1;
+        }
+
+    protected:
+        size_t last_write_;
+        std::array<T, kHot> hot_;
+    };
+};
+
+
+// DMA channels shared by all PSRAMTieredStorage buffers
+#ifndef PSRAM_TIERED_DMA_CHANNELS
+#define PSRAM_TIERED_DMA_CHANNELS   2
+#endif
+
+
+/**
+ * @brief Small pool of DMA channels for PSRAMTieredStorage flushes.
+ *
+ * Up to PSRAM_TIERED_DMA_CHANNELS channels are claimed on the first
+ * flush (so buffers built at startup do not take channels before drivers
+ * that require one) and released with the last tiered buffer. A flush
+ * takes any idle channel; when all are busy (or none could be claimed, or
+ * on the host) the caller copies with memcpy instead. Flush from one core.
+ */
+class PSRAMTieredDMA {
+public:
+    static void Acquire() { users_++; }
+
+    static void Release() {
+        if (users_ == 0 || --users_ > 0) {
+            return;
+        }
+#if defined(ARDUINO_ARCH_RP2040)
+        WaitAll();
+        for (int i = 0; i < n_channels_; i++) {
+            dma_channel_unclaim(channels_[i]);
+        }
+#endif
+        n_channels_ = 0;
+        claimed_ = false;
+    }
+
+    /**
+     * @brief Start copying `bytes` from src to dst on an idle channel.
+     * @return false if no channel was idle; the copy has not been made.
+     */
+    static bool Copy(void *dst, const void *src, size_t bytes) {
+#if defined(ARDUINO_ARCH_RP2040)
+        if (!claimed_) {
+            claimed_ = true;
+            while (n_channels_ < PSRAM_TIERED_DMA_CHANNELS) {
+                const int ch = dma_claim_unused_channel(false);
+                if (ch < 0) {
+                    break;
+                }
+                channels_[n_channels_++] = ch;
+            }
+        }
+        for (int i = 0; i < n_channels_; i++) {
+            const int ch = channels_[i];
+            if (dma_channel_is_busy(ch)) {
+                continue;
+            }
+            dma_channel_config c = dma_channel_get_default_config(ch);
+            const bool words = bytes % 4 == 0;
+            channel_config_set_transfer_data_size(&c, words ? DMA_SIZE_32 : DMA_SIZE_8);
+            channel_config_set_read_increment(&c, true);
+            channel_config_set_write_increment(&c, true);
+            dma_channel_configure(ch, &c, dst, src, words ? bytes / 4 : bytes, true);
+            return true;
+        }
+#else
+        (void)dst;
+        (void)src;
+        (void)bytes;
+#endif
+        return false;
+    }
+
+    /**
+     * @brief Wait until every flush in flight has reached PSRAM.
+     */
+    static void WaitAll() {
+#if defined(ARDUINO_ARCH_RP2040)
+        for (int i = 0; i < n_channels_; i++) {
+            dma_channel_wait_for_finish_blocking(channels_[i]);
+        }
+#endif
+    }
+
+protected:
+    static inline int channels_[PSRAM_TIERED_DMA_CHANNELS] = {};
+    static inline int n_channels_ = 0;
+    static inline bool claimed_ = false;
+    static inline size_t users_ = 0;
+};
+
+
+/**
+ * @brief SRAM head ring in front of a PSRAM body.
+ *
+ * Writes only touch the kHead-sample SRAM ring. Each time half of the ring
+ * fills, that half is copied to the PSRAM body in one DMA transfer on a
+ * channel from the shared PSRAMTieredDMA pool (memcpy when every channel
+ * is busy, and on the host), so PSRAM sees block writes rather than one
+ * write per sample. Reads within kHead of the write head come from SRAM;
+ * older history from PSRAM. The copy of a half-block starts kHead/2
+ * samples before its data can be needed from PSRAM, which leaves far more
+ * time than the transfer takes.
+ *
+ * Meant for a few long lines (grains, loopers), not every short delay in
+ * a patch: lines written in lockstep flush on the same sample, and those
+ * beyond the pool size copy with the CPU.
+ *
+ * @tparam kHead Head size in samples, power of 2.
+ */
+template<size_t kHead>
+struct PSRAMTieredStorage {
+    static_assert((kHead & (kHead - 1)) == 0 && kHead >= 4, "kHead must be a power of 2 and at least 4");
+
+    template<typename T, size_t N>
+    class Buffer : public PSRAMStorage::Buffer<T, N> {
+        static_assert(kHead <= N, "Head larger than the buffer");
+        static constexpr size_t kHalf = kHead / 2;
+
+    public:
+        Buffer() : last_write_(N - 1), head_{} {
+            PSRAMTieredDMA::Acquire();
+        }
+
+        ~Buffer() {
+            PSRAMTieredDMA::WaitAll();
+            PSRAMTieredDMA::Release();
+        }
+
+        T __force_inline Read(size_t i) const {
+            if (((last_write_ - i) & (N - 1)) < kHead) {
+                return head_[i & (kHead - 1)];
+            }
+            return this->data_[i];
+        }
+
+        void __force_inline Write(size_t i, T v) {
+            head_[i & (kHead - 1)] = v;
+            last_write_ = i;
+            if ((i & (kHalf - 1)) == kHalf - 1) {
+                Flush_(i & ~(kHalf - 1));
+            }
+        }
+
+        /**
+         * @brief Write n consecutive samples from `start` (start + n <= N)
+         * straight to the body, keeping the newest kHead in the head.
+         */
+        void WriteBlock(size_t start, const T *src, size_t n) {
+            if (n == 0) {
+                return;
+            }
+            PSRAMTieredDMA::WaitAll();
+            // Samples before `start` in its half are only in the head so far
+            for (size_t i = start & ~(kHalf - 1); i < start; i++) {
+                this->data_[i] = head_[i & (kHead - 1)];
+            }
+            std::memcpy(this->data_ + start, src, n * sizeof(T));
+            for (size_t j = n > kHead ? n - kHead : 0; j < n; j++) {
+                head_[(start + j) & (kHead - 1)] = src[j];
+            }
+            last_write_ = start + n - 1;
+        }
+
+    protected:
+        size_t last_write_;
+        std::array<T, kHead> head_;
+
+        /**
+         * @brief Copy the half-block starting at `start` to the body.
+         */
+        void Flush_(size_t start) {
+            const T *src = &head_[start & (kHead - 1)];
+            T *dst = this->data_ + start;
+            if (!PSRAMTieredDMA::Copy(dst, src, sizeof(T) * kHalf)) {
+                std::memcpy(dst, src, sizeof(T) * kHalf);
+            }
+        }
+    };
+};
+
+#endif // MEMLLIB_UTILS_BUFFER_STORAGE_HPP
@@ -0,0 +1,51 @@
+#ifndef MEMLLIB_UTILS_CRC16_HPP
+#define MEMLLIB_UTILS_CRC16_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+namespace crc16_detail {
+
+constexpr std::array<uint16_t, 256> MakeTable() {
+    std::array<uint16_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint16_t crc = static_cast<uint16_t>(i << 8);
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                                 : static_cast<uint16_t>(crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+}  // namespace crc16_detail
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, no reflection).
+ *
+ * Table driven, one lookup per byte. Matches Python's
+ * binascii.crc_hqx(data, 0xFFFF) for host-side tools.
+ */
+class CRC16
+{
+public:
+    static constexpr uint16_t kInit = 0xFFFF;
+
+    static inline uint16_t update(uint16_t crc, const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            crc = static_cast<uint16_t>((crc << 8) ^ kTable_[((crc >> 8) ^ data[i]) & 0xFF]);
+        }
+        return crc;
+    }
+
+    static inline uint16_t compute(const uint8_t* data, size_t len) {
+        return update(kInit, data, len);
+    }
+
+private:
+    static constexpr std::array<uint16_t, 256> kTable_ = crc16_detail::MakeTable();
+};
+
+#endif // MEMLLIB_UTILS_CRC16_HPP
@@ -0,0 +1,212 @@
+#ifndef MEMLLIB_UTILS_COMPACT_PACKET_HPP
+#define MEMLLIB_UTILS_COMPACT_PACKET_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+
+/**
+ * @brief IEEE 754 binary32 -> binary16, round to nearest even.
+ * Overflow saturates to infinity, NaN stays NaN.
+ */
+inline uint16_t float_to_half(float f)
+{
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+
+    const uint32_t sign = (x >> 16) & 0x8000;
+    const uint32_t abs_x = x & 0x7FFFFFFF;
+
+    if (abs_x >= 0x7F800000) {
+        // Inf or NaN
+        return static_cast<uint16_t>(sign | 0x7C00 | (abs_x > 0x7F800000 ? 0x200 : 0));
+    }
+    if (abs_x >= 0x477FF000) {
+        // Rounds above 65504
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+    if (abs_x < 0x38800000) {
+        // Subnormal half (or zero)
+        if (abs_x < 0x33000000) {
+            return static_cast<uint16_t>(sign);
+        }
+        const uint32_t exp = abs_x >> 23;
+        const uint32_t mant = (abs_x & 0x7FFFFF) | 0x800000;
+        const uint32_t shift = 126 - exp;
+        uint32_t half = mant >> shift;
+        const uint32_t rem = mant & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (rem > halfway || (rem == halfway && (half & 1))) {
+            half++;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = ((abs_x >> 13) - (112 << 10));
+    const uint32_t rem = abs_x & 0x1FFF;
+    if (rem > 0x1000 || (rem == 0x1000 && (half & 1))) {
+        half++;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+/**
+ * @brief IEEE 754 binary16 -> binary32 (exact).
+ */
+inline float half_to_float(uint16_t h)
+{
+    const uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1F;
+    uint32_t mant = h & 0x3FF;
+    uint32_t x;
+
+    if (exp == 0x1F) {
+        x = sign | 0x7F800000 | (mant << 13);
+    } else if (exp != 0) {
+        x = sign | ((exp + 112) << 23) | (mant << 13);
+    } else if (mant == 0) {
+        x = sign;
+    } else {
+        // Normalise subnormal
+        exp = 113;
+        while (!(mant & 0x400)) {
+            mant <<= 1;
+            exp--;
+        }
+        x = sign | (exp << 23) | ((mant & 0x3FF) << 13);
+    }
+
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+
+/**
+ * @brief Delta-coded parameter packet for host visualisers.
+ *
+ * Layout (before SLIP framing), all multi-byte fields little endian:
+ *
+ *     [0]      kMagic | encoding   (encoding: 1 = half float, 2 = int16)
+ *     [1]      sequence number, wraps at 256
+ *     [2]      total parameter count N
+ *     [3..]    changed-parameter bitmask, ceil(N/8) bytes, bit i%8 of byte i/8
+ *     [..]     one 16-bit value per set bit, in index order
+ *
+ * int16 values carry [-1, 1] scaled by 32767. Only parameters whose 16-bit
+ * code differs from the last packet are sent; every keyframe_interval
+ * packets all bits are set so a receiver can (re)synchronise. Compared with
+ * 4 bytes per float every update this is 2x smaller for a full frame and
+ * usually much smaller when few parameters move.
+ *
+ * @tparam kMaxParams Largest parameter count that will be encoded.
+ */
+template<size_t kMaxParams>
+class CompactPacketEncoder
+{
+public:
+    enum Encoding : uint8_t {
+        kHalf = 1,
+        kInt16 = 2
+    };
+
+    static constexpr uint8_t kMagic = 0xA0;
+    static constexpr size_t kHeaderBytes = 3;
+    static constexpr size_t kMaskBytes = (kMaxParams + 7) / 8;
+    static constexpr size_t kMaxPacketBytes = kHeaderBytes + kMaskBytes + 2 * kMaxParams;
+
+    static_assert(kMaxParams <= 255, "Parameter count must fit in one byte");
+
+    CompactPacketEncoder(Encoding encoding = kHalf, uint8_t keyframe_interval = 32) :
+        encoding_(encoding),
+        keyframe_interval_(keyframe_interval),
+        seq_(0),
+        since_keyframe_(0),
+        n_last_(0)
+    {
+        std::memset(last_codes_, 0, sizeof(last_codes_));
+    }
+
+    void SetEncoding(Encoding encoding) {
+        encoding_ = encoding;
+        ForceKeyframe();
+    }
+
+    /**
+     * @param interval Packets between full frames (0 = only the first).
+     */
+    void SetKeyframeInterval(uint8_t interval) { keyframe_interval_ = interval; }
+
+    /**
+     * @brief Make the next packet carry every parameter.
+     */
+    void ForceKeyframe() { n_last_ = 0; }
+
+    /**
+     * @brief Build a packet from the current parameter values.
+     *
+     * @param values Parameter values (values beyond kMaxParams are ignored).
+     * @param out Destination, at least kMaxPacketBytes long.
+     * @return Packet length in bytes, or 0 if nothing changed.
+     */
+    size_t Encode(std::span<const float> values, uint8_t *out) {
+        const size_t n = values.size() < kMaxParams ? values.size() : kMaxParams;
+        const size_t mask_bytes = (n + 7) / 8;
+
+        bool keyframe = (n != n_last_);
+        if (keyframe_interval_ > 0 && since_keyframe_ >= keyframe_interval_) {
+            keyframe = true;
+        }
+
+        uint8_t *mask = out + kHeaderBytes;
+        uint8_t *payload = mask + mask_bytes;
+        std::memset(mask, 0, mask_bytes);
+
+        size_t n_changed = 0;
+        for (size_t i = 0; i < n; i++) {
+            const uint16_t code = Quantise_(values[i]);
+            if (keyframe || code != last_codes_[i]) {
+                last_codes_[i] = code;
+                mask[i >> 3] |= static_cast<uint8_t>(1u << (i & 7));
+                payload[2 * n_changed] = static_cast<uint8_t>(code & 0xFF);
+                payload[2 * n_changed + 1] = static_cast<uint8_t>(code >> 8);
+                n_changed++;
+            }
+        }
+
+        if (n_changed == 0 && n > 0) {
+            since_keyframe_++;
+            return 0;
+        }
+
+        out[0] = kMagic | encoding_;
+        out[1] = seq_++;
+        out[2] = static_cast<uint8_t>(n);
+
+        n_last_ = n;
+        since_keyframe_ = keyframe ? 0 : since_keyframe_ + 1;
+
+        return kHeaderBytes + mask_bytes + 2 * n_changed;
+    }
+
+protected:
+    inline uint16_t Quantise_(float v) const {
+        if (encoding_ == kInt16) {
+            v = v > 1.f ? 1.f : (v < -1.f ? -1.f : v);
+            int32_t q = static_cast<int32_t>(v * 32767.f + (v >= 0.f ? 0.5f : -0.5f));
+            return static_cast<uint16_t>(static_cast<int16_t>(q));
+        }
+        return float_to_half(v);
+    }
+
+    Encoding encoding_;
+    uint8_t keyframe_interval_;
+    uint8_t seq_;
+    uint8_t since_keyframe_;
+    size_t n_last_;
+    uint16_t last_codes_[kMaxParams];
+};
+
+#endif // MEMLLIB_UTILS_COMPACT_PACKET_HPP
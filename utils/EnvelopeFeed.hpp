@@ -0,0 +1,101 @@
+#ifndef MEMLLIB_UTILS_ENVELOPE_FEED_HPP
+#define MEMLLIB_UTILS_ENVELOPE_FEED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "SPSCRing.hpp"
+
+
+/**
+ * @brief Decimated min/max envelope of a signal, handed from the audio
+ * core to a display.
+ *
+ * The producer calls Process() per sample (or per control value); every
+ * `decimation` inputs become one Column holding their minimum and maximum,
+ * pushed into a lock-free ring. The consumer pops columns at its own
+ * frame rate, so a scope costs the audio core a compare per sample and
+ * the display one plot column per `decimation` samples. Columns that
+ * don't fit (display not keeping up) are dropped and counted.
+ *
+ * @tparam N Ring capacity in columns, power of 2.
+ */
+template<size_t N = 256>
+class EnvelopeFeed
+{
+public:
+    struct Column {
+        float lo;
+        float hi;
+    };
+
+    explicit EnvelopeFeed(size_t decimation = 1) :
+        decimation_(decimation ? decimation : 1),
+        active_(true),
+        count_(0),
+        lo_(0),
+        hi_(0),
+        dropped_(0) {}
+
+    /**
+     * @brief Inputs per column. Takes effect at the next column.
+     */
+    inline void SetDecimation(size_t decimation) { decimation_ = decimation ? decimation : 1; }
+    inline size_t GetDecimation() const { return decimation_; }
+
+    /**
+     * @brief While inactive (e.g. the view is off screen) Process() returns
+     * straight away.
+     */
+    inline void SetActive(bool active) { active_ = active; }
+    inline bool IsActive() const { return active_; }
+
+    /* Producer side */
+
+    inline void Process(float x) {
+        if (!active_) {
+            return;
+        }
+        if (count_ == 0) {
+            lo_ = hi_ = x;
+        } else if (x < lo_) {
+            lo_ = x;
+        } else if (x > hi_) {
+            hi_ = x;
+        }
+        if (++count_ >= decimation_) {
+            count_ = 0;
+            if (!ring_.Push(Column{lo_, hi_})) {
+                dropped_ = dropped_ + 1;
+            }
+        }
+    }
+
+    void Process(const float *x, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            Process(x[i]);
+        }
+    }
+
+    /* Consumer side */
+
+    inline size_t Available() const { return ring_.Available(); }
+
+    inline bool Pop(Column &column) { return ring_.Pop(&column, 1) == 1; }
+
+    inline size_t Pop(Column *out, size_t n) { return ring_.Pop(out, n); }
+
+    inline void Clear() { ring_.Clear(); }
+
+    inline uint32_t GetDropped() const { return dropped_; }
+
+protected:
+    SPSCRing<Column, N> ring_;
+    volatile size_t decimation_;
+    volatile bool active_;
+    size_t count_;
+    float lo_;
+    float hi_;
+    volatile uint32_t dropped_;
+};
+
+#endif // MEMLLIB_UTILS_ENVELOPE_FEED_HPP
@@ -0,0 +1,390 @@
+#ifndef MEMLLIB_UTILS_PSRAM_ARENA_HPP
+#define MEMLLIB_UTILS_PSRAM_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(ARDUINO_ARCH_RP2040)
+#include <Arduino.h>
+#endif
+
+// Size of the default arena, taken from the PSRAM heap on RP2350 (pmalloc)
+// and from the C heap on the host.
+#ifndef PSRAM_ARENA_BYTES
+#define PSRAM_ARENA_BYTES   (2u * 1024u * 1024u)
+#endif
+
+
+/**
+ * @brief Stop on an allocation that has no fallback left (panic on the
+ * Pico, abort on the host).
+ */
+[[noreturn]] inline void PSRAMOutOfMemory(const char *what) {
+#if defined(ARDUINO_ARCH_RP2040)
+    panic("%s: out of memory", what);
+#else
+    std::fprintf(stderr, "%s: out of memory\n", what);
+    std::abort();
+#endif
+}
+
+
+/**
+ * @brief Bump allocator over one block of PSRAM.
+ *
+ * Allocation moves a pointer up; Free() only reclaims the most recent
+ * allocation, anything else stays "stranded" until a Reset() below it.
+ * Mark()/Reset() (or a Scope) release everything allocated since the mark
+ * in one go, e.g. all buffers of an audio app when switching modes.
+ *
+ * Not thread safe and not for the audio callback: allocate at setup time.
+ * On the host the block comes from malloc, so DSP code can be tested
+ * against the same allocator.
+ */
+class PSRAMArena
+{
+public:
+
+    struct Stats {
+        size_t capacity;        ///< Bytes in the arena
+        size_t used;            ///< Bytes below the top pointer
+        size_t high_water;      ///< Largest `used` seen
+        size_t requested;       ///< Bytes asked for by live allocations
+        size_t padding;         ///< Bytes lost to alignment
+        size_t stranded;        ///< Freed bytes not yet reclaimable (upper bound)
+        size_t n_allocations;
+        size_t n_failed;
+
+        /**
+         * @brief Share of used bytes not serving a live allocation (0..1).
+         */
+        float Fragmentation() const {
+            return used ? static_cast<float>(padding + stranded) / static_cast<float>(used) : 0.f;
+        }
+    };
+
+    PSRAMArena() :
+        base_(nullptr),
+        capacity_(0),
+        top_(0),
+        owned_(false),
+        stats_{} {}
+
+    ~PSRAMArena() { Release_(); }
+
+    PSRAMArena(const PSRAMArena &) = delete;
+    PSRAMArena &operator=(const PSRAMArena &) = delete;
+
+    /**
+     * @brief The shared arena used by PSRAMAllocator and PSRAMStorage.
+     * Initialised with PSRAM_ARENA_BYTES on first use.
+     */
+    static PSRAMArena &Default() {
+        static PSRAMArena arena;
+        if (!arena.IsReady()) {
+            arena.Init(PSRAM_ARENA_BYTES);
+        }
+        return arena;
+    }
+
+    /**
+     * @brief Allocate the backing block (PSRAM heap on RP2350, malloc elsewhere).
+     */
+    bool Init(size_t bytes) {
+        Release_();
+#if defined(ARDUINO_ARCH_RP2040) && defined(PICO_RP2350)
+        void *block = pmalloc(bytes);
+#else
+        void *block = std::malloc(bytes);
+#endif
+        if (!block) {
+            return false;
+        }
+        Attach_(static_cast<uint8_t *>(block), bytes, true);
+        return true;
+    }
+
+    /**
+     * @brief Use a caller-provided block, e.g. a PSRAM_ATTR array.
+     */
+    bool Init(void *base, size_t bytes) {
+        Release_();
+        if (!base || bytes == 0) {
+            return false;
+        }
+        Attach_(static_cast<uint8_t *>(base), bytes, false);
+        return true;
+    }
+
+    inline bool IsReady() const { return base_ != nullptr; }
+
+    inline bool Owns(const void *p) const {
+        const uint8_t *b = static_cast<const uint8_t *>(p);
+        return base_ && b >= base_ && b < base_ + capacity_;
+    }
+
+    /**
+     * @return Aligned memory, or nullptr if the arena is full.
+     */
+    void *Allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        const uintptr_t start = reinterpret_cast<uintptr_t>(base_) + top_;
+        const uintptr_t aligned = (start + align - 1) & ~static_cast<uintptr_t>(align - 1);
+        const size_t pad = static_cast<size_t>(aligned - start);
+        if (!base_ || bytes == 0 || top_ + pad + bytes > capacity_) {
+            stats_.n_failed++;
+            return nullptr;
+        }
+        top_ += pad + bytes;
+        stats_.padding += pad;
+        stats_.requested += bytes;
+        stats_.n_allocations++;
+        if (top_ > stats_.high_water) {
+            stats_.high_water = top_;
+        }
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    template<typename T>
+    T *AllocateArray(size_t n) {
+        return static_cast<T *>(Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * @brief Give back an allocation. Only the most recent one is
+     * reclaimed immediately.
+     */
+    void Free(void *p, size_t bytes) {
+        if (!Owns(p)) {
+            return;
+        }
+        const size_t offset = static_cast<size_t>(static_cast<uint8_t *>(p) - base_);
+        stats_.requested -= bytes < stats_.requested ? bytes : stats_.requested;
+        if (offset + bytes == top_) {
+            top_ = offset;
+        } else {
+            stats_.stranded += bytes;
+        }
+    }
+
+    /**
+     * @brief Top pointer and stats at the time of Mark().
+     */
+    struct Marker {
+        size_t top;
+        size_t requested;
+        size_t padding;
+        size_t stranded;
+    };
+
+    inline Marker Mark() const { return { top_, stats_.requested, stats_.padding, stats_.stranded }; }
+
+    /**
+     * @brief Release everything allocated since `mark` and put the stats
+     * back to their values at the mark. An allocation older than the mark
+     * that was freed since is counted as live again (the arena keeps no
+     * per-allocation record); free older allocations outside the scope.
+     */
+    void Reset(const Marker &mark) {
+        if (mark.top >= top_) {
+            return;
+        }
+        top_ = mark.top;
+        stats_.requested = mark.requested;
+        stats_.padding = mark.padding;
+        stats_.stranded = mark.stranded;
+    }
+
+    void Reset() {
+        top_ = 0;
+        stats_.requested = 0;
+        stats_.padding = 0;
+        stats_.stranded = 0;
+    }
+
+    inline size_t Available() const { return capacity_ - top_; }
+
+    Stats GetStats() const {
+        Stats s = stats_;
+        s.capacity = capacity_;
+        s.used = top_;
+        return s;
+    }
+
+    /**
+     * @brief Releases everything allocated during its lifetime.
+     */
+    class Scope {
+    public:
+        explicit Scope(PSRAMArena &arena) : arena_(arena), mark_(arena.Mark()) {}
+        ~Scope() { arena_.Reset(mark_); }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    protected:
+        PSRAMArena &arena_;
+        Marker mark_;
+    };
+
+protected:
+    uint8_t *base_;
+    size_t capacity_;
+    size_t top_;
+    bool owned_;
+    Stats stats_;
+
+    void Attach_(uint8_t *base, size_t bytes, bool owned) {
+        base_ = base;
+        capacity_ = bytes;
+        top_ = 0;
+        owned_ = owned;
+        stats_ = {};
+    }
+
+    void Release_() {
+        if (owned_ && base_) {
+#if !(defined(ARDUINO_ARCH_RP2040) && defined(PICO_RP2350))
+            std::free(base_);
+#endif
+        }
+        base_ = nullptr;
+        capacity_ = 0;
+        top_ = 0;
+        owned_ = false;
+    }
+};
+
+
+/**
+ * @brief Fixed-size block pool carved out of an arena.
+ *
+ * O(1) allocate and free with no fragmentation between blocks; the only
+ * waste is the unused tail of each block (reported as internal
+ * fragmentation).
+ *
+ * @tparam kBlockBytes Block size (rounded up to pointer alignment).
+ * @tparam kBlocks Number of blocks.
+ */
+template<size_t kBlockBytes, size_t kBlocks>
+class PSRAMPool
+{
+public:
+    static constexpr size_t kStride = (kBlockBytes + alignof(void *) - 1) & ~(alignof(void *) - 1);
+
+    struct Stats {
+        size_t in_use;
+        size_t peak;
+        size_t requested;       ///< Bytes asked for by live blocks
+        size_t n_failed;
+
+        /**
+         * @brief Share of live block bytes not asked for (0..1).
+         */
+        float Fragmentation() const {
+            const size_t held = in_use * kStride;
+            return held ? 1.f - static_cast<float>(requested) / static_cast<float>(held) : 0.f;
+        }
+    };
+
+    PSRAMPool() : blocks_(nullptr), free_(nullptr), stats_{} {}
+
+    /**
+     * @brief Take the pool's memory from an arena.
+     */
+    bool Init(PSRAMArena &arena = PSRAMArena::Default()) {
+        blocks_ = static_cast<uint8_t *>(arena.Allocate(kStride * kBlocks, alignof(void *)));
+        if (!blocks_) {
+            return false;
+        }
+        free_ = nullptr;
+        for (size_t i = kBlocks; i-- > 0;) {
+            void **block = reinterpret_cast<void **>(blocks_ + i * kStride);
+            *block = free_;
+            free_ = block;
+        }
+        stats_ = {};
+        return true;
+    }
+
+    void *Allocate(size_t bytes = kBlockBytes) {
+        if (!free_ || bytes > kBlockBytes) {
+            stats_.n_failed++;
+            return nullptr;
+        }
+        void **block = static_cast<void **>(free_);
+        free_ = *block;
+        stats_.in_use++;
+        stats_.requested += bytes;
+        if (stats_.in_use > stats_.peak) {
+            stats_.peak = stats_.in_use;
+        }
+        return block;
+    }
+
+    void Free(void *p, size_t bytes = kBlockBytes) {
+        if (!p) {
+            return;
+        }
+        *static_cast<void **>(p) = free_;
+        free_ = p;
+        stats_.in_use--;
+        stats_.requested -= bytes < stats_.requested ? bytes : stats_.requested;
+    }
+
+    Stats GetStats() const { return stats_; }
+
+protected:
+    uint8_t *blocks_;
+    void *free_;
+    Stats stats_;
+};
+
+
+/**
+ * @brief STL allocator on a PSRAMArena, e.g.
+ * std::vector<float, PSRAMAllocator<float>>.
+ *
+ * Falls back to the C heap if the arena is full (counted in n_failed), so
+ * containers keep working. Best suited to containers that are sized once.
+ */
+template<typename T>
+class PSRAMAllocator
+{
+public:
+    using value_type = T;
+
+    PSRAMAllocator() : arena_(&PSRAMArena::Default()) {}
+    explicit PSRAMAllocator(PSRAMArena &arena) : arena_(&arena) {}
+    template<typename U>
+    PSRAMAllocator(const PSRAMAllocator<U> &other) : arena_(other.arena_) {}
+
+    T *allocate(size_t n) {
+        void *p = arena_->Allocate(n * sizeof(T), alignof(T));
+        if (!p) {
+            p = std::malloc(n * sizeof(T));
+            if (!p) {
+                PSRAMOutOfMemory("PSRAMAllocator");
+            }
+        }
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, size_t n) {
+        if (arena_->Owns(p)) {
+            arena_->Free(p, n * sizeof(T));
+        } else {
+            std::free(p);
+        }
+    }
+
+    template<typename U>
+    bool operator==(const PSRAMAllocator<U> &other) const { return arena_ == other.arena_; }
+    template<typename U>
+    bool operator!=(const PSRAMAllocator<U> &other) const { return arena_ != other.arena_; }
+
+    PSRAMArena *arena_;
+};
+
+#endif // MEMLLIB_UTILS_PSRAM_ARENA_HPP
@@ -0,0 +1,244 @@
+#ifndef MEMLLIB_UTILS_SLIP_DECODER_HPP
+#define MEMLLIB_UTILS_SLIP_DECODER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include "CRC16.hpp"
+
+
+/**
+ * @brief Streaming SLIP frame decoder.
+ *
+ * Bytes are unescaped once, straight from the input (a DMA ring or a block
+ * read) into an internal frame buffer, and each complete frame is handed to
+ * the caller as a span into that buffer - no further copies. The span is
+ * only valid for the duration of the callback.
+ *
+ * Frames may optionally end with a CRC-16/CCITT-FALSE trailer (little
+ * endian) over the payload; it is checked and stripped before the callback.
+ * Malformed frames are dropped and counted.
+ *
+ * @tparam kMaxFrameBytes Largest decoded frame, including any CRC trailer.
+ */
+template<size_t kMaxFrameBytes>
+class SLIPDecoder
+{
+public:
+    static constexpr uint8_t END = 192;
+    static constexpr uint8_t ESC = 219;
+    static constexpr uint8_t ESC_END = 220;
+    static constexpr uint8_t ESC_ESC = 221;
+
+    static constexpr size_t kCRCBytes = 2;
+
+    struct Stats {
+        uint32_t frames;         ///< Frames delivered
+        uint32_t overruns;       ///< Frames longer than kMaxFrameBytes
+        uint32_t bad_escapes;    ///< ESC followed by anything but ESC_END/ESC_ESC
+        uint32_t crc_errors;     ///< CRC mismatch or frame too short for a trailer
+    };
+
+    SLIPDecoder(bool use_crc = false) : use_crc_(use_crc) {
+        Reset();
+    }
+
+    /**
+     * @brief Drop any partial frame, resynchronise on the next END
+     * and clear the statistics.
+     */
+    void Reset() {
+        len_ = 0;
+        escaped_ = false;
+        synced_ = false;
+        discard_ = false;
+        stats_ = {};
+    }
+
+    /**
+     * @brief Expect (and strip) a CRC-16 trailer on every frame.
+     */
+    void SetCRC(bool use_crc) { use_crc_ = use_crc; }
+
+    const Stats& GetStats() const { return stats_; }
+    uint32_t GetErrorCount() const {
+        return stats_.overruns + stats_.bad_escapes + stats_.crc_errors;
+    }
+
+    /**
+     * @brief Decode a block of raw bytes.
+     *
+     * @param bytes Encoded input.
+     * @param on_frame Called as on_frame(std::span<const uint8_t>) for each
+     * valid frame payload.
+     * @return Number of frames delivered.
+     */
+    template<typename F>
+    size_t Feed(std::span<const uint8_t> bytes, F&& on_frame) {
+        size_t n_frames = 0;
+        const uint8_t *p = bytes.data();
+        const uint8_t *end = p + bytes.size();
+
+        // Bytes before the first END belong to a frame we joined half way
+        while (!synced_ && p < end) {
+            if (*p++ == END) {
+                synced_ = true;
+            }
+        }
+
+        while (p < end) {
+            const uint8_t byte = *p++;
+
+            if (byte == END) {
+                if (EndFrame_(on_frame)) {
+                    n_frames++;
+                }
+                continue;
+            }
+            if (discard_) {
+                continue;
+            }
+
+            uint8_t out = byte;
+            if (escaped_) {
+                escaped_ = false;
+                if (byte == ESC_END) {
+                    out = END;
+                } else if (byte == ESC_ESC) {
+                    out = ESC;
+                } else {
+                    stats_.bad_escapes++;
+                    discard_ = true;
+                    continue;
+                }
+            } else if (byte == ESC) {
+                escaped_ = true;
+                continue;
+            }
+
+            if (len_ >= kMaxFrameBytes) {
+                stats_.overruns++;
+                discard_ = true;
+                continue;
+            }
+            frame_[len_++] = out;
+        }
+
+        return n_frames;
+    }
+
+    /**
+     * @brief Decode everything between read_pos and write_pos of a byte
+     * ring written by a DMA channel, in at most two contiguous blocks.
+     *
+     * @param ring Ring base address.
+     * @param ring_size Ring size in bytes (power of 2).
+     * @param read_pos Consumer position, advanced to write_pos.
+     * @param write_pos Producer position reported by the DMA channel.
+     * @param on_frame As for Feed().
+     * @return Number of frames delivered.
+     */
+    template<typename F>
+    size_t FeedRing(const volatile uint8_t *ring, size_t ring_size,
+                    uint32_t &read_pos, uint32_t write_pos, F&& on_frame) {
+        const uint8_t *base = const_cast<const uint8_t*>(ring);
+        size_t n_frames = 0;
+
+        if (write_pos < read_pos) {
+            n_frames += Feed(std::span<const uint8_t>(base + read_pos, ring_size - read_pos), on_frame);
+            read_pos = 0;
+        }
+        if (write_pos > read_pos) {
+            n_frames += Feed(std::span<const uint8_t>(base + read_pos, write_pos - read_pos), on_frame);
+        }
+        read_pos = write_pos;
+
+        return n_frames;
+    }
+
+    /**
+     * @brief Copy a frame of little-endian floats into the caller's array.
+     * @return Number of values written (at most max_values).
+     */
+    static size_t ParseFloats(std::span<const uint8_t> frame, float *dst, size_t max_values) {
+        size_t n = frame.size() / sizeof(float);
+        if (n > max_values) n = max_values;
+        std::memcpy(dst, frame.data(), n * sizeof(float));
+        return n;
+    }
+
+    /**
+     * @brief Copy a frame of little-endian int16 values into the caller's array.
+     * @return Number of values written (at most max_values).
+     */
+    static size_t ParseInt16(std::span<const uint8_t> frame, int16_t *dst, size_t max_values) {
+        size_t n = frame.size() / sizeof(int16_t);
+        if (n > max_values) n = max_values;
+        std::memcpy(dst, frame.data(), n * sizeof(int16_t));
+        return n;
+    }
+
+    /**
+     * @brief Convert a frame of little-endian int16 values to float,
+     * multiplying by scale (e.g. 1/32768 for normalised sensor data).
+     * @return Number of values written (at most max_values).
+     */
+    static size_t ParseInt16(std::span<const uint8_t> frame, float *dst, size_t max_values,
+                             float scale) {
+        size_t n = frame.size() / sizeof(int16_t);
+        if (n > max_values) n = max_values;
+        const uint8_t *src = frame.data();
+        for (size_t i = 0; i < n; i++) {
+            int16_t v = static_cast<int16_t>(src[2 * i] | (src[2 * i + 1] << 8));
+            dst[i] = static_cast<float>(v) * scale;
+        }
+        return n;
+    }
+
+protected:
+    template<typename F>
+    bool EndFrame_(F& on_frame) {
+        const bool drop = discard_ || escaped_;
+        size_t len = len_;
+
+        len_ = 0;
+        discard_ = false;
+        if (escaped_) {
+            stats_.bad_escapes++;
+            escaped_ = false;
+        }
+
+        // Back-to-back ENDs are flush markers, not empty frames
+        if (drop || len == 0) {
+            return false;
+        }
+
+        if (use_crc_) {
+            if (len <= kCRCBytes) {
+                stats_.crc_errors++;
+                return false;
+            }
+            len -= kCRCBytes;
+            const uint16_t rx_crc = static_cast<uint16_t>(frame_[len] | (frame_[len + 1] << 8));
+            if (CRC16::compute(frame_, len) != rx_crc) {
+                stats_.crc_errors++;
+                return false;
+            }
+        }
+
+        stats_.frames++;
+        on_frame(std::span<const uint8_t>(frame_, len));
+        return true;
+    }
+
+    uint8_t frame_[kMaxFrameBytes];
+    size_t len_;
+    bool escaped_;
+    bool synced_;
+    bool discard_;
+    bool use_crc_;
+    Stats stats_;
+};
+
+#endif // MEMLLIB_UTILS_SLIP_DECODER_HPP
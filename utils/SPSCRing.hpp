@@ -0,0 +1,103 @@
+#ifndef MEMLLIB_UTILS_SPSC_RING_HPP
+#define MEMLLIB_UTILS_SPSC_RING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "hardware/sync.h"
+
+
+/**
+ * @brief Lock-free single-producer / single-consumer ring.
+ *
+ * One side (typically the audio callback) only calls Push(), the other
+ * (a main loop, possibly on the other core) only calls Pop()/Peek(). Each
+ * index is written by one side only; __dmb() orders the data against the
+ * index update so the ring is safe across the two cores.
+ *
+ * @tparam T Element type (trivially copyable).
+ * @tparam N Capacity, power of 2.
+ */
+template<typename T, size_t N>
+class SPSCRing
+{
+public:
+    static_assert((N & (N - 1)) == 0, "Ring size must be a power of 2");
+
+    SPSCRing() : head_(0), tail_(0) {}
+
+    inline size_t Capacity() const { return N; }
+
+    /**
+     * @brief Elements available to the consumer.
+     */
+    inline size_t Available() const { return head_ - tail_; }
+
+    /**
+     * @brief Space available to the producer.
+     */
+    inline size_t Space() const { return N - (head_ - tail_); }
+
+    /**
+     * @brief Push all n elements, or none if they don't fit.
+     * @return true if pushed.
+     */
+    bool Push(const T *data, size_t n) {
+        const size_t head = head_;
+        if (N - (head - tail_) < n) {
+            return false;
+        }
+        for (size_t i = 0; i < n; i++) {
+            buffer_[(head + i) & (N - 1)] = data[i];
+        }
+        __dmb();
+        head_ = head + n;
+        return true;
+    }
+
+    inline bool Push(const T &value) { return Push(&value, 1); }
+
+    /**
+     * @brief Pop up to n elements.
+     * @return Number of elements popped.
+     */
+    size_t Pop(T *out, size_t n) {
+        const size_t tail = tail_;
+        const size_t available = head_ - tail;
+        if (n > available) {
+            n = available;
+        }
+        __dmb();
+        for (size_t i = 0; i < n; i++) {
+            out[i] = buffer_[(tail + i) & (N - 1)];
+        }
+        __dmb();
+        tail_ = tail + n;
+        return n;
+    }
+
+    /**
+     * @brief Copy the oldest element without popping it.
+     * @return false if the ring is empty.
+     */
+    bool Peek(T &out) const {
+        const size_t tail = tail_;
+        if (head_ == tail) {
+            return false;
+        }
+        __dmb();
+        out = buffer_[tail & (N - 1)];
+        return true;
+    }
+
+    /**
+     * @brief Drop everything currently queued (consumer side).
+     */
+    void Clear() { tail_ = head_; }
+
+protected:
+    T buffer_[N];
+    volatile size_t head_;      ///< Written by the producer only
+    volatile size_t tail_;      ///< Written by the consumer only
+};
+
+#endif // MEMLLIB_UTILS_SPSC_RING_HPP
@@ -0,0 +1,73 @@
+#ifndef MEMLLIB_UTILS_TRIPLE_BUFFER_HPP
+#define MEMLLIB_UTILS_TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+
+/**
+ * @brief Lock-free triple buffer for handing a whole table from one side
+ * to the other (e.g. slice tables from the main loop to the audio
+ * callback).
+ *
+ * The writer fills Back() and calls Publish(); the reader calls Update()
+ * (typically once per block) and reads Front(). Each side owns one of the
+ * three buffers, and the third is swapped through a single atomic, so
+ * neither side ever waits or sees a half-written table. If the writer
+ * publishes twice before the reader updates, the reader gets the newer
+ * one.
+ *
+ * @tparam T Buffer type.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : shared_(1), back_(0), front_(2) {}
+
+    /**
+     * @brief Writer: the buffer to fill. Its contents are whatever was
+     * there last, not necessarily the last published table.
+     */
+    inline T &Back() { return buffers_[back_]; }
+
+    /**
+     * @brief Writer: hand Back() over to the reader.
+     */
+    inline void Publish() {
+        back_ = shared_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndex;
+    }
+
+    /**
+     * @brief Reader: take the latest published buffer, if there is one.
+     * @return true if Front() changed.
+     */
+    inline bool Update() {
+        if (!(shared_.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        front_ = shared_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+
+    /**
+     * @brief Reader: the current buffer.
+     */
+    inline const T &Front() const { return buffers_[front_]; }
+
+    /**
+     * @brief All three buffers, for initialisation before either side runs.
+     */
+    inline T &Raw(size_t i) { return buffers_[i]; }
+
+private:
+    static constexpr uint8_t kIndex = 3;
+    static constexpr uint8_t kFresh = 4;
+
+    T buffers_[3];
+    std::atomic<uint8_t> shared_;
+    uint8_t back_;
+    uint8_t front_;
+};
+
+#endif // MEMLLIB_UTILS_TRIPLE_BUFFER_HPP
@@ -0,0 +1,254 @@
+#ifndef MEMLLIB_UTILS_WINDOW_STATS_HPP
+#define MEMLLIB_UTILS_WINDOW_STATS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+
+/**
+ * @brief Mean, mean square, RMS and variance over a sliding window, in
+ * O(1) per sample.
+ *
+ * Samples are quantised to 24-bit fixed point (Q23, the codec's own
+ * resolution) and kept in a ring of N. The window's sum and sum of
+ * squares are held in 64-bit integers: adding the new sample and
+ * subtracting the one leaving is exact, so the running sums never drift
+ * or go negative however long it runs. Inputs are clamped to +/-2.
+ *
+ * @tparam N Ring capacity in samples (the longest window), power of 2,
+ * at most 32768 so the sum of squares fits 64 bits.
+ */
+template<size_t N>
+class WindowStats
+{
+public:
+    static_assert((N & (N - 1)) == 0, "Window capacity must be a power of 2");
+    static_assert(N <= 32768, "Window capacity too large for 64-bit sums");
+
+    explicit WindowStats(size_t window = N) {
+        SetWindow(window);
+    }
+
+    /**
+     * @brief Window length in samples, 1..N. Clears the history.
+     */
+    void SetWindow(size_t window) {
+        window_ = window < 1 ? 1 : (window > N ? N : window);
+        Reset();
+    }
+    inline size_t GetWindow() const { return window_; }
+
+    void Reset() {
+        for (size_t i = 0; i < N; i++) {
+            ring_[i] = 0;
+        }
+        pos_ = 0;
+        count_ = 0;
+        sum_ = 0;
+        sum_sq_ = 0;
+    }
+
+    inline void Process(float x) {
+        const int32_t q = Quantise_(x);
+        const size_t out = (pos_ - window_) & kMask;
+        const int32_t old = ring_[out];
+        ring_[pos_] = q;
+        pos_ = (pos_ + 1) & kMask;
+        sum_ += q - old;
+        sum_sq_ += static_cast<int64_t>(q) * q - static_cast<int64_t>(old) * old;
+        if (count_ < window_) {
+            count_++;
+        }
+    }
+
+    void Process(const float *x, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            Process(x[i]);
+        }
+    }
+
+    /**
+     * @brief Samples in the window so far (less than the window length
+     * until it has filled).
+     */
+    inline size_t Count() const { return count_; }
+
+    inline float Mean() const {
+        return count_ ? static_cast<float>(sum_) * (kInvScale / static_cast<float>(count_)) : 0.f;
+    }
+
+    inline float MeanSquare() const {
+        return count_ ? static_cast<float>(sum_sq_) * (kInvScale * kInvScale / static_cast<float>(count_)) : 0.f;
+    }
+
+    inline float RMS() const { return sqrtf(MeanSquare()); }
+
+    /**
+     * @brief Population variance. Computed in double, so a large DC offset
+     * doesn't cancel away a small signal.
+     */
+    inline float Variance() const {
+        if (!count_) {
+            return 0.f;
+        }
+        const double n = static_cast<double>(count_);
+        const double mean = static_cast<double>(sum_) / n;
+        const double var = (static_cast<double>(sum_sq_) / n - mean * mean) *
+                           static_cast<double>(kInvScale) * static_cast<double>(kInvScale);
+        return var > 0.0 ? static_cast<float>(var) : 0.f;
+    }
+
+protected:
+    static constexpr size_t kMask = N - 1;
+    static constexpr float kScale = 8388608.f;     // 2^23
+    static constexpr float kInvScale = 1.f / kScale;
+    static constexpr float kLimit = 2.f - kInvScale;
+
+    int32_t ring_[N];
+    size_t pos_;
+    size_t window_;
+    size_t count_;
+    int64_t sum_;
+    int64_t sum_sq_;
+
+    static inline int32_t Quantise_(float x) {
+        x = x > kLimit ? kLimit : (x < -kLimit ? -kLimit : x);
+        return static_cast<int32_t>(lrintf(x * kScale));
+    }
+};
+
+
+/**
+ * @brief Largest |x| over a sliding window (peak hold for meters), in
+ * amortised O(1) per sample.
+ *
+ * Keeps a fixed-capacity queue of the samples that could still become the
+ * window's peak, in decreasing order: each new sample removes the smaller
+ * ones before it, and the front leaves once it is older than the window.
+ *
+ * @tparam N Longest window in samples, power of 2.
+ */
+template<size_t N>
+class WindowPeak
+{
+public:
+    static_assert((N & (N - 1)) == 0, "Window capacity must be a power of 2");
+
+    explicit WindowPeak(size_t window = N) {
+        SetWindow(window);
+    }
+
+    /**
+     * @brief Window length in samples, 1..N. Clears the history.
+     */
+    void SetWindow(size_t window) {
+        window_ = window < 1 ? 1 : (window > N ? N : window);
+        Reset();
+    }
+    inline size_t GetWindow() const { return window_; }
+
+    inline void Reset() {
+        head_ = 0;
+        size_ = 0;
+        t_ = 0;
+    }
+
+    inline void Process(float x) {
+        // Unsigned difference, so the sample clock may wrap
+        if (size_ && t_ - time_[head_] >= window_) {
+            head_ = (head_ + 1) & kMask;
+            size_--;
+        }
+        const float v = fabsf(x);
+        while (size_ && value_[(head_ + size_ - 1) & kMask] <= v) {
+            size_--;
+        }
+        const size_t back = (head_ + size_) & kMask;
+        value_[back] = v;
+        time_[back] = t_;
+        size_++;
+        t_++;
+    }
+
+    void Process(const float *x, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            Process(x[i]);
+        }
+    }
+
+    inline float Peak() const { return size_ ? value_[head_] : 0.f; }
+
+protected:
+    static constexpr size_t kMask = N - 1;
+
+    float value_[N];
+    uint32_t time_[N];
+    size_t head_;
+    size_t size_;
+    size_t window_;
+    uint32_t t_;
+};
+
+
+/**
+ * @brief Number of events (true inputs) in a sliding window, e.g. zero
+ * crossings per second. One bit of history per sample, exact count.
+ *
+ * @tparam N Longest window in samples, multiple of 32 and power of 2.
+ */
+template<size_t N>
+class WindowCount
+{
+public:
+    static_assert((N & (N - 1)) == 0 && N >= 32, "Window capacity must be a power of 2, at least 32");
+
+    explicit WindowCount(size_t window = N) {
+        SetWindow(window);
+    }
+
+    /**
+     * @brief Window length in samples, 1..N. Clears the history.
+     */
+    void SetWindow(size_t window) {
+        window_ = window < 1 ? 1 : (window > N ? N : window);
+        Reset();
+    }
+    inline size_t GetWindow() const { return window_; }
+
+    void Reset() {
+        for (size_t i = 0; i < kWords; i++) {
+            bits_[i] = 0;
+        }
+        pos_ = 0;
+        count_ = 0;
+    }
+
+    inline void Process(bool event) {
+        const size_t out = (pos_ - window_) & kMask;
+        count_ -= (bits_[out >> 5] >> (out & 31)) & 1u;
+        const uint32_t bit = 1u << (pos_ & 31);
+        uint32_t &word = bits_[pos_ >> 5];
+        word = event ? (word | bit) : (word & ~bit);
+        count_ += event ? 1u : 0u;
+        pos_ = (pos_ + 1) & kMask;
+    }
+
+    inline size_t Count() const { return count_; }
+
+    /**
+     * @brief Events per sample over the window.
+     */
+    inline float Rate() const { return static_cast<float>(count_) / static_cast<float>(window_); }
+
+protected:
+    static constexpr size_t kMask = N - 1;
+    static constexpr size_t kWords = N / 32;
+
+    uint32_t bits_[kWords];
+    size_t pos_;
+    size_t window_;
+    size_t count_;
+};
+
+#endif // MEMLLIB_UTILS_WINDOW_STATS_HPP